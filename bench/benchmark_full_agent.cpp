@@ -1,16 +1,35 @@
-// Benchmark wrapper for the standalone full_agent executable.
-// Runs scenarios A/B/C and measures wall time for each run.
+// In-process comparison of the standalone full_agent (full_agent_core)
+// and the library TelemetryAgent on identical inputs.
+//
+// Each scenario's full_agent simulator sequences are flattened once into
+// per-tick sample lists; every implementation is then fed the same samples
+// in the same order, with output suppressed, and each ingest and each tick
+// is timed individually.
+//
+// Rows:
+//   full_agent      full_agent::TelemetryAgent, samples by name
+//   library/name    telemetry::TelemetryAgent, samples by name
+//   library/handle  telemetry::TelemetryAgent, samples by InterfaceId
+#include <algorithm>
 #include <chrono>
-#include <cstdlib>
+#include <cstdint>
 #include <cstdio>
+#include <cstdlib>
+#include <iostream>
 #include <string>
 #include <vector>
-#include <iostream>
+
+#include "full_agent.hpp"
+#include "latency_histogram.hpp"
+#include "telemetry_agent.hpp"
+
+using Clock = std::chrono::steady_clock;
 
 struct Options {
   bool run_all = true;
   char scenario = 'A';
   int runs = 3;
+  int seconds = 3600;
 };
 
 static char parse_scenario(const std::string& s) {
@@ -39,35 +58,118 @@ static Options parse_args(int argc, char** argv) {
       opt.run_all = false;
     } else if (a == "--runs" && i + 1 < argc) {
       opt.runs = parse_int(argv[++i], "--runs");
+    } else if (a == "--seconds" && i + 1 < argc) {
+      opt.seconds = parse_int(argv[++i], "--seconds");
     } else if (a == "--help" || a == "-h") {
-      std::printf("Usage: benchmark_full_agent [--scenario A|B|C] [--runs N]\n");
+      std::printf("Usage: benchmark_full_agent [--scenario A|B|C] [--runs N] [--seconds N]\n");
       std::exit(0);
     } else {
       std::cerr << "Unknown arg: " << a << "\n";
       std::exit(2);
     }
   }
+  // The simulators place their missing/late samples in the first 90 s.
+  opt.seconds = std::max(opt.seconds, 90);
   return opt;
 }
 
-static std::string full_agent_exe() {
-#ifdef _WIN32
-  return "full_agent.exe";
-#else
-  return "./full_agent";
-#endif
+// The full_agent driver's feed order: at tick t, sample index t of every
+// interface in name order.
+struct FeedSample {
+  std::string iface;
+  telemetry::InterfaceId id = 0;
+  full_agent::Measurement m{};
+};
+
+struct Feed {
+  std::vector<std::string> ifaces;
+  std::vector<std::vector<FeedSample>> ticks;
+  std::size_t samples = 0;
+};
+
+static Feed make_feed(char scenario, int seconds) {
+  const full_agent::ScenarioSequences seq = full_agent::Simulator::getScenario(scenario, seconds);
+  Feed feed;
+  for (const auto& [iface, v] : seq) feed.ifaces.push_back(iface);
+  feed.ticks.resize(static_cast<std::size_t>(seconds));
+  for (int t = 0; t < seconds; ++t) {
+    telemetry::InterfaceId id = 0;
+    for (const auto& [iface, v] : seq) {
+      if (static_cast<std::size_t>(t) < v.size()) {
+        feed.ticks[t].push_back(FeedSample{iface, id, v[t]});
+        ++feed.samples;
+      }
+      ++id;
+    }
+  }
+  return feed;
 }
 
-static double run_once(char scenario) {
-  const std::string cmd = full_agent_exe() + " run --scenario " + std::string(1, scenario);
-  const auto start = std::chrono::steady_clock::now();
-  const int rc = std::system(cmd.c_str());
-  const auto end = std::chrono::steady_clock::now();
-  if (rc != 0) {
-    std::cerr << "full_agent failed for scenario " << scenario << ", rc=" << rc << "\n";
-    std::exit(1);
+struct ImplResult {
+  const char* name = "";
+  telemetry::LatencyHistogram sample_ns;
+  telemetry::LatencyHistogram tick_ns;
+  std::chrono::duration<double> total{0};
+};
+
+static uint64_t ns_between(Clock::time_point a, Clock::time_point b) {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count());
+}
+
+static void run_full_agent(const Feed& feed, ImplResult& r) {
+  full_agent::TelemetryAgent agent(false, nullptr);
+  const auto start = Clock::now();
+  for (int t = 0; t < static_cast<int>(feed.ticks.size()); ++t) {
+    for (const FeedSample& s : feed.ticks[t]) {
+      const auto t0 = Clock::now();
+      agent.processMeasurement(s.iface, s.m, t);
+      r.sample_ns.record(ns_between(t0, Clock::now()));
+    }
+    const auto t0 = Clock::now();
+    agent.tick(t);
+    r.tick_ns.record(ns_between(t0, Clock::now()));
+  }
+  r.total += Clock::now() - start;
+}
+
+static telemetry::Metrics to_metrics(const full_agent::Measurement& m) {
+  return telemetry::Metrics{m.rtt, m.throughput, m.loss, m.jitter};
+}
+
+static void run_library(const Feed& feed, bool by_handle, ImplResult& r) {
+  telemetry::TelemetryAgent agent;
+  for (const auto& iface : feed.ifaces) agent.register_interface(iface);
+  const auto start = Clock::now();
+  for (int t = 0; t < static_cast<int>(feed.ticks.size()); ++t) {
+    for (const FeedSample& s : feed.ticks[t]) {
+      const auto t0 = Clock::now();
+      if (by_handle) {
+        agent.ingest(s.id, s.m.timestamp, to_metrics(s.m));
+      } else {
+        agent.ingest(s.iface, s.m.timestamp, to_metrics(s.m));
+      }
+      r.sample_ns.record(ns_between(t0, Clock::now()));
+    }
+    // full_agent's tick scores, runs the FSM and accumulates the run summary.
+    const auto t0 = Clock::now();
+    agent.note_time(t);
+    agent.record_tick();
+    agent.drain_transitions([](const telemetry::TransitionEvent&) {});
+    r.tick_ns.record(ns_between(t0, Clock::now()));
   }
-  return std::chrono::duration<double>(end - start).count();
+  r.total += Clock::now() - start;
+}
+
+static void print_row(char scenario, const ImplResult& r, int runs) {
+  std::printf("%-9c%-16s%-10llu%-12llu%-12llu%-10llu%-12llu%-12llu%-10.3f\n",
+              scenario, r.name,
+              static_cast<unsigned long long>(r.sample_ns.count()),
+              static_cast<unsigned long long>(r.sample_ns.percentile(0.50)),
+              static_cast<unsigned long long>(r.sample_ns.percentile(0.99)),
+              static_cast<unsigned long long>(r.tick_ns.count()),
+              static_cast<unsigned long long>(r.tick_ns.percentile(0.50)),
+              static_cast<unsigned long long>(r.tick_ns.percentile(0.99)),
+              r.total.count() * 1000.0 / std::max(1, runs));
 }
 
 int main(int argc, char** argv) {
@@ -78,19 +180,37 @@ int main(int argc, char** argv) {
   } else {
     scenarios = {opt.scenario};
   }
+  full_agent::discardLog().setOutput(nullptr);
 
   std::printf("benchmark_full_agent\n");
-  std::printf("  runs=%d\n\n", opt.runs);
+  std::printf("  runs=%d seconds=%d\n\n", opt.runs, opt.seconds);
+  std::printf("%-9s%-16s%-10s%-12s%-12s%-10s%-12s%-12s%-10s\n",
+              "scenario", "impl", "samples", "sample_p50", "sample_p99", "ticks", "tick_p50", "tick_p99",
+              "ms/run");
+  std::printf("%s\n", std::string(103, '-').c_str());
 
   for (char s : scenarios) {
-    double total = 0.0;
+    const Feed feed = make_feed(s, opt.seconds);
+    ImplResult full, by_name, by_handle;
+    full.name = "full_agent";
+    by_name.name = "library/name";
+    by_handle.name = "library/handle";
     for (int i = 0; i < opt.runs; ++i) {
-      total += run_once(s);
+      run_full_agent(feed, full);
+      run_library(feed, false, by_name);
+      run_library(feed, true, by_handle);
     }
-    const double avg = total / std::max(1, opt.runs);
-    std::printf("Scenario %c avg_time_s=%.6f total_time_s=%.6f\n",
-                s, avg, total);
+    print_row(s, full, opt.runs);
+    print_row(s, by_name, opt.runs);
+    print_row(s, by_handle, opt.runs);
   }
 
+  std::printf(
+    "\nLegend:\n"
+    "  sample_p50/p99 = ns per ingest call (full_agent: processMeasurement)\n"
+    "  tick_p50/p99 = ns per tick (full_agent: tick(); library: note_time() + record_tick() + drain)\n"
+    "  ms/run = wall time of one pass over the scenario, timing overhead included\n"
+    "  Each timed call includes ~20-40 ns of clock reads; outputs are suppressed.\n"
+  );
   return 0;
 }
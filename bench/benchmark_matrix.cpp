@@ -0,0 +1,460 @@
+// Large-scale benchmark matrix for TelemetryAgent.
+//
+// Sweeps interface count x samples/s per interface x imperfect-data mode x
+// EWMA off/on. Every cell runs a warmup (window fill) and then --reps
+// measured repetitions, and reports:
+//   - per-ingest and per-tick latency p50/p99/p999 (LatencyHistogram)
+//   - throughput (ingests per second of agent time)
+//   - heap bytes / allocations during the measured phase
+// as an aligned table, CSV or JSON (--format) so runs can be diffed between
+// releases.
+//
+// Samples are synthesised per (interface, second) outside the timed calls;
+// each latency includes one steady_clock read.
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "batch_scorer.hpp"
+#include "latency_histogram.hpp"
+#include "scenarios.hpp"
+#include "telemetry_agent.hpp"
+
+using namespace telemetry;
+
+// --- heap accounting (single-threaded benchmark) ---
+
+static uint64_t g_alloc_bytes = 0;
+static uint64_t g_alloc_count = 0;
+
+void* operator new(std::size_t n) {
+  g_alloc_bytes += n;
+  ++g_alloc_count;
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// --- options ---
+
+enum class Imperfect { None, Missing, Late, Both };
+
+static const char* imperfect_name(Imperfect m) {
+  switch (m) {
+    case Imperfect::None: return "none";
+    case Imperfect::Missing: return "missing";
+    case Imperfect::Late: return "late";
+    case Imperfect::Both: return "both";
+  }
+  return "?";
+}
+
+static const char* recompute_name(RecomputeMode m) {
+  return m == RecomputeMode::PerTick ? "pertick" : "eager";
+}
+
+enum class Format { Table, Csv, Json };
+
+struct Options {
+  std::vector<int> ifaces = {4, 64, 1024, 10000};
+  std::vector<int> rates = {1, 10};
+  std::vector<Imperfect> imperfect = {Imperfect::None, Imperfect::Missing, Imperfect::Late, Imperfect::Both};
+  std::vector<bool> ewma = {false, true};
+  RecomputeMode recompute = RecomputeMode::Eager;
+  int warmup = 45;
+  int seconds = 60;
+  int reps = 3;
+  Format format = Format::Table;
+  std::string out_path;
+};
+
+static int parse_int(const char* s, const char* flag) {
+  try {
+    return std::stoi(s);
+  } catch (...) {
+    std::cerr << "Invalid int for " << flag << ": " << s << "\n";
+    std::exit(2);
+  }
+}
+
+static std::vector<std::string> split_csv(const std::string& s) {
+  std::vector<std::string> out;
+  std::size_t start = 0;
+  while (start <= s.size()) {
+    const std::size_t comma = s.find(',', start);
+    const std::size_t end = (comma == std::string::npos) ? s.size() : comma;
+    if (end > start) out.push_back(s.substr(start, end - start));
+    start = end + 1;
+  }
+  return out;
+}
+
+static std::vector<int> parse_int_list(const std::string& s, const char* flag) {
+  std::vector<int> out;
+  for (const auto& item : split_csv(s)) {
+    const int v = parse_int(item.c_str(), flag);
+    if (v <= 0) {
+      std::cerr << flag << " values must be positive: " << item << "\n";
+      std::exit(2);
+    }
+    out.push_back(v);
+  }
+  return out;
+}
+
+static std::vector<Imperfect> parse_imperfect_list(const std::string& s) {
+  std::vector<Imperfect> out;
+  for (const auto& item : split_csv(s)) {
+    if (item == "none") out.push_back(Imperfect::None);
+    else if (item == "missing") out.push_back(Imperfect::Missing);
+    else if (item == "late") out.push_back(Imperfect::Late);
+    else if (item == "both") out.push_back(Imperfect::Both);
+    else {
+      std::cerr << "Unknown imperfect mode: " << item << " (use none|missing|late|both)\n";
+      std::exit(2);
+    }
+  }
+  return out;
+}
+
+static std::vector<bool> parse_ewma_list(const std::string& s) {
+  std::vector<bool> out;
+  for (const auto& item : split_csv(s)) {
+    if (item == "off") out.push_back(false);
+    else if (item == "on") out.push_back(true);
+    else {
+      std::cerr << "Unknown --ewma value: " << item << " (use off|on)\n";
+      std::exit(2);
+    }
+  }
+  return out;
+}
+
+static Options parse_args(int argc, char** argv) {
+  Options opt;
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    if (a == "--ifaces" && i + 1 < argc) {
+      opt.ifaces = parse_int_list(argv[++i], "--ifaces");
+    } else if (a == "--rates" && i + 1 < argc) {
+      opt.rates = parse_int_list(argv[++i], "--rates");
+    } else if (a == "--imperfect" && i + 1 < argc) {
+      opt.imperfect = parse_imperfect_list(argv[++i]);
+    } else if (a == "--ewma" && i + 1 < argc) {
+      opt.ewma = parse_ewma_list(argv[++i]);
+    } else if (a == "--recompute" && i + 1 < argc) {
+      const std::string m = argv[++i];
+      if (m == "eager") opt.recompute = RecomputeMode::Eager;
+      else if (m == "pertick") opt.recompute = RecomputeMode::PerTick;
+      else {
+        std::cerr << "Unknown --recompute mode: " << m << " (use eager|pertick)\n";
+        std::exit(2);
+      }
+    } else if (a == "--warmup" && i + 1 < argc) {
+      opt.warmup = parse_int(argv[++i], "--warmup");
+    } else if (a == "--seconds" && i + 1 < argc) {
+      opt.seconds = parse_int(argv[++i], "--seconds");
+    } else if (a == "--reps" && i + 1 < argc) {
+      opt.reps = parse_int(argv[++i], "--reps");
+    } else if (a == "--format" && i + 1 < argc) {
+      const std::string f = argv[++i];
+      if (f == "table") opt.format = Format::Table;
+      else if (f == "csv") opt.format = Format::Csv;
+      else if (f == "json") opt.format = Format::Json;
+      else {
+        std::cerr << "Unknown format: " << f << " (use table|csv|json)\n";
+        std::exit(2);
+      }
+    } else if (a == "--out" && i + 1 < argc) {
+      opt.out_path = argv[++i];
+    } else if (a == "--quick") {
+      opt.ifaces = {4, 256};
+      opt.rates = {1};
+      opt.seconds = 30;
+      opt.reps = 1;
+    } else if (a == "--help" || a == "-h") {
+      std::printf(
+        "Usage: benchmark_matrix [--ifaces 4,64,1024,10000] [--rates 1,10]\n"
+        "                        [--imperfect none,missing,late,both] [--ewma off,on]\n"
+        "                        [--recompute eager|pertick] [--warmup S] [--seconds S] [--reps N]\n"
+        "                        [--format table|csv|json] [--out FILE] [--quick]\n\n"
+        "Runs every combination of the lists. --rates is samples/s per interface;\n"
+        "--seconds is simulated time measured per repetition after --warmup.\n"
+        "--quick is a smoke-test preset (4,256 ifaces; 1/s; 30 s; 1 rep).\n"
+      );
+      std::exit(0);
+    } else {
+      std::cerr << "Unknown arg: " << a << "\n";
+      std::exit(2);
+    }
+  }
+  if (opt.seconds <= 0 || opt.reps <= 0 || opt.warmup < 0) {
+    std::cerr << "--seconds and --reps must be positive, --warmup non-negative\n";
+    std::exit(2);
+  }
+  return opt;
+}
+
+// --- one matrix cell ---
+
+struct CellConfig {
+  int ifaces = 4;
+  int rate = 1;
+  Imperfect imperfect = Imperfect::None;
+  bool ewma = true;
+};
+
+struct CellResult {
+  CellConfig cfg;
+  uint64_t ingests = 0;
+  uint64_t ticks = 0;
+  uint64_t transitions = 0;
+  uint64_t ingest_p50 = 0, ingest_p99 = 0, ingest_p999 = 0;
+  uint64_t tick_p50 = 0, tick_p99 = 0, tick_p999 = 0;
+  double busy_s = 0.0; // sum of timed ingest + tick durations
+  uint64_t alloc_bytes = 0;
+  uint64_t alloc_count = 0;
+
+  double ingests_per_s() const { return busy_s > 0.0 ? static_cast<double>(ingests) / busy_s : 0.0; }
+};
+
+// Each interface drifts through good and bad periods at its own phase, so
+// FSMs keep transitioning at every scale.
+static Metrics synth_metrics(int iface, int64_t t, int k) {
+  const double phase = static_cast<double>(t) / 40.0 + static_cast<double>(iface) * 0.7;
+  const double q = 0.5 + 0.5 * std::sin(phase) + 0.02 * static_cast<double>((iface * 31 + k * 7 + t) % 5);
+  const double bad = std::clamp(1.0 - q, 0.0, 1.0);
+  return Metrics{20.0 + 500.0 * bad, 190.0 - 170.0 * bad, 15.0 * bad, 100.0 * bad};
+}
+
+static uint64_t elapsed_ns(std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b) {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count());
+}
+
+static CellResult run_cell(const Options& opt, const CellConfig& cell, const AgentConfig& base_cfg) {
+  AgentConfig cfg = base_cfg;
+  cfg.score.useEwma = cell.ewma;
+
+  const ImperfectDataConfig imp{};
+  const bool missing = (cell.imperfect == Imperfect::Missing || cell.imperfect == Imperfect::Both);
+  const bool late = (cell.imperfect == Imperfect::Late || cell.imperfect == Imperfect::Both);
+
+  CellResult out;
+  out.cfg = cell;
+  LatencyHistogram ingest_hist;
+  LatencyHistogram tick_hist;
+  std::vector<std::string> names;
+  for (int i = 0; i < cell.ifaces; ++i) names.push_back("if" + std::to_string(i));
+
+  for (int rep = 0; rep < opt.reps; ++rep) {
+    TelemetryAgent agent(cfg);
+    std::vector<InterfaceId> ids;
+    ids.reserve(names.size());
+    for (const auto& n : names) ids.push_back(agent.register_interface(n));
+
+    const int64_t end_t = opt.warmup + opt.seconds;
+    uint64_t bytes0 = 0, count0 = 0;
+    for (int64_t t = 0; t < end_t; ++t) {
+      const bool measured = (t >= opt.warmup);
+      if (t == opt.warmup) {
+        bytes0 = g_alloc_bytes;
+        count0 = g_alloc_count;
+      }
+
+      const auto t0 = std::chrono::steady_clock::now();
+      agent.note_time(t);
+      const auto t1 = std::chrono::steady_clock::now();
+      if (measured) {
+        const uint64_t ns = elapsed_ns(t0, t1);
+        tick_hist.record(ns);
+        out.busy_s += static_cast<double>(ns) * 1e-9;
+        ++out.ticks;
+      }
+
+      for (int k = 0; k < cell.rate; ++k) {
+        for (int i = 0; i < cell.ifaces; ++i) {
+          if (missing && ((t + i) % imp.drop_every_n) == 0) continue;
+          int64_t ts = t;
+          if (late && ((t + i + k) % imp.late_every_n) == 0) ts = t - imp.late_by_sec;
+          const Metrics m = synth_metrics(i, t, k);
+
+          const auto a = std::chrono::steady_clock::now();
+          agent.ingest(ids[static_cast<std::size_t>(i)], ts, m);
+          const auto b = std::chrono::steady_clock::now();
+          if (measured) {
+            const uint64_t ns = elapsed_ns(a, b);
+            ingest_hist.record(ns);
+            out.busy_s += static_cast<double>(ns) * 1e-9;
+            ++out.ingests;
+          }
+        }
+      }
+
+      const std::size_t n = agent.drain_transitions([](const TransitionEvent&) {});
+      if (measured) out.transitions += n;
+    }
+    out.alloc_bytes += g_alloc_bytes - bytes0;
+    out.alloc_count += g_alloc_count - count0;
+  }
+
+  out.ingest_p50 = ingest_hist.percentile(0.50);
+  out.ingest_p99 = ingest_hist.percentile(0.99);
+  out.ingest_p999 = ingest_hist.percentile(0.999);
+  out.tick_p50 = tick_hist.percentile(0.50);
+  out.tick_p99 = tick_hist.percentile(0.99);
+  out.tick_p999 = tick_hist.percentile(0.999);
+  return out;
+}
+
+// --- output ---
+
+static void print_table(std::FILE* f, const Options& opt, const std::vector<CellResult>& rows) {
+  std::fprintf(f, "benchmark_matrix  warmup=%d seconds=%d reps=%d kernel=%s recompute=%s\n\n",
+               opt.warmup, opt.seconds, opt.reps, to_string(active_score_kernel()),
+               recompute_name(opt.recompute));
+  std::fprintf(f, "%-8s%-6s%-9s%-6s%-12s%-24s%-28s%-14s%-14s%-10s\n",
+               "ifaces", "rate", "imperf", "ewma", "ingests",
+               "ingest ns p50/99/999", "tick us p50/99/999", "ingests/s", "alloc_B", "allocs");
+  std::fprintf(f, "%s\n", std::string(131, '-').c_str());
+  for (const auto& r : rows) {
+    char ingest_col[64];
+    char tick_col[64];
+    std::snprintf(ingest_col, sizeof(ingest_col), "%llu/%llu/%llu",
+                  static_cast<unsigned long long>(r.ingest_p50),
+                  static_cast<unsigned long long>(r.ingest_p99),
+                  static_cast<unsigned long long>(r.ingest_p999));
+    std::snprintf(tick_col, sizeof(tick_col), "%.1f/%.1f/%.1f",
+                  static_cast<double>(r.tick_p50) / 1e3,
+                  static_cast<double>(r.tick_p99) / 1e3,
+                  static_cast<double>(r.tick_p999) / 1e3);
+    std::fprintf(f, "%-8d%-6d%-9s%-6s%-12llu%-24s%-28s%-14.0f%-14llu%-10llu\n",
+                 r.cfg.ifaces, r.cfg.rate, imperfect_name(r.cfg.imperfect), r.cfg.ewma ? "on" : "off",
+                 static_cast<unsigned long long>(r.ingests), ingest_col, tick_col, r.ingests_per_s(),
+                 static_cast<unsigned long long>(r.alloc_bytes),
+                 static_cast<unsigned long long>(r.alloc_count));
+  }
+  std::fprintf(f,
+    "\nLegend:\n"
+    "  rate = samples/s per interface; imperf = ImperfectDataConfig mode (defaults)\n"
+    "  ingest ns / tick us = latency percentiles of ingest() / note_time() (+1 clock read)\n"
+    "  ingests/s = measured ingests / agent time (timed ingest + tick durations)\n"
+    "  alloc_B / allocs = heap traffic during the measured phase, summed over reps\n");
+}
+
+static const char* kCsvHeader =
+  "ifaces,rate,imperfect,ewma,reps,seconds,ingests,ticks,transitions,"
+  "ingest_p50_ns,ingest_p99_ns,ingest_p999_ns,tick_p50_ns,tick_p99_ns,tick_p999_ns,"
+  "ingests_per_s,alloc_bytes,alloc_count\n";
+
+static void print_csv(std::FILE* f, const Options& opt, const std::vector<CellResult>& rows) {
+  std::fputs(kCsvHeader, f);
+  for (const auto& r : rows) {
+    std::fprintf(f, "%d,%d,%s,%s,%d,%d,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%.0f,%llu,%llu\n",
+                 r.cfg.ifaces, r.cfg.rate, imperfect_name(r.cfg.imperfect), r.cfg.ewma ? "on" : "off",
+                 opt.reps, opt.seconds,
+                 static_cast<unsigned long long>(r.ingests),
+                 static_cast<unsigned long long>(r.ticks),
+                 static_cast<unsigned long long>(r.transitions),
+                 static_cast<unsigned long long>(r.ingest_p50),
+                 static_cast<unsigned long long>(r.ingest_p99),
+                 static_cast<unsigned long long>(r.ingest_p999),
+                 static_cast<unsigned long long>(r.tick_p50),
+                 static_cast<unsigned long long>(r.tick_p99),
+                 static_cast<unsigned long long>(r.tick_p999),
+                 r.ingests_per_s(),
+                 static_cast<unsigned long long>(r.alloc_bytes),
+                 static_cast<unsigned long long>(r.alloc_count));
+  }
+}
+
+static void print_json(std::FILE* f, const Options& opt, const std::vector<CellResult>& rows) {
+  std::fprintf(f, "{\n  \"benchmark\": \"matrix\",\n");
+#ifdef __VERSION__
+  std::fprintf(f, "  \"compiler\": \"%s\",\n", __VERSION__);
+#endif
+  std::fprintf(f, "  \"score_kernel\": \"%s\",\n", to_string(active_score_kernel()));
+  std::fprintf(f, "  \"recompute\": \"%s\",\n", recompute_name(opt.recompute));
+  std::fprintf(f, "  \"warmup\": %d,\n  \"seconds\": %d,\n  \"reps\": %d,\n  \"results\": [\n",
+               opt.warmup, opt.seconds, opt.reps);
+  for (std::size_t i = 0; i < rows.size(); ++i) {
+    const auto& r = rows[i];
+    std::fprintf(f,
+      "    {\"ifaces\": %d, \"rate\": %d, \"imperfect\": \"%s\", \"ewma\": %s, "
+      "\"ingests\": %llu, \"ticks\": %llu, \"transitions\": %llu, "
+      "\"ingest_ns\": {\"p50\": %llu, \"p99\": %llu, \"p999\": %llu}, "
+      "\"tick_ns\": {\"p50\": %llu, \"p99\": %llu, \"p999\": %llu}, "
+      "\"ingests_per_s\": %.0f, \"alloc_bytes\": %llu, \"alloc_count\": %llu}%s\n",
+      r.cfg.ifaces, r.cfg.rate, imperfect_name(r.cfg.imperfect), r.cfg.ewma ? "true" : "false",
+      static_cast<unsigned long long>(r.ingests),
+      static_cast<unsigned long long>(r.ticks),
+      static_cast<unsigned long long>(r.transitions),
+      static_cast<unsigned long long>(r.ingest_p50),
+      static_cast<unsigned long long>(r.ingest_p99),
+      static_cast<unsigned long long>(r.ingest_p999),
+      static_cast<unsigned long long>(r.tick_p50),
+      static_cast<unsigned long long>(r.tick_p99),
+      static_cast<unsigned long long>(r.tick_p999),
+      r.ingests_per_s(),
+      static_cast<unsigned long long>(r.alloc_bytes),
+      static_cast<unsigned long long>(r.alloc_count),
+      (i + 1 < rows.size()) ? "," : "");
+  }
+  std::fprintf(f, "  ]\n}\n");
+}
+
+int main(int argc, char** argv) {
+  const Options opt = parse_args(argc, argv);
+
+  // Same tuning as benchmark_scenarios.
+  AgentConfig base_cfg;
+  base_cfg.score.ewma_alpha = 0.25;
+  base_cfg.fsm.healthy_enter = 0.78;
+  base_cfg.fsm.healthy_exit  = 0.70;
+  base_cfg.fsm.down_enter    = 0.35;
+  base_cfg.fsm.down_exit     = 0.45;
+  base_cfg.fsm.healthy_enter_N = 8;
+  base_cfg.fsm.healthy_exit_N  = 5;
+  base_cfg.fsm.down_enter_N    = 3;
+  base_cfg.fsm.down_exit_N     = 5;
+  base_cfg.fsm.min_dwell_sec   = 5;
+  base_cfg.recompute = opt.recompute;
+
+  std::vector<CellResult> rows;
+  for (int n : opt.ifaces) {
+    for (int rate : opt.rates) {
+      for (Imperfect imp : opt.imperfect) {
+        for (bool ewma : opt.ewma) {
+          rows.push_back(run_cell(opt, CellConfig{n, rate, imp, ewma}, base_cfg));
+          if (opt.format == Format::Table || !opt.out_path.empty()) {
+            std::fprintf(stderr, "  done ifaces=%d rate=%d imperfect=%s ewma=%s\n",
+                         n, rate, imperfect_name(imp), ewma ? "on" : "off");
+          }
+        }
+      }
+    }
+  }
+
+  std::FILE* f = stdout;
+  if (!opt.out_path.empty()) {
+    f = std::fopen(opt.out_path.c_str(), "w");
+    if (!f) {
+      std::perror(opt.out_path.c_str());
+      return 1;
+    }
+  }
+  switch (opt.format) {
+    case Format::Table: print_table(f, opt, rows); break;
+    case Format::Csv: print_csv(f, opt, rows); break;
+    case Format::Json: print_json(f, opt, rows); break;
+  }
+  if (f != stdout) std::fclose(f);
+  return 0;
+}
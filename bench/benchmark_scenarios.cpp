@@ -4,6 +4,17 @@
 //   - run scenarios A, B, C, D
 //   - for each scenario, run twice: useEwma=false then useEwma=true
 //   - print a compact comparison table
+//   - compare RollingWindow::summary() (running sums) against summary_scan()
+//   - compare the scalar and SIMD batch scoring kernels
+//   - compare per-interface fsm_update() against the batched FSM kernels
+//   - compare note_time() visiting every tracker against active ones only
+//   - compare formatting the snapshot table as text against a binary frame
+//   - compare heap bytes per interface and tick cost of the three engines
+//   - compare SampleCollector receive cost with and without recvmmsg batching
+//   - time checkpoint encode, write and restore for a large agent
+//   - compare a per-tick top-4 query by sorting snapshots against best_interfaces()
+//   - time ScenarioGenerator and FleetGenerator per sample against the agent
+//   - time digest pushes and site rollups in a FleetAggregator
 //
 // You can still benchmark a single scenario via: --scenario A|B|C|D
 #include <chrono>
@@ -11,10 +22,26 @@
 #include <cstdlib>
 #include <algorithm>
 #include <cstdio>
+#include <limits>
 #include <string>
 #include <vector>
 #include <iostream>
+#include <arpa/inet.h>
+#include <malloc.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
+#include "batch_scorer.hpp"
+#include "checkpoint.hpp"
+#include "columnar_agent.hpp"
+#include "compact_agent.hpp"
+#include "fleet_generator.hpp"
+#include "fleet_summary.hpp"
+#include "fsm_batch.hpp"
+#include "rolling_window.hpp"
+#include "sample_collector.hpp"
+#include "snapshot_export.hpp"
 #include "telemetry_agent.hpp"
 #include "scenarios.hpp"
 
@@ -30,6 +57,7 @@ struct Options {
   int drop_every_n = 10;
   int late_every_n = 12;
   int late_by_sec = 2;
+  bool batch = false; // feed each tick through ingest_batch()
 };
 
 static ScenarioId parse_scenario(const std::string& s) {
@@ -71,10 +99,12 @@ static Options parse_args(int argc, char** argv) {
       opt.late_every_n = parse_int(argv[++i], "--late-every");
     } else if (a == "--late-by" && i + 1 < argc) {
       opt.late_by_sec = parse_int(argv[++i], "--late-by");
+    } else if (a == "--batch") {
+      opt.batch = true;
     } else if (a == "--help" || a == "-h") {
       std::printf(
         "Usage: benchmark_scenarios [--scenario A|B|C|D] [--seconds N] [--runs N]\n"
-        "                           [--missing] [--late]\n"
+        "                           [--missing] [--late] [--batch]\n"
         "                           [--drop-every N] [--late-every N] [--late-by N]\n\n"
         "Default: runs scenarios A,B,C,D and prints a comparison table for useEwma=false/true.\n"
       );
@@ -130,24 +160,34 @@ static BenchResult bench_one_scenario(const Options& opt, ScenarioId sid, bool u
   imp.late_every_n = opt.late_every_n;
   imp.late_by_sec = opt.late_by_sec;
 
-  for (int run = 0; run < opt.runs; ++run) {
-    TelemetryAgent agent(cfg);
-    for (const auto& iface : ifaces) {
-      agent.ensure_interface(iface);
+  // Generated up front so the timed loop measures the agent only; ids are
+  // registration order.
+  const ScenarioGenerator gen(sid, imp);
+  std::vector<Sample> samples;
+  std::vector<std::size_t> tick_end; // samples[tick_end[t-1], tick_end[t]) belong to tick t
+  for (int64_t t = 0; t < opt.seconds; ++t) {
+    for (std::size_t k = 0; k < ifaces.size(); ++k) {
+      if (auto g = gen.sample(ifaces[k], t)) samples.push_back(Sample{static_cast<InterfaceId>(k), g->ts, g->m});
     }
+    tick_end.push_back(samples.size());
+  }
 
-    ScenarioGenerator gen(sid, imp);
+  for (int run = 0; run < opt.runs; ++run) {
+    TelemetryAgent agent(cfg);
+    for (const auto& iface : ifaces) (void)agent.register_interface(iface);
 
     const auto start = std::chrono::steady_clock::now();
-    int64_t ingests = 0;
+    const int64_t ingests = static_cast<int64_t>(samples.size());
 
+    std::size_t begin = 0;
     for (int64_t t = 0; t < opt.seconds; ++t) {
       agent.note_time(t);
-      for (const auto& iface : ifaces) {
-        auto g = gen.sample(iface, t);
-        if (!g) continue;
-        agent.ingest(iface, g->ts, g->m);
-        ++ingests;
+      const std::span<const Sample> batch(samples.data() + begin, tick_end[t] - begin);
+      begin = tick_end[t];
+      if (opt.batch) {
+        agent.ingest_batch(batch);
+      } else {
+        for (const Sample& smp : batch) agent.ingest(smp.id, smp.ts, smp.m);
       }
       agent.record_tick();
     }
@@ -160,13 +200,614 @@ static BenchResult bench_one_scenario(const Options& opt, ScenarioId sid, bool u
   return out;
 }
 
+struct WindowBenchResult {
+  const char* name = "";
+  int64_t calls = 0;
+  std::chrono::duration<double> total_time{0};
+
+  double ns_per_call() const {
+    return (calls > 0) ? total_time.count() * 1e9 / (double)calls : 0.0;
+  }
+};
+
+// Mirrors the tracker's access pattern: note_time + summary, ingest + summary.
+template <typename SummaryFn>
+static WindowBenchResult bench_window_summary(const Options& opt, const char* name, SummaryFn summary_fn,
+                                              bool quantiles = false) {
+  const int64_t ticks = static_cast<int64_t>(std::max(1, opt.runs)) * 200000;
+
+  WindowBenchResult out;
+  out.name = name;
+
+  RollingWindow w;
+  if (quantiles) w.enable_quantiles();
+  double sink = 0.0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int64_t t = 0; t < ticks; ++t) {
+    w.note_time(t);
+    sink += summary_fn(w).avg_rtt_ms;
+    w.ingest(t, Metrics{20.0 + (double)(t % 7), 180.0, 0.1 * (double)(t % 5), 3.0 + (double)(t % 11)});
+    sink += summary_fn(w).avg_rtt_ms;
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  out.total_time = end - start;
+  out.calls = ticks * 2;
+  if (sink < 0.0) std::printf("%f\n", sink); // keep the loop observable
+  return out;
+}
+
+static void print_window_table(const Options& opt) {
+  const WindowBenchResult fast = bench_window_summary(
+    opt, "summary", [](const RollingWindow& w) { return w.summary(); });
+  const WindowBenchResult scan = bench_window_summary(
+    opt, "summary_scan", [](const RollingWindow& w) { return w.summary_scan(); });
+  const WindowBenchResult quant = bench_window_summary(
+    opt, "quantiles", [](const RollingWindow& w) { return w.summary(); }, true);
+
+  std::printf("\n%-16s%-16s%-14s\n", "window", "calls", "ns/call");
+  std::printf("%s\n", std::string(46, '-').c_str());
+  for (const auto& r : {fast, scan, quant}) {
+    std::printf("%-16s%-16lld%-14.2f\n",
+                r.name,
+                static_cast<long long>(r.calls),
+                r.ns_per_call());
+  }
+}
+
+// Scores a 4096-interface column set repeatedly with one kernel.
+static WindowBenchResult bench_score_kernel(const Options& opt, ScoreKernel k, const ScoreConfig& cfg) {
+  constexpr std::size_t kIfaces = 4096;
+  const int64_t passes = static_cast<int64_t>(std::max(1, opt.runs)) * 400;
+
+  std::vector<double> tp(kIfaces), rtt(kIfaces), loss(kIfaces), jit(kIfaces), conf(kIfaces);
+  std::vector<double> avg(kIfaces), ewma(kIfaces), used(kIfaces);
+  std::vector<uint8_t> have(kIfaces, 0);
+  for (std::size_t i = 0; i < kIfaces; ++i) {
+    tp[i] = (double)(i % 200);
+    rtt[i] = 10.0 + (double)(i % 790);
+    loss[i] = (double)(i % 30) * 0.5;
+    jit[i] = (double)(i % 100);
+    conf[i] = (double)(i % 46) / 45.0;
+  }
+  ScoreBatch b;
+  b.avg_tp_mbps = tp.data();
+  b.avg_rtt_ms = rtt.data();
+  b.avg_loss_pct = loss.data();
+  b.avg_jitter_ms = jit.data();
+  b.confidence = conf.data();
+  b.score_avg = avg.data();
+  b.score_ewma = ewma.data();
+  b.have_ewma = have.data();
+  b.score_used = used.data();
+  b.n = kIfaces;
+
+  WindowBenchResult out;
+  out.name = to_string(k);
+  const auto start = std::chrono::steady_clock::now();
+  for (int64_t p = 0; p < passes; ++p) score_batch_with(k, cfg, b);
+  const auto end = std::chrono::steady_clock::now();
+  out.total_time = end - start;
+  out.calls = passes * static_cast<int64_t>(kIfaces);
+  if (used[kIfaces / 2] < 0.0) std::printf("%f\n", used[0]);
+  return out;
+}
+
+static void print_kernel_table(const Options& opt, const ScoreConfig& cfg) {
+  std::printf("\n%-16s%-16s%-14s\n", "score kernel", "ifaces scored", "ns/iface");
+  std::printf("%s\n", std::string(46, '-').c_str());
+  for (ScoreKernel k : {ScoreKernel::Scalar, ScoreKernel::Avx2, ScoreKernel::Neon}) {
+    if (!score_kernel_available(k)) continue;
+    const WindowBenchResult r = bench_score_kernel(opt, k, cfg);
+    std::printf("%-16s%-16lld%-14.2f\n",
+                r.name,
+                static_cast<long long>(r.calls),
+                r.ns_per_call());
+  }
+}
+
+// Steps 4096 FSMs in mixed states through scores that straddle the
+// thresholds: fsm_update() per entry (kernel == nullptr) vs one batched
+// kernel. Eight score sets rotate so statuses keep changing.
+static WindowBenchResult bench_fsm_kernel(const Options& opt, const ScoreKernel* kernel, const FsmConfig& cfg) {
+  constexpr std::size_t kIfaces = 4096;
+  constexpr std::size_t kSets = 8;
+  const int64_t passes = static_cast<int64_t>(std::max(1, opt.runs)) * 400;
+
+  std::vector<double> score(kSets * kIfaces), conf(kSets * kIfaces);
+  uint64_t x = 0x9e3779b97f4a7c15ULL;
+  for (std::size_t i = 0; i < score.size(); ++i) {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    score[i] = 0.2 + 0.7 * (double)(x >> 40) / (double)(1u << 24);
+    conf[i] = (x & 0xf) == 0 ? 0.3 : 1.0;
+  }
+  std::vector<FsmState> states(kIfaces);
+  for (std::size_t i = 0; i < kIfaces; ++i) states[i].status = static_cast<IfStatus>(i * 7 % 3);
+  std::vector<uint8_t> status(kIfaces);
+  std::vector<int64_t> last(kIfaces, std::numeric_limits<int64_t>::min());
+  std::vector<int> hx(kIfaces, 0), he(kIfaces, 0), de(kIfaces, 0), dx(kIfaces, 0);
+  for (std::size_t i = 0; i < kIfaces; ++i) status[i] = static_cast<uint8_t>(states[i].status);
+  std::vector<FsmChange> changes(kIfaces);
+  FsmBatch b{status.data(), last.data(), hx.data(), he.data(), de.data(), dx.data(), nullptr, nullptr, kIfaces};
+
+  WindowBenchResult out;
+  out.name = kernel ? to_string(*kernel) : "fsm_update";
+  std::size_t transitions = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int64_t p = 0; p < passes; ++p) {
+    const std::size_t set = static_cast<std::size_t>(p) % kSets * kIfaces;
+    if (kernel) {
+      b.score = score.data() + set;
+      b.confidence = conf.data() + set;
+      transitions += fsm_update_batch_with(*kernel, cfg, b, p, changes);
+    } else {
+      for (std::size_t i = 0; i < kIfaces; ++i) {
+        transitions += fsm_update(cfg, states[i], p, score[set + i], conf[set + i]).transitioned;
+      }
+    }
+  }
+  const auto end = std::chrono::steady_clock::now();
+  out.total_time = end - start;
+  out.calls = passes * static_cast<int64_t>(kIfaces);
+  if (transitions == 0) std::printf("fsm: no transitions\n");
+  return out;
+}
+
+static void print_fsm_table(const Options& opt, const FsmConfig& cfg) {
+  std::printf("\n%-16s%-16s%-14s\n", "fsm kernel", "ifaces stepped", "ns/iface");
+  std::printf("%s\n", std::string(46, '-').c_str());
+  std::vector<WindowBenchResult> rows{bench_fsm_kernel(opt, nullptr, cfg)};
+  for (ScoreKernel k : {ScoreKernel::Scalar, ScoreKernel::Avx2}) {
+    if (score_kernel_available(k)) rows.push_back(bench_fsm_kernel(opt, &k, cfg));
+  }
+  for (const WindowBenchResult& r : rows) {
+    std::printf("%-16s%-16lld%-14.2f\n",
+                r.name,
+                static_cast<long long>(r.calls),
+                r.ns_per_call());
+  }
+}
+
+// 10k interfaces of which 1% report every second and the rest are silent:
+// note_time() cost when every tracker is visited vs only the active ones.
+static WindowBenchResult bench_tick_scan(const Options& opt, TickScan scan, const AgentConfig& base_cfg) {
+  constexpr int kIfaces = 10000;
+  constexpr int kReporting = 100;
+  constexpr int64_t kWarmup = 300; // silent trackers settle
+  const int64_t ticks = static_cast<int64_t>(std::max(1, opt.runs)) * 200;
+
+  AgentConfig cfg = base_cfg;
+  cfg.tick_scan = scan;
+  TelemetryAgent agent(cfg);
+  for (int i = 0; i < kIfaces; ++i) agent.register_interface("if" + std::to_string(i));
+
+  WindowBenchResult out;
+  out.name = scan == TickScan::All ? "all" : "active";
+  for (int64_t t = 0; t < kWarmup + ticks; ++t) {
+    for (InterfaceId id = 0; id < kReporting; ++id) {
+      agent.ingest(id, t, Metrics{20.0 + (double)((t + id) % 7), 180.0, 0.1, 3.0});
+    }
+    const auto start = std::chrono::steady_clock::now();
+    agent.note_time(t);
+    if (t >= kWarmup) out.total_time += std::chrono::steady_clock::now() - start;
+  }
+  out.calls = ticks;
+  return out;
+}
+
+static void print_tick_scan_table(const Options& opt, const AgentConfig& cfg) {
+  std::printf("\n%-16s%-16s%-14s\n", "tick scan", "ticks", "ns/tick");
+  std::printf("%s\n", std::string(46, '-').c_str());
+  for (TickScan scan : {TickScan::All, TickScan::Active}) {
+    const WindowBenchResult r = bench_tick_scan(opt, scan, cfg);
+    std::printf("%-16s%-16lld%-14.0f\n",
+                r.name,
+                static_cast<long long>(r.calls),
+                r.ns_per_call());
+  }
+}
+
+// 1000 interfaces: per-tick cost of exporting the snapshot table as the CLI's
+// printf rows (into a buffer, so stdout is not measured) vs one binary frame
+// in a shared-memory ring.
+static WindowBenchResult bench_export(const Options& opt, bool text) {
+  constexpr int kIfaces = 1000;
+  const int64_t ticks = static_cast<int64_t>(std::max(1, opt.runs)) * 200;
+
+  TelemetryAgent agent;
+  for (int i = 0; i < kIfaces; ++i) agent.register_interface("if" + std::to_string(i));
+  ShmRingConfig ring_cfg;
+  ring_cfg.max_interfaces = kIfaces;
+  ShmSnapshotRing ring("/benchmark_scenarios_" + std::to_string(::getpid()), ring_cfg);
+  std::vector<char> buf(kIfaces * 96);
+
+  WindowBenchResult out;
+  out.name = text ? "text rows" : "shm frame";
+  std::size_t sink = 0;
+  for (int64_t t = 0; t < ticks; ++t) {
+    for (InterfaceId id = 0; id < kIfaces; ++id) {
+      agent.ingest(id, t, Metrics{20.0 + (double)((t + id) % 7), 180.0, 0.1, 3.0});
+    }
+    const auto start = std::chrono::steady_clock::now();
+    if (text) {
+      std::size_t at = 0;
+      for (InterfaceId id = 0; id < kIfaces; ++id) {
+        const InterfaceSnapshot& s = agent.snapshot(id);
+        at += std::snprintf(buf.data() + at, buf.size() - at,
+                            "%-6s%-9s%-8.3f%-8.3f%-8.3f%-7.2f%-10.1f%-10.1f%-10.2f%-10.1f\n",
+                            s.iface.c_str(), to_string(s.status), s.score_used, s.score_raw, s.score_smoothed,
+                            s.confidence, s.avg_tp_mbps, s.avg_rtt_ms, s.avg_loss_pct, s.avg_jitter_ms);
+        if (at >= buf.size()) at = 0;
+      }
+      sink += at;
+    } else {
+      ring.publish(agent, t, {});
+    }
+    out.total_time += std::chrono::steady_clock::now() - start;
+  }
+  out.calls = ticks;
+  if (sink == 1) std::printf("%zu\n", sink); // keep the loop observable
+  return out;
+}
+
+static void print_export_table(const Options& opt) {
+  std::printf("\n%-16s%-16s%-14s\n", "export", "ticks", "ns/tick");
+  std::printf("%s\n", std::string(46, '-').c_str());
+  for (bool text : {true, false}) {
+    const WindowBenchResult r = bench_export(opt, text);
+    std::printf("%-16s%-16lld%-14.0f\n",
+                r.name,
+                static_cast<long long>(r.calls),
+                r.ns_per_call());
+  }
+}
+
+// 8192 interfaces (a power of two, so vectors carry no growth slack), all
+// reporting every second: heap growth per interface once the windows have
+// filled (glibc mallinfo2, mmapped blocks included) and note_time() cost.
+struct FootprintResult {
+  const char* name = "";
+  double bytes_per_iface = 0.0;
+  WindowBenchResult tick;
+};
+
+static std::size_t heap_in_use() {
+  const struct mallinfo2 mi = ::mallinfo2();
+  return mi.uordblks + mi.hblkhd;
+}
+
+template <typename Agent>
+static FootprintResult bench_footprint(const Options& opt, const char* name) {
+  constexpr int kIfaces = 8192;
+  const int64_t ticks = static_cast<int64_t>(std::max(1, opt.runs)) * 20;
+  constexpr int64_t kWarmup = RollingWindow::kWindow;
+
+  FootprintResult out;
+  out.name = name;
+  const std::size_t heap_before = heap_in_use();
+  {
+    Agent agent;
+    for (int i = 0; i < kIfaces; ++i) agent.register_interface("tun" + std::to_string(i));
+    for (int64_t t = 0; t < kWarmup + ticks; ++t) {
+      for (InterfaceId id = 0; id < kIfaces; ++id) {
+        agent.ingest(id, t, Metrics{20.0 + (double)((t + id) % 7), 180.0, 0.1, 3.0});
+      }
+      const auto start = std::chrono::steady_clock::now();
+      agent.note_time(t);
+      if (t >= kWarmup) out.tick.total_time += std::chrono::steady_clock::now() - start;
+      agent.drain_transitions([](const TransitionEvent&) {});
+      if (t == kWarmup) {
+        out.bytes_per_iface = static_cast<double>(heap_in_use() - heap_before) / kIfaces;
+      }
+    }
+  }
+  out.tick.calls = ticks;
+  return out;
+}
+
+static void print_footprint_table(const Options& opt) {
+  std::printf("\n%-16s%-16s%-14s\n", "engine", "bytes/iface", "ns/tick");
+  std::printf("%s\n", std::string(46, '-').c_str());
+  for (const FootprintResult& r : {bench_footprint<TelemetryAgent>(opt, "telemetry"),
+                                   bench_footprint<ColumnarTelemetryAgent>(opt, "columnar"),
+                                   bench_footprint<CompactTelemetryAgent>(opt, "compact")}) {
+    std::printf("%-16s%-16.0f%-14.0f\n", r.name, r.bytes_per_iface, r.tick.ns_per_call());
+  }
+}
+
+// 1000 interfaces reporting over UDP loopback in MTU-sized datagrams:
+// SampleCollector receive + decode + ingest_batch() cost per sample, one
+// datagram per recvmmsg() call vs batch datagrams per call. Each round
+// queues 32 datagrams first, so only the receive side is timed.
+struct CollectorResult {
+  uint32_t batch = 0;
+  uint64_t samples = 0;
+  uint64_t recv_calls = 0;
+  std::chrono::duration<double> total_time{0};
+};
+
+static CollectorResult bench_collector(const Options& opt, uint32_t batch) {
+  constexpr int kIfaces = 1000;
+  constexpr int kDatagramsPerRound = 32;
+  const int rounds = std::max(1, opt.runs) * 100;
+
+  TelemetryAgent agent;
+  for (int i = 0; i < kIfaces; ++i) agent.register_interface("if" + std::to_string(i));
+  CollectorConfig cfg;
+  cfg.batch = batch;
+  cfg.tick_ms = 0;
+  SampleCollector collector(agent, cfg);
+  sockaddr_in to{};
+  to.sin_family = AF_INET;
+  to.sin_port = htons(collector.bind_udp("127.0.0.1", 0));
+  ::inet_pton(AF_INET, "127.0.0.1", &to.sin_addr);
+  const int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+
+  std::vector<Sample> samples;
+  std::vector<uint64_t> words;
+  InterfaceId next = 0;
+  CollectorResult out;
+  out.batch = batch;
+  for (int r = 0; r < rounds; ++r) {
+    agent.note_time(r);
+    for (int d = 0; d < kDatagramsPerRound; ++d) {
+      samples.clear();
+      for (std::size_t k = 0; k < kSamplesPerMtu; ++k, next = (next + 1) % kIfaces) {
+        samples.push_back(Sample{next, r, Metrics{20.0 + (double)((r + next) % 7), 180.0, 0.1, 3.0}});
+      }
+      encode_samples(samples, words);
+      (void)::sendto(fd, words.data(), words.size() * 8, 0, reinterpret_cast<const sockaddr*>(&to), sizeof to);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    while (collector.poll(0) > 0) {}
+    out.total_time += std::chrono::steady_clock::now() - start;
+  }
+  ::close(fd);
+  out.samples = collector.stats().samples;
+  out.recv_calls = collector.stats().recv_calls;
+  return out;
+}
+
+static void print_collector_table(const Options& opt) {
+  std::printf("\n%-16s%-16s%-16s%-14s%-14s\n", "collector", "samples", "recv calls", "ns/sample", "Msamples/s");
+  std::printf("%s\n", std::string(76, '-').c_str());
+  for (uint32_t batch : {1u, 64u}) {
+    const CollectorResult r = bench_collector(opt, batch);
+    const double secs = r.total_time.count();
+    std::printf("%-16s%-16llu%-16llu%-14.1f%-14.2f\n",
+                batch == 1 ? "recvmmsg x1" : "recvmmsg x64",
+                static_cast<unsigned long long>(r.samples),
+                static_cast<unsigned long long>(r.recv_calls),
+                r.samples > 0 ? secs * 1e9 / (double)r.samples : 0.0,
+                secs > 0 ? (double)r.samples / secs / 1e6 : 0.0);
+  }
+}
+
+// 8192 interfaces with full windows: checkpoint encode (on the agent's
+// thread), atomic file write, and mmap + restore into a fresh agent.
+static void print_checkpoint_table(const Options& opt) {
+  constexpr int kIfaces = 8192;
+  const int reps = std::max(1, opt.runs);
+  TelemetryAgent agent;
+  for (int i = 0; i < kIfaces; ++i) agent.register_interface("tun" + std::to_string(i));
+  for (int64_t t = 0; t < RollingWindow::kWindow; ++t) {
+    agent.note_time(t);
+    for (InterfaceId id = 0; id < kIfaces; ++id) {
+      agent.ingest(id, t, Metrics{20.0 + (double)((t + id) % 7), 180.0, 0.1, 3.0});
+    }
+  }
+  const int64_t tick = RollingWindow::kWindow - 1;
+  const std::string path = "/tmp/benchmark_scenarios_" + std::to_string(::getpid()) + ".ckpt";
+
+  std::vector<uint64_t> words;
+  std::chrono::duration<double> encode{0}, write{0}, restore{0};
+  for (int r = 0; r < reps; ++r) {
+    auto t0 = std::chrono::steady_clock::now();
+    encode_checkpoint(agent, tick, words);
+    auto t1 = std::chrono::steady_clock::now();
+    write_checkpoint_file(path, words);
+    auto t2 = std::chrono::steady_clock::now();
+    TelemetryAgent restored;
+    (void)restore_checkpoint(restored, path);
+    auto t3 = std::chrono::steady_clock::now();
+    encode += t1 - t0;
+    write += t2 - t1;
+    restore += t3 - t2;
+  }
+  std::remove(path.c_str());
+
+  std::printf("\n%-16s%-16s%-14s%-14s%-14s\n", "checkpoint", "MB", "encode ms", "write ms", "restore ms");
+  std::printf("%s\n", std::string(74, '-').c_str());
+  std::printf("%-16d%-16.1f%-14.2f%-14.2f%-14.2f\n", kIfaces, (double)words.size() * 8 / 1e6,
+              encode.count() * 1e3 / reps, write.count() * 1e3 / reps, restore.count() * 1e3 / reps);
+}
+
+// 10k interfaces of which 1% report every second: per-tick cost of picking
+// the 4 best Healthy interfaces by sorting every snapshot vs best_interfaces().
+static WindowBenchResult bench_top_k(const Options& opt, bool ranked) {
+  constexpr int kIfaces = 10000;
+  constexpr int kReporting = 100;
+  constexpr std::size_t kTop = 4;
+  constexpr int64_t kWarmup = 300;
+  const int64_t ticks = static_cast<int64_t>(std::max(1, opt.runs)) * 200;
+
+  AgentConfig cfg;
+  cfg.tick_scan = TickScan::Active;
+  TelemetryAgent agent(cfg);
+  for (int i = 0; i < kIfaces; ++i) {
+    const InterfaceId id = agent.register_interface("if" + std::to_string(i));
+    agent.ingest(id, 0, Metrics{20.0 + (double)(i % 11), 180.0, 0.1, 3.0});
+  }
+
+  std::vector<InterfaceId> ids(kIfaces), best(kTop);
+  volatile InterfaceId sink = 0;
+  WindowBenchResult out;
+  out.name = ranked ? "best_interfaces" : "partial_sort";
+  for (int64_t t = 0; t < kWarmup + ticks; ++t) {
+    for (InterfaceId id = 0; id < kReporting; ++id) {
+      agent.ingest(id, t, Metrics{20.0 + (double)((t + id) % 7), 180.0, 0.1, 3.0});
+    }
+    agent.note_time(t);
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t n = 0;
+    if (ranked) {
+      n = agent.best_interfaces(kTop, IfStatus::Healthy, best);
+    } else {
+      std::size_t healthy = 0;
+      for (InterfaceId id = 0; id < kIfaces; ++id) {
+        if (agent.snapshot(id).status == IfStatus::Healthy) ids[healthy++] = id;
+      }
+      const auto by_score = [&](InterfaceId a, InterfaceId b) {
+        const double sa = agent.snapshot(a).score_used, sb = agent.snapshot(b).score_used;
+        return sa != sb ? sa > sb : a < b;
+      };
+      n = std::min(healthy, kTop);
+      std::partial_sort(ids.begin(), ids.begin() + n, ids.begin() + healthy, by_score);
+      std::copy_n(ids.begin(), n, best.begin());
+    }
+    if (n > 0) sink = best[0];
+    if (t >= kWarmup) out.total_time += std::chrono::steady_clock::now() - start;
+  }
+  (void)sink;
+  out.calls = ticks;
+  return out;
+}
+
+static void print_top_k_table(const Options& opt) {
+  std::printf("\n%-16s%-16s%-14s\n", "top-4 query", "ticks", "ns/tick");
+  std::printf("%s\n", std::string(46, '-').c_str());
+  for (bool ranked : {false, true}) {
+    const WindowBenchResult r = bench_top_k(opt, ranked);
+    std::printf("%-16s%-16lld%-14.0f\n",
+                r.name,
+                static_cast<long long>(r.calls),
+                r.ns_per_call());
+  }
+}
+
+// Generator cost per sample next to what the agent spends on it: the
+// four-interface ScenarioGenerator (string dispatch per sample) and a
+// 10k-interface FleetGenerator filling whole ticks (5% missing, 2% late).
+struct GeneratorResult {
+  const char* name = "";
+  int64_t samples = 0;
+  std::chrono::duration<double> gen_time{0};
+  std::chrono::duration<double> agent_time{0};
+};
+
+static GeneratorResult bench_generator(const Options& opt, bool fleet) {
+  const int64_t ticks = static_cast<int64_t>(std::max(1, opt.runs)) * 60;
+  const std::vector<std::string> names = {"eth0", "wifi0", "lte0", "sat0"};
+  FleetConfig fc;
+  fc.interfaces = fleet ? 10000 : names.size();
+  fc.missing_rate = 0.05;
+  fc.late_rate = 0.02;
+  const FleetGenerator fleet_gen(fc);
+  ImperfectDataConfig imp;
+  imp.enable_missing = true;
+  imp.enable_late = true;
+  const ScenarioGenerator scenario_gen(ScenarioId::B, imp);
+
+  TelemetryAgent agent;
+  for (std::size_t i = 0; i < fc.interfaces; ++i) {
+    agent.register_interface(fleet ? "if" + std::to_string(i) : names[i]);
+  }
+  std::vector<Sample> batch(fc.interfaces);
+
+  GeneratorResult out;
+  out.name = fleet ? "fleet x10000" : "scenario x4";
+  for (int64_t t = 0; t < ticks; ++t) {
+    const auto t0 = std::chrono::steady_clock::now();
+    std::size_t n = 0;
+    if (fleet) {
+      n = fleet_gen.tick(t, batch);
+    } else {
+      for (std::size_t k = 0; k < names.size(); ++k) {
+        if (auto g = scenario_gen.sample(names[k], t)) batch[n++] = Sample{static_cast<InterfaceId>(k), g->ts, g->m};
+      }
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    agent.ingest_batch(std::span<const Sample>(batch.data(), n));
+    agent.note_time(t);
+    const auto t2 = std::chrono::steady_clock::now();
+    out.gen_time += t1 - t0;
+    out.agent_time += t2 - t1;
+    out.samples += static_cast<int64_t>(n);
+  }
+  return out;
+}
+
+static void print_generator_table(const Options& opt) {
+  std::printf("\n%-16s%-16s%-16s%-14s\n", "generator", "samples", "gen ns/sample", "agent ns/sample");
+  std::printf("%s\n", std::string(62, '-').c_str());
+  for (bool fleet : {false, true}) {
+    const GeneratorResult r = bench_generator(opt, fleet);
+    const double per = r.samples > 0 ? 1e9 / (double)r.samples : 0.0;
+    std::printf("%-16s%-16lld%-16.1f%-14.1f\n",
+                r.name,
+                static_cast<long long>(r.samples),
+                r.gen_time.count() * per,
+                r.agent_time.count() * per);
+  }
+}
+
+// One 64-interface agent stands in for 500 nodes over 10 sites, each
+// pushing 4 uplink digests: push encode, aggregator ingest and site rollup.
+static void print_aggregator_table(const Options& opt) {
+  constexpr int kNodes = 500;
+  constexpr int kSites = 10;
+  const int reps = std::max(1, opt.runs);
+  FleetConfig fc;
+  fc.interfaces = 64;
+  const FleetGenerator fleet(fc);
+  TelemetryAgent agent;
+  for (std::size_t i = 0; i < fleet.size(); ++i) agent.register_interface("if" + std::to_string(i));
+  std::vector<Sample> batch(fleet.size());
+  for (int64_t t = 0; t < RollingWindow::kWindow; ++t) {
+    agent.ingest_batch(std::span<const Sample>(batch.data(), fleet.tick(t, batch)));
+    agent.note_time(t);
+  }
+  static const char* kUplinks[] = {"mpls", "inet", "lte", "sat"};
+  const GroupOf uplink_of = [](InterfaceId id) { return std::string_view(kUplinks[id % 4]); };
+
+  FleetAggregator agg;
+  std::vector<std::byte> datagram;
+  std::chrono::duration<double> encode{0}, ingest{0}, rollup{0};
+  for (int r = 0; r < reps; ++r) {
+    for (int n = 0; n < kNodes; ++n) {
+      const auto t0 = std::chrono::steady_clock::now();
+      std::string site = "site", node = "r";
+      site += std::to_string(n % kSites);
+      node += std::to_string(n);
+      const DigestPush push = make_push(agent, std::move(site), std::move(node), r, uplink_of);
+      encode_push(push, datagram);
+      const auto t1 = std::chrono::steady_clock::now();
+      (void)agg.ingest(datagram);
+      ingest += std::chrono::steady_clock::now() - t1;
+      encode += t1 - t0;
+    }
+    const auto t0 = std::chrono::steady_clock::now();
+    uint64_t seen = 0;
+    for (const auto& site : agg.sites()) seen += agg.site(site).interfaces;
+    rollup += std::chrono::steady_clock::now() - t0;
+    if (seen != uint64_t{kNodes} * fleet.size()) std::printf("aggregator: unexpected rollup size\n");
+  }
+
+  std::printf("\n%-16s%-16s%-16s%-16s%-14s\n", "aggregator", "push bytes", "encode us", "ingest us", "rollup ms");
+  std::printf("%s\n", std::string(78, '-').c_str());
+  std::printf("%-16s%-16zu%-16.1f%-16.1f%-14.2f\n", "500 nodes", datagram.size(),
+              encode.count() * 1e6 / (reps * kNodes), ingest.count() * 1e6 / (reps * kNodes),
+              rollup.count() * 1e3 / reps);
+}
+
 static void print_table_header(const Options& opt) {
   std::printf("benchmark_scenarios\n");
-  std::printf("  runs=%d seconds=%d missing=%s late=%s",
+  std::printf("  runs=%d seconds=%d missing=%s late=%s batch=%s",
               opt.runs,
               opt.seconds,
               opt.missing ? "true" : "false",
-              opt.late ? "true" : "false");
+              opt.late ? "true" : "false",
+              opt.batch ? "true" : "false");
   if (opt.missing) std::printf(" drop_every=%d", opt.drop_every_n);
   if (opt.late) std::printf(" late_every=%d late_by=%d", opt.late_every_n, opt.late_by_sec);
   std::printf("\n\n");
@@ -219,11 +860,34 @@ int main(int argc, char** argv) {
     print_row(r_ewma);
   }
 
+  print_window_table(opt);
+  print_kernel_table(opt, base_cfg.score);
+  print_fsm_table(opt, base_cfg.fsm);
+  print_tick_scan_table(opt, base_cfg);
+  print_export_table(opt);
+  print_footprint_table(opt);
+  print_collector_table(opt);
+  print_checkpoint_table(opt);
+  print_top_k_table(opt);
+  print_generator_table(opt);
+  print_aggregator_table(opt);
+
   std::printf(
     "\nLegend:\n"
     "  avg_ms/run = average wall time per run (lower is faster)\n"
-    "  total_ingests = total number of agent.ingest() calls across all runs\n"
+    "  total_ingests = total number of samples ingested across all runs\n"
     "  ingests/s = total_ingests / total_wall_time\n"
+    "  window ns/call = RollingWindow note_time/ingest + summary call (running sums vs 45-slot scan; quantiles = running sums + RTT/jitter/loss order statistics)\n"
+    "  score kernel ns/iface = batch normalise/weight/EWMA/cap cost per interface\n"
+    "  fsm kernel ns/iface = one FSM step per interface, 4096 in mixed states: fsm_update() per entry vs fsm_update_batch_with()\n"
+    "  tick scan ns/tick = note_time() over 10k interfaces with 1%% reporting (TickScan::All vs Active)\n"
+    "  export ns/tick = 1000-interface snapshot table as printf rows vs one ShmSnapshotRing frame\n"
+    "  engine bytes/iface = heap per interface with 8192 interfaces (TelemetryAgent, ColumnarTelemetryAgent, CompactTelemetryAgent)\n"
+    "  collector ns/sample = UDP loopback receive + decode + ingest_batch(), 1 vs 64 datagrams per recvmmsg()\n"
+    "  checkpoint ms = 8192 full windows: encode_checkpoint(), write_checkpoint_file() (fsync), restore_checkpoint()\n"
+    "  top-4 query ns/tick = 4 best Healthy of 10k interfaces (1%% reporting): partial_sort of every snapshot vs best_interfaces()\n"
+    "  generator ns/sample = sample generation vs ingest_batch() + note_time(), 4-interface ScenarioGenerator vs 10k-interface FleetGenerator\n"
+    "  aggregator = 64-interface digest push (4 uplinks): make_push() + encode_push(), FleetAggregator::ingest(), all 10 site rollups\n"
   );
   return 0;
 }
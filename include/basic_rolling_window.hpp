@@ -0,0 +1,287 @@
+// basic_rolling_window.hpp
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+
+#include "metric_descriptors.hpp"
+
+namespace telemetry {
+
+// Merged: a sample folded into an occupied second by merge().
+enum class WindowIngestResult : uint8_t { Inserted, Overwritten, Merged, TooOld };
+
+// Default observer: BasicRollingWindow calls on_add/on_remove for every
+// per-second value entering or leaving the window, and on_clear when the
+// whole window expires at once. Empty, so it costs nothing.
+struct NoWindowObserver {
+  template <typename Values> void on_add(const Values&) {}
+  template <typename Values> void on_remove(const Values&) {}
+  void on_clear() {}
+};
+
+// Sliding window of Length seconds over the metrics in Set (a MetricSet).
+//
+// Same semantics as RollingWindow: one slot per second, out-of-order samples
+// inside [newest_ts - (Length-1), newest_ts] accepted, older ones rejected,
+// running sums kept so summary() is O(1). The ring has bit_ceil(Length)
+// slots so a timestamp maps to its slot with a mask; choose a power-of-two
+// Length (e.g. 64) to use every slot.
+//
+// Header-only so each instantiation constant-folds Length and the metric
+// count into its loops. Observer sees the same add/remove stream as the
+// running sums, for order statistics and the like.
+template <std::size_t Length, typename Set, typename Observer = NoWindowObserver>
+class BasicRollingWindow {
+public:
+  static_assert(Length > 0, "window must hold at least one second");
+
+  static constexpr int kWindow = static_cast<int>(Length);
+  static constexpr std::size_t kSlots = std::bit_ceil(Length);
+  static constexpr std::size_t kMetrics = Set::size;
+
+  using Values = typename Set::Values;
+  using IngestResult = WindowIngestResult;
+
+  struct Summary {
+    int64_t newest_ts = 0;
+    int64_t oldest_ts = 0;
+    int count = 0;
+    double confidence = 0.0;   // count / Length
+    double missing_rate = 1.0; // 1 - confidence
+    Values avg{};              // per-metric mean, in Set order
+  };
+
+  // One occupied second, as saved and restored by checkpoints.
+  struct Second {
+    int64_t ts = 0;
+    Values v{};
+    uint32_t samples = 0;
+  };
+
+  // A second sample for the same second replaces the first.
+  IngestResult insert(int64_t ts, const Values& v) {
+    Slot* slot = slot_for_(ts);
+    if (!slot) return IngestResult::TooOld;
+    const bool overwrite = slot->ts != kEmpty;
+    if (overwrite) remove_(slot->v);
+    slot->ts = ts;
+    slot->v = v;
+    samples_[idx(ts)] = 1;
+    add_(v);
+    return overwrite ? IngestResult::Overwritten : IngestResult::Inserted;
+  }
+
+  // A second sample for the same second is averaged in: the slot holds the
+  // running mean of its samples and still counts as one second.
+  IngestResult merge(int64_t ts, const Values& v) {
+    Slot* slot = slot_for_(ts);
+    if (!slot) return IngestResult::TooOld;
+    uint32_t& n = samples_[idx(ts)];
+    if (slot->ts == kEmpty) {
+      slot->ts = ts;
+      slot->v = v;
+      n = 1;
+      add_(v);
+      return IngestResult::Inserted;
+    }
+    remove_(slot->v);
+    const double dn = static_cast<double>(++n);
+    for (std::size_t k = 0; k < kMetrics; ++k) slot->v[k] += (v[k] - slot->v[k]) / dn;
+    add_(slot->v);
+    return IngestResult::Merged;
+  }
+
+  // Advance time without adding a sample (expires old slots).
+  void note_time(int64_t ts_now) {
+    if (newest_ts_ == kEmpty) {
+      newest_ts_ = ts_now;
+      return;
+    }
+    if (ts_now > newest_ts_) advance_(ts_now);
+  }
+
+  Summary summary() const {
+    Summary s;
+    if (newest_ts_ == kEmpty) return s;
+    s.newest_ts = newest_ts_;
+    s.oldest_ts = newest_ts_ - (kWindow - 1);
+    s.count = count_;
+    s.confidence = static_cast<double>(count_) / static_cast<double>(kWindow);
+    s.missing_rate = 1.0 - s.confidence;
+    if (count_ > 0) {
+      for (std::size_t k = 0; k < kMetrics; ++k) s.avg[k] = sums_[k] / count_;
+    }
+    return s;
+  }
+
+  // Reference O(kSlots) rescan; kept for parity tests and benches.
+  Summary summary_scan() const {
+    Summary s;
+    if (newest_ts_ == kEmpty) return s;
+    s.newest_ts = newest_ts_;
+    s.oldest_ts = newest_ts_ - (kWindow - 1);
+
+    Values sums{};
+    int count = 0;
+    for (const auto& slot : slots_) {
+      if (slot.ts == kEmpty || slot.ts < s.oldest_ts || slot.ts > s.newest_ts) continue;
+      for (std::size_t k = 0; k < kMetrics; ++k) sums[k] += slot.v[k];
+      ++count;
+    }
+    s.count = count;
+    s.confidence = static_cast<double>(count) / static_cast<double>(kWindow);
+    s.missing_rate = 1.0 - s.confidence;
+    if (count > 0) {
+      for (std::size_t k = 0; k < kMetrics; ++k) s.avg[k] = sums[k] / count;
+    }
+    return s;
+  }
+
+  int64_t newest_ts() const { return newest_ts_; }
+
+  // Oldest occupied second (expires once time reaches it + Length); O(Length).
+  std::optional<int64_t> oldest_sample_ts() const {
+    if (count_ == 0) return std::nullopt;
+    int64_t t = newest_ts_ - (kWindow - 1);
+    while (slots_[idx(t)].ts != t) ++t;
+    return t;
+  }
+
+  // Running sums exactly as held (they carry the rounding of every add and
+  // remove, so a rescan of the slots need not reproduce them bit for bit).
+  const Values& sums() const { return sums_; }
+
+  // Occupied seconds, oldest first.
+  template <typename Fn>
+  void for_each_second(Fn&& fn) const {
+    if (count_ == 0) return;
+    for (int64_t t = newest_ts_ - (kWindow - 1); t <= newest_ts_; ++t) {
+      const Slot& slot = slots_[idx(t)];
+      if (slot.ts == t) fn(Second{t, slot.v, samples_[idx(t)]});
+    }
+  }
+
+  // Replaces the contents with saved state: newest_ts() (the int64_t
+  // minimum if the window never saw a timestamp), for_each_second() and
+  // sums(), so later summaries match the saved window bit for bit. The
+  // observer sees every second added.
+  // Returns false, leaving the window empty, if a second lies outside the
+  // window, repeats or has no samples.
+  bool restore(int64_t newest_ts, const Values& sums, std::span<const Second> seconds) {
+    clear_();
+    if (newest_ts == kEmpty) return seconds.empty();
+    newest_ts_ = newest_ts;
+    for (const Second& sec : seconds) {
+      Slot& slot = slots_[idx(sec.ts)];
+      if (sec.ts > newest_ts || sec.ts < newest_ts - (kWindow - 1) || slot.ts != kEmpty || sec.samples == 0) {
+        clear_();
+        return false;
+      }
+      slot.ts = sec.ts;
+      slot.v = sec.v;
+      samples_[idx(sec.ts)] = sec.samples;
+      ++count_;
+      obs_.on_add(sec.v);
+    }
+    sums_ = count_ > 0 ? sums : Values{};
+    return true;
+  }
+
+  Observer& observer() { return obs_; }
+  const Observer& observer() const { return obs_; }
+
+  bool has_sample(int64_t ts) const { return ts != kEmpty && slots_[idx(ts)].ts == ts; }
+
+  // Samples folded into second ts (0 if none).
+  uint32_t samples_at(int64_t ts) const { return has_sample(ts) ? samples_[idx(ts)] : 0; }
+
+  std::optional<Values> get(int64_t ts) const {
+    const Slot& slot = slots_[idx(ts)];
+    if (ts != kEmpty && slot.ts == ts) return slot.v;
+    return std::nullopt;
+  }
+
+private:
+  // Marks an empty slot and an empty window; never a real sample time.
+  static constexpr int64_t kEmpty = std::numeric_limits<int64_t>::min();
+
+  struct Slot {
+    int64_t ts = kEmpty;
+    Values v{};
+  };
+
+  // Two's-complement wrap makes this a non-negative modulo for negative ts too.
+  static std::size_t idx(int64_t ts) { return static_cast<std::size_t>(ts) & (kSlots - 1); }
+
+  void clear_() {
+    for (auto& slot : slots_) slot.ts = kEmpty;
+    newest_ts_ = kEmpty;
+    sums_ = Values{};
+    count_ = 0;
+    obs_.on_clear();
+  }
+
+  // Advances time to ts if newer; nullptr if ts is too old for the window.
+  // By the invariant, an occupied slot returned here holds the same ts.
+  Slot* slot_for_(int64_t ts) {
+    if (newest_ts_ == kEmpty) {
+      newest_ts_ = ts;
+    } else if (ts > newest_ts_) {
+      advance_(ts);
+    }
+    if (ts < newest_ts_ - (kWindow - 1)) return nullptr;
+    return &slots_[idx(ts)];
+  }
+
+  void advance_(int64_t ts_now) {
+    if (ts_now - newest_ts_ >= kWindow) {
+      // Jump past the whole window: everything expires.
+      for (auto& slot : slots_) slot.ts = kEmpty;
+      sums_ = Values{};
+      count_ = 0;
+      obs_.on_clear();
+    } else {
+      const int64_t old_oldest = newest_ts_ - (kWindow - 1);
+      const int64_t new_oldest = ts_now - (kWindow - 1);
+      for (int64_t t = old_oldest; t < new_oldest; ++t) {
+        Slot& slot = slots_[idx(t)];
+        if (slot.ts != t) continue;
+        remove_(slot.v);
+        slot.ts = kEmpty;
+      }
+    }
+    newest_ts_ = ts_now;
+  }
+
+  void add_(const Values& v) {
+    for (std::size_t k = 0; k < kMetrics; ++k) sums_[k] += v[k];
+    ++count_;
+    obs_.on_add(v);
+  }
+
+  void remove_(const Values& v) {
+    obs_.on_remove(v);
+    if (--count_ == 0) {
+      // Drop accumulated rounding error whenever the window empties.
+      sums_ = Values{};
+      return;
+    }
+    for (std::size_t k = 0; k < kMetrics; ++k) sums_[k] -= v[k];
+  }
+
+  // Invariant: every occupied slot has ts inside [newest_ts_ - (kWindow-1), newest_ts_].
+  std::array<Slot, kSlots> slots_{};
+  std::array<uint32_t, kSlots> samples_{}; // per slot, kept apart so Slot stays dense
+  int64_t newest_ts_ = kEmpty;
+  Values sums_{};
+  int count_ = 0;
+  [[no_unique_address]] Observer obs_{};
+};
+
+} // namespace telemetry
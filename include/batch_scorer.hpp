@@ -0,0 +1,50 @@
+// batch_scorer.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "interface_tracker.hpp"
+
+namespace telemetry {
+
+// Structure-of-arrays view of N window summaries and their score state.
+//
+// Inputs are the window means and confidence; score_ewma/have_ewma carry the
+// EWMA across calls; score_avg/score_used are written. All arrays hold n entries.
+struct ScoreBatch {
+  const double* avg_tp_mbps = nullptr;
+  const double* avg_rtt_ms = nullptr;
+  const double* avg_loss_pct = nullptr;
+  const double* avg_jitter_ms = nullptr;
+  const double* confidence = nullptr;
+
+  double* score_avg = nullptr;  // out
+  double* score_ewma = nullptr; // in/out
+  uint8_t* have_ewma = nullptr; // in/out (0/1)
+  double* score_used = nullptr; // out
+
+  std::size_t n = 0;
+};
+
+enum class ScoreKernel { Scalar, Avx2, Neon };
+
+const char* to_string(ScoreKernel k);
+
+// True if `k` was compiled in and the running CPU supports it.
+bool score_kernel_available(ScoreKernel k);
+
+// Fastest available kernel, chosen once at runtime (not by -march).
+ScoreKernel active_score_kernel();
+
+// Batch equivalent of InterfaceTracker's normalise -> weight -> EWMA ->
+// downtrend penalty -> confidence cap pipeline.
+//
+// The vector kernels use the same operation order and clamp selects as the
+// scalar path and never fuse multiply-adds, so results match InterfaceTracker
+// to within 1e-12 (any difference comes from the compiler contracting the
+// scalar path into FMAs; without contraction they are bit-identical).
+void score_batch(const ScoreConfig& cfg, const ScoreBatch& b);
+void score_batch_with(ScoreKernel k, const ScoreConfig& cfg, const ScoreBatch& b);
+
+} // namespace telemetry
@@ -0,0 +1,250 @@
+// bucketed_window.hpp
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+
+#include "basic_rolling_window.hpp"
+#include "metric_descriptors.hpp"
+
+namespace telemetry {
+
+// Count / sum / min / max of any number of samples over a MetricSet.
+template <typename Set>
+struct MetricAggregate {
+  using Values = typename Set::Values;
+
+  uint32_t n = 0;
+  Values sum{};
+  Values min{};
+  Values max{};
+
+  void add(const Values& v) {
+    if (n == 0) {
+      min = v;
+      max = v;
+    } else {
+      for (std::size_t k = 0; k < Set::size; ++k) {
+        min[k] = std::min(min[k], v[k]);
+        max[k] = std::max(max[k], v[k]);
+      }
+    }
+    for (std::size_t k = 0; k < Set::size; ++k) sum[k] += v[k];
+    ++n;
+  }
+
+  double mean(std::size_t k) const { return n > 0 ? sum[k] / n : 0.0; }
+};
+
+namespace detail {
+inline int64_t floor_div(int64_t a, int64_t b) {
+  const int64_t q = a / b;
+  return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+} // namespace detail
+
+// Ring of Buckets aggregates, each covering BucketSec seconds, keyed by
+// floor(ts / BucketSec). Samples land in their bucket directly, so every
+// update is O(1) and memory is fixed; late samples are accepted while their
+// bucket is still in the ring. BucketSec = 1 is a sub-second-capable 1 s
+// window; larger buckets give the coarse tiers of MultiResolutionWindow.
+template <int64_t BucketSec, std::size_t Buckets, typename Set>
+class BucketRing {
+public:
+  static_assert(BucketSec > 0 && Buckets > 0);
+
+  static constexpr int64_t kBucketSec = BucketSec;
+  static constexpr std::size_t kBuckets = Buckets;
+  static constexpr std::size_t kSlots = std::bit_ceil(Buckets);
+
+  using Values = typename Set::Values;
+  using Aggregate = MetricAggregate<Set>;
+  using IngestResult = WindowIngestResult;
+
+  struct Summary {
+    int64_t newest_bucket = 0; // floor(ts / BucketSec) of the newest bucket
+    int buckets = 0;           // buckets holding at least one sample
+    uint64_t samples = 0;
+    double confidence = 0.0;   // buckets / Buckets
+    double missing_rate = 1.0;
+    Values avg{};              // mean over every sample in the ring
+  };
+
+  // Inserted: first sample of its bucket; Merged: added to an existing one.
+  IngestResult insert(int64_t ts, const Values& v) {
+    const int64_t key = detail::floor_div(ts, BucketSec);
+    if (newest_ == kEmpty) {
+      newest_ = key;
+    } else if (key > newest_) {
+      advance_(key);
+    }
+    if (key < newest_ - static_cast<int64_t>(Buckets - 1)) return IngestResult::TooOld;
+
+    Slot& slot = slots_[idx(key)];
+    const bool fresh = slot.key == kEmpty;
+    if (fresh) {
+      slot.key = key;
+      ++buckets_;
+    }
+    slot.agg.add(v);
+    for (std::size_t k = 0; k < Set::size; ++k) sums_[k] += v[k];
+    ++samples_;
+    return fresh ? IngestResult::Inserted : IngestResult::Merged;
+  }
+
+  void note_time(int64_t ts_now) {
+    const int64_t key = detail::floor_div(ts_now, BucketSec);
+    if (newest_ == kEmpty) {
+      newest_ = key;
+      return;
+    }
+    if (key > newest_) advance_(key);
+  }
+
+  Summary summary() const {
+    Summary s;
+    if (newest_ == kEmpty) return s;
+    s.newest_bucket = newest_;
+    s.buckets = buckets_;
+    s.samples = samples_;
+    s.confidence = static_cast<double>(buckets_) / static_cast<double>(Buckets);
+    s.missing_rate = 1.0 - s.confidence;
+    if (samples_ > 0) {
+      for (std::size_t k = 0; k < Set::size; ++k) s.avg[k] = sums_[k] / static_cast<double>(samples_);
+    }
+    return s;
+  }
+
+  // Bucket `age` steps back from the newest (0 = newest, possibly still
+  // filling); nullptr if empty or out of range.
+  const Aggregate* bucket(std::size_t age) const {
+    if (newest_ == kEmpty || age >= Buckets) return nullptr;
+    const int64_t key = newest_ - static_cast<int64_t>(age);
+    const Slot& slot = slots_[idx(key)];
+    return slot.key == key ? &slot.agg : nullptr;
+  }
+
+  // Window-wide min/max of metric k: O(Buckets).
+  double min(std::size_t k) const { return extreme_(k, true); }
+  double max(std::size_t k) const { return extreme_(k, false); }
+
+  // Least-squares slope of bucket means for metric k, in units per bucket
+  // (positive = rising). 0 with fewer than two filled buckets. O(Buckets).
+  double trend(std::size_t k) const {
+    double n = 0.0, sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+    for (std::size_t age = 0; age < Buckets; ++age) {
+      const Aggregate* b = bucket(age);
+      if (!b) continue;
+      const double x = -static_cast<double>(age);
+      const double y = b->mean(k);
+      n += 1.0;
+      sx += x;
+      sy += y;
+      sxx += x * x;
+      sxy += x * y;
+    }
+    const double den = n * sxx - sx * sx;
+    return (n < 2.0 || den == 0.0) ? 0.0 : (n * sxy - sx * sy) / den;
+  }
+
+private:
+  static constexpr int64_t kEmpty = std::numeric_limits<int64_t>::min();
+
+  struct Slot {
+    int64_t key = kEmpty;
+    Aggregate agg{};
+  };
+
+  static std::size_t idx(int64_t key) { return static_cast<std::size_t>(key) & (kSlots - 1); }
+
+  void advance_(int64_t key_now) {
+    if (key_now - newest_ >= static_cast<int64_t>(Buckets)) {
+      for (auto& slot : slots_) slot = Slot{};
+      sums_ = Values{};
+      samples_ = 0;
+      buckets_ = 0;
+    } else {
+      const int64_t old_oldest = newest_ - static_cast<int64_t>(Buckets - 1);
+      const int64_t new_oldest = key_now - static_cast<int64_t>(Buckets - 1);
+      for (int64_t key = old_oldest; key < new_oldest; ++key) {
+        Slot& slot = slots_[idx(key)];
+        if (slot.key != key) continue;
+        samples_ -= slot.agg.n;
+        if (--buckets_ == 0) {
+          // Drop accumulated rounding error whenever the ring empties.
+          sums_ = Values{};
+        } else {
+          for (std::size_t k = 0; k < Set::size; ++k) sums_[k] -= slot.agg.sum[k];
+        }
+        slot = Slot{};
+      }
+    }
+    newest_ = key_now;
+  }
+
+  double extreme_(std::size_t k, bool want_min) const {
+    bool any = false;
+    double out = 0.0;
+    for (std::size_t age = 0; age < Buckets; ++age) {
+      const Aggregate* b = bucket(age);
+      if (!b) continue;
+      const double v = want_min ? b->min[k] : b->max[k];
+      if (!any || (want_min ? v < out : v > out)) out = v;
+      any = true;
+    }
+    return out;
+  }
+
+  // Invariant: every occupied slot's key is inside [newest_ - (Buckets-1), newest_].
+  std::array<Slot, kSlots> slots_{};
+  int64_t newest_ = kEmpty;
+  Values sums_{};
+  uint64_t samples_ = 0;
+  int buckets_ = 0;
+};
+
+// Length seconds of one-second buckets that keep every sub-second sample.
+template <std::size_t Length, typename Set>
+using BucketedWindow = BucketRing<1, Length, Set>;
+
+// A fine one-second window plus coarser BucketRing tiers, all fed by the
+// same samples and expired by the same clock. Each tier keeps its own
+// horizon, so a sample too old for the fine window may still reach a tier.
+template <std::size_t Length, typename Set, typename... Tiers>
+class MultiResolutionWindow {
+public:
+  using Values = typename Set::Values;
+  using Fine = BucketedWindow<Length, Set>;
+
+  // Result for the fine window.
+  WindowIngestResult insert(int64_t ts, const Values& v) {
+    std::apply([&](auto&... t) { (t.insert(ts, v), ...); }, tiers_);
+    return fine_.insert(ts, v);
+  }
+
+  void note_time(int64_t ts_now) {
+    fine_.note_time(ts_now);
+    std::apply([&](auto&... t) { (t.note_time(ts_now), ...); }, tiers_);
+  }
+
+  const Fine& fine() const { return fine_; }
+
+  template <std::size_t I>
+  const auto& tier() const { return std::get<I>(tiers_); }
+
+private:
+  Fine fine_;
+  std::tuple<Tiers...> tiers_;
+};
+
+// 45 s of 1 s buckets, 15 min of 1 min buckets, 1 h of 15 min buckets.
+using ProbeWindow = MultiResolutionWindow<45, DefaultMetrics,
+                                          BucketRing<60, 15, DefaultMetrics>,
+                                          BucketRing<900, 4, DefaultMetrics>>;
+
+} // namespace telemetry
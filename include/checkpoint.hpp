@@ -0,0 +1,168 @@
+// checkpoint.hpp
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "telemetry_agent.hpp"
+
+namespace telemetry {
+
+// Binary checkpoint of a TelemetryAgent's per-interface state (windows,
+// running sums, EWMA, FSM counters and dwell clock), so a restarted daemon
+// resumes with trustworthy statuses instead of 45 seconds of empty windows.
+//
+// Layout (host byte order; `endian` tells a foreign file apart):
+//   CheckpointHeader                 64 bytes
+//   CheckpointRecord[record_count]   one per InterfaceId, from byte 64
+//   name table at names_offset       name_count x {uint32 id, uint32 len,
+//                                    len bytes, zero pad to 8}
+// Records are fixed-width and 8-byte aligned, so a reader maps the file and
+// restores from them in place. A restored agent continues exactly as the
+// saved one would have: same snapshots, same transitions.
+//
+// The header carries config_hash(): restoring into an agent whose scoring,
+// FSM, recompute or same-second settings or config profiles differ is
+// refused. Which profile each interface uses is not saved (assign them
+// again; a restored tracker keeps its current profile). Transitions not yet
+// drained and run-summary totals are not saved.
+struct CheckpointHeader {
+  static constexpr char kMagic[8] = {'T', 'L', 'M', 'C', 'K', 'P', 'T', '1'};
+  static constexpr uint32_t kVersion = 1;
+  static constexpr uint32_t kEndian = 0x01020304;
+
+  char magic[8] = {};
+  uint32_t version = kVersion;
+  uint32_t record_size = 0;
+  uint32_t endian = kEndian;
+  uint32_t window_seconds = 0;
+  uint64_t config_hash = 0;
+  int64_t tick_ts = 0; // last note_time() before the checkpoint
+  uint64_t record_count = 0;
+  uint64_t names_offset = 0;
+  uint32_t name_count = 0;
+  uint32_t reserved0 = 0;
+};
+
+struct CheckpointRecord {
+  static constexpr std::size_t kSeconds = RollingWindow::kWindow;
+  static constexpr std::size_t kMetrics = DefaultMetrics::size;
+  enum Flags : uint8_t { kHaveEwma = 1, kDirty = 2 };
+
+  uint32_t id = 0;
+  uint8_t status = 0; // IfStatus
+  uint8_t flags = 0;
+  uint16_t reserved0 = 0;
+
+  // Window: second k of the arrays is window_newest_ts - (kSeconds-1) + k,
+  // occupied if bit k of `occupied` is set. Metrics in DefaultMetrics order.
+  int64_t window_newest_ts = 0;
+  uint64_t occupied = 0;
+  double window_sums[kMetrics] = {};
+
+  int64_t last_eval_ts = 0;
+  int64_t last_transition_ts = 0;
+  int32_t cnt_below_healthy_exit = 0;
+  int32_t cnt_above_healthy_enter = 0;
+  int32_t cnt_below_down_enter = 0;
+  int32_t cnt_above_down_exit = 0;
+
+  double score_avg = 0.0;
+  double score_ewma = 0.0;
+  double score_used = 0.0;
+  double confidence = 0.0;
+  double avg_tp_mbps = 0.0;
+  double avg_rtt_ms = 0.0;
+  double avg_loss_pct = 0.0;
+  double avg_jitter_ms = 0.0;
+
+  uint32_t samples[kSeconds] = {};
+  uint32_t reserved1 = 0;
+  double values[kSeconds][kMetrics] = {};
+};
+
+static_assert(sizeof(CheckpointHeader) == 64 && std::is_trivially_copyable_v<CheckpointHeader>);
+static_assert(sizeof(CheckpointRecord) % 8 == 0 && std::is_trivially_copyable_v<CheckpointRecord>);
+static_assert(CheckpointRecord::kSeconds <= 64, "occupied is one 64-bit mask");
+
+// Stable hash (FNV-1a over field values) of the settings that shape tracker
+// state: ScoreConfig, FsmConfig, recompute and same_second. tick_scan only
+// changes which trackers a tick visits, so it is left out.
+uint64_t config_hash(const AgentConfig& cfg);
+// config_hash(agent.config()) extended with the name and settings of every
+// profile past the default; equal to it when there are none.
+uint64_t config_hash(const TelemetryAgent& agent);
+
+// Encodes agent's state into words (resized to fit; reuse it to avoid
+// reallocating). tick_ts is the agent's last note_time().
+void encode_checkpoint(const TelemetryAgent& agent, int64_t tick_ts, std::vector<uint64_t>& words);
+
+// Writes words to path atomically: a temporary file beside it, fsync, then
+// rename over path. Throws std::runtime_error on I/O errors.
+void write_checkpoint_file(const std::string& path, std::span<const uint64_t> words);
+
+// encode_checkpoint() + write_checkpoint_file() on the calling thread.
+void save_checkpoint(const TelemetryAgent& agent, int64_t tick_ts, const std::string& path);
+
+struct CheckpointInfo {
+  int64_t tick_ts = 0;
+  std::size_t interfaces = 0;
+};
+
+// Maps the checkpoint at path and restores every interface in it into agent
+// by name, registering names the agent does not know yet; the agent's other
+// interfaces are untouched. Throws std::runtime_error, before changing the
+// agent, on a missing, truncated, foreign or corrupt file or a config hash
+// mismatch. The next note_time() evaluates and publishes restored trackers.
+CheckpointInfo restore_checkpoint(TelemetryAgent& agent, const std::string& path);
+
+// Periodic checkpoints with the file I/O off the agent's thread: capture()
+// encodes on the caller's thread (a copy of each tracker's state) and hands
+// the buffer to a writer thread, which writes it with
+// write_checkpoint_file(). A capture while the previous write is still in
+// flight is skipped rather than queued.
+class CheckpointWriter {
+public:
+  explicit CheckpointWriter(std::string path);
+  ~CheckpointWriter(); // finishes the write in flight, swallowing errors
+
+  CheckpointWriter(const CheckpointWriter&) = delete;
+  CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+  // Returns false if skipped. Rethrows the previous write's error, if any.
+  bool capture(const TelemetryAgent& agent, int64_t tick_ts);
+
+  // Blocks until no write is in flight; rethrows its error, if any.
+  void wait();
+
+  uint64_t written() const;
+  uint64_t skipped() const { return skipped_; }
+
+private:
+  void run_();
+  void rethrow_locked_(); // with mu_ held
+
+  std::string path_;
+  std::vector<uint64_t> spare_; // encoded into by capture(), swapped with pending_
+
+  mutable std::mutex mu_;
+  std::condition_variable cv_;
+  std::vector<uint64_t> pending_;
+  bool busy_ = false;
+  bool quit_ = false;
+  uint64_t written_ = 0;
+  std::exception_ptr error_;
+
+  uint64_t skipped_ = 0;
+  std::thread thread_;
+};
+
+} // namespace telemetry
@@ -0,0 +1,161 @@
+// columnar_agent.hpp
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "config_profile.hpp"
+#include "fsm_batch.hpp"
+#include "interface_tracker.hpp"
+#include "rolling_window.hpp"
+#include "telemetry_agent.hpp"
+#include "transition_ring.hpp"
+
+namespace telemetry {
+
+// Structure-of-arrays variant of TelemetryAgent for thousands of interfaces.
+//
+// Interfaces get dense integer handles (as in TelemetryAgent); window slots,
+// running sums, EWMA state, FSM counters and snapshot fields each live in one
+// contiguous array indexed by handle, so note_time() is a linear sweep instead
+// of a walk over per-tracker objects. Scoring for a tick runs through the
+// batch kernel in batch_scorer.hpp, the FSMs through the one in fsm_batch.hpp.
+// Behaviour (scores, statuses, transitions) matches TelemetryAgent sample for
+// sample; names are only touched on registration, lookup and snapshot export.
+// Scores on window means only: a ScoreConfig asking for quantile scoring
+// makes the constructor (or add_profile()/set_profile()) throw
+// std::invalid_argument.
+//
+// Config profiles work as in TelemetryAgent. A tick scores each run of
+// consecutive handles sharing a profile in one kernel call with that
+// profile's constants, then runs their FSMs; register interfaces of one kind
+// together to keep the runs long.
+class ColumnarTelemetryAgent {
+public:
+  explicit ColumnarTelemetryAgent(AgentConfig cfg = {}, std::size_t reserve_ifaces = 0,
+                                  TransitionLogConfig log = {});
+
+  // Returns the existing handle if the interface is already registered.
+  InterfaceId register_interface(std::string_view iface);
+  std::optional<InterfaceId> find_interface(std::string_view iface) const;
+
+  void ingest(InterfaceId id, int64_t ts, const Metrics& m);
+  void ingest(const std::string& iface, int64_t ts, const Metrics& m);
+
+  // Expire time for every interface (one pass over the columns).
+  void note_time(int64_t ts_now);
+
+  std::size_t size() const { return names_.size(); }
+  const std::string& name(InterfaceId id) const { return names_[id]; }
+
+  // Hot-path readers; no string copies.
+  IfStatus status(InterfaceId id) const { return static_cast<IfStatus>(status_[id]); }
+  double score_used(InterfaceId id) const { return score_used_[id]; }
+  double confidence(InterfaceId id) const { return confidence_[id]; }
+
+  InterfaceSnapshot snapshot(InterfaceId id) const;
+  std::vector<InterfaceSnapshot> snapshots() const;
+
+  // Same transition stream as TelemetryAgent.
+  template <typename Fn>
+    requires std::invocable<Fn&, const TransitionEvent&>
+  std::size_t drain_transitions(Fn&& fn) { return transitions_.drain(std::forward<Fn>(fn)); }
+  std::size_t drain_transitions(std::span<TransitionEvent> out) { return transitions_.drain(out); }
+  std::vector<TransitionEvent> drain_transitions();
+  const TransitionStats& transition_stats() const { return transitions_.stats(); }
+
+  void record_tick();
+  std::vector<TelemetryAgent::RunSummaryItem> summary_ranked() const;
+
+  // As TelemetryAgent's; settings apply from each interface's next evaluation.
+  ProfileId add_profile(std::string_view name, const ConfigProfile& p);
+  std::optional<ProfileId> find_profile(std::string_view name) const { return profiles_.find(name); }
+  void set_profile(ProfileId id, const ConfigProfile& p);
+  void assign_profile(InterfaceId id, ProfileId profile) { (void)profiles_.assign(id, profile); }
+  ProfileId profile_of(InterfaceId id) const { return profiles_.of(id); }
+  const ProfileTable& profiles() const { return profiles_; }
+
+private:
+  static constexpr int kWindow = RollingWindow::kWindow;
+
+  static int slot_idx(int64_t ts) {
+    const int64_t r = ts % kWindow;
+    return static_cast<int>(r < 0 ? r + kWindow : r);
+  }
+
+  bool window_ingest_(InterfaceId id, int64_t ts, const Metrics& m);
+  void window_advance_(InterfaceId id, int64_t ts_now);
+  void window_remove_(InterfaceId id, std::size_t slot);
+  // Window sums -> confidence/means columns.
+  void summarize_(InterfaceId id);
+  // Score columns for [first, first + n) via the batch kernel.
+  void score_(InterfaceId first, std::size_t n, const ScoreConfig& c);
+  // FSM columns for [first, first + n) via fsm_update_batch(); transitions
+  // are queued in handle order.
+  void evaluate_fsm_(InterfaceId first, std::size_t n, int64_t now_ts, const FsmConfig& f);
+  void recompute_(InterfaceId id, int64_t now_ts);
+
+  AgentConfig cfg_;
+  ProfileTable profiles_;
+
+  // Cold: names and lookup.
+  std::vector<std::string> names_;
+  InterfaceIndex index_;
+
+  // Window: kWindow slots per interface, slot = id * kWindow + ts % kWindow.
+  std::vector<int64_t> slot_ts_;
+  std::vector<double> slot_rtt_;
+  std::vector<double> slot_tp_;
+  std::vector<double> slot_loss_;
+  std::vector<double> slot_jit_;
+  std::vector<uint32_t> slot_n_;     // samples averaged into the slot (SameSecond::Average)
+  std::vector<uint64_t> slot_valid_; // bit per slot
+
+  std::vector<int64_t> newest_ts_;
+  std::vector<double> sum_rtt_;
+  std::vector<double> sum_tp_;
+  std::vector<double> sum_loss_;
+  std::vector<double> sum_jit_;
+  std::vector<int> count_;
+
+  // Scores.
+  std::vector<double> score_avg_;
+  std::vector<double> score_ewma_;
+  std::vector<double> score_used_;
+  std::vector<uint8_t> have_ewma_;
+
+  // FSM.
+  std::vector<uint8_t> status_;
+  std::vector<int64_t> last_transition_ts_;
+  std::vector<int> cnt_below_healthy_exit_;
+  std::vector<int> cnt_above_healthy_enter_;
+  std::vector<int> cnt_below_down_enter_;
+  std::vector<int> cnt_above_down_exit_;
+  std::vector<FsmChange> fsm_changes_; // scratch, one entry per interface
+
+  // Snapshot fields not covered above.
+  std::vector<double> confidence_;
+  std::vector<double> avg_tp_;
+  std::vector<double> avg_rtt_;
+  std::vector<double> avg_loss_;
+  std::vector<double> avg_jit_;
+
+  // Run summary.
+  std::vector<double> score_sum_;
+  std::vector<int> score_count_;
+
+  // PerTick mode: samples since the last evaluation.
+  std::vector<uint8_t> dirty_;
+  int64_t last_tick_ts_ = std::numeric_limits<int64_t>::min();
+
+  TransitionRing transitions_;
+};
+
+} // namespace telemetry
@@ -0,0 +1,139 @@
+// compact_agent.hpp
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "compact_window.hpp"
+#include "interface_tracker.hpp"
+#include "rolling_window.hpp"
+#include "telemetry_agent.hpp"
+#include "transition_ring.hpp"
+
+namespace telemetry {
+
+// InterfaceTracker's window -> score -> EWMA -> FSM pipeline in under 1 KB
+// (InterfaceTracker is ~3.1 KB): the config is shared; the name lives with
+// the agent; window values are floats in a CompactRollingWindow;
+// no snapshot or pending event is materialised. Scores track InterfaceTracker
+// to within float rounding of the window values (~1e-7).
+//
+// Scores on window means only: quantile scoring throws std::invalid_argument.
+class CompactInterfaceTracker {
+public:
+  using Window = CompactRollingWindow<RollingWindow::kWindow, DefaultMetrics>;
+
+  // cfg must outlive the tracker.
+  explicit CompactInterfaceTracker(const AgentConfig* cfg);
+
+  // Evaluates immediately in Eager mode, otherwise only marks the tracker dirty.
+  Window::IngestResult ingest(int64_t ts, const Metrics& m);
+
+  // Returns false if PerTick mode skipped a repeated tick with no new samples.
+  bool note_time(int64_t ts_now);
+
+  bool dirty() const { return dirty_; }
+  IfStatus status() const { return fsm_.status; }
+  double score_used() const { return score_used_; }
+  double confidence() const { return static_cast<double>(eval_count_) / RollingWindow::kWindow; }
+
+  // As InterfaceTracker::snapshot() at the last evaluation.
+  InterfaceSnapshot snapshot(std::string_view iface) const;
+
+  // The transition produced by the last evaluation (if any), cleared.
+  std::optional<TransitionEvent> drain_transition(InterfaceId id);
+
+  const Window& window() const { return window_; }
+
+private:
+  void recompute_(int64_t now_ts);
+
+  const AgentConfig* cfg_;
+  Window window_;
+  FsmState fsm_;
+
+  double score_avg_ = 0.0;
+  double score_ewma_ = 0.0;
+  double score_used_ = 0.0;
+  int64_t last_eval_ts_ = std::numeric_limits<int64_t>::min();
+
+  // Window means (DefaultMetrics order) and count at the last evaluation.
+  std::array<float, DefaultMetrics::size> eval_avg_{};
+  uint8_t eval_count_ = 0;
+
+  bool have_ewma_ = false;
+  bool dirty_ = false;
+  TransitionReason pending_ = TransitionReason::None;
+  IfStatus pending_from_ = IfStatus::Degraded;
+};
+
+// TelemetryAgent for memory-bound deployments (many tunnels on a small edge
+// box): CompactInterfaceTrackers sharing one AgentConfig, names interned
+// once and looked up through views of them, snapshots built on request.
+//
+// Same API shape as ColumnarTelemetryAgent. Statuses and transitions match
+// TelemetryAgent unless a score lands within float rounding of an FSM
+// threshold. note_time() visits every interface (no TickScan), no
+// SnapshotTable is published and there is no instrumentation.
+class CompactTelemetryAgent {
+public:
+  explicit CompactTelemetryAgent(AgentConfig cfg = {}, std::size_t reserve_ifaces = 0,
+                                 TransitionLogConfig log = {});
+
+  // Returns the existing handle if the interface is already registered.
+  InterfaceId register_interface(std::string_view iface);
+  std::optional<InterfaceId> find_interface(std::string_view iface) const;
+
+  void ingest(InterfaceId id, int64_t ts, const Metrics& m);
+  void ingest(const std::string& iface, int64_t ts, const Metrics& m);
+
+  void note_time(int64_t ts_now);
+
+  std::size_t size() const { return trackers_.size(); }
+  const std::string& name(InterfaceId id) const { return names_[id]; }
+  const AgentConfig& config() const { return *cfg_; }
+
+  IfStatus status(InterfaceId id) const { return trackers_[id].status(); }
+  double score_used(InterfaceId id) const { return trackers_[id].score_used(); }
+  double confidence(InterfaceId id) const { return trackers_[id].confidence(); }
+  const CompactInterfaceTracker& tracker(InterfaceId id) const { return trackers_[id]; }
+
+  InterfaceSnapshot snapshot(InterfaceId id) const { return trackers_[id].snapshot(names_[id]); }
+  std::vector<InterfaceSnapshot> snapshots() const;
+
+  template <typename Fn>
+    requires std::invocable<Fn&, const TransitionEvent&>
+  std::size_t drain_transitions(Fn&& fn) { return transitions_.drain(std::forward<Fn>(fn)); }
+  std::size_t drain_transitions(std::span<TransitionEvent> out) { return transitions_.drain(out); }
+  std::vector<TransitionEvent> drain_transitions();
+  const TransitionStats& transition_stats() const { return transitions_.stats(); }
+
+  void record_tick();
+  std::vector<TelemetryAgent::RunSummaryItem> summary_ranked() const;
+
+private:
+  void collect_(InterfaceId id);
+
+  std::unique_ptr<const AgentConfig> cfg_; // trackers point here; survives moves of the agent
+  std::vector<CompactInterfaceTracker> trackers_;
+
+  // Interned names: a deque never moves its strings, so index_ keys view them.
+  std::deque<std::string> names_;
+  std::unordered_map<std::string_view, InterfaceId> index_;
+
+  std::vector<double> score_sum_;
+  std::vector<int> score_count_;
+  TransitionRing transitions_;
+};
+
+} // namespace telemetry
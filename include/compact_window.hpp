@@ -0,0 +1,194 @@
+// compact_window.hpp
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+#include "basic_rolling_window.hpp"
+#include "metric_descriptors.hpp"
+
+namespace telemetry {
+
+// BasicRollingWindow semantics in about a third of the memory, for agents
+// tracking many interfaces on small devices.
+//
+// * Values are stored as float; running sums stay in double. A double sum
+//   of floats is exact unless the values span ~29 binary orders of
+//   magnitude, so adding and removing them does not drift.
+// * Slots carry no timestamp. The ring has exactly Length slots and every
+//   occupied slot lies in [newest_ts - (Length-1), newest_ts], so slot
+//   ts % Length can only hold one second; a 64-bit mask marks occupancy.
+// * Same-second sample counts are 8-bit: past 255 samples in one second,
+//   merge() weighs each new sample 1/255 instead of 1/n.
+//
+// No observer hook: order statistics would need the full-precision values.
+template <std::size_t Length, typename Set>
+class CompactRollingWindow {
+public:
+  static_assert(Length > 0 && Length <= 64, "occupancy is one 64-bit mask");
+
+  static constexpr int kWindow = static_cast<int>(Length);
+  static constexpr std::size_t kMetrics = Set::size;
+
+  using Values = typename Set::Values;
+  using Summary = typename BasicRollingWindow<Length, Set>::Summary;
+  using IngestResult = WindowIngestResult;
+
+  // A second sample for the same second replaces the first.
+  IngestResult insert(int64_t ts, const Values& v) {
+    const int i = slot_for_(ts);
+    if (i < 0) return IngestResult::TooOld;
+    const uint64_t bit = uint64_t{1} << i;
+    const bool overwrite = (valid_ & bit) != 0;
+    if (overwrite) remove_(i);
+    store_(i, v);
+    n_[i] = 1;
+    valid_ |= bit;
+    add_(i);
+    return overwrite ? IngestResult::Overwritten : IngestResult::Inserted;
+  }
+
+  // A second sample for the same second is averaged in (see BasicRollingWindow::merge()).
+  IngestResult merge(int64_t ts, const Values& v) {
+    const int i = slot_for_(ts);
+    if (i < 0) return IngestResult::TooOld;
+    const uint64_t bit = uint64_t{1} << i;
+    if (!(valid_ & bit)) {
+      store_(i, v);
+      n_[i] = 1;
+      valid_ |= bit;
+      add_(i);
+      return IngestResult::Inserted;
+    }
+    remove_(i);
+    if (n_[i] < std::numeric_limits<uint8_t>::max()) ++n_[i];
+    const double dn = static_cast<double>(n_[i]);
+    for (std::size_t k = 0; k < kMetrics; ++k) {
+      const double cur = v_[i][k];
+      v_[i][k] = static_cast<float>(cur + (v[k] - cur) / dn);
+    }
+    add_(i);
+    return IngestResult::Merged;
+  }
+
+  // Advance time without adding a sample (expires old slots).
+  void note_time(int64_t ts_now) {
+    if (newest_ts_ == kEmpty) {
+      newest_ts_ = ts_now;
+      return;
+    }
+    if (ts_now > newest_ts_) advance_(ts_now);
+  }
+
+  Summary summary() const {
+    Summary s;
+    if (newest_ts_ == kEmpty) return s;
+    s.newest_ts = newest_ts_;
+    s.oldest_ts = newest_ts_ - (kWindow - 1);
+    s.count = count_;
+    s.confidence = static_cast<double>(count_) / static_cast<double>(kWindow);
+    s.missing_rate = 1.0 - s.confidence;
+    if (count_ > 0) {
+      for (std::size_t k = 0; k < kMetrics; ++k) s.avg[k] = sums_[k] / count_;
+    }
+    return s;
+  }
+
+  int64_t newest_ts() const { return newest_ts_; }
+  int count() const { return count_; }
+
+  // Oldest occupied second (expires once time reaches it + Length); O(Length).
+  std::optional<int64_t> oldest_sample_ts() const {
+    if (count_ == 0) return std::nullopt;
+    int64_t t = newest_ts_ - (kWindow - 1);
+    while (!(valid_ & (uint64_t{1} << idx(t)))) ++t;
+    return t;
+  }
+
+  bool has_sample(int64_t ts) const {
+    return newest_ts_ != kEmpty && ts <= newest_ts_ && ts >= newest_ts_ - (kWindow - 1) &&
+           (valid_ & (uint64_t{1} << idx(ts))) != 0;
+  }
+
+  // Samples folded into second ts (0 if none).
+  uint32_t samples_at(int64_t ts) const { return has_sample(ts) ? n_[idx(ts)] : 0; }
+
+  // The stored (float-rounded) values of second ts.
+  std::optional<Values> get(int64_t ts) const {
+    if (!has_sample(ts)) return std::nullopt;
+    Values out{};
+    for (std::size_t k = 0; k < kMetrics; ++k) out[k] = v_[idx(ts)][k];
+    return out;
+  }
+
+private:
+  // Marks an empty window; never a real sample time.
+  static constexpr int64_t kEmpty = std::numeric_limits<int64_t>::min();
+
+  static int idx(int64_t ts) {
+    const int64_t r = ts % kWindow;
+    return static_cast<int>(r < 0 ? r + kWindow : r);
+  }
+
+  // Advances time to ts if newer; -1 if ts is too old for the window.
+  int slot_for_(int64_t ts) {
+    if (newest_ts_ == kEmpty) {
+      newest_ts_ = ts;
+    } else if (ts > newest_ts_) {
+      advance_(ts);
+    }
+    if (ts < newest_ts_ - (kWindow - 1)) return -1;
+    return idx(ts);
+  }
+
+  void advance_(int64_t ts_now) {
+    if (ts_now - newest_ts_ >= kWindow) {
+      // Jump past the whole window: everything expires.
+      valid_ = 0;
+      sums_ = Values{};
+      count_ = 0;
+    } else if (valid_ != 0) {
+      const int64_t old_oldest = newest_ts_ - (kWindow - 1);
+      const int64_t new_oldest = ts_now - (kWindow - 1);
+      for (int64_t t = old_oldest; t < new_oldest; ++t) {
+        const int i = idx(t);
+        const uint64_t bit = uint64_t{1} << i;
+        if (!(valid_ & bit)) continue;
+        remove_(i);
+        valid_ &= ~bit;
+      }
+    }
+    newest_ts_ = ts_now;
+  }
+
+  void store_(int i, const Values& v) {
+    for (std::size_t k = 0; k < kMetrics; ++k) v_[i][k] = static_cast<float>(v[k]);
+  }
+
+  void add_(int i) {
+    for (std::size_t k = 0; k < kMetrics; ++k) sums_[k] += v_[i][k];
+    ++count_;
+  }
+
+  void remove_(int i) {
+    if (--count_ == 0) {
+      sums_ = Values{};
+      return;
+    }
+    for (std::size_t k = 0; k < kMetrics; ++k) sums_[k] -= v_[i][k];
+  }
+
+  // Invariant: a set bit i means second t with idx(t) == i inside
+  // [newest_ts_ - (kWindow-1), newest_ts_] holds a sample.
+  std::array<std::array<float, kMetrics>, Length> v_{};
+  Values sums_{};
+  int64_t newest_ts_ = kEmpty;
+  uint64_t valid_ = 0;
+  std::array<uint8_t, Length> n_{};
+  uint8_t count_ = 0;
+};
+
+} // namespace telemetry
@@ -0,0 +1,78 @@
+// config_profile.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "interface_tracker.hpp"
+
+namespace telemetry {
+
+// Dense handle into a ProfileTable; 0 is always the agent's own config.
+using ProfileId = uint32_t;
+inline constexpr ProfileId kDefaultProfile = 0;
+
+// Starting points for common link types. wired_profile() is the default
+// config; the others widen the RTT/jitter ranges to what a good link of
+// that kind shows, lower the throughput ceiling, smooth harder and ask for
+// more evidence and dwell before moving, since those links are noisier.
+ConfigProfile wired_profile();
+ConfigProfile cellular_profile();
+ConfigProfile satellite_profile();
+
+// Throws std::invalid_argument if a range is empty, inverted or not finite.
+void check_profile(const ConfigProfile& p);
+
+// The profiles of one agent and which interfaces use each.
+//
+// Profiles are interned by name and live in stable heap slots, so trackers
+// hold a plain pointer to theirs; replace() overwrites a slot in place, so a
+// hot swap reaches every member without touching the trackers. Each profile
+// also lists its interfaces in ascending order, so an agent can evaluate one
+// profile's interfaces together with its constants hoisted.
+//
+// Meant for a handful of profiles: name lookup is a linear scan.
+class ProfileTable {
+public:
+  explicit ProfileTable(const ConfigProfile& default_profile);
+
+  // Returns the handle of the profile called name, adding it if new.
+  // Throws std::invalid_argument if name is taken by a different profile
+  // (replace() changes one) or p fails check_profile(), and
+  // std::length_error past 65536 profiles.
+  ProfileId add(std::string_view name, const ConfigProfile& p);
+  std::optional<ProfileId> find(std::string_view name) const;
+
+  // Overwrites profile id in place; pointers to it stay valid.
+  void replace(ProfileId id, const ConfigProfile& p);
+
+  std::size_t size() const { return slots_.size(); }
+  const ConfigProfile& get(ProfileId id) const { return *slots_[id].profile; }
+  const std::string& name(ProfileId id) const { return slots_[id].name; }
+
+  // Membership. add_member() appends the next interface (id == members so
+  // far) to the default profile; assign() moves one and returns its old
+  // profile.
+  void reserve(std::size_t interfaces);
+  void add_member(InterfaceId id);
+  ProfileId assign(InterfaceId id, ProfileId p);
+  ProfileId of(InterfaceId id) const { return of_[id]; }
+  std::span<const InterfaceId> members(ProfileId p) const { return slots_[p].members; }
+
+private:
+  struct Slot {
+    std::string name;
+    std::unique_ptr<ConfigProfile> profile;
+    std::vector<InterfaceId> members; // ascending
+  };
+  std::vector<Slot> slots_;
+  std::vector<ProfileId> of_; // indexed by InterfaceId
+};
+
+} // namespace telemetry
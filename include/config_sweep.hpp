@@ -0,0 +1,97 @@
+// config_sweep.hpp
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "scenarios.hpp"
+#include "telemetry_agent.hpp"
+#include "trace_file.hpp"
+
+namespace telemetry {
+
+// Input shared read-only by every sweep task: trace records in call order
+// (see trace_file.hpp) and the interface names by id.
+class SweepTrace {
+public:
+  // A mapped trace; the reader must outlive the SweepTrace. A corrupt trace
+  // never gets here: TraceReader's constructor throws.
+  static SweepTrace view(const TraceReader& reader);
+
+  // The CLI's run of a scenario (tick, then one sample per interface),
+  // generated in memory.
+  static SweepTrace scenario(ScenarioId sid, int seconds, ImperfectDataConfig imp = {});
+
+  std::span<const TraceRecord> records() const { return external_.empty() ? std::span<const TraceRecord>(owned_) : external_; }
+  const std::vector<std::string>& names() const { return names_; }
+  std::size_t interfaces() const { return names_.size(); }
+
+private:
+  void index_();
+
+  std::vector<std::string> names_; // one per interface id ("if<id>" if unnamed)
+  std::vector<TraceRecord> owned_;
+  std::span<const TraceRecord> external_;
+};
+
+// An interface is expected to reach `expect` (or worse) from `start_ts` on.
+struct SweepIncident {
+  InterfaceId id = 0;
+  int64_t start_ts = 0;
+  IfStatus expect = IfStatus::Down;
+};
+
+struct SweepOptions {
+  unsigned threads = 0;        // 0 = std::thread::hardware_concurrency()
+  int64_t flap_window_sec = 60; // a transition undone within this counts as a flap
+  std::span<const SweepIncident> incidents;
+};
+
+// Per-config outcome of one replay.
+struct SweepResult {
+  uint64_t transitions = 0;
+  uint64_t flaps = 0;
+  double flaps_per_iface_hour = 0.0;
+
+  // Incidents reached (time-to-detect = first ts at or after start_ts with
+  // the status at least as bad; 0 if it already was) and never reached.
+  uint64_t detected = 0;
+  uint64_t missed = 0;
+  double mean_ttd_sec = 0.0;
+  int64_t max_ttd_sec = 0;
+
+  // Interface-seconds spent in each IfStatus over the trace's time span.
+  int64_t status_seconds[3] = {0, 0, 0};
+};
+
+// Replays the trace into a fresh TelemetryAgent(cfg) on the calling thread.
+SweepResult evaluate(const SweepTrace& trace, const AgentConfig& cfg, const SweepOptions& opt = {});
+
+// evaluate() for every config across a work-stealing thread pool. Each task
+// owns its agent; tasks share only the read-only trace, and results land in
+// their own slot, so the output matches a sequential loop exactly. A task's
+// exception is rethrown once all workers have stopped.
+std::vector<SweepResult> run_sweep(const SweepTrace& trace, std::span<const AgentConfig> configs,
+                                   const SweepOptions& opt = {});
+
+// Values to try per FsmConfig field; an empty axis keeps the base value.
+struct FsmGrid {
+  std::vector<double> healthy_enter, healthy_exit, down_enter, down_exit;
+  std::vector<int> healthy_enter_N, healthy_exit_N, down_enter_N, down_exit_N;
+  std::vector<int64_t> min_dwell_sec;
+};
+
+// Cartesian product of the grid over base. Points without proper hysteresis
+// (down_enter <= down_exit < healthy_exit <= healthy_enter) are skipped.
+std::vector<AgentConfig> expand(const AgentConfig& base, const FsmGrid& grid);
+
+// A deliberately twitchy config (no EWMA, single-tick evidence, no dwell):
+// its degradations make a reference incident list for time-to-detect.
+AgentConfig sharp_reference(AgentConfig base);
+
+// Every move to a worse status the reference config makes on the trace.
+std::vector<SweepIncident> reference_incidents(const SweepTrace& trace, const AgentConfig& reference);
+
+} // namespace telemetry
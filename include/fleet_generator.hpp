@@ -0,0 +1,78 @@
+// fleet_generator.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "telemetry_agent.hpp"
+
+namespace telemetry {
+
+// Per-interface behaviour in a synthetic fleet.
+enum class FleetProfile : uint8_t {
+  Stable, // wired link with small noise
+  Ramp,   // degrades linearly to a bad plateau, holds, recovers; every ramp period
+  Spike,  // spike_len_sec of bad metrics every spike period
+  Noisy,  // cellular-like link with large per-sample noise
+};
+
+const char* fleet_profile_name(FleetProfile p);
+
+struct FleetConfig {
+  std::size_t interfaces = 1000;
+  uint64_t seed = 1;
+
+  // Profiles cycle by InterfaceId: id % 4 picks Stable, Ramp, Spike, Noisy.
+  // Each interface gets a seeded baseline scale and phase, so interfaces of
+  // one profile do not move in lockstep.
+  int ramp_period_sec = 120;
+  int spike_period_sec = 15;
+  int spike_len_sec = 4;
+
+  // Per-sample probabilities, decided by a hash of (seed, id, t).
+  double missing_rate = 0.0;
+  double late_rate = 0.0;
+  int late_by_sec = 3;
+};
+
+// Deterministic 1 Hz sample source for fleets of any size: tick(t) writes
+// every reporting interface's sample for second t into a caller-owned array,
+// ready for TelemetryAgent::ingest_batch(). Per-interface parameters are
+// precomputed, and jitter, drops and lateness come from a counter-based
+// hash rather than a stateful RNG, so a tick costs tens of ns per interface,
+// does not allocate, and ticks can be generated in any order.
+//
+// Unlike ScenarioGenerator, interfaces are addressed by index: register
+// them with the agent in id order.
+class FleetGenerator {
+public:
+  // Throws std::invalid_argument on a rate outside [0, 1], a non-positive
+  // period or spike length, or a negative late_by_sec.
+  explicit FleetGenerator(FleetConfig cfg = {});
+
+  std::size_t size() const { return params_.size(); }
+  const FleetConfig& config() const { return cfg_; }
+  FleetProfile profile(InterfaceId id) const { return static_cast<FleetProfile>(id % 4); }
+
+  // Samples for second t, ids ascending, into out; returns the count (at
+  // most size()). Throws std::length_error if out is shorter than size().
+  std::size_t tick(int64_t t, std::span<Sample> out) const;
+
+private:
+  // Metrics as arrays in Metrics field order: rtt, throughput, loss, jitter.
+  struct Params {
+    double base[4] = {};
+    double ramp[4] = {};  // added at the bottom of a ramp
+    double spike[4] = {}; // added during a spike
+    double noise[4] = {}; // peak-to-peak noise amplitude
+    int32_t ramp_phase = 0;  // in [0, ramp_period_sec)
+    int32_t spike_phase = 0; // in [0, spike_period_sec)
+  };
+
+  FleetConfig cfg_;
+  std::vector<Params> params_; // indexed by InterfaceId
+};
+
+} // namespace telemetry
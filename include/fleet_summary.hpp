@@ -0,0 +1,165 @@
+// fleet_summary.hpp
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "telemetry_agent.hpp"
+
+namespace telemetry {
+
+// Mergeable quantile sketch of non-negative values: log-linear buckets, kSub
+// per power of two from 2^kMinExp to 2^kMaxExp (below is the zero bucket,
+// above the last), so a quantile is within ~6% of the true value. Merging
+// adds counts; the result is the sketch of the union, in any order.
+class ValueSketch {
+public:
+  static constexpr int kSub = 8;
+  static constexpr int kMinExp = -6; // 1/64
+  static constexpr int kMaxExp = 20; // ~1e6
+  static constexpr std::size_t kBuckets = 1 + (kMaxExp - kMinExp) * kSub;
+
+  void add(double x, uint32_t n = 1);
+  void merge(const ValueSketch& o);
+
+  uint64_t count() const { return count_; }
+  double min() const { return count_ ? min_ : 0.0; }
+  double max() const { return count_ ? max_ : 0.0; }
+
+  // Nearest-rank quantile (q in [0, 1]), as the middle of its bucket clamped
+  // to [min(), max()] (min() or max() in the end buckets); 0 when empty.
+  double quantile(double q) const;
+
+  // Non-empty buckets as (index, count), ascending; for serialisation.
+  template <typename Fn>
+  void for_each_bucket(Fn&& fn) const {
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+      if (buckets_[i] != 0) fn(i, buckets_[i]);
+    }
+  }
+  // Adds count to bucket i (i < kBuckets); min/max are set by the caller.
+  void add_bucket(std::size_t i, uint32_t count);
+  void set_range(double lo, double hi);
+
+private:
+  static std::size_t index_(double x);
+  static double lower_bound_(std::size_t i);
+
+  std::array<uint32_t, kBuckets> buckets_{};
+  uint64_t count_ = 0;
+  double min_ = 0.0;
+  double max_ = 0.0;
+};
+
+// Mergeable summary of a set of interfaces' windows: per-second sums and
+// maxima, RTT/jitter sketches, a status histogram and the score sum. Built
+// from trackers on the box that owns them, then merged across interfaces,
+// boxes and sites without the raw samples; merging is associative and
+// commutative (up to floating-point rounding of the sums).
+struct WindowDigest {
+  static constexpr std::size_t kStatuses = 3; // IfStatus values
+
+  uint32_t interfaces = 0;
+  uint64_t seconds = 0;         // window seconds with data, over all interfaces
+  int64_t newest_ts = 0;        // newest window second seen (0 if none)
+  double rtt_sum = 0.0;         // over per-second values
+  double throughput_sum = 0.0;
+  double loss_sum = 0.0;
+  double jitter_sum = 0.0;
+  double max_loss_pct = 0.0;
+  double score_used_sum = 0.0;  // one score per interface
+  std::array<uint32_t, kStatuses> status_counts{};
+  ValueSketch rtt_ms;
+  ValueSketch jitter_ms;
+
+  // Adds one interface's window, status and score.
+  void add(const InterfaceTracker& tr);
+  void merge(const WindowDigest& o);
+
+  // Fraction of the interfaces' window seconds that had data.
+  double confidence() const;
+  double avg_rtt_ms() const { return seconds ? rtt_sum / seconds : 0.0; }
+  double avg_throughput_mbps() const { return seconds ? throughput_sum / seconds : 0.0; }
+  double avg_loss_pct() const { return seconds ? loss_sum / seconds : 0.0; }
+  double avg_jitter_ms() const { return seconds ? jitter_sum / seconds : 0.0; }
+  double avg_score_used() const { return interfaces ? score_used_sum / interfaces : 0.0; }
+  uint32_t count(IfStatus s) const { return status_counts[static_cast<std::size_t>(s)]; }
+
+  // Appends the compact encoding (fixed fields, then each sketch's
+  // non-empty buckets as uint8 index + uint32 count) to out.
+  void encode(std::vector<std::byte>& out) const;
+  // Decodes one digest from the front of in and advances in past it;
+  // nullopt if truncated or inconsistent.
+  static std::optional<WindowDigest> decode(std::span<const std::byte>& in);
+};
+
+// One agent's report: a digest per group (uplink) of its interfaces.
+struct DigestPush {
+  std::string site;
+  std::string node;
+  int64_t tick_ts = 0;
+  std::vector<std::pair<std::string, WindowDigest>> groups; // sorted by name, unique
+};
+
+// Builds a push from every interface of agent, grouped by group_of(id)
+// (default: one group per interface, named after it). Interfaces mapped to
+// an empty name are left out.
+using GroupOf = std::function<std::string_view(InterfaceId)>;
+DigestPush make_push(const TelemetryAgent& agent, std::string site, std::string node, int64_t tick_ts,
+                     const GroupOf& group_of = {});
+
+// Push datagram: magic "TLMD", version, group count, endian marker and
+// tick_ts, then site and node names and each group's name and digest (names
+// as uint16 length + bytes). Host byte order, like the sample and snapshot
+// formats. encode_push() replaces out's contents. Throws std::length_error for
+// names over 65535 bytes or more than 65535 groups.
+void encode_push(const DigestPush& push, std::vector<std::byte>& out);
+std::optional<DigestPush> decode_push(std::span<const std::byte> datagram);
+
+struct AggregatorStats {
+  uint64_t pushes = 0;      // accepted
+  uint64_t bad = 0;         // undecodable datagrams
+  uint64_t stale = 0;       // older than the node's last accepted push
+  uint64_t expired = 0;     // nodes dropped by expire()
+};
+
+// Site-level rollups from the latest push of every node. A push replaces
+// its node's previous one (pushes carry window state, not increments), so
+// rollups never double count; queries merge the current pushes, costing
+// O(nodes x groups) per call, and ingest is a decode and a map update.
+class FleetAggregator {
+public:
+  // Returns false (and counts it) for a bad or stale push. Groups of a push
+  // built by hand are sorted, and same-named ones merged, on the way in.
+  bool ingest(std::span<const std::byte> datagram);
+  bool ingest(DigestPush push);
+
+  // Forgets nodes whose last push has tick_ts < now - max_age.
+  std::size_t expire(int64_t now, int64_t max_age);
+
+  std::vector<std::string> sites() const;
+  std::vector<std::string> uplinks(std::string_view site) const;
+  std::size_t nodes(std::string_view site) const;
+
+  // Everything a site's nodes reported, or only their group named uplink.
+  WindowDigest site(std::string_view site) const;
+  WindowDigest uplink(std::string_view site, std::string_view uplink) const;
+
+  const AggregatorStats& stats() const { return stats_; }
+
+private:
+  using Nodes = std::map<std::string, DigestPush, std::less<>>;
+  std::map<std::string, Nodes, std::less<>> sites_; // site -> node -> latest push
+  AggregatorStats stats_;
+};
+
+} // namespace telemetry
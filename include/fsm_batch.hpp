@@ -0,0 +1,49 @@
+// fsm_batch.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "batch_scorer.hpp"
+#include "hysteresis_fsm.hpp"
+
+namespace telemetry {
+
+// Structure-of-arrays view of N FsmStates (one column per field) and this
+// tick's inputs. The state columns are updated in place; all arrays hold n
+// entries.
+struct FsmBatch {
+  uint8_t* status = nullptr; // IfStatus
+  int64_t* last_transition_ts = nullptr;
+  int* cnt_below_healthy_exit = nullptr;
+  int* cnt_above_healthy_enter = nullptr;
+  int* cnt_below_down_enter = nullptr;
+  int* cnt_above_down_exit = nullptr;
+
+  const double* score = nullptr;
+  const double* confidence = nullptr;
+
+  std::size_t n = 0;
+};
+
+// One transition made by fsm_update_batch(); index is the entry's position.
+struct FsmChange {
+  uint32_t index = 0;
+  IfStatus from = IfStatus::Degraded;
+  IfStatus to = IfStatus::Degraded;
+  TransitionReason reason = TransitionReason::None;
+};
+
+// fsm_update(cfg, entry, ts_now, score, confidence) for every entry, with
+// the same results, without a per-entry branch on the status: each entry's
+// counters, transition and next status come from masks over all three
+// states, and only entries that transitioned are written to out, in index
+// order. Returns their count. out must hold b.n entries (std::length_error
+// otherwise). The vector kernels use the ScoreKernel dispatch of
+// batch_scorer.hpp (no NEON kernel yet; it runs the scalar one).
+std::size_t fsm_update_batch(const FsmConfig& cfg, const FsmBatch& b, int64_t ts_now, std::span<FsmChange> out);
+std::size_t fsm_update_batch_with(ScoreKernel k, const FsmConfig& cfg, const FsmBatch& b, int64_t ts_now,
+                                  std::span<FsmChange> out);
+
+} // namespace telemetry
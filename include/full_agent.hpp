@@ -0,0 +1,319 @@
+// full_agent.hpp
+//
+// The standalone full_agent (src/full_agent.cpp) as a linkable library,
+// full_agent_core: window, scorer, FSM, agent and scenario simulator, so
+// benchmarks can drive it in-process next to the telemetry_agent library
+// (see bench/benchmark_full_agent.cpp). It does not depend on that library.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace full_agent {
+
+struct Measurement {
+    int timestamp;
+    double rtt;        // ms
+    double throughput; // Mbps
+    double loss;       // %
+    double jitter;     // ms
+};
+
+enum class Status { Healthy, Degraded, Down };
+
+std::string statusToString(Status s);
+
+// Counts discarded samples and reports them at most once per
+// REPORT_EVERY_SEC of agent time, so a late-sample storm costs a counter
+// increment per sample instead of a write to stderr.
+class DiscardLog {
+private:
+    static constexpr int REPORT_EVERY_SEC = 10;
+    size_t total = 0;
+    size_t suppressed = 0;
+    bool reported = false;
+    int next_report_time = 0;
+    std::ostream* out = &std::cerr;
+
+public:
+    void note(int timestamp, int current_time) {
+        ++total;
+        if (reported && current_time < next_report_time) {
+            ++suppressed;
+            return;
+        }
+        if (out && suppressed > 0) {
+            *out << "Discarding old sample at t=" << timestamp << " (" << suppressed << " more since last report)\n";
+        } else if (out) {
+            *out << "Discarding old sample at t=" << timestamp << "\n";
+        }
+        suppressed = 0;
+        reported = true;
+        next_report_time = current_time + REPORT_EVERY_SEC;
+    }
+
+    // nullptr counts without reporting.
+    void setOutput(std::ostream* os) { out = os; }
+
+    size_t count() const { return total; }
+    size_t unreported() const { return suppressed; }
+};
+
+// Process-wide discard counter used by every RollingWindow.
+DiscardLog& discardLog();
+
+// Fixed-capacity ring indexed by timestamp (one slot per second, a second
+// sample for the same second replaces the first) with running sums, as in
+// the library's RollingWindow. The window is anchored at the latest
+// current_time passed to add(): samples older than current_time - 44 are
+// discarded, and samples ahead of it are held while they fit in the ring.
+class RollingWindow {
+private:
+    static constexpr int WINDOW_SEC = 45;
+    static constexpr int SLOTS = 64;  // power of two >= WINDOW_SEC; the rest holds early samples
+    static constexpr int EMPTY = std::numeric_limits<int>::min();
+
+    struct Slot {
+        int timestamp = EMPTY;
+        Measurement m{};
+    };
+
+    std::array<Slot, SLOTS> slots{};
+    int oldest_allowed = EMPTY;
+    double sum_rtt = 0.0;
+    double sum_throughput = 0.0;
+    double sum_loss = 0.0;
+    double sum_jitter = 0.0;
+    size_t count = 0;
+
+    static size_t index(int timestamp) { return static_cast<unsigned>(timestamp) & (SLOTS - 1); }
+
+    void addToSums(const Measurement& m) {
+        sum_rtt += m.rtt;
+        sum_throughput += m.throughput;
+        sum_loss += m.loss;
+        sum_jitter += m.jitter;
+        ++count;
+    }
+
+    void removeFromSums(const Measurement& m) {
+        if (--count == 0) {
+            sum_rtt = sum_throughput = sum_loss = sum_jitter = 0.0;  // drop rounding error
+            return;
+        }
+        sum_rtt -= m.rtt;
+        sum_throughput -= m.throughput;
+        sum_loss -= m.loss;
+        sum_jitter -= m.jitter;
+    }
+
+    void advance(int new_oldest) {
+        if (oldest_allowed != EMPTY && new_oldest - oldest_allowed < SLOTS) {
+            for (int t = oldest_allowed; t < new_oldest; ++t) {
+                Slot& slot = slots[index(t)];
+                if (slot.timestamp != t) continue;
+                removeFromSums(slot.m);
+                slot.timestamp = EMPTY;
+            }
+        } else {
+            for (auto& slot : slots) slot.timestamp = EMPTY;
+            sum_rtt = sum_throughput = sum_loss = sum_jitter = 0.0;
+            count = 0;
+        }
+        oldest_allowed = new_oldest;
+    }
+
+public:
+    // Returns false (and counts the discard) if the sample does not fit.
+    bool add(const Measurement& m, int current_time) {
+        const int new_oldest = current_time - (WINDOW_SEC - 1);
+        if (oldest_allowed == EMPTY || new_oldest > oldest_allowed) advance(new_oldest);
+        if (m.timestamp < oldest_allowed || m.timestamp - oldest_allowed >= SLOTS) {
+            discardLog().note(m.timestamp, current_time);
+            return false;
+        }
+        Slot& slot = slots[index(m.timestamp)];
+        if (slot.timestamp == m.timestamp) removeFromSums(slot.m);
+        slot.timestamp = m.timestamp;
+        slot.m = m;
+        addToSums(m);
+        return true;
+    }
+
+    double getAvgRTT() const { return count > 0 ? sum_rtt / count : 0.0; }
+    double getAvgThroughput() const { return count > 0 ? sum_throughput / count : 0.0; }
+    double getAvgLoss() const { return count > 0 ? sum_loss / count : 0.0; }
+    double getAvgJitter() const { return count > 0 ? sum_jitter / count : 0.0; }
+    size_t size() const { return count; }
+};
+
+struct Scorer {
+    static double normalizeThroughput(double val) { return std::min(1.0, val / 200.0); }
+    static double normalizeRTT(double val) { return std::max(0.0, 1.0 - (val - 10.0) / 790.0); }
+    static double normalizeLoss(double val) { return std::max(0.0, 1.0 - val / 30.0); }
+    static double normalizeJitter(double val) { return std::max(0.0, 1.0 - val / 200.0); }
+
+    // Strategy 1: Weighted sum on averages
+    static double computeScore(const RollingWindow& window) {
+        double n_tp = normalizeThroughput(window.getAvgThroughput());
+        double n_rtt = normalizeRTT(window.getAvgRTT());
+        double n_loss = normalizeLoss(window.getAvgLoss());
+        double n_jit = normalizeJitter(window.getAvgJitter());
+        return 0.3 * n_tp + 0.3 * n_rtt + 0.2 * n_loss + 0.2 * n_jit;
+    }
+
+    // Strategy 2 (Bonus): EWMA on metrics + trend penalty
+    static double computeScoreEWMA(const RollingWindow& window, double prev_ewma_score) {
+        double alpha = 0.2;
+        double current_score = computeScore(window);
+        double ewma = alpha * current_score + (1 - alpha) * prev_ewma_score;
+        // Simple trend: if current < prev, penalty
+        double penalty = (current_score < prev_ewma_score) ? -0.1 : 0.0;
+        return std::clamp(ewma + penalty, 0.0, 1.0);
+    }
+};
+
+class HysteresisStatus {
+private:
+    static constexpr int CONSECUTIVE_REQ = 5;
+    static constexpr double THRESH_HEALTHY = 0.8;
+    static constexpr double THRESH_DEGRADED = 0.4;
+
+    Status current = Status::Healthy;
+    int consec_below_healthy = 0;
+    int consec_below_degraded = 0;
+    int consec_above_degraded = 0;
+    int consec_above_healthy = 0;
+
+public:
+    std::pair<Status, bool> update(double score) {
+        bool changed = false;
+        switch (current) {
+            case Status::Healthy:
+                if (score < THRESH_HEALTHY) {
+                    ++consec_below_healthy;
+                    if (consec_below_healthy >= CONSECUTIVE_REQ) {
+                        current = Status::Degraded;
+                        changed = true;
+                    }
+                } else {
+                    consec_below_healthy = 0;
+                }
+                break;
+            case Status::Degraded:
+                if (score < THRESH_DEGRADED) {
+                    ++consec_below_degraded;
+                    if (consec_below_degraded >= CONSECUTIVE_REQ) {
+                        current = Status::Down;
+                        changed = true;
+                    }
+                } else if (score > THRESH_HEALTHY) {
+                    ++consec_above_healthy;
+                    if (consec_above_healthy >= CONSECUTIVE_REQ) {
+                        current = Status::Healthy;
+                        changed = true;
+                    }
+                } else {
+                    consec_below_degraded = 0;
+                    consec_above_healthy = 0;
+                }
+                break;
+            case Status::Down:
+                if (score > THRESH_DEGRADED) {
+                    ++consec_above_degraded;
+                    if (consec_above_degraded >= CONSECUTIVE_REQ) {
+                        current = Status::Degraded;
+                        changed = true;
+                    }
+                } else {
+                    consec_above_degraded = 0;
+                }
+                break;
+        }
+        return {current, changed};
+    }
+
+    Status getStatus() const { return current; }
+};
+
+class InterfaceState {
+private:
+    RollingWindow window;
+    HysteresisStatus status_mgr;
+    double last_score = 0.0;
+    double ewma_score = 0.0;  // For Strategy 2
+    double sum_scores = 0.0;  // For end summary
+    int score_count = 0;
+
+public:
+    void addMeasurement(const Measurement& m, int current_time) {
+        window.add(m, current_time);
+    }
+
+    void computeScore(bool use_ewma = false) {
+        if (use_ewma) {
+            ewma_score = Scorer::computeScoreEWMA(window, ewma_score);
+            last_score = ewma_score;
+        } else {
+            last_score = Scorer::computeScore(window);
+        }
+        sum_scores += last_score;
+        ++score_count;
+    }
+
+    std::pair<double, Status> getLatest() {
+        auto [status, changed] = status_mgr.update(last_score);
+        return {last_score, status};
+    }
+
+    double getAvgScore() const { return score_count > 0 ? sum_scores / score_count : 0.0; }
+};
+
+class TelemetryAgent {
+private:
+    std::map<std::string, InterfaceState> interfaces = {
+        {"eth0", {}}, {"wifi0", {}}, {"lte0", {}}, {"sat0", {}}
+    };
+    std::map<std::string, Status> last_statuses;
+    bool use_ewma = false;  // Toggle for comparison
+    std::FILE* out = stdout;
+
+public:
+    // tick() and printSummary() write to `output`; nullptr suppresses them.
+    explicit TelemetryAgent(bool ewma = false, std::FILE* output = stdout) : use_ewma(ewma), out(output) {}
+
+    void processMeasurement(const std::string& iface, const Measurement& m, int current_time) {
+        if (interfaces.count(iface)) {
+            interfaces[iface].addMeasurement(m, current_time);
+        }
+    }
+
+    void tick(int current_time);
+    void printSummary();
+};
+
+// Per-interface samples; a run feeds index t at tick t.
+using ScenarioSequences = std::map<std::string, std::vector<Measurement>>;
+
+namespace Simulator {
+    ScenarioSequences generateScenarioA(int duration);
+    ScenarioSequences generateScenarioB(int duration);
+    ScenarioSequences generateScenarioC(int duration);
+
+    // Throws std::invalid_argument for anything but A, B or C.
+    ScenarioSequences getScenario(char id, int duration = 90);
+}
+
+// The executable's run: for t in [0, duration), feed every interface's
+// sample t (if any), then tick.
+void runScenario(TelemetryAgent& agent, const ScenarioSequences& sequences, int duration = 90);
+
+} // namespace full_agent
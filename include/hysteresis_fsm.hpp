@@ -0,0 +1,124 @@
+// hysteresis_fsm.hpp
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+namespace telemetry {
+
+enum class IfStatus { Healthy, Degraded, Down };
+
+inline const char* to_string(IfStatus s) {
+  switch (s) {
+    case IfStatus::Healthy: return "Healthy";
+    case IfStatus::Degraded: return "Degraded";
+    case IfStatus::Down: return "Down";
+  }
+  return "?";
+}
+
+// Transition reasons reported by HysteresisFsm.
+namespace fsm_reason {
+inline constexpr const char* kForceDown = "confidence below force-down threshold";
+inline constexpr const char* kHealthyExit = "score <= healthy_exit for N ticks";
+inline constexpr const char* kDownEnter = "score <= down_enter for M ticks";
+inline constexpr const char* kHealthyEnter = "score >= healthy_enter for N ticks";
+inline constexpr const char* kDownExit = "score >= down_exit for P ticks";
+} // namespace fsm_reason
+
+enum class TransitionReason : uint8_t { None, ForceDown, HealthyExit, DownEnter, HealthyEnter, DownExit };
+
+inline const char* to_string(TransitionReason r) {
+  switch (r) {
+    case TransitionReason::None: return "";
+    case TransitionReason::ForceDown: return fsm_reason::kForceDown;
+    case TransitionReason::HealthyExit: return fsm_reason::kHealthyExit;
+    case TransitionReason::DownEnter: return fsm_reason::kDownEnter;
+    case TransitionReason::HealthyEnter: return fsm_reason::kHealthyEnter;
+    case TransitionReason::DownExit: return fsm_reason::kDownExit;
+  }
+  return "?";
+}
+
+struct FsmConfig {
+  // Hysteresis thresholds (enter differs from exit).
+  double healthy_enter = 0.72;
+  double healthy_exit = 0.66;
+  double down_enter = 0.35;
+  double down_exit = 0.45;
+
+  // Consecutive evidence required (ticks).
+  int healthy_enter_N = 6;
+  int healthy_exit_N = 6;
+  int down_enter_N = 3;
+  int down_exit_N = 5;
+
+  // Minimum time between transitions (0 disables). Fast drop to Down ignores it.
+  int64_t min_dwell_sec = 5;
+
+  // Promotion to Healthy requires at least this window confidence.
+  double min_confidence_for_promotion = 0.60;
+
+  // Force Down when confidence drops below this value (negative disables).
+  double force_down_if_confidence_below = -1.0;
+
+  bool operator==(const FsmConfig&) const = default;
+};
+
+// Horizons returned by next_change_ts(): the next update changes state
+// whenever it runs / no update with the same inputs ever will.
+inline constexpr int64_t kChangeNow = std::numeric_limits<int64_t>::min();
+inline constexpr int64_t kChangeNever = std::numeric_limits<int64_t>::max();
+
+struct FsmUpdate {
+  IfStatus status = IfStatus::Degraded;
+  bool transitioned = false;
+  TransitionReason reason = TransitionReason::None;
+};
+
+// HysteresisFsm's mutable state, apart from its config, for trackers that
+// share one FsmConfig (see compact_agent.hpp).
+struct FsmState {
+  IfStatus status = IfStatus::Degraded;
+  int64_t last_transition_ts = std::numeric_limits<int64_t>::min();
+
+  int cnt_below_healthy_exit = 0;
+  int cnt_above_healthy_enter = 0;
+  int cnt_below_down_enter = 0;
+  int cnt_above_down_exit = 0;
+};
+
+// HysteresisFsm::update() / next_change_ts() on external state.
+FsmUpdate fsm_update(const FsmConfig& cfg, FsmState& st, int64_t ts_now, double score, double confidence);
+int64_t fsm_next_change_ts(const FsmConfig& cfg, const FsmState& st, double score, double confidence);
+
+// Anti-flapping state machine: Healthy <-> Degraded <-> Down.
+class HysteresisFsm {
+public:
+  explicit HysteresisFsm(FsmConfig cfg = {}, IfStatus initial = IfStatus::Degraded);
+
+  FsmUpdate update(int64_t ts_now, double score, double confidence) {
+    return fsm_update(cfg_, st_, ts_now, score, confidence);
+  }
+
+  // Earliest ts at which update(ts, score, confidence) could change the FSM
+  // if score and confidence stay as given: kChangeNow while evidence is
+  // still being counted, the end of the dwell when only that blocks a
+  // transition, kChangeNever when every such update is a no-op.
+  int64_t next_change_ts(double score, double confidence) const {
+    return fsm_next_change_ts(cfg_, st_, score, confidence);
+  }
+
+  IfStatus status() const { return st_.status; }
+  int64_t last_transition_ts() const { return st_.last_transition_ts; }
+
+  // Checkpoint access.
+  const FsmState& state() const { return st_; }
+  void restore(const FsmState& st) { st_ = st; }
+
+private:
+  FsmConfig cfg_;
+  FsmState st_;
+};
+
+} // namespace telemetry
@@ -0,0 +1,51 @@
+// instrumentation.hpp
+#pragma once
+
+#include <cstdint>
+
+#include "latency_histogram.hpp"
+
+// Set by CMake (option TELEMETRY_INSTRUMENTATION). With 0 the agent keeps
+// the stats API but records nothing and the hot path carries no extra code.
+#ifndef TELEMETRY_INSTRUMENTATION
+#define TELEMETRY_INSTRUMENTATION 1
+#endif
+
+namespace telemetry {
+
+inline constexpr bool kInstrumentationEnabled = (TELEMETRY_INSTRUMENTATION != 0);
+
+// Sample accounting, kept per interface and summed for the whole agent.
+struct IngestCounters {
+  uint64_t ingested = 0;     // accepted into the window
+  uint64_t overwritten = 0;  // accepted, replacing a sample for the same second
+  uint64_t merged = 0;       // accepted, averaged into a sample for the same second
+  uint64_t dropped_late = 0; // rejected: older than the window
+  uint64_t future = 0;       // timestamp ahead of the last note_time()
+  uint64_t recomputes = 0;   // score/FSM evaluations (ingest + tick)
+  uint64_t transitions = 0;
+
+  IngestCounters& operator+=(const IngestCounters& o) {
+    ingested += o.ingested;
+    overwritten += o.overwritten;
+    merged += o.merged;
+    dropped_late += o.dropped_late;
+    future += o.future;
+    recomputes += o.recomputes;
+    transitions += o.transitions;
+    return *this;
+  }
+};
+
+struct AgentStats {
+  // Every kIngestTimingEvery-th ingest is timed, to keep clock reads off
+  // most hot-path calls; note_time() is timed on every tick.
+  static constexpr uint64_t kIngestTimingEvery = 16;
+
+  IngestCounters totals;
+  uint64_t ticks = 0;
+  LatencyHistogram ingest_ns;
+  LatencyHistogram tick_ns;
+};
+
+} // namespace telemetry
@@ -0,0 +1,246 @@
+// interface_tracker.hpp
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+
+#include "hysteresis_fsm.hpp"
+#include "rolling_window.hpp"
+
+namespace telemetry {
+
+// Dense per-agent interface handle.
+using InterfaceId = uint32_t;
+
+// Window statistic fed to a metric's normaliser.
+enum class WindowStat : uint8_t { Mean, P50, P95, P99 };
+
+// Normalisation range per scored metric; the defaults are the descriptors'
+// (metric_descriptors.hpp), so default scores are unchanged.
+struct MetricRanges {
+  MetricRange tp = range_of<ThroughputMetric>();
+  MetricRange rtt = range_of<RttMetric>();
+  MetricRange loss = range_of<LossMetric>();
+  MetricRange jitter = range_of<JitterMetric>();
+  bool operator==(const MetricRanges&) const = default;
+};
+
+struct ScoreConfig {
+  // Weights (quality metrics dominate throughput).
+  double w_loss = 0.30;
+  double w_rtt = 0.25;
+  double w_tp = 0.25;
+  double w_jit = 0.20;
+
+  // A satellite or LTE link needs a much wider RTT/jitter range than
+  // Ethernet to score anywhere but zero; see config_profile.hpp.
+  MetricRanges ranges;
+
+  // Tail-aware scoring: score RTT/jitter on a window quantile and loss on
+  // the window maximum, so one spike weighs less than sustained degradation
+  // at p50 and more at p99. Anything but the defaults makes the tracker
+  // maintain quantiles (TelemetryAgent only; the columnar agent and batch
+  // kernels score on means).
+  WindowStat rtt_stat = WindowStat::Mean;
+  WindowStat jitter_stat = WindowStat::Mean;
+  bool loss_use_max = false;
+
+  // Strategy selection: score_used = useEwma ? score_ewma : score_avg.
+  bool useEwma = true;
+  double ewma_alpha = 0.25;
+
+  // Optional downward-trend penalty applied to the EWMA.
+  bool enable_downtrend_penalty = false;
+  double downtrend_penalty = 0.02;
+
+  // Optional cap on the score while window confidence is low.
+  bool enable_confidence_cap = true;
+  double min_confidence_for_promotion = 0.60;
+  double score_cap_when_low_conf = 0.70;
+
+  bool operator==(const ScoreConfig&) const = default;
+};
+
+inline bool uses_window_quantiles(const ScoreConfig& c) {
+  return c.rtt_stat != WindowStat::Mean || c.jitter_stat != WindowStat::Mean || c.loss_use_max;
+}
+
+// When scoring and the FSM run.
+enum class RecomputeMode : uint8_t {
+  Eager,   // after every ingest and every note_time() (EWMA/FSM advance per sample)
+  PerTick, // ingest only updates the window; exactly one evaluation per tick
+};
+
+// What a second sample for an already-filled second does.
+enum class SameSecond : uint8_t {
+  Replace, // last sample wins (one sample per second collectors)
+  Average, // the second holds the mean of all its samples (sub-second probes)
+};
+
+// Which trackers note_time() visits (TelemetryAgent; the other engines
+// always visit every interface).
+enum class TickScan : uint8_t {
+  All,    // every tracker on every tick
+  Active, // only trackers whose state can change: those with new samples or
+          // still converging, plus sleepers woken by a timer wheel when a
+          // sample expires or an FSM dwell ends. Same snapshots and transitions.
+};
+
+struct AgentConfig {
+  ScoreConfig score;
+  FsmConfig fsm;
+  RecomputeMode recompute = RecomputeMode::Eager;
+  SameSecond same_second = SameSecond::Replace;
+  TickScan tick_scan = TickScan::All;
+};
+
+// The per-interface part of AgentConfig: how a link is scored and how
+// eagerly its status moves. Trackers share profiles by pointer (see
+// ProfileTable in config_profile.hpp); when and how samples are taken stays
+// agent-wide.
+struct ConfigProfile {
+  ScoreConfig score;
+  FsmConfig fsm;
+  bool operator==(const ConfigProfile&) const = default;
+};
+
+// Latest per-interface state exposed to callers.
+struct InterfaceSnapshot {
+  std::string iface;
+  IfStatus status = IfStatus::Degraded;
+
+  double score_raw = 0.0;      // window-average score
+  double score_smoothed = 0.0; // EWMA score
+  double score_used = 0.0;     // score that drives the FSM
+
+  double confidence = 0.0;
+  double missing_rate = 1.0;
+
+  double avg_tp_mbps = 0.0;
+  double avg_rtt_ms = 0.0;
+  double avg_loss_pct = 0.0;
+  double avg_jitter_ms = 0.0;
+};
+
+// Edge-triggered status change. Trivially copyable: the interface is a
+// handle (resolve names through the agent) and the reason is an enum.
+struct TransitionEvent {
+  InterfaceId id = 0;
+  int64_t ts = 0;
+  IfStatus from = IfStatus::Degraded;
+  IfStatus to = IfStatus::Degraded;
+  TransitionReason reason = TransitionReason::None;
+};
+
+// InterfaceTracker's evaluation state apart from its window and name, as
+// saved in checkpoints (see checkpoint.hpp).
+struct TrackerState {
+  FsmState fsm;
+  double score_avg = 0.0;
+  double score_ewma = 0.0;
+  double score_used = 0.0;
+  bool have_ewma = false;
+  bool dirty = false;
+  int64_t last_eval_ts = std::numeric_limits<int64_t>::min();
+
+  // The last evaluation's window figures (the snapshot lags the window
+  // while samples are staged).
+  double confidence = 0.0;
+  double avg_tp_mbps = 0.0;
+  double avg_rtt_ms = 0.0;
+  double avg_loss_pct = 0.0;
+  double avg_jitter_ms = 0.0;
+};
+
+// Deep module per interface: window -> score -> EWMA -> FSM -> snapshot.
+class InterfaceTracker {
+public:
+  // Standalone tracker owning a profile made of cfg's score and fsm.
+  InterfaceTracker(std::string iface, AgentConfig cfg, InterfaceId id = 0);
+  // Tracker scoring with *profile, which must outlive it (or the next
+  // set_profile()); cfg supplies only recompute and same_second.
+  InterfaceTracker(std::string iface, const ConfigProfile* profile, const AgentConfig& cfg, InterfaceId id);
+
+  // Evaluations from now on use *profile (also after the pointee was
+  // replaced in place); window, EWMA and FSM counters carry over. Turns on
+  // window quantiles, seeded from the current window, if the profile needs
+  // them.
+  void set_profile(const ConfigProfile* profile);
+  const ConfigProfile& profile() const { return *profile_; }
+
+  RollingWindow::IngestResult ingest(int64_t ts, const Metrics& m);
+
+  // Batched ingest: stage() only updates the window and marks the tracker
+  // dirty; flush() then runs the single Eager evaluation for everything
+  // staged (PerTick leaves it to note_time()). Returns true if it evaluated.
+  RollingWindow::IngestResult stage(int64_t ts, const Metrics& m);
+  bool flush();
+
+  // Returns false if PerTick mode skipped a repeated tick with no new samples.
+  bool note_time(int64_t ts_now);
+
+  // Samples arrived since the last evaluation.
+  bool dirty() const { return dirty_; }
+
+  // With no new samples, every note_time(t) for t before the returned ts
+  // leaves the tracker unchanged: kChangeNow if the next one will change it
+  // (dirty, EWMA still converging, FSM counting), otherwise the first ts at
+  // which a sample expires or an FSM dwell ends, or kChangeNever.
+  int64_t next_change_ts() const;
+
+  // Expires the window up to ts_now without evaluating, for a tracker whose
+  // no-op ticks were skipped.
+  void advance_window(int64_t ts_now) { window_.note_time(ts_now); }
+
+  const InterfaceSnapshot& snapshot() const { return last_snapshot_; }
+  const std::string& iface() const { return iface_; }
+  InterfaceId id() const { return id_; }
+
+  // Returns the transition produced by the last update (if any) and clears it.
+  std::optional<TransitionEvent> drain_transition();
+
+  // Checkpoint access. restore() replaces everything but the name, id and
+  // profile (a pending transition is dropped); it returns false, leaving the
+  // window empty, if the window state is inconsistent (see
+  // BasicRollingWindow::restore()).
+  TrackerState state() const;
+  const RollingWindow& window() const { return window_; }
+  bool restore(const TrackerState& st, int64_t window_newest_ts, const DefaultMetrics::Values& window_sums,
+               std::span<const RollingWindow::Storage::Second> seconds);
+
+  static double clamp01(double x);
+  static double norm_tp(double mbps);
+  static double norm_rtt(double ms);
+  static double norm_loss(double pct);
+  static double norm_jit(double ms);
+
+private:
+  double compute_avg_score_(const RollingWindow::Summary& s) const;
+  double update_ewma_(double prev, double current) const;
+  void recompute_(int64_t now_ts);
+
+  std::string iface_;
+  InterfaceId id_;
+  const ConfigProfile* profile_;
+  std::shared_ptr<const ConfigProfile> own_profile_; // standalone trackers only
+  RecomputeMode recompute_mode_;
+  SameSecond same_second_;
+  RollingWindow window_;
+  FsmState fsm_;
+
+  double score_avg_ = 0.0;
+  double score_ewma_ = 0.0;
+  double score_used_ = 0.0;
+  bool have_ewma_ = false;
+  bool dirty_ = false;
+  int64_t last_eval_ts_ = std::numeric_limits<int64_t>::min();
+
+  InterfaceSnapshot last_snapshot_;
+  std::optional<TransitionEvent> pending_transition_;
+};
+
+} // namespace telemetry
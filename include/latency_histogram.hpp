@@ -0,0 +1,75 @@
+// latency_histogram.hpp
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace telemetry {
+
+// Fixed-size log-linear histogram of nanosecond latencies.
+//
+// Exact below 64 ns, then kSub sub-buckets per power of two (~6% resolution)
+// up to 2^kMaxExp ns; larger values land in the last bucket. Recording is a
+// bit scan and an increment and never allocates.
+class LatencyHistogram {
+public:
+  static constexpr int kLinear = 64;
+  static constexpr int kSub = 16;
+  static constexpr int kMaxExp = 40; // ~18 minutes
+  static constexpr std::size_t kBuckets = kLinear + (kMaxExp - 6 + 1) * kSub;
+
+  void record(uint64_t ns) {
+    ++buckets_[index_(ns)];
+    ++count_;
+    if (ns > max_) max_ = ns;
+  }
+
+  uint64_t count() const { return count_; }
+  uint64_t max() const { return max_; }
+
+  // Lower bound of the bucket holding the q-quantile (0 if empty).
+  uint64_t percentile(double q) const {
+    if (count_ == 0) return 0;
+    const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(count_))));
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+      seen += buckets_[i];
+      if (seen >= rank) return lower_bound_(i);
+    }
+    return lower_bound_(kBuckets - 1);
+  }
+
+  void merge(const LatencyHistogram& o) {
+    for (std::size_t i = 0; i < kBuckets; ++i) buckets_[i] += o.buckets_[i];
+    count_ += o.count_;
+    max_ = std::max(max_, o.max_);
+  }
+
+  void clear() { *this = LatencyHistogram{}; }
+
+private:
+  static std::size_t index_(uint64_t v) {
+    if (v < kLinear) return static_cast<std::size_t>(v);
+    int exp = static_cast<int>(std::bit_width(v)) - 1;
+    if (exp > kMaxExp) return kBuckets - 1;
+    const uint64_t sub = (v >> (exp - 4)) & (kSub - 1);
+    return kLinear + static_cast<std::size_t>(exp - 6) * kSub + static_cast<std::size_t>(sub);
+  }
+
+  static uint64_t lower_bound_(std::size_t i) {
+    if (i < kLinear) return i;
+    const std::size_t exp = 6 + (i - kLinear) / kSub;
+    const std::size_t sub = (i - kLinear) % kSub;
+    return (uint64_t{1} << exp) + (static_cast<uint64_t>(sub) << (exp - 4));
+  }
+
+  std::array<uint64_t, kBuckets> buckets_{};
+  uint64_t count_ = 0;
+  uint64_t max_ = 0;
+};
+
+} // namespace telemetry
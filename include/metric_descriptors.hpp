@@ -0,0 +1,163 @@
+// metric_descriptors.hpp
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace telemetry {
+
+// A metric descriptor is an empty type naming one scored metric and its
+// normalisation: values are mapped linearly from [lo, hi] onto [0, 1]
+// (inverted when lower is better) and clamped. Everything is constexpr, so
+// a window or scorer instantiated on a descriptor pack folds the constants
+// into its kernels.
+template <typename D>
+concept MetricDescriptor = requires {
+  { D::name } -> std::convertible_to<const char*>;
+  { D::lo } -> std::convertible_to<double>;
+  { D::hi } -> std::convertible_to<double>;
+  { D::higher_is_better } -> std::convertible_to<bool>;
+  { D::weight } -> std::convertible_to<double>;
+} && (D::hi > D::lo);
+
+struct ThroughputMetric {
+  static constexpr const char* name = "throughput_mbps";
+  static constexpr double lo = 0.0;
+  static constexpr double hi = 200.0;
+  static constexpr bool higher_is_better = true;
+  static constexpr double weight = 0.25;
+};
+
+struct RttMetric {
+  static constexpr const char* name = "rtt_ms";
+  static constexpr double lo = 10.0;
+  static constexpr double hi = 800.0;
+  static constexpr bool higher_is_better = false;
+  static constexpr double weight = 0.25;
+};
+
+struct LossMetric {
+  static constexpr const char* name = "loss_pct";
+  static constexpr double lo = 0.0;
+  static constexpr double hi = 30.0;
+  static constexpr bool higher_is_better = false;
+  static constexpr double weight = 0.30;
+};
+
+struct JitterMetric {
+  static constexpr const char* name = "jitter_ms";
+  static constexpr double lo = 0.0;
+  static constexpr double hi = 200.0;
+  static constexpr bool higher_is_better = false;
+  static constexpr double weight = 0.20;
+};
+
+// Optional extras for links that report them.
+struct RetransmitMetric {
+  static constexpr const char* name = "retransmit_pct";
+  static constexpr double lo = 0.0;
+  static constexpr double hi = 10.0;
+  static constexpr bool higher_is_better = false;
+  static constexpr double weight = 0.10;
+};
+
+struct SignalStrengthMetric {
+  static constexpr const char* name = "signal_dbm";
+  static constexpr double lo = -110.0;
+  static constexpr double hi = -50.0;
+  static constexpr bool higher_is_better = true;
+  static constexpr double weight = 0.10;
+};
+
+constexpr double clamp_unit(double x) {
+  if (x < 0.0) return 0.0;
+  if (x > 1.0) return 1.0;
+  return x;
+}
+
+// Same operation order as the hand-written norm_* functions, so the default
+// metrics give bit-identical scores.
+template <MetricDescriptor D>
+constexpr double normalize(double v) {
+  if constexpr (D::higher_is_better) {
+    if constexpr (D::lo == 0.0) {
+      return clamp_unit(v / D::hi);
+    } else {
+      return clamp_unit((v - D::lo) / (D::hi - D::lo));
+    }
+  } else {
+    if constexpr (D::lo == 0.0) {
+      return clamp_unit(1.0 - v / D::hi);
+    } else {
+      return clamp_unit(1.0 - (v - D::lo) / (D::hi - D::lo));
+    }
+  }
+}
+
+// A descriptor's range as a runtime value, so per-interface profiles can
+// rescale a metric (satellite RTT) while keeping its direction.
+struct MetricRange {
+  double lo = 0.0;
+  double hi = 1.0;
+  bool operator==(const MetricRange&) const = default;
+};
+
+template <MetricDescriptor D>
+constexpr MetricRange range_of() {
+  return {D::lo, D::hi};
+}
+
+// normalize<D>() over r instead of D's own range. For r == range_of<D>() the
+// result is bit-identical (v - 0.0 and hi - 0.0 are exact).
+template <MetricDescriptor D>
+constexpr double normalize(double v, const MetricRange& r) {
+  if constexpr (D::higher_is_better) {
+    return clamp_unit((v - r.lo) / (r.hi - r.lo));
+  } else {
+    return clamp_unit(1.0 - (v - r.lo) / (r.hi - r.lo));
+  }
+}
+
+// An ordered set of metrics; a sample is one double per metric.
+template <MetricDescriptor... Ds>
+struct MetricSet {
+  static constexpr std::size_t size = sizeof...(Ds);
+  static_assert(size > 0, "a metric set needs at least one metric");
+
+  using Values = std::array<double, size>;
+
+  static constexpr std::array<const char*, size> names = {Ds::name...};
+  static constexpr std::array<double, size> default_weights = {Ds::weight...};
+
+  // Position of descriptor D in the set.
+  template <MetricDescriptor D>
+  static constexpr std::size_t index_of() {
+    static_assert((std::is_same_v<D, Ds> || ...), "metric not in this set");
+    std::size_t i = 0;
+    ((std::is_same_v<D, Ds> ? false : (++i, true)) && ...);
+    return i;
+  }
+
+  // Weighted sum of the normalised values, clamped to [0, 1].
+  static constexpr double score(const Values& v, const std::array<double, size>& w = default_weights) {
+    return score_(v, w, std::index_sequence_for<Ds...>{});
+  }
+
+private:
+  template <std::size_t... I>
+  static constexpr double score_(const Values& v, const std::array<double, size>& w,
+                                 std::index_sequence<I...>) {
+    double s = 0.0;
+    ((s += w[I] * normalize<Ds>(v[I])), ...);
+    return clamp_unit(s);
+  }
+};
+
+// The four metrics every interface reports. The order is not Metrics' field
+// order; map fields with index_of<>() (see RollingWindow::to_values()).
+using DefaultMetrics = MetricSet<ThroughputMetric, RttMetric, LossMetric, JitterMetric>;
+
+} // namespace telemetry
@@ -0,0 +1,85 @@
+// mpsc_queue.hpp
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace telemetry {
+
+// Bounded lock-free multi-producer / single-consumer ring (Vyukov-style).
+//
+// Each cell carries a sequence number: producers claim a position with one CAS
+// on tail_, write the value and publish it by bumping the cell sequence; the
+// single consumer reads in order without any RMW. try_push() fails instead of
+// blocking when the ring is full. Capacity is rounded up to a power of two.
+template <typename T>
+class BoundedMpscQueue {
+public:
+  explicit BoundedMpscQueue(std::size_t capacity)
+    : mask_(round_up_pow2(capacity) - 1),
+      cells_(new Cell[mask_ + 1]) {
+    for (std::size_t i = 0; i <= mask_; ++i) cells_[i].seq.store(i, std::memory_order_relaxed);
+  }
+
+  BoundedMpscQueue(const BoundedMpscQueue&) = delete;
+  BoundedMpscQueue& operator=(const BoundedMpscQueue&) = delete;
+
+  std::size_t capacity() const { return mask_ + 1; }
+
+  // Any thread.
+  bool try_push(const T& v) {
+    std::size_t pos = tail_.load(std::memory_order_relaxed);
+    Cell* c = nullptr;
+    for (;;) {
+      c = &cells_[pos & mask_];
+      const std::size_t seq = c->seq.load(std::memory_order_acquire);
+      const auto dif = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+      if (dif == 0) {
+        if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+      } else if (dif < 0) {
+        return false; // full
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+    c->value = v;
+    c->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer thread only.
+  bool try_pop(T& out) {
+    Cell& c = cells_[head_ & mask_];
+    if (c.seq.load(std::memory_order_acquire) != head_ + 1) return false;
+    out = c.value;
+    c.seq.store(head_ + mask_ + 1, std::memory_order_release);
+    ++head_;
+    return true;
+  }
+
+  // Consumer thread only.
+  bool empty() const {
+    return cells_[head_ & mask_].seq.load(std::memory_order_acquire) != head_ + 1;
+  }
+
+private:
+  struct Cell {
+    std::atomic<std::size_t> seq{0};
+    T value{};
+  };
+
+  static std::size_t round_up_pow2(std::size_t n) {
+    std::size_t p = 2;
+    while (p < n) p <<= 1;
+    return p;
+  }
+
+  const std::size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+  alignas(64) std::atomic<std::size_t> tail_{0};
+  alignas(64) std::size_t head_ = 0;
+};
+
+} // namespace telemetry
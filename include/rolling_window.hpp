@@ -0,0 +1,117 @@
+// rolling_window.hpp
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#include "basic_rolling_window.hpp"
+#include "window_quantiles.hpp"
+
+namespace telemetry {
+
+// One network measurement for a single interface at a single second.
+struct Metrics {
+  double rtt_ms = 0.0;
+  double throughput_mbps = 0.0;
+  double loss_pct = 0.0;
+  double jitter_ms = 0.0;
+};
+
+// Fixed 45-second sliding window indexed by timestamp (one slot per second).
+//
+// Samples may arrive out of order; anything inside
+// [newest_ts - (kWindow-1), newest_ts] is accepted, older samples are rejected.
+// Memory is bounded and no allocation happens after construction.
+//
+// Running sums/count are adjusted on ingest, overwrite and eviction, so
+// summary() is O(1) and never scans the slots.
+//
+// The default instantiation of BasicRollingWindow (64-slot ring, mask
+// indexing) over DefaultMetrics, with a named-field Metrics/Summary API.
+class RollingWindow {
+public:
+  static constexpr int kWindow = 45;
+  using Storage = BasicRollingWindow<kWindow, DefaultMetrics, WindowQuantiles<kWindow>>;
+
+  struct Summary {
+    int64_t newest_ts = 0;
+    int64_t oldest_ts = 0;
+    int count = 0;
+    double confidence = 0.0;   // count / kWindow
+    double missing_rate = 1.0; // 1 - confidence
+
+    double avg_rtt_ms = 0.0;
+    double avg_throughput_mbps = 0.0;
+    double avg_loss_pct = 0.0;
+    double avg_jitter_ms = 0.0;
+
+    // Over the per-second values; only filled with enable_quantiles().
+    double p50_rtt_ms = 0.0;
+    double p95_rtt_ms = 0.0;
+    double p99_rtt_ms = 0.0;
+    double p50_jitter_ms = 0.0;
+    double p95_jitter_ms = 0.0;
+    double p99_jitter_ms = 0.0;
+    double max_loss_pct = 0.0;
+  };
+
+  using IngestResult = WindowIngestResult;
+
+  // Returns false if the sample is too old to fit in the window.
+  bool ingest(int64_t ts, const Metrics& m) { return insert(ts, m) != IngestResult::TooOld; }
+
+  // ingest() that also reports whether an existing second was replaced.
+  IngestResult insert(int64_t ts, const Metrics& m) { return w_.insert(ts, to_values(m)); }
+
+  // Averages same-second samples instead of replacing (see Storage::merge).
+  IngestResult merge(int64_t ts, const Metrics& m) { return w_.merge(ts, to_values(m)); }
+
+  // Advance time without adding a sample (expires old slots).
+  void note_time(int64_t ts_now) { w_.note_time(ts_now); }
+
+  // Track RTT/jitter quantiles and max loss from now on, starting from the
+  // seconds already in the window. Ingest and eviction then cost O(log W)
+  // plus a bounded shift per metric.
+  void enable_quantiles() {
+    if (quantiles_enabled()) return;
+    w_.observer().enable();
+    w_.for_each_second([this](const Storage::Second& s) { w_.observer().on_add(s.v); });
+  }
+  bool quantiles_enabled() const { return w_.observer().state() != nullptr; }
+
+  Summary summary() const;
+
+  // Reference O(kWindow) rescan of all slots; kept for parity tests and benches.
+  Summary summary_scan() const;
+
+  int64_t newest_ts() const { return w_.newest_ts(); }
+  std::optional<int64_t> oldest_sample_ts() const { return w_.oldest_sample_ts(); }
+
+  // Checkpoint access (see checkpoint.hpp and Storage::restore()).
+  const Storage& storage() const { return w_; }
+  bool restore(int64_t newest_ts, const DefaultMetrics::Values& sums, std::span<const Storage::Second> seconds) {
+    return w_.restore(newest_ts, sums, seconds);
+  }
+
+  // Debug helpers.
+  bool has_sample(int64_t ts) const { return w_.has_sample(ts); }
+  uint32_t samples_at(int64_t ts) const { return w_.samples_at(ts); }
+  std::optional<Metrics> get(int64_t ts) const;
+
+  static DefaultMetrics::Values to_values(const Metrics& m) {
+    DefaultMetrics::Values v{};
+    v[DefaultMetrics::index_of<ThroughputMetric>()] = m.throughput_mbps;
+    v[DefaultMetrics::index_of<RttMetric>()] = m.rtt_ms;
+    v[DefaultMetrics::index_of<LossMetric>()] = m.loss_pct;
+    v[DefaultMetrics::index_of<JitterMetric>()] = m.jitter_ms;
+    return v;
+  }
+
+private:
+  Summary from_storage(const Storage::Summary& s) const;
+
+  Storage w_;
+};
+
+} // namespace telemetry
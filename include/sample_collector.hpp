@@ -0,0 +1,154 @@
+// sample_collector.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "telemetry_agent.hpp"
+
+namespace telemetry {
+
+// Datagram format for probe reports: a WireSampleHeader followed by count
+// WireSample records. As with snapshot frames, everything is host byte order
+// and a multiple of 8 bytes, so the collector reads records in place from
+// its receive buffers. Records address interfaces by the receiving agent's
+// InterfaceId: probes are configured with the same interface list the
+// collector registers, in the same order.
+struct WireSampleHeader {
+  static constexpr uint32_t kMagic = 0x534D4C54; // "TLMS"
+  static constexpr uint16_t kVersion = 1;
+
+  uint32_t magic = kMagic;
+  uint16_t version = kVersion;
+  uint16_t count = 0;
+};
+
+struct WireSample {
+  uint32_t id = 0;
+  uint32_t reserved = 0;
+  int64_t ts = 0;
+  double rtt_ms = 0.0;
+  double throughput_mbps = 0.0;
+  double loss_pct = 0.0;
+  double jitter_ms = 0.0;
+};
+
+static_assert(sizeof(WireSampleHeader) == 8 && std::is_trivially_copyable_v<WireSampleHeader>);
+static_assert(sizeof(WireSample) == 48 && std::is_trivially_copyable_v<WireSample>);
+
+// Samples per datagram that fit a 1500-byte Ethernet MTU over UDP/IPv4.
+inline constexpr std::size_t kSamplesPerMtu = (1500 - 28 - sizeof(WireSampleHeader)) / sizeof(WireSample);
+
+// Encodes samples as one datagram into out (resized to fit). Throws
+// std::length_error past 65535 samples.
+void encode_samples(std::span<const Sample> samples, std::vector<uint64_t>& out);
+
+// The records of one datagram, in place; nullopt if it is foreign, truncated
+// or inconsistent. data must be 8-byte aligned.
+std::optional<std::span<const WireSample>> parse_samples(std::span<const std::byte> datagram);
+
+struct CollectorConfig {
+  uint32_t batch = 64;           // datagrams per recvmmsg() call
+  uint32_t max_datagram = 4096;  // receive buffer per datagram; longer ones are dropped
+  uint32_t calls_per_wakeup = 8; // recvmmsg() calls per socket before other sockets get a turn
+  int rcvbuf_bytes = 4 << 20;    // SO_RCVBUF for bound sockets (0 leaves the default)
+
+  // Period of the timerfd that drives note_time(); 0 disables it (the
+  // caller calls note_time() itself).
+  int tick_ms = 1000;
+  // Tick timestamp; empty means CLOCK_REALTIME seconds.
+  std::function<int64_t()> clock;
+};
+
+struct CollectorStats {
+  uint64_t recv_calls = 0;
+  uint64_t datagrams = 0;
+  uint64_t samples = 0;
+  uint64_t bad_datagrams = 0;     // foreign, truncated or inconsistent
+  uint64_t oversize_datagrams = 0; // longer than max_datagram
+  uint64_t unknown_interface = 0;  // records naming an unregistered InterfaceId
+  uint64_t ticks = 0;
+  uint64_t missed_ticks = 0;       // timer expirations folded into a later tick
+};
+
+// Receives probe reports on datagram sockets and feeds them to a
+// TelemetryAgent, Linux only (elsewhere the constructor throws
+// std::runtime_error).
+//
+// One epoll loop waits on every socket, a timerfd and a stop eventfd. A
+// readable socket is drained with recvmmsg() into preallocated buffers,
+// batch datagrams per call; each call's records are decoded in place and go
+// to the agent as one ingest_batch(), so an interface reported several
+// times in one batch is evaluated once, on its final window. When the timer
+// fires the collector calls note_time(clock()) and then the tick handler,
+// which is where callers drain transitions or publish snapshots.
+//
+// The agent belongs to the collector's thread while poll() or run() is
+// active (only published() may be read elsewhere). stop() may be called
+// from any thread or a signal handler. Socket and epoll errors throw
+// std::runtime_error; malformed datagrams are only counted.
+class SampleCollector {
+public:
+  using TickHandler = std::function<void(int64_t tick_ts)>;
+
+  explicit SampleCollector(TelemetryAgent& agent, CollectorConfig cfg = {});
+  ~SampleCollector(); // closes every socket; unlinks Unix sockets it bound
+
+  SampleCollector(const SampleCollector&) = delete;
+  SampleCollector& operator=(const SampleCollector&) = delete;
+
+  // IPv4 UDP socket on addr:port ("0.0.0.0" for all interfaces); port 0
+  // picks a free one. Returns the bound port.
+  uint16_t bind_udp(const std::string& addr, uint16_t port);
+
+  // Unix datagram socket at path (which must not exist yet).
+  void bind_unix(const std::string& path);
+
+  // Any datagram socket (socketpair, inherited fd, ...); takes ownership and
+  // makes it non-blocking.
+  void add_socket(int fd);
+
+  void on_tick(TickHandler fn) { on_tick_ = std::move(fn); }
+
+  // One wait of up to timeout_ms (-1 blocks) and the work it found. Returns
+  // the samples ingested.
+  std::size_t poll(int timeout_ms);
+
+  // poll() until stop().
+  void run();
+
+  // Makes run() return (and the current poll() wake); async-signal-safe.
+  void stop();
+
+  const CollectorStats& stats() const { return stats_; }
+
+private:
+  struct Rx;
+
+  void drain_(int fd);
+  void tick_();
+
+  TelemetryAgent& agent_;
+  CollectorConfig cfg_;
+  CollectorStats stats_;
+  TickHandler on_tick_;
+
+  int epoll_fd_ = -1;
+  int timer_fd_ = -1;
+  int stop_fd_ = -1;
+  std::vector<int> sockets_;
+  std::vector<std::string> unix_paths_;
+  bool stopping_ = false;
+
+  std::unique_ptr<Rx> rx_;       // recvmmsg headers and buffers
+  std::vector<Sample> samples_;  // one call's decoded records
+};
+
+} // namespace telemetry
@@ -0,0 +1,54 @@
+// scenarios.hpp
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "rolling_window.hpp"
+
+namespace telemetry {
+
+enum class ScenarioId { A, B, C, D };
+
+const char* scenario_name(ScenarioId id);
+
+// Deterministic imperfections layered on top of a scenario.
+struct ImperfectDataConfig {
+  bool enable_missing = false;
+  bool enable_late = false;
+  int drop_every_n = 20;  // ~5% missing
+  int late_every_n = 50;  // ~2% late
+  int late_by_sec = 3;
+};
+
+// Deterministic 1 Hz sample source for eth0/wifi0/lte0/sat0.
+class ScenarioGenerator {
+public:
+  struct Generated {
+    int64_t ts = 0;
+    Metrics m{};
+  };
+
+  explicit ScenarioGenerator(ScenarioId id, ImperfectDataConfig imp = {});
+
+  // Sample for `iface` at tick `t`; nullopt when dropped or unknown iface.
+  std::optional<Generated> sample(const std::string& iface, int64_t t) const;
+
+private:
+  static double lerp(double a, double b, double u);
+
+  Metrics eth0_(int64_t t) const;
+  Metrics wifi0_(int64_t t) const;
+  Metrics lte0_(int64_t t) const;
+  Metrics sat0_(int64_t t) const;
+
+  Metrics scenarioA_wifi_(int64_t t) const;
+  Metrics scenarioB_wifi_(int64_t t) const;
+  Metrics scenarioC_lte_(int64_t t) const;
+
+  ScenarioId id_;
+  ImperfectDataConfig imp_;
+};
+
+} // namespace telemetry
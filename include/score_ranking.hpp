@@ -0,0 +1,56 @@
+// score_ranking.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <span>
+#include <vector>
+
+#include "interface_tracker.hpp"
+
+namespace telemetry {
+
+// Interfaces kept in rank order, best first: status (Healthy, Degraded,
+// Down), then score descending, then id. Each id's position is remembered,
+// so an update re-keys one node in O(log n) and reuses it (no allocation
+// once an id is added); reading the best k is a walk of k nodes.
+//
+// NaN scores rank below every number.
+class ScoreRanking {
+public:
+  // Adds ids up to n - 1, each as (Degraded, 0.0) until updated.
+  void resize(std::size_t n);
+  void reserve(std::size_t n) { where_.reserve(n); }
+  std::size_t size() const { return where_.size(); }
+
+  // No-op if the key is unchanged.
+  void update(InterfaceId id, IfStatus status, double score);
+
+  // Up to k best ids whose status is at least min_status (Healthy is the
+  // best), written to out (k is capped at out.size()); returns the count.
+  std::size_t best(std::size_t k, IfStatus min_status, std::span<InterfaceId> out) const;
+
+  IfStatus status(InterfaceId id) const { return static_cast<IfStatus>(where_[id]->status); }
+  double score(InterfaceId id) const { return where_[id]->score; }
+
+private:
+  struct Key {
+    uint8_t status = 0; // IfStatus; lower is better
+    double score = 0.0;
+    InterfaceId id = 0;
+  };
+  struct Better {
+    bool operator()(const Key& a, const Key& b) const {
+      if (a.status != b.status) return a.status < b.status;
+      if (a.score != b.score) return a.score > b.score;
+      return a.id < b.id;
+    }
+  };
+  using Set = std::set<Key, Better>;
+
+  Set set_;
+  std::vector<Set::iterator> where_; // indexed by InterfaceId
+};
+
+} // namespace telemetry
@@ -0,0 +1,122 @@
+// sharded_agent.hpp
+#pragma once
+
+#include <concepts>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "mpsc_queue.hpp"
+#include "telemetry_agent.hpp"
+#include "transition_ring.hpp"
+
+namespace telemetry {
+
+// Multi-threaded collect -> score -> publish pipeline.
+//
+// Interfaces are partitioned round-robin across shards; each shard's worker
+// thread exclusively owns a TelemetryAgent (no locks on the scoring path).
+// Producer threads push samples into the shard's lock-free MPSC queue.
+// note_time() enqueues a tick behind those samples on every shard, the
+// workers run it in parallel, and the caller waits on a barrier before the
+// per-shard snapshots and transitions are merged.
+//
+// Samples a producer pushed before note_time() was called are applied before
+// that tick. Per-interface order is preserved for samples from one producer.
+class ShardedTelemetryAgent {
+public:
+  ShardedTelemetryAgent(AgentConfig cfg, std::size_t shards, std::size_t queue_capacity = 1 << 14,
+                        TransitionLogConfig log = {});
+  ~ShardedTelemetryAgent();
+
+  ShardedTelemetryAgent(const ShardedTelemetryAgent&) = delete;
+  ShardedTelemetryAgent& operator=(const ShardedTelemetryAgent&) = delete;
+
+  // Any thread (serialised internally; cold path).
+  InterfaceId register_interface(std::string_view iface);
+  std::optional<InterfaceId> find_interface(std::string_view iface) const;
+
+  // Producer threads. try_ingest() returns false if the shard queue is full;
+  // ingest() yields until there is room.
+  bool try_ingest(InterfaceId id, int64_t ts, const Metrics& m);
+  void ingest(InterfaceId id, int64_t ts, const Metrics& m);
+
+  // Control thread: tick every shard in parallel and wait for all of them.
+  void note_time(int64_t ts_now);
+
+  // Control thread; state as of the last note_time(), in InterfaceId order.
+  const std::vector<InterfaceSnapshot>& snapshots() const { return merged_; }
+  template <typename Fn>
+    requires std::invocable<Fn&, const TransitionEvent&>
+  std::size_t drain_transitions(Fn&& fn) { return merged_transitions_.drain(std::forward<Fn>(fn)); }
+  std::size_t drain_transitions(std::span<TransitionEvent> out) { return merged_transitions_.drain(out); }
+  std::vector<TransitionEvent> drain_transitions();
+  // Merged-ring counters; per-shard rings use the same capacity and policy.
+  const TransitionStats& transition_stats() const { return merged_transitions_.stats(); }
+
+  std::size_t shard_count() const { return shards_.size(); }
+  std::size_t size() const;
+
+private:
+  enum class CmdKind : uint8_t { Sample, Tick, Stop };
+
+  struct Command {
+    CmdKind kind = CmdKind::Sample;
+    InterfaceId local = 0;
+    int64_t ts = 0;
+    Metrics m{};
+  };
+
+  struct Shard {
+    Shard(AgentConfig cfg, std::size_t queue_capacity, TransitionLogConfig log, uint32_t index)
+      : index(index), agent(cfg, log), queue(queue_capacity), transitions(log) {}
+
+    uint32_t index;                  // global id = local id * shard_count + index
+    TelemetryAgent agent;            // worker thread only
+    BoundedMpscQueue<Command> queue;
+
+    // Idle wake-up: the worker sleeps on wake_gen only after announcing it.
+    std::atomic<bool> sleeping{false};
+    std::atomic<uint32_t> wake_gen{0};
+
+    // Registrations not yet applied by the worker.
+    std::mutex reg_mu;
+    std::vector<std::string> pending_names;
+
+    // Tick output, written by the worker before it arrives at the barrier.
+    std::vector<InterfaceSnapshot> snapshots;
+    TransitionRing transitions;      // ids already global
+
+    std::thread worker;
+  };
+
+  Shard& shard_of(InterfaceId id) { return *shards_[id % shards_.size()]; }
+  InterfaceId local_of(InterfaceId id) const {
+    return static_cast<InterfaceId>(id / shards_.size());
+  }
+
+  void push_blocking_(Shard& sh, const Command& cmd);
+  void wake_(Shard& sh);
+  void run_shard_(Shard& sh);
+  void sync_registrations_(Shard& sh);
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+
+  mutable std::mutex reg_mu_;
+  InterfaceIndex index_;
+  std::vector<std::string> names_;
+
+  std::atomic<std::size_t> tick_pending_{0}; // shards still working on the tick
+  std::vector<InterfaceSnapshot> merged_;
+  TransitionRing merged_transitions_;
+};
+
+} // namespace telemetry
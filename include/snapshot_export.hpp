@@ -0,0 +1,200 @@
+// snapshot_export.hpp
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "telemetry_agent.hpp"
+
+namespace telemetry {
+
+// Fixed-layout binary frames for same-host consumers (routing daemons and
+// the like) that want per-tick state without parsing text.
+//
+// A frame is a WireFrameHeader followed by payload_bytes of payload:
+//   Tick:  WireSnapshot[snapshot_count] (one per InterfaceId, in id order),
+//          then WireTransition[event_count]
+//   Names: name_count x {uint32 id, uint32 len, len bytes, zero pad to 8}
+// Everything is host byte order (magic reads back reversed on a foreign
+// host) and a multiple of 8 bytes, so a consumer with an 8-byte aligned
+// buffer uses the records in place.
+enum class FrameKind : uint16_t { Tick = 1, Names = 2 };
+
+struct WireFrameHeader {
+  static constexpr uint32_t kMagic = 0x464D4C54; // "TLMF"
+  static constexpr uint16_t kVersion = 1;
+
+  uint32_t magic = kMagic;
+  uint16_t version = kVersion;
+  FrameKind kind = FrameKind::Tick;
+  uint16_t header_size = 48;
+  uint16_t snapshot_size = 80;
+  uint16_t event_size = 16;
+  uint16_t reserved0 = 0;
+  uint64_t seq = 0; // frames sent before this one on the same sink
+  int64_t tick_ts = 0;
+  uint32_t snapshot_count = 0;
+  uint32_t event_count = 0;
+  uint32_t payload_bytes = 0;
+  uint32_t name_count = 0;
+};
+
+struct WireSnapshot {
+  uint32_t id = 0;
+  uint8_t status = 0; // IfStatus
+  uint8_t reserved[3] = {};
+  double score_raw = 0.0;
+  double score_smoothed = 0.0;
+  double score_used = 0.0;
+  double confidence = 0.0;
+  double missing_rate = 1.0;
+  double avg_tp_mbps = 0.0;
+  double avg_rtt_ms = 0.0;
+  double avg_loss_pct = 0.0;
+  double avg_jitter_ms = 0.0;
+};
+
+struct WireTransition {
+  uint32_t id = 0;
+  uint8_t from = 0;   // IfStatus
+  uint8_t to = 0;     // IfStatus
+  uint8_t reason = 0; // TransitionReason
+  uint8_t reserved = 0;
+  int64_t ts = 0;
+};
+
+static_assert(sizeof(WireFrameHeader) == 48 && std::is_trivially_copyable_v<WireFrameHeader>);
+static_assert(sizeof(WireSnapshot) == 80 && std::is_trivially_copyable_v<WireSnapshot>);
+static_assert(sizeof(WireTransition) == 16 && std::is_trivially_copyable_v<WireTransition>);
+
+WireSnapshot to_wire(InterfaceId id, const InterfaceSnapshot& s);
+WireTransition to_wire(const TransitionEvent& ev);
+
+// Records of one frame, pointing into the buffer it was parsed from.
+struct FrameView {
+  WireFrameHeader header;
+  std::span<const WireSnapshot> snapshots;
+  std::span<const WireTransition> events;
+  std::span<const std::byte> name_table; // Names frames
+};
+
+// Validates a whole frame (header + payload). Throws std::runtime_error on a
+// foreign, truncated or inconsistent frame.
+FrameView parse_frame(std::span<const uint64_t> words);
+
+// Merges a Names frame's entries into names (indexed by InterfaceId).
+void decode_names(const FrameView& f, std::vector<std::string>& names);
+
+// Streams frames over a connected socket (AF_UNIX stream or a socketpair).
+// Each frame is one gather write straight from the staging arrays; a Names
+// frame goes first whenever the agent has interfaces the peer has not been
+// told about. Blocks while the peer is behind; I/O errors (including a
+// closed peer) throw std::runtime_error, and a frame larger than read_frame()
+// accepts (256 MiB of payload) throws std::length_error before any write.
+class SocketSnapshotSink {
+public:
+  explicit SocketSnapshotSink(int fd); // takes ownership of fd
+  static SocketSnapshotSink connect(const std::string& path);
+  ~SocketSnapshotSink();
+
+  SocketSnapshotSink(SocketSnapshotSink&& other) noexcept;
+  SocketSnapshotSink& operator=(SocketSnapshotSink&&) = delete;
+  SocketSnapshotSink(const SocketSnapshotSink&) = delete;
+  SocketSnapshotSink& operator=(const SocketSnapshotSink&) = delete;
+
+  void publish(const TelemetryAgent& agent, int64_t tick_ts, std::span<const TransitionEvent> events);
+  uint64_t frames() const { return seq_; }
+
+private:
+  void send_(const WireFrameHeader& h, std::span<const std::span<const std::byte>> parts);
+
+  int fd_ = -1;
+  uint64_t seq_ = 0;
+  std::size_t names_sent_ = 0;
+  std::vector<WireSnapshot> snaps_;
+  std::vector<WireTransition> events_;
+  std::vector<uint64_t> names_;
+};
+
+// Reads one frame from a stream socket into words (resized to fit). Returns
+// false on a clean end of stream; throws std::runtime_error otherwise.
+bool read_frame(int fd, std::vector<uint64_t>& words);
+
+struct ShmRingConfig {
+  uint32_t slot_count = 8;          // frames kept; readers lapped by more lose them
+  uint32_t max_interfaces = 1024;   // per-slot capacity
+  uint32_t max_events = 256;        // transitions per frame
+  uint32_t name_bytes = 64 * 1024;  // interface name table
+};
+
+enum class ShmRead : uint8_t { Ok, NotReady, Overrun };
+
+// Single-writer ring of Tick frames in POSIX shared memory (shm_open name).
+// Any number of reader processes map it read-only. Each slot is a seqlock:
+// the writer encodes snapshots straight from the trackers into the slot,
+// then bumps its sequence; a reader copies a slot out and keeps it only if
+// the sequence held. The name table lives beside the ring under its own
+// sequence, rewritten when interfaces are added, so late joiners find it.
+//
+// Ring words are relaxed atomics, as in SnapshotTable, so a torn read is
+// detected rather than undefined. Throws std::runtime_error on shm errors
+// and std::length_error when a frame or the name table outgrows its space.
+class ShmSnapshotRing {
+public:
+  ShmSnapshotRing(const std::string& name, ShmRingConfig cfg = {}); // creates or replaces
+  ~ShmSnapshotRing(); // unmaps and unlinks; mapped readers keep working
+
+  ShmSnapshotRing(const ShmSnapshotRing&) = delete;
+  ShmSnapshotRing& operator=(const ShmSnapshotRing&) = delete;
+
+  void publish(const TelemetryAgent& agent, int64_t tick_ts, std::span<const TransitionEvent> events);
+  uint64_t frames() const { return seq_; }
+
+private:
+  friend class ShmSnapshotReader;
+  struct Layout;
+
+  std::string name_;
+  ShmRingConfig cfg_;
+  std::atomic<uint64_t>* base_ = nullptr;
+  std::size_t bytes_ = 0;
+  uint64_t seq_ = 0;
+  std::size_t names_written_ = 0;
+  std::vector<uint64_t> names_;
+};
+
+class ShmSnapshotReader {
+public:
+  explicit ShmSnapshotReader(const std::string& name);
+  ~ShmSnapshotReader();
+
+  ShmSnapshotReader(const ShmSnapshotReader&) = delete;
+  ShmSnapshotReader& operator=(const ShmSnapshotReader&) = delete;
+
+  // Frames published so far; frame k is readable until frame k + slot_count.
+  uint64_t published() const;
+
+  // Copies frame k into words. Overrun means the writer has lapped it (or
+  // was rewriting it during the copy); skip ahead to published() - 1.
+  ShmRead read(uint64_t k, std::vector<uint64_t>& words) const;
+
+  // Latest complete frame; false if none has been published yet.
+  bool read_latest(std::vector<uint64_t>& words) const;
+
+  // Interface names by InterfaceId; false if the table is mid-rewrite.
+  bool names(std::vector<std::string>& out) const;
+
+private:
+  const std::atomic<uint64_t>* base_ = nullptr;
+  std::size_t bytes_ = 0;
+  uint32_t slot_count_ = 0;
+  uint32_t slot_words_ = 0;
+  uint32_t name_words_ = 0;
+};
+
+} // namespace telemetry
@@ -0,0 +1,131 @@
+// snapshot_table.hpp
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "interface_tracker.hpp"
+
+namespace telemetry {
+
+// String-free copy of InterfaceSnapshot for cross-thread readers; the name
+// is implied by the InterfaceId it is read under.
+struct PublishedSnapshot {
+  IfStatus status = IfStatus::Degraded;
+
+  double score_raw = 0.0;
+  double score_smoothed = 0.0;
+  double score_used = 0.0;
+
+  double confidence = 0.0;
+  double missing_rate = 1.0;
+
+  double avg_tp_mbps = 0.0;
+  double avg_rtt_ms = 0.0;
+  double avg_loss_pct = 0.0;
+  double avg_jitter_ms = 0.0;
+};
+
+// Per-tick snapshot table: one writer publishes, any number of threads read
+// without locks, blocking or allocation.
+//
+// Two buffers, each guarded by a sequence counter (seqlock). The writer fills
+// the back buffer and then flips front_, so a reader only retries if the
+// writer laps it, i.e. publishes twice during one read. Storage is chunked and
+// never moves, so the table can grow while readers are copying from it.
+class SnapshotTable {
+public:
+  static constexpr std::size_t kChunk = 1024;
+  static constexpr std::size_t kMaxChunks = 1024; // 1M interfaces
+
+  SnapshotTable() = default;
+  SnapshotTable(const SnapshotTable&) = delete;
+  SnapshotTable& operator=(const SnapshotTable&) = delete;
+
+  // Writer thread only. snapshot_of(i) returns the InterfaceSnapshot for id i.
+  template <typename SnapshotOf>
+  void publish(int64_t tick_ts, std::size_t n, const SnapshotOf& snapshot_of) {
+    Buffer& b = begin_write_(n);
+    for (std::size_t i = 0; i < n; ++i) store_(*entry_(b, i), snapshot_of(static_cast<InterfaceId>(i)));
+    end_write_(b, tick_ts, n);
+    prev_changed_valid_ = false;
+  }
+
+  // publish() for a writer that knows which ids changed since the previous
+  // publish (ids new since then need not be listed). The back buffer is two
+  // publishes old, so it is patched with this and the previous change list:
+  // cost scales with changes, not with n.
+  template <typename SnapshotOf>
+  void publish_changed(int64_t tick_ts, std::size_t n, std::span<const InterfaceId> changed,
+                       const SnapshotOf& snapshot_of) {
+    Buffer& b = begin_write_(n);
+    const std::size_t have = prev_changed_valid_ ? std::min<std::size_t>(b.count.load(std::memory_order_relaxed), n) : 0;
+    auto patch = [&](std::span<const InterfaceId> ids) {
+      for (const InterfaceId id : ids) {
+        if (id < have) store_(*entry_(b, id), snapshot_of(id));
+      }
+    };
+    patch(prev_changed_);
+    patch(changed);
+    for (std::size_t i = have; i < n; ++i) store_(*entry_(b, i), snapshot_of(static_cast<InterfaceId>(i)));
+    end_write_(b, tick_ts, n);
+    prev_changed_.assign(changed.begin(), changed.end());
+    prev_changed_valid_ = true;
+  }
+
+  // Writer thread only. Allocates storage for n interfaces up front, so
+  // publishes up to that size never allocate.
+  void reserve(std::size_t n);
+
+  // Any thread. Number of publishes so far; pollers can skip unchanged ticks.
+  uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
+  // Any thread. Interfaces in the latest published tick.
+  std::size_t size() const;
+
+  // Any thread. Returns false if id was not in the latest published tick.
+  bool read(InterfaceId id, PublishedSnapshot& out, int64_t* tick_ts = nullptr) const;
+
+  // Any thread. Copies up to out.size() entries, all from the same tick, and
+  // returns the number copied.
+  std::size_t read_all(std::span<PublishedSnapshot> out, int64_t* tick_ts = nullptr) const;
+
+private:
+  static constexpr std::size_t kWords = 10; // status + 9 doubles
+
+  // Fields are relaxed atomics so a torn read is detected, not undefined.
+  using Entry = std::array<std::atomic<uint64_t>, kWords>;
+
+  struct Buffer {
+    std::atomic<uint64_t> seq{0}; // odd while the writer is inside
+    std::atomic<uint64_t> count{0};
+    std::atomic<int64_t> tick_ts{0};
+    std::array<std::atomic<Entry*>, kMaxChunks> chunks{};
+  };
+
+  // nullptr only if a reader raced a growing write; its seq check will fail.
+  static Entry* entry_(const Buffer& b, std::size_t i) {
+    Entry* chunk = b.chunks[i / kChunk].load(std::memory_order_acquire);
+    return chunk ? chunk + i % kChunk : nullptr;
+  }
+  static void store_(Entry& e, const InterfaceSnapshot& s);
+  static void load_(const Entry& e, PublishedSnapshot& out);
+
+  void allocate_chunks_(Buffer& b, std::size_t n);
+  Buffer& begin_write_(std::size_t n);
+  void end_write_(Buffer& b, int64_t tick_ts, std::size_t n);
+
+  Buffer buf_[2];
+  std::atomic<uint32_t> front_{0};
+  std::atomic<uint64_t> version_{0};
+  std::vector<std::unique_ptr<Entry[]>> owned_; // writer side
+  std::vector<InterfaceId> prev_changed_;        // writer side: last publish_changed() list
+  bool prev_changed_valid_ = false;              // false after publish(): next one rewrites all
+};
+
+} // namespace telemetry
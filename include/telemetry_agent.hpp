@@ -0,0 +1,217 @@
+// telemetry_agent.hpp
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "config_profile.hpp"
+#include "instrumentation.hpp"
+#include "interface_tracker.hpp"
+#include "score_ranking.hpp"
+#include "snapshot_table.hpp"
+#include "timer_wheel.hpp"
+#include "trace_file.hpp"
+#include "transition_ring.hpp"
+
+namespace telemetry {
+
+// Transparent hash so name lookups accept std::string_view without a copy.
+struct InterfaceNameHash {
+  using is_transparent = void;
+  std::size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+};
+
+using InterfaceIndex = std::unordered_map<std::string, InterfaceId, InterfaceNameHash, std::equal_to<>>;
+
+// One sample addressed by handle, as fed to ingest_batch().
+struct Sample {
+  InterfaceId id = 0;
+  int64_t ts = 0;
+  Metrics m{};
+};
+
+// Multi-interface manager: routes samples to per-interface trackers.
+//
+// Trackers are stored densely and addressed by InterfaceId. The name-based
+// API is a thin wrapper doing one lookup; collectors that know their
+// interface index should register once and ingest by handle.
+//
+// The agent is single-threaded except for published(): every note_time()
+// publishes the tick's snapshots there for lock-free readers on other threads.
+//
+// With TickScan::Active, a tracker whose next tick would be a no-op sleeps
+// in a timer wheel until a sample arrives or its wake time (next expiry or
+// dwell end) passes, so tick cost follows activity rather than size().
+//
+// Registration allocates. After reserve(max_interfaces) and registering up
+// to that many interfaces, ingest, note_time(), record_tick() and the span,
+// callback and std::pmr forms of the queries do not (with the recorder off),
+// so a real-time tick loop can run without malloc; see TickArena.
+//
+// Scoring and FSM settings come from per-interface profiles: every
+// interface starts on kDefaultProfile (cfg's score and fsm) and can be moved
+// to a named one, e.g. satellite_profile(), sharing it by pointer.
+class TelemetryAgent {
+public:
+  struct RunSummaryItem {
+    std::string iface;
+    double avg_score = 0.0;
+    IfStatus last_status = IfStatus::Degraded;
+  };
+
+  // RunSummaryItem by handle, for the allocation-free summary.
+  struct RankedInterface {
+    InterfaceId id = 0;
+    double avg_score = 0.0;
+    IfStatus last_status = IfStatus::Degraded;
+  };
+
+  explicit TelemetryAgent(AgentConfig cfg = {}, TransitionLogConfig log = {});
+
+  // Preallocates per-interface storage (trackers in one contiguous block,
+  // index, timer wheel, snapshot table, tick scratch) for max_interfaces.
+  void reserve(std::size_t max_interfaces);
+
+  // Returns a stable handle; registering an existing name returns its handle.
+  InterfaceId register_interface(std::string_view iface);
+  std::optional<InterfaceId> find_interface(std::string_view iface) const;
+
+  void ensure_interface(const std::string& iface) { (void)register_interface(iface); }
+
+  // Hot path: no hashing, no allocation (apart from transition events).
+  void ingest(InterfaceId id, int64_t ts, const Metrics& m);
+  void ingest(const std::string& iface, int64_t ts, const Metrics& m);
+
+  // Bulk ingest: every sample goes into its window (too-old and out-of-order
+  // samples handled as by ingest()), then each touched interface is
+  // evaluated once. Equivalent to ingest() per sample when no interface
+  // appears twice; otherwise EWMA/FSM see only the batch's final window.
+  void ingest_batch(std::span<const Sample> batch);
+
+  // Expire time even if samples are missing.
+  void note_time(int64_t ts_now);
+
+  // Trackers the next note_time() will evaluate (all of them with TickScan::All).
+  std::size_t active_count() const;
+
+  std::size_t size() const { return trackers_.size(); }
+  const InterfaceSnapshot& snapshot(InterfaceId id) const { return trackers_[id].snapshot(); }
+  std::vector<InterfaceSnapshot> snapshots() const;
+  // Name-free snapshots indexed by InterfaceId, allocated from mr.
+  std::pmr::vector<PublishedSnapshot> snapshots(std::pmr::memory_resource* mr) const;
+
+  // Safe to read from any thread; updated at the end of every note_time().
+  const SnapshotTable& published() const { return published_; }
+
+  // Transitions since the last drain, oldest first; events name interfaces by
+  // handle. The callback and span forms do not allocate.
+  template <typename Fn>
+    requires std::invocable<Fn&, const TransitionEvent&>
+  std::size_t drain_transitions(Fn&& fn) { return transitions_.drain(std::forward<Fn>(fn)); }
+  std::size_t drain_transitions(std::span<TransitionEvent> out) { return transitions_.drain(out); }
+  std::vector<TransitionEvent> drain_transitions();
+  std::pmr::vector<TransitionEvent> drain_transitions(std::pmr::memory_resource* mr);
+
+  // Recorded / overwritten / dropped counts for the transition ring.
+  const TransitionStats& transition_stats() const { return transitions_.stats(); }
+
+  // Sample/recompute/transition counters and ingest/tick latency histograms;
+  // all zero when built with TELEMETRY_INSTRUMENTATION=0.
+  const AgentStats& stats() const;
+  const IngestCounters& interface_stats(InterfaceId id) const;
+  void reset_stats();
+
+  // Mirrors every registration, sample and tick into w (nullptr stops), so
+  // telemetry_replay can reproduce the run. Interfaces registered so far are
+  // named immediately, and w records the settings replay needs (see
+  // TraceHeader's flags). The agent does not own w.
+  void record_to(TraceWriter* w);
+
+  // score and fsm are the default profile's, as last set.
+  const AgentConfig& config() const { return cfg_; }
+
+  // Profiles (see ProfileTable). add_profile() interns by name. set_profile()
+  // swaps a profile's settings in place: its interfaces keep their windows,
+  // scores and FSM counters and use the new settings from their next
+  // evaluation, which (with TickScan::Active) the next note_time() runs.
+  // assign_profile() moves one interface the same way.
+  ProfileId add_profile(std::string_view name, const ConfigProfile& p) { return profiles_.add(name, p); }
+  std::optional<ProfileId> find_profile(std::string_view name) const { return profiles_.find(name); }
+  void set_profile(ProfileId id, const ConfigProfile& p);
+  void assign_profile(InterfaceId id, ProfileId profile);
+  ProfileId profile_of(InterfaceId id) const { return profiles_.of(id); }
+  const ProfileTable& profiles() const { return profiles_; }
+
+  // Checkpoint access (see checkpoint.hpp). restore_tracker() replaces one
+  // tracker's state as InterfaceTracker::restore() does (false if the window
+  // state is inconsistent) and schedules it for the next note_time(), which
+  // publishes it; tick_ts is the tick the state was saved at.
+  const InterfaceTracker& tracker(InterfaceId id) const { return trackers_[id]; }
+  bool restore_tracker(InterfaceId id, int64_t tick_ts, const TrackerState& st, int64_t window_newest_ts,
+                       const DefaultMetrics::Values& window_sums,
+                       std::span<const RollingWindow::Storage::Second> seconds);
+
+  // Up to k interfaces with the best current score_used among those whose
+  // status is at least min_status (Healthy first, then Degraded, then Down;
+  // ties by id), best first; returns the count. Only interfaces evaluated
+  // since the previous call are re-ranked, so a per-tick query costs
+  // O(k + changed * log n) rather than a sort of every snapshot. The span
+  // form does not allocate.
+  std::size_t best_interfaces(std::size_t k, IfStatus min_status, std::span<InterfaceId> out);
+  std::vector<InterfaceId> best_interfaces(std::size_t k, IfStatus min_status = IfStatus::Down);
+
+  // Accumulate per-interface score_used for end-of-run ranking.
+  void record_tick();
+
+  // Interfaces ranked by average score_used across recorded ticks.
+  std::vector<RunSummaryItem> summary_ranked() const;
+  std::pmr::vector<RankedInterface> summary_ranked(std::pmr::memory_resource* mr) const;
+
+private:
+  AgentConfig cfg_;
+  ProfileTable profiles_;
+  std::vector<InterfaceTracker> trackers_; // indexed by InterfaceId
+  InterfaceIndex index_;
+  std::vector<double> score_sum_;
+  std::vector<int> score_count_;
+  TransitionRing transitions_;
+  SnapshotTable published_;
+  std::vector<InterfaceId> batch_touched_; // ingest_batch() scratch
+  TraceWriter* recorder_ = nullptr;
+  int64_t last_tick_ts_ = std::numeric_limits<int64_t>::min();
+
+  // TickScan::Active: one bit per tracker note_time() must evaluate; the
+  // others wait in wheel_. tick_ids_ lists this tick's evaluations for
+  // SnapshotTable::publish_changed().
+  void evaluate_(InterfaceId id, int64_t ts_now);
+  void wake_(InterfaceId id);
+  void reschedule_(InterfaceId id);
+  std::vector<uint64_t> active_;
+  TimerWheel wheel_;
+  std::vector<InterfaceId> tick_ids_;
+
+  // best_interfaces(): one bit per tracker evaluated since the last query,
+  // listed in rank_queue_ so the query re-ranks only those.
+  void mark_ranked_(InterfaceId id);
+  ScoreRanking ranking_;
+  std::vector<uint64_t> rank_dirty_;
+  std::vector<InterfaceId> rank_queue_;
+
+#if TELEMETRY_INSTRUMENTATION
+  AgentStats stats_;
+  std::vector<IngestCounters> iface_stats_; // indexed by InterfaceId
+  uint64_t ingest_calls_ = 0;
+#endif
+};
+
+} // namespace telemetry
@@ -0,0 +1,48 @@
+// tick_arena.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+
+namespace telemetry {
+
+// Resettable monotonic memory resource for per-tick temporaries (the
+// std::pmr overloads of TelemetryAgent::snapshots(), drain_transitions() and
+// summary_ranked()). Allocation bumps a pointer through one block allocated
+// by the constructor; deallocation is a no-op and reset() frees everything
+// at once, so a tick loop that resets the arena never touches the heap.
+//
+// A request that does not fit goes to upstream. The default,
+// std::pmr::null_memory_resource(), throws std::bad_alloc instead of falling
+// back to malloc; size the arena from high_water().
+class TickArena : public std::pmr::memory_resource {
+public:
+  explicit TickArena(std::size_t bytes, std::pmr::memory_resource* upstream = std::pmr::null_memory_resource());
+
+  TickArena(const TickArena&) = delete;
+  TickArena& operator=(const TickArena&) = delete;
+
+  // Everything allocated from the block since the last reset() is dead.
+  void reset() { used_ = 0; }
+
+  std::size_t capacity() const { return capacity_; }
+  std::size_t used() const { return used_; }
+  std::size_t high_water() const { return high_water_; } // most bytes needed between resets
+  uint64_t overflows() const { return overflows_; }     // requests passed to upstream
+
+private:
+  void* do_allocate(std::size_t bytes, std::size_t align) override;
+  void do_deallocate(void* p, std::size_t bytes, std::size_t align) override;
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+  std::unique_ptr<std::byte[]> block_;
+  std::size_t capacity_ = 0;
+  std::size_t used_ = 0;
+  std::size_t high_water_ = 0;
+  uint64_t overflows_ = 0;
+  std::pmr::memory_resource* upstream_;
+};
+
+} // namespace telemetry
@@ -0,0 +1,92 @@
+// timer_wheel.hpp
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace telemetry {
+
+// Hierarchical timing wheel of one-shot timers, one per dense id (an
+// InterfaceId). Time is in whole seconds.
+//
+// Four levels of 64 slots with 1 s, 64 s, 4096 s and 262144 s resolution
+// cover about 194 days ahead of now(); later deadlines wait in an overflow
+// list. A timer lives in the level of the highest bit where its deadline
+// differs from now() and moves down a level each time the wheel reaches its
+// slot, so schedule/cancel are O(1) and advance() only visits occupied slots
+// (found through per-level occupancy masks), however far time jumps.
+//
+// Nodes are intrusive and indexed by id: after resize() nothing allocates.
+class TimerWheel {
+public:
+  using Id = uint32_t;
+
+  static constexpr int kLevelBits = 6;
+  static constexpr int kLevels = 4;
+  static constexpr std::size_t kSlotsPerLevel = std::size_t{1} << kLevelBits;
+
+  TimerWheel() { heads_.fill(kNil); }
+
+  // Ids [0, n) become usable; never shrinks.
+  void resize(std::size_t n);
+
+  // Arms (or re-arms) id to fire at the first advance(t) with t >= at;
+  // an `at` not after now() fires at the next advance().
+  void schedule(Id id, int64_t at);
+  void cancel(Id id);
+
+  bool scheduled(Id id) const { return nodes_[id].where != kNone; }
+  int64_t deadline(Id id) const { return from_key_(nodes_[id].at); }
+  std::size_t size() const { return size_; }
+
+  // Latest time passed to advance() (the earliest int64_t before that).
+  int64_t now() const { return from_key_(now_); }
+
+  // Moves the wheel to t and calls fn(id) once for every timer with
+  // deadline <= t (slot by slot, so roughly in deadline order). The timer is
+  // disarmed before fn runs, so fn may schedule or cancel any id.
+  template <typename Fn>
+    requires std::invocable<Fn&, Id>
+  std::size_t advance(int64_t t, Fn&& fn) {
+    std::size_t fired = 0;
+    for (Id id = pop_expired_(to_key_(t)); id != kNil; id = pop_expired_(to_key_(t))) {
+      fn(id);
+      ++fired;
+    }
+    return fired;
+  }
+
+private:
+  static constexpr Id kNil = 0xFFFFFFFFu;
+  static constexpr uint32_t kNone = 0xFFFFFFFFu;
+  static constexpr uint32_t kOverflow = kLevels * kSlotsPerLevel;
+  static constexpr uint32_t kDue = kOverflow + 1;
+
+  struct Node {
+    Id prev = kNil;
+    Id next = kNil;
+    uint32_t where = kNone; // slot index, kOverflow, kDue or kNone
+    uint64_t at = 0;        // deadline key
+  };
+
+  // Order-preserving map of int64_t onto uint64_t so slot arithmetic is
+  // plain unsigned shifting, negative timestamps included.
+  static uint64_t to_key_(int64_t t) { return static_cast<uint64_t>(t) ^ (uint64_t{1} << 63); }
+  static int64_t from_key_(uint64_t k) { return static_cast<int64_t>(k ^ (uint64_t{1} << 63)); }
+
+  void link_(Id id, uint32_t where);
+  void unlink_(Id id);
+  void place_(Id id);
+  Id pop_expired_(uint64_t t);
+
+  std::vector<Node> nodes_;
+  std::array<Id, kDue + 1> heads_;
+  std::array<uint64_t, kLevels> occupied_{}; // bit s of level L: slot L*64+s non-empty
+  uint64_t now_ = 0;
+  std::size_t size_ = 0;
+};
+
+} // namespace telemetry
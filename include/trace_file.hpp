@@ -0,0 +1,151 @@
+// trace_file.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "interface_tracker.hpp"
+
+namespace telemetry {
+
+// Binary trace of what an agent was fed: samples, ingest_batch() boundaries
+// and ticks in call order. A replay that makes the same calls (ingest() for
+// loose samples, one ingest_batch() per recorded batch, note_time() per
+// tick) reproduces every snapshot and transition; feeding batched samples
+// one by one does not when a batch holds an interface more than once.
+//
+// The header's flags keep the recording agent's EWMA, recompute and
+// same-second settings, which replay adopts. Weights, thresholds and the
+// EWMA alpha are not recorded; a replay assumes AgentConfig defaults.
+//
+// Layout (host byte order; `endian` tells a foreign file apart):
+//   TraceHeader                  64 bytes
+//   TraceRecord[record_count]    48 bytes each, starting at byte 64
+//   name table at names_offset   name_count x {uint32 id, uint32 len, len bytes}
+// Records are fixed-width and 8-byte aligned in the mapping, so a reader
+// maps the file and walks them in place.
+struct TraceHeader {
+  static constexpr char kMagic[8] = {'T', 'L', 'M', 'T', 'R', 'A', 'C', 'E'};
+  static constexpr uint32_t kVersion = 1;
+  static constexpr uint32_t kEndian = 0x01020304;
+
+  // flags
+  static constexpr uint32_t kNoEwma = 1u << 0;            // score.useEwma off
+  static constexpr uint32_t kPerTick = 1u << 1;           // RecomputeMode::PerTick
+  static constexpr uint32_t kSameSecondAverage = 1u << 2; // SameSecond::Average
+
+  char magic[8] = {};
+  uint32_t version = kVersion;
+  uint32_t record_size = 0;
+  uint32_t endian = kEndian;
+  uint32_t flags = 0;
+  uint64_t record_count = 0;
+  uint64_t names_offset = 0;
+  uint32_t name_count = 0;
+  uint32_t reserved0 = 0;
+  uint64_t reserved[2] = {};
+
+  static uint32_t config_flags(const AgentConfig& cfg);
+  // Sets the recorded settings on cfg, leaving the rest alone.
+  void apply_config(AgentConfig& cfg) const;
+};
+
+// One ingest() (iface = InterfaceId), one note_time() (iface = kTick) or
+// the start / end of one ingest_batch() (kBatchBegin / kBatchEnd, with the
+// samples in between). Markers carry no metrics; batch markers no ts.
+struct TraceRecord {
+  static constexpr uint32_t kTick = 0xFFFFFFFFu;
+  static constexpr uint32_t kBatchBegin = 0xFFFFFFFEu;
+  static constexpr uint32_t kBatchEnd = 0xFFFFFFFDu;
+
+  uint32_t iface = 0;
+  uint32_t flags = 0; // reserved, 0
+  int64_t ts = 0;
+  double rtt_ms = 0.0;
+  double throughput_mbps = 0.0;
+  double loss_pct = 0.0;
+  double jitter_ms = 0.0;
+
+  bool is_tick() const { return iface == kTick; }
+  bool is_sample() const { return iface < kBatchEnd; }
+  Metrics metrics() const { return Metrics{rtt_ms, throughput_mbps, loss_pct, jitter_ms}; }
+};
+
+static_assert(sizeof(TraceHeader) == 64 && std::is_trivially_copyable_v<TraceHeader>);
+static_assert(sizeof(TraceRecord) == 48 && std::is_trivially_copyable_v<TraceRecord>);
+
+// Streams records to a file through a fixed buffer. close() writes the name
+// table and patches the header; I/O failures throw std::runtime_error.
+class TraceWriter {
+public:
+  explicit TraceWriter(const std::string& path);
+  ~TraceWriter(); // closes, swallowing errors; call close() to see them
+
+  TraceWriter(const TraceWriter&) = delete;
+  TraceWriter& operator=(const TraceWriter&) = delete;
+
+  void name(InterfaceId id, std::string_view iface);
+  void config(const AgentConfig& cfg) { flags_ = TraceHeader::config_flags(cfg); }
+  void sample(InterfaceId id, int64_t ts, const Metrics& m) {
+    push_(TraceRecord{id, 0, ts, m.rtt_ms, m.throughput_mbps, m.loss_pct, m.jitter_ms});
+  }
+  void tick(int64_t ts) { push_(TraceRecord{TraceRecord::kTick, 0, ts, 0.0, 0.0, 0.0, 0.0}); }
+  void batch_begin() { push_(TraceRecord{TraceRecord::kBatchBegin, 0, 0, 0.0, 0.0, 0.0, 0.0}); }
+  void batch_end() { push_(TraceRecord{TraceRecord::kBatchEnd, 0, 0, 0.0, 0.0, 0.0, 0.0}); }
+
+  void close();
+  uint64_t records() const { return count_; }
+
+private:
+  static constexpr std::size_t kBufferRecords = 8192;
+
+  void push_(const TraceRecord& r) {
+    buf_.push_back(r);
+    ++count_;
+    if (buf_.size() == kBufferRecords) flush_();
+  }
+  void flush_();
+
+  std::string path_;
+  std::FILE* f_ = nullptr;
+  std::vector<TraceRecord> buf_;
+  std::vector<std::string> names_; // indexed by InterfaceId
+  uint64_t count_ = 0;
+  uint32_t flags_ = 0;
+};
+
+// Read-only view of a trace file: memory-mapped where the platform allows,
+// read into memory otherwise. Throws std::runtime_error on a missing,
+// truncated or foreign file, or on a sample for an interface the name table
+// does not list.
+class TraceReader {
+public:
+  explicit TraceReader(const std::string& path);
+  ~TraceReader();
+
+  TraceReader(const TraceReader&) = delete;
+  TraceReader& operator=(const TraceReader&) = delete;
+
+  const TraceHeader& header() const { return header_; }
+  std::span<const TraceRecord> records() const { return records_; }
+
+  // Interface names by InterfaceId ("" for ids the trace never named).
+  const std::vector<std::string>& names() const { return names_; }
+
+private:
+  const unsigned char* data_ = nullptr;
+  std::size_t size_ = 0;
+  bool mapped_ = false;
+  std::vector<unsigned char> owned_; // fallback when not mapped
+  TraceHeader header_{};
+  std::span<const TraceRecord> records_;
+  std::vector<std::string> names_;
+};
+
+} // namespace telemetry
@@ -0,0 +1,70 @@
+// transition_ring.hpp
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "interface_tracker.hpp"
+
+namespace telemetry {
+
+// What a full TransitionRing does with the next event.
+enum class OverflowPolicy : uint8_t {
+  OverwriteOldest, // keep the most recent history
+  DropNewest,      // keep the oldest undrained events
+};
+
+struct TransitionLogConfig {
+  std::size_t capacity = 4096;
+  OverflowPolicy overflow = OverflowPolicy::OverwriteOldest;
+};
+
+struct TransitionStats {
+  uint64_t recorded = 0;    // accepted into the ring
+  uint64_t overwritten = 0; // undrained events lost to OverwriteOldest
+  uint64_t dropped = 0;     // new events rejected by DropNewest
+};
+
+// Fixed-capacity FIFO of transition events. Storage is allocated once in the
+// constructor; push() and the drains never touch the heap.
+class TransitionRing {
+public:
+  explicit TransitionRing(TransitionLogConfig cfg = {});
+
+  void push(const TransitionEvent& ev);
+
+  std::size_t size() const { return size_; }
+  std::size_t capacity() const { return buf_.size(); }
+  bool empty() const { return size_ == 0; }
+  const TransitionStats& stats() const { return stats_; }
+
+  // Calls fn(const TransitionEvent&) oldest first, then empties the ring.
+  template <typename Fn>
+    requires std::invocable<Fn&, const TransitionEvent&>
+  std::size_t drain(Fn&& fn) {
+    const std::size_t n = size_;
+    for (std::size_t i = 0; i < n; ++i) fn(buf_[wrap_(head_ + i)]);
+    head_ = 0;
+    size_ = 0;
+    return n;
+  }
+
+  // Moves up to out.size() of the oldest events into out; returns the count.
+  std::size_t drain(std::span<TransitionEvent> out);
+
+  void clear() { head_ = size_ = 0; }
+
+private:
+  std::size_t wrap_(std::size_t i) const { return i < buf_.size() ? i : i - buf_.size(); }
+
+  std::vector<TransitionEvent> buf_;
+  OverflowPolicy overflow_;
+  std::size_t head_ = 0; // oldest event
+  std::size_t size_ = 0;
+  TransitionStats stats_;
+};
+
+} // namespace telemetry
@@ -0,0 +1,116 @@
+// window_quantiles.hpp
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+
+#include "metric_descriptors.hpp"
+
+namespace telemetry {
+
+// Exact order statistics over at most N values that enter and leave in any
+// order (a sliding window's per-second values).
+//
+// Values are kept sorted in a fixed array: insert/erase are a binary search
+// plus a shift of at most N doubles, reads are O(1). For window-sized N this
+// beats tree or sketch structures and never allocates. NaNs are ignored.
+template <std::size_t N>
+class SortedWindow {
+public:
+  void insert(double x) {
+    if (std::isnan(x) || n_ == N) return;
+    double* end = v_.data() + n_;
+    double* pos = std::upper_bound(v_.data(), end, x);
+    std::move_backward(pos, end, end + 1);
+    *pos = x;
+    ++n_;
+  }
+
+  void erase(double x) {
+    if (std::isnan(x)) return;
+    double* end = v_.data() + n_;
+    double* pos = std::lower_bound(v_.data(), end, x);
+    if (pos == end || *pos != x) return;
+    std::move(pos + 1, end, pos);
+    --n_;
+  }
+
+  void clear() { n_ = 0; }
+  std::size_t size() const { return n_; }
+
+  // Nearest-rank quantile (q in [0, 1]); 0 when empty.
+  double quantile(double q) const {
+    if (n_ == 0) return 0.0;
+    const auto rank = static_cast<std::size_t>(std::ceil(q * static_cast<double>(n_)));
+    return v_[std::clamp<std::size_t>(rank, 1, n_) - 1];
+  }
+
+  double min() const { return n_ ? v_[0] : 0.0; }
+  double max() const { return n_ ? v_[n_ - 1] : 0.0; }
+
+private:
+  std::array<double, N> v_{};
+  std::size_t n_ = 0;
+};
+
+// BasicRollingWindow observer keeping RTT and jitter quantiles and the loss
+// maximum for a DefaultMetrics window of N seconds.
+//
+// Off until enable() (one allocation, before the first sample), so windows
+// that score on means carry only a null pointer.
+template <std::size_t N>
+class WindowQuantiles {
+public:
+  struct State {
+    SortedWindow<N> rtt;
+    SortedWindow<N> jitter;
+    SortedWindow<N> loss;
+  };
+
+  WindowQuantiles() = default;
+  WindowQuantiles(const WindowQuantiles& o) : state_(o.state_ ? std::make_unique<State>(*o.state_) : nullptr) {}
+  WindowQuantiles& operator=(const WindowQuantiles& o) {
+    if (this != &o) state_ = o.state_ ? std::make_unique<State>(*o.state_) : nullptr;
+    return *this;
+  }
+  WindowQuantiles(WindowQuantiles&&) noexcept = default;
+  WindowQuantiles& operator=(WindowQuantiles&&) noexcept = default;
+
+  void enable() {
+    if (!state_) state_ = std::make_unique<State>();
+  }
+  const State* state() const { return state_.get(); }
+
+  void on_add(const DefaultMetrics::Values& v) {
+    if (!state_) return;
+    state_->rtt.insert(v[kRtt]);
+    state_->jitter.insert(v[kJit]);
+    state_->loss.insert(v[kLoss]);
+  }
+
+  void on_remove(const DefaultMetrics::Values& v) {
+    if (!state_) return;
+    state_->rtt.erase(v[kRtt]);
+    state_->jitter.erase(v[kJit]);
+    state_->loss.erase(v[kLoss]);
+  }
+
+  void on_clear() {
+    if (!state_) return;
+    state_->rtt.clear();
+    state_->jitter.clear();
+    state_->loss.clear();
+  }
+
+private:
+  static constexpr std::size_t kRtt = DefaultMetrics::index_of<RttMetric>();
+  static constexpr std::size_t kJit = DefaultMetrics::index_of<JitterMetric>();
+  static constexpr std::size_t kLoss = DefaultMetrics::index_of<LossMetric>();
+
+  std::unique_ptr<State> state_;
+};
+
+} // namespace telemetry
@@ -0,0 +1,266 @@
+// batch_scorer.cpp
+#include "batch_scorer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define TELEMETRY_HAVE_AVX2_KERNEL 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define TELEMETRY_HAVE_NEON_KERNEL 1
+#include <arm_neon.h>
+#endif
+
+namespace telemetry {
+
+// The vector kernels hard-code each metric's normalisation direction; the
+// ranges come from the ScoreConfig and are broadcast once per call.
+static_assert(ThroughputMetric::higher_is_better);
+static_assert(!RttMetric::higher_is_better);
+static_assert(!LossMetric::higher_is_better);
+static_assert(!JitterMetric::higher_is_better);
+
+const char* to_string(ScoreKernel k) {
+  switch (k) {
+    case ScoreKernel::Scalar: return "scalar";
+    case ScoreKernel::Avx2: return "avx2";
+    case ScoreKernel::Neon: return "neon";
+  }
+  return "?";
+}
+
+// --- scalar (reference, also used for tails) ---
+
+static void score_range_scalar(const ScoreConfig& c, const ScoreBatch& b,
+                               std::size_t begin, std::size_t end) {
+  for (std::size_t i = begin; i < end; ++i) {
+    const double avg = InterfaceTracker::clamp01(
+      c.w_tp * normalize<ThroughputMetric>(b.avg_tp_mbps[i], c.ranges.tp) +
+      c.w_rtt * normalize<RttMetric>(b.avg_rtt_ms[i], c.ranges.rtt) +
+      c.w_loss * normalize<LossMetric>(b.avg_loss_pct[i], c.ranges.loss) +
+      c.w_jit * normalize<JitterMetric>(b.avg_jitter_ms[i], c.ranges.jitter));
+    b.score_avg[i] = avg;
+
+    double ewma = avg;
+    if (b.have_ewma[i] && c.useEwma) {
+      const double prev = b.score_ewma[i];
+      ewma = c.ewma_alpha * avg + (1.0 - c.ewma_alpha) * prev;
+      if (c.enable_downtrend_penalty && avg < prev) ewma -= c.downtrend_penalty;
+      ewma = InterfaceTracker::clamp01(ewma);
+    }
+    b.score_ewma[i] = ewma;
+    b.have_ewma[i] = 1;
+
+    double candidate = c.useEwma ? ewma : avg;
+    if (c.enable_confidence_cap && b.confidence[i] < c.min_confidence_for_promotion) {
+      candidate = std::min(candidate, c.score_cap_when_low_conf);
+    }
+    b.score_used[i] = candidate;
+  }
+}
+
+// --- AVX2 (4 lanes) ---
+
+#ifdef TELEMETRY_HAVE_AVX2_KERNEL
+__attribute__((target("avx2")))
+static inline __m256d clamp01_avx2(__m256d x) {
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d one = _mm256_set1_pd(1.0);
+  // Same selects as clamp01(): x < 0 -> 0, x > 1 -> 1, else x (NaN passes through).
+  x = _mm256_blendv_pd(x, zero, _mm256_cmp_pd(x, zero, _CMP_LT_OQ));
+  return _mm256_blendv_pd(x, one, _mm256_cmp_pd(x, one, _CMP_GT_OQ));
+}
+
+__attribute__((target("avx2")))
+static void score_batch_avx2(const ScoreConfig& c, const ScoreBatch& b) {
+  const __m256d one = _mm256_set1_pd(1.0);
+  const __m256d w_tp = _mm256_set1_pd(c.w_tp);
+  const __m256d w_rtt = _mm256_set1_pd(c.w_rtt);
+  const __m256d w_loss = _mm256_set1_pd(c.w_loss);
+  const __m256d w_jit = _mm256_set1_pd(c.w_jit);
+  const MetricRanges& r = c.ranges;
+  const __m256d tp_lo = _mm256_set1_pd(r.tp.lo);
+  const __m256d tp_span = _mm256_set1_pd(r.tp.hi - r.tp.lo);
+  const __m256d rtt_lo = _mm256_set1_pd(r.rtt.lo);
+  const __m256d rtt_span = _mm256_set1_pd(r.rtt.hi - r.rtt.lo);
+  const __m256d loss_lo = _mm256_set1_pd(r.loss.lo);
+  const __m256d loss_span = _mm256_set1_pd(r.loss.hi - r.loss.lo);
+  const __m256d jit_lo = _mm256_set1_pd(r.jitter.lo);
+  const __m256d jit_span = _mm256_set1_pd(r.jitter.hi - r.jitter.lo);
+  const __m256d alpha = _mm256_set1_pd(c.ewma_alpha);
+  const __m256d one_minus_alpha = _mm256_set1_pd(1.0 - c.ewma_alpha);
+  const __m256d penalty = _mm256_set1_pd(c.enable_downtrend_penalty ? c.downtrend_penalty : 0.0);
+  const __m256d min_conf = _mm256_set1_pd(c.min_confidence_for_promotion);
+  const __m256d cap = _mm256_set1_pd(c.score_cap_when_low_conf);
+
+  const std::size_t n4 = b.n & ~std::size_t{3};
+  for (std::size_t i = 0; i < n4; i += 4) {
+    const __m256d n_tp = clamp01_avx2(
+      _mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(b.avg_tp_mbps + i), tp_lo), tp_span));
+    const __m256d n_rtt = clamp01_avx2(_mm256_sub_pd(
+      one, _mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(b.avg_rtt_ms + i), rtt_lo), rtt_span)));
+    const __m256d n_loss = clamp01_avx2(_mm256_sub_pd(
+      one, _mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(b.avg_loss_pct + i), loss_lo), loss_span)));
+    const __m256d n_jit = clamp01_avx2(_mm256_sub_pd(
+      one, _mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(b.avg_jitter_ms + i), jit_lo), jit_span)));
+
+    __m256d s = _mm256_add_pd(_mm256_mul_pd(w_tp, n_tp), _mm256_mul_pd(w_rtt, n_rtt));
+    s = _mm256_add_pd(s, _mm256_mul_pd(w_loss, n_loss));
+    s = _mm256_add_pd(s, _mm256_mul_pd(w_jit, n_jit));
+    const __m256d avg = clamp01_avx2(s);
+    _mm256_storeu_pd(b.score_avg + i, avg);
+
+    __m256d ewma = avg;
+    if (c.useEwma) {
+      uint32_t have4;
+      std::memcpy(&have4, b.have_ewma + i, sizeof(have4));
+      const __m256d have = _mm256_castsi256_pd(_mm256_cmpgt_epi64(
+        _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(static_cast<int>(have4))),
+        _mm256_setzero_si256()));
+
+      const __m256d prev = _mm256_loadu_pd(b.score_ewma + i);
+      __m256d upd = _mm256_add_pd(_mm256_mul_pd(alpha, avg), _mm256_mul_pd(one_minus_alpha, prev));
+      const __m256d down = _mm256_cmp_pd(avg, prev, _CMP_LT_OQ);
+      upd = _mm256_sub_pd(upd, _mm256_and_pd(down, penalty));
+      ewma = _mm256_blendv_pd(avg, clamp01_avx2(upd), have);
+    }
+    _mm256_storeu_pd(b.score_ewma + i, ewma);
+    std::memset(b.have_ewma + i, 1, 4);
+
+    __m256d used = ewma;
+    if (c.enable_confidence_cap) {
+      const __m256d low = _mm256_cmp_pd(_mm256_loadu_pd(b.confidence + i), min_conf, _CMP_LT_OQ);
+      // std::min(used, cap) == (cap < used) ? cap : used == minpd(cap, used).
+      used = _mm256_blendv_pd(used, _mm256_min_pd(cap, used), low);
+    }
+    _mm256_storeu_pd(b.score_used + i, used);
+  }
+  score_range_scalar(c, b, n4, b.n);
+}
+#endif
+
+// --- NEON (2 lanes) ---
+
+#ifdef TELEMETRY_HAVE_NEON_KERNEL
+static inline float64x2_t clamp01_neon(float64x2_t x) {
+  const float64x2_t zero = vdupq_n_f64(0.0);
+  const float64x2_t one = vdupq_n_f64(1.0);
+  x = vbslq_f64(vcltq_f64(x, zero), zero, x);
+  return vbslq_f64(vcgtq_f64(x, one), one, x);
+}
+
+static void score_batch_neon(const ScoreConfig& c, const ScoreBatch& b) {
+  const float64x2_t one = vdupq_n_f64(1.0);
+  const float64x2_t w_tp = vdupq_n_f64(c.w_tp);
+  const float64x2_t w_rtt = vdupq_n_f64(c.w_rtt);
+  const float64x2_t w_loss = vdupq_n_f64(c.w_loss);
+  const float64x2_t w_jit = vdupq_n_f64(c.w_jit);
+  const MetricRanges& r = c.ranges;
+  const float64x2_t tp_lo = vdupq_n_f64(r.tp.lo);
+  const float64x2_t tp_span = vdupq_n_f64(r.tp.hi - r.tp.lo);
+  const float64x2_t rtt_lo = vdupq_n_f64(r.rtt.lo);
+  const float64x2_t rtt_span = vdupq_n_f64(r.rtt.hi - r.rtt.lo);
+  const float64x2_t loss_lo = vdupq_n_f64(r.loss.lo);
+  const float64x2_t loss_span = vdupq_n_f64(r.loss.hi - r.loss.lo);
+  const float64x2_t jit_lo = vdupq_n_f64(r.jitter.lo);
+  const float64x2_t jit_span = vdupq_n_f64(r.jitter.hi - r.jitter.lo);
+  const float64x2_t alpha = vdupq_n_f64(c.ewma_alpha);
+  const float64x2_t one_minus_alpha = vdupq_n_f64(1.0 - c.ewma_alpha);
+  const float64x2_t penalty = vdupq_n_f64(c.enable_downtrend_penalty ? c.downtrend_penalty : 0.0);
+  const float64x2_t min_conf = vdupq_n_f64(c.min_confidence_for_promotion);
+  const float64x2_t cap = vdupq_n_f64(c.score_cap_when_low_conf);
+
+  // Separate vmul/vadd (never vfma) to keep the scalar rounding sequence.
+  const std::size_t n2 = b.n & ~std::size_t{1};
+  for (std::size_t i = 0; i < n2; i += 2) {
+    const float64x2_t n_tp = clamp01_neon(vdivq_f64(vsubq_f64(vld1q_f64(b.avg_tp_mbps + i), tp_lo), tp_span));
+    const float64x2_t n_rtt = clamp01_neon(vsubq_f64(
+      one, vdivq_f64(vsubq_f64(vld1q_f64(b.avg_rtt_ms + i), rtt_lo), rtt_span)));
+    const float64x2_t n_loss = clamp01_neon(vsubq_f64(
+      one, vdivq_f64(vsubq_f64(vld1q_f64(b.avg_loss_pct + i), loss_lo), loss_span)));
+    const float64x2_t n_jit = clamp01_neon(vsubq_f64(
+      one, vdivq_f64(vsubq_f64(vld1q_f64(b.avg_jitter_ms + i), jit_lo), jit_span)));
+
+    float64x2_t s = vaddq_f64(vmulq_f64(w_tp, n_tp), vmulq_f64(w_rtt, n_rtt));
+    s = vaddq_f64(s, vmulq_f64(w_loss, n_loss));
+    s = vaddq_f64(s, vmulq_f64(w_jit, n_jit));
+    const float64x2_t avg = clamp01_neon(s);
+    vst1q_f64(b.score_avg + i, avg);
+
+    float64x2_t ewma = avg;
+    if (c.useEwma) {
+      const uint64_t h[2] = {b.have_ewma[i], b.have_ewma[i + 1]};
+      const uint64x2_t have = vcgtq_u64(vld1q_u64(h), vdupq_n_u64(0));
+
+      const float64x2_t prev = vld1q_f64(b.score_ewma + i);
+      float64x2_t upd = vaddq_f64(vmulq_f64(alpha, avg), vmulq_f64(one_minus_alpha, prev));
+      const uint64x2_t down = vcltq_f64(avg, prev);
+      upd = vsubq_f64(upd, vbslq_f64(down, penalty, vdupq_n_f64(0.0)));
+      ewma = vbslq_f64(have, clamp01_neon(upd), avg);
+    }
+    vst1q_f64(b.score_ewma + i, ewma);
+    b.have_ewma[i] = 1;
+    b.have_ewma[i + 1] = 1;
+
+    float64x2_t used = ewma;
+    if (c.enable_confidence_cap) {
+      const uint64x2_t low = vcltq_f64(vld1q_f64(b.confidence + i), min_conf);
+      const float64x2_t capped = vbslq_f64(vcltq_f64(cap, used), cap, used);
+      used = vbslq_f64(low, capped, used);
+    }
+    vst1q_f64(b.score_used + i, used);
+  }
+  score_range_scalar(c, b, n2, b.n);
+}
+#endif
+
+// --- dispatch ---
+
+bool score_kernel_available(ScoreKernel k) {
+  switch (k) {
+    case ScoreKernel::Scalar: return true;
+    case ScoreKernel::Avx2:
+#ifdef TELEMETRY_HAVE_AVX2_KERNEL
+      return __builtin_cpu_supports("avx2");
+#else
+      return false;
+#endif
+    case ScoreKernel::Neon:
+#ifdef TELEMETRY_HAVE_NEON_KERNEL
+      return true;
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+ScoreKernel active_score_kernel() {
+  static const ScoreKernel k = [] {
+    if (score_kernel_available(ScoreKernel::Avx2)) return ScoreKernel::Avx2;
+    if (score_kernel_available(ScoreKernel::Neon)) return ScoreKernel::Neon;
+    return ScoreKernel::Scalar;
+  }();
+  return k;
+}
+
+void score_batch_with(ScoreKernel k, const ScoreConfig& cfg, const ScoreBatch& b) {
+  switch (k) {
+#ifdef TELEMETRY_HAVE_AVX2_KERNEL
+    case ScoreKernel::Avx2: score_batch_avx2(cfg, b); return;
+#endif
+#ifdef TELEMETRY_HAVE_NEON_KERNEL
+    case ScoreKernel::Neon: score_batch_neon(cfg, b); return;
+#endif
+    default: score_range_scalar(cfg, b, 0, b.n); return;
+  }
+}
+
+void score_batch(const ScoreConfig& cfg, const ScoreBatch& b) {
+  score_batch_with(active_score_kernel(), cfg, b);
+}
+
+} // namespace telemetry
@@ -0,0 +1,429 @@
+// checkpoint.cpp
+#include "checkpoint.hpp"
+
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TELEMETRY_CHECKPOINT_POSIX 1
+#else
+#define TELEMETRY_CHECKPOINT_POSIX 0
+#endif
+
+namespace telemetry {
+
+namespace {
+constexpr std::size_t kHeaderWords = sizeof(CheckpointHeader) / 8;
+constexpr std::size_t kRecordWords = sizeof(CheckpointRecord) / 8;
+constexpr int64_t kNoTime = std::numeric_limits<int64_t>::min();
+
+[[noreturn]] void fail(const std::string& path, const char* what) {
+  throw std::runtime_error("checkpoint " + path + ": " + what);
+}
+
+struct Fnv1a {
+  uint64_t h = 0xcbf29ce484222325ull;
+  void add(uint64_t v) {
+    for (int i = 0; i < 8; ++i, v >>= 8) {
+      h ^= v & 0xff;
+      h *= 0x100000001b3ull;
+    }
+  }
+  void add(double v) { add(std::bit_cast<uint64_t>(v)); }
+  void add(int64_t v) { add(static_cast<uint64_t>(v)); }
+  void add(int v) { add(static_cast<uint64_t>(static_cast<int64_t>(v))); }
+  void add(bool v) { add(uint64_t{v}); }
+  template <typename E>
+    requires std::is_enum_v<E>
+  void add(E v) { add(static_cast<uint64_t>(v)); }
+};
+
+CheckpointRecord to_record(InterfaceId id, const InterfaceTracker& tr) {
+  const TrackerState st = tr.state();
+  const auto& w = tr.window().storage();
+  CheckpointRecord r;
+  r.id = id;
+  r.status = static_cast<uint8_t>(st.fsm.status);
+  r.flags = static_cast<uint8_t>((st.have_ewma ? CheckpointRecord::kHaveEwma : 0) |
+                                 (st.dirty ? CheckpointRecord::kDirty : 0));
+  r.window_newest_ts = w.newest_ts();
+  for (std::size_t k = 0; k < CheckpointRecord::kMetrics; ++k) r.window_sums[k] = w.sums()[k];
+  const int64_t first = r.window_newest_ts - (RollingWindow::kWindow - 1);
+  w.for_each_second([&](const RollingWindow::Storage::Second& sec) {
+    const auto k = static_cast<std::size_t>(sec.ts - first);
+    r.occupied |= uint64_t{1} << k;
+    r.samples[k] = sec.samples;
+    for (std::size_t m = 0; m < CheckpointRecord::kMetrics; ++m) r.values[k][m] = sec.v[m];
+  });
+
+  r.last_eval_ts = st.last_eval_ts;
+  r.last_transition_ts = st.fsm.last_transition_ts;
+  r.cnt_below_healthy_exit = st.fsm.cnt_below_healthy_exit;
+  r.cnt_above_healthy_enter = st.fsm.cnt_above_healthy_enter;
+  r.cnt_below_down_enter = st.fsm.cnt_below_down_enter;
+  r.cnt_above_down_exit = st.fsm.cnt_above_down_exit;
+  r.score_avg = st.score_avg;
+  r.score_ewma = st.score_ewma;
+  r.score_used = st.score_used;
+  r.confidence = st.confidence;
+  r.avg_tp_mbps = st.avg_tp_mbps;
+  r.avg_rtt_ms = st.avg_rtt_ms;
+  r.avg_loss_pct = st.avg_loss_pct;
+  r.avg_jitter_ms = st.avg_jitter_ms;
+  return r;
+}
+
+TrackerState to_state(const CheckpointRecord& r) {
+  TrackerState st;
+  st.fsm.status = static_cast<IfStatus>(r.status);
+  st.fsm.last_transition_ts = r.last_transition_ts;
+  st.fsm.cnt_below_healthy_exit = r.cnt_below_healthy_exit;
+  st.fsm.cnt_above_healthy_enter = r.cnt_above_healthy_enter;
+  st.fsm.cnt_below_down_enter = r.cnt_below_down_enter;
+  st.fsm.cnt_above_down_exit = r.cnt_above_down_exit;
+  st.score_avg = r.score_avg;
+  st.score_ewma = r.score_ewma;
+  st.score_used = r.score_used;
+  st.have_ewma = (r.flags & CheckpointRecord::kHaveEwma) != 0;
+  st.dirty = (r.flags & CheckpointRecord::kDirty) != 0;
+  st.last_eval_ts = r.last_eval_ts;
+  st.confidence = r.confidence;
+  st.avg_tp_mbps = r.avg_tp_mbps;
+  st.avg_rtt_ms = r.avg_rtt_ms;
+  st.avg_loss_pct = r.avg_loss_pct;
+  st.avg_jitter_ms = r.avg_jitter_ms;
+  return st;
+}
+
+void window_of(const CheckpointRecord& r, std::vector<RollingWindow::Storage::Second>& out) {
+  out.clear();
+  const int64_t first = r.window_newest_ts - (RollingWindow::kWindow - 1);
+  for (uint64_t bits = r.occupied; bits != 0; bits &= bits - 1) {
+    const auto k = static_cast<std::size_t>(std::countr_zero(bits));
+    RollingWindow::Storage::Second sec;
+    sec.ts = first + static_cast<int64_t>(k);
+    sec.samples = r.samples[k];
+    for (std::size_t m = 0; m < CheckpointRecord::kMetrics; ++m) sec.v[m] = r.values[k][m];
+    out.push_back(sec);
+  }
+}
+
+bool record_ok(const CheckpointRecord& r, std::size_t index) {
+  constexpr uint64_t kAll = CheckpointRecord::kSeconds == 64 ? ~uint64_t{0}
+                                                              : (uint64_t{1} << CheckpointRecord::kSeconds) - 1;
+  if (r.id != index || r.status > static_cast<uint8_t>(IfStatus::Down)) return false;
+  if ((r.flags & ~(CheckpointRecord::kHaveEwma | CheckpointRecord::kDirty)) != 0) return false;
+  if ((r.occupied & ~kAll) != 0) return false;
+  if (r.window_newest_ts == kNoTime) return r.occupied == 0;
+  if (r.window_newest_ts < kNoTime + RollingWindow::kWindow) return false;
+  for (std::size_t k = 0; k < CheckpointRecord::kSeconds; ++k) {
+    if (((r.occupied >> k) & 1) != (r.samples[k] != 0)) return false;
+  }
+  return true;
+}
+
+// Read-only bytes of a file: mapped where the platform allows, otherwise
+// read into 8-byte aligned memory.
+class FileBytes {
+public:
+  explicit FileBytes(const std::string& path) {
+#if TELEMETRY_CHECKPOINT_POSIX
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) fail(path, "cannot open");
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      fail(path, "cannot stat");
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ > 0) {
+      void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED) {
+        data_ = static_cast<const unsigned char*>(p);
+        mapped_ = true;
+      }
+    }
+    ::close(fd);
+#endif
+    if (!mapped_) {
+      std::FILE* f = std::fopen(path.c_str(), "rb");
+      if (!f) fail(path, "cannot open");
+      std::vector<unsigned char> bytes;
+      unsigned char chunk[1 << 16];
+      for (std::size_t n; (n = std::fread(chunk, 1, sizeof chunk, f)) > 0;) bytes.insert(bytes.end(), chunk, chunk + n);
+      std::fclose(f);
+      owned_.resize((bytes.size() + 7) / 8);
+      if (!bytes.empty()) std::memcpy(owned_.data(), bytes.data(), bytes.size());
+      data_ = reinterpret_cast<const unsigned char*>(owned_.data());
+      size_ = bytes.size();
+    }
+  }
+
+  ~FileBytes() {
+#if TELEMETRY_CHECKPOINT_POSIX
+    if (mapped_) ::munmap(const_cast<unsigned char*>(data_), size_);
+#endif
+  }
+
+  FileBytes(const FileBytes&) = delete;
+  FileBytes& operator=(const FileBytes&) = delete;
+
+  const unsigned char* data() const { return data_; }
+  std::size_t size() const { return size_; }
+
+private:
+  const unsigned char* data_ = nullptr;
+  std::size_t size_ = 0;
+  bool mapped_ = false;
+  std::vector<uint64_t> owned_;
+};
+} // namespace
+
+namespace {
+void add_profile(Fnv1a& f, const ScoreConfig& s, const FsmConfig& m) {
+  f.add(s.w_loss);
+  f.add(s.w_rtt);
+  f.add(s.w_tp);
+  f.add(s.w_jit);
+  for (const MetricRange& r : {s.ranges.tp, s.ranges.rtt, s.ranges.loss, s.ranges.jitter}) {
+    f.add(r.lo);
+    f.add(r.hi);
+  }
+  f.add(s.rtt_stat);
+  f.add(s.jitter_stat);
+  f.add(s.loss_use_max);
+  f.add(s.useEwma);
+  f.add(s.ewma_alpha);
+  f.add(s.enable_downtrend_penalty);
+  f.add(s.downtrend_penalty);
+  f.add(s.enable_confidence_cap);
+  f.add(s.min_confidence_for_promotion);
+  f.add(s.score_cap_when_low_conf);
+
+  f.add(m.healthy_enter);
+  f.add(m.healthy_exit);
+  f.add(m.down_enter);
+  f.add(m.down_exit);
+  f.add(m.healthy_enter_N);
+  f.add(m.healthy_exit_N);
+  f.add(m.down_enter_N);
+  f.add(m.down_exit_N);
+  f.add(m.min_dwell_sec);
+  f.add(m.min_confidence_for_promotion);
+  f.add(m.force_down_if_confidence_below);
+}
+} // namespace
+
+uint64_t config_hash(const AgentConfig& cfg) {
+  Fnv1a f;
+  add_profile(f, cfg.score, cfg.fsm);
+  f.add(cfg.recompute);
+  f.add(cfg.same_second);
+  return f.h;
+}
+
+uint64_t config_hash(const TelemetryAgent& agent) {
+  Fnv1a f;
+  f.h = config_hash(agent.config());
+  for (ProfileId id = 1; id < agent.profiles().size(); ++id) {
+    const std::string& name = agent.profiles().name(id);
+    f.add(static_cast<uint64_t>(name.size()));
+    for (const char c : name) f.add(static_cast<uint64_t>(static_cast<unsigned char>(c)));
+    add_profile(f, agent.profiles().get(id).score, agent.profiles().get(id).fsm);
+  }
+  return f.h;
+}
+
+void encode_checkpoint(const TelemetryAgent& agent, int64_t tick_ts, std::vector<uint64_t>& words) {
+  const std::size_t n = agent.size();
+  words.resize(kHeaderWords + n * kRecordWords);
+  for (InterfaceId id = 0; id < n; ++id) {
+    const CheckpointRecord r = to_record(id, agent.tracker(id));
+    std::memcpy(words.data() + kHeaderWords + id * kRecordWords, &r, sizeof r);
+  }
+
+  CheckpointHeader h;
+  std::memcpy(h.magic, CheckpointHeader::kMagic, sizeof h.magic);
+  h.record_size = sizeof(CheckpointRecord);
+  h.window_seconds = RollingWindow::kWindow;
+  h.config_hash = config_hash(agent);
+  h.tick_ts = tick_ts;
+  h.record_count = n;
+  h.names_offset = words.size() * 8;
+  h.name_count = static_cast<uint32_t>(n);
+  for (InterfaceId id = 0; id < n; ++id) {
+    const std::string& name = agent.tracker(id).iface();
+    const std::size_t at = words.size();
+    words.resize(at + 1 + (name.size() + 7) / 8, 0);
+    words[at] = static_cast<uint64_t>(id) | static_cast<uint64_t>(name.size()) << 32;
+    std::memcpy(words.data() + at + 1, name.data(), name.size());
+  }
+  std::memcpy(words.data(), &h, sizeof h);
+}
+
+void write_checkpoint_file(const std::string& path, std::span<const uint64_t> words) {
+  const std::string tmp = path + ".tmp";
+  std::FILE* f = std::fopen(tmp.c_str(), "wb");
+  if (!f) fail(tmp, "cannot open for writing");
+  bool ok = std::fwrite(words.data(), 8, words.size(), f) == words.size() && std::fflush(f) == 0;
+#if TELEMETRY_CHECKPOINT_POSIX
+  ok = ok && ::fsync(::fileno(f)) == 0;
+#endif
+  ok = (std::fclose(f) == 0) && ok;
+  if (!ok) {
+    std::remove(tmp.c_str());
+    fail(tmp, "write failed");
+  }
+  if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+    std::remove(tmp.c_str());
+    fail(path, "rename failed");
+  }
+}
+
+void save_checkpoint(const TelemetryAgent& agent, int64_t tick_ts, const std::string& path) {
+  std::vector<uint64_t> words;
+  encode_checkpoint(agent, tick_ts, words);
+  write_checkpoint_file(path, words);
+}
+
+CheckpointInfo restore_checkpoint(TelemetryAgent& agent, const std::string& path) {
+  const FileBytes file(path);
+  const unsigned char* data = file.data();
+  const std::size_t size = file.size();
+
+  CheckpointHeader h;
+  if (size < sizeof h) fail(path, "truncated header");
+  std::memcpy(&h, data, sizeof h);
+  if (std::memcmp(h.magic, CheckpointHeader::kMagic, sizeof h.magic) != 0) fail(path, "not a checkpoint");
+  if (h.endian != CheckpointHeader::kEndian) fail(path, "written with the other byte order");
+  if (h.version != CheckpointHeader::kVersion) fail(path, "unsupported version");
+  if (h.record_size != sizeof(CheckpointRecord) || h.window_seconds != RollingWindow::kWindow) {
+    fail(path, "unexpected record layout");
+  }
+  if (h.config_hash != config_hash(agent)) fail(path, "saved with a different agent config");
+  const uint64_t records_end = sizeof h + h.record_count * sizeof(CheckpointRecord);
+  if (h.record_count > size / sizeof(CheckpointRecord) || records_end > size || h.names_offset != records_end) {
+    fail(path, "truncated records");
+  }
+  const std::span<const CheckpointRecord> records(reinterpret_cast<const CheckpointRecord*>(data + sizeof h),
+                                                  static_cast<std::size_t>(h.record_count));
+
+  // Validate everything before touching the agent.
+  if (h.name_count != h.record_count) fail(path, "corrupt name table");
+  std::vector<std::string_view> names(records.size());
+  std::unordered_set<std::string_view> seen;
+  std::size_t off = static_cast<std::size_t>(h.names_offset);
+  for (uint32_t i = 0; i < h.name_count; ++i) {
+    uint64_t entry = 0;
+    if (size - off < sizeof entry) fail(path, "truncated name table");
+    std::memcpy(&entry, data + off, sizeof entry);
+    off += sizeof entry;
+    const auto id = static_cast<uint32_t>(entry);
+    const auto len = static_cast<std::size_t>(entry >> 32);
+    if (size - off < (len + 7) / 8 * 8) fail(path, "truncated name table");
+    if (id != i || len == 0) fail(path, "corrupt name table");
+    names[i] = {reinterpret_cast<const char*>(data + off), len};
+    if (!seen.insert(names[i]).second) fail(path, "duplicate interface name");
+    off += (len + 7) / 8 * 8;
+  }
+  for (std::size_t i = 0; i < records.size(); ++i) {
+    if (!record_ok(records[i], i)) fail(path, "corrupt record");
+  }
+
+  std::vector<RollingWindow::Storage::Second> seconds;
+  seconds.reserve(CheckpointRecord::kSeconds);
+  for (std::size_t i = 0; i < records.size(); ++i) {
+    const CheckpointRecord& r = records[i];
+    const InterfaceId id = agent.register_interface(names[i]);
+    window_of(r, seconds);
+    DefaultMetrics::Values sums{};
+    for (std::size_t k = 0; k < CheckpointRecord::kMetrics; ++k) sums[k] = r.window_sums[k];
+    // record_ok() checked the window, so this cannot fail.
+    (void)agent.restore_tracker(id, h.tick_ts, to_state(r), r.window_newest_ts, sums, seconds);
+  }
+  return CheckpointInfo{h.tick_ts, records.size()};
+}
+
+// ---------------------------------------------------------------------------
+// Background writer
+
+CheckpointWriter::CheckpointWriter(std::string path) : path_(std::move(path)), thread_([this] { run_(); }) {}
+
+CheckpointWriter::~CheckpointWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    quit_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+}
+
+void CheckpointWriter::rethrow_locked_() {
+  if (error_) std::rethrow_exception(std::exchange(error_, nullptr));
+}
+
+bool CheckpointWriter::capture(const TelemetryAgent& agent, int64_t tick_ts) {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    rethrow_locked_();
+    if (busy_) {
+      ++skipped_;
+      return false;
+    }
+  }
+  // The writer thread leaves pending_ alone while idle, and spare_ is ours.
+  encode_checkpoint(agent, tick_ts, spare_);
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    std::swap(spare_, pending_);
+    busy_ = true;
+  }
+  cv_.notify_all();
+  return true;
+}
+
+void CheckpointWriter::wait() {
+  std::unique_lock<std::mutex> lock(mu_);
+  cv_.wait(lock, [this] { return !busy_; });
+  rethrow_locked_();
+}
+
+uint64_t CheckpointWriter::written() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  return written_;
+}
+
+void CheckpointWriter::run_() {
+  std::unique_lock<std::mutex> lock(mu_);
+  for (;;) {
+    cv_.wait(lock, [this] { return busy_ || quit_; });
+    if (!busy_) return;
+    lock.unlock();
+    std::exception_ptr err;
+    try {
+      write_checkpoint_file(path_, pending_);
+    } catch (...) {
+      err = std::current_exception();
+    }
+    lock.lock();
+    if (err) {
+      error_ = err;
+    } else {
+      ++written_;
+    }
+    busy_ = false;
+    cv_.notify_all();
+  }
+}
+
+} // namespace telemetry
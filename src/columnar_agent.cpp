@@ -0,0 +1,333 @@
+// columnar_agent.cpp
+#include "columnar_agent.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "batch_scorer.hpp"
+
+namespace telemetry {
+
+static_assert(RollingWindow::kWindow <= 64, "slot_valid_ uses one 64-bit mask per interface");
+
+namespace {
+constexpr int64_t kNoTs = std::numeric_limits<int64_t>::min();
+
+const ScoreConfig& means_only(const ScoreConfig& c) {
+  if (uses_window_quantiles(c)) {
+    throw std::invalid_argument("ColumnarTelemetryAgent: quantile scoring is not supported");
+  }
+  return c;
+}
+} // namespace
+
+ColumnarTelemetryAgent::ColumnarTelemetryAgent(AgentConfig cfg, std::size_t reserve_ifaces,
+                                               TransitionLogConfig log)
+  : cfg_(cfg), profiles_(ConfigProfile{means_only(cfg.score), cfg.fsm}), transitions_(log) {
+  if (reserve_ifaces == 0) return;
+  names_.reserve(reserve_ifaces);
+  profiles_.reserve(reserve_ifaces);
+  index_.reserve(reserve_ifaces);
+  const std::size_t slots = reserve_ifaces * kWindow;
+  slot_ts_.reserve(slots);
+  slot_rtt_.reserve(slots);
+  slot_tp_.reserve(slots);
+  slot_loss_.reserve(slots);
+  slot_jit_.reserve(slots);
+  slot_n_.reserve(slots);
+}
+
+InterfaceId ColumnarTelemetryAgent::register_interface(std::string_view iface) {
+  if (auto it = index_.find(iface); it != index_.end()) return it->second;
+
+  const auto id = static_cast<InterfaceId>(names_.size());
+  names_.emplace_back(iface);
+  index_.emplace(std::string(iface), id);
+  profiles_.add_member(id);
+
+  const std::size_t slots = names_.size() * kWindow;
+  slot_ts_.resize(slots, 0);
+  slot_rtt_.resize(slots, 0.0);
+  slot_tp_.resize(slots, 0.0);
+  slot_loss_.resize(slots, 0.0);
+  slot_jit_.resize(slots, 0.0);
+  slot_n_.resize(slots, 0);
+  slot_valid_.push_back(0);
+
+  newest_ts_.push_back(kNoTs);
+  sum_rtt_.push_back(0.0);
+  sum_tp_.push_back(0.0);
+  sum_loss_.push_back(0.0);
+  sum_jit_.push_back(0.0);
+  count_.push_back(0);
+
+  score_avg_.push_back(0.0);
+  score_ewma_.push_back(0.0);
+  score_used_.push_back(0.0);
+  have_ewma_.push_back(0);
+
+  status_.push_back(static_cast<uint8_t>(IfStatus::Degraded));
+  last_transition_ts_.push_back(kNoTs);
+  cnt_below_healthy_exit_.push_back(0);
+  cnt_above_healthy_enter_.push_back(0);
+  cnt_below_down_enter_.push_back(0);
+  cnt_above_down_exit_.push_back(0);
+  fsm_changes_.emplace_back();
+
+  confidence_.push_back(0.0);
+  avg_tp_.push_back(0.0);
+  avg_rtt_.push_back(0.0);
+  avg_loss_.push_back(0.0);
+  avg_jit_.push_back(0.0);
+
+  score_sum_.push_back(0.0);
+  score_count_.push_back(0);
+  dirty_.push_back(1); // never evaluated
+  return id;
+}
+
+std::optional<InterfaceId> ColumnarTelemetryAgent::find_interface(std::string_view iface) const {
+  if (auto it = index_.find(iface); it != index_.end()) return it->second;
+  return std::nullopt;
+}
+
+// --- window (same semantics as RollingWindow) ---
+
+void ColumnarTelemetryAgent::window_remove_(InterfaceId id, std::size_t slot) {
+  if (--count_[id] == 0) {
+    sum_rtt_[id] = sum_tp_[id] = sum_loss_[id] = sum_jit_[id] = 0.0;
+    return;
+  }
+  sum_rtt_[id] -= slot_rtt_[slot];
+  sum_tp_[id] -= slot_tp_[slot];
+  sum_loss_[id] -= slot_loss_[slot];
+  sum_jit_[id] -= slot_jit_[slot];
+}
+
+void ColumnarTelemetryAgent::window_advance_(InterfaceId id, int64_t ts_now) {
+  const int64_t newest = newest_ts_[id];
+  if (ts_now - newest >= kWindow) {
+    slot_valid_[id] = 0;
+    sum_rtt_[id] = sum_tp_[id] = sum_loss_[id] = sum_jit_[id] = 0.0;
+    count_[id] = 0;
+  } else if (slot_valid_[id] != 0) {
+    const std::size_t base = static_cast<std::size_t>(id) * kWindow;
+    const int64_t old_oldest = newest - (kWindow - 1);
+    const int64_t new_oldest = ts_now - (kWindow - 1);
+    for (int64_t t = old_oldest; t < new_oldest; ++t) {
+      const int i = slot_idx(t);
+      const uint64_t bit = uint64_t{1} << i;
+      if (!(slot_valid_[id] & bit) || slot_ts_[base + i] != t) continue;
+      window_remove_(id, base + i);
+      slot_valid_[id] &= ~bit;
+    }
+  }
+  newest_ts_[id] = ts_now;
+}
+
+bool ColumnarTelemetryAgent::window_ingest_(InterfaceId id, int64_t ts, const Metrics& m) {
+  if (newest_ts_[id] == kNoTs) {
+    newest_ts_[id] = ts;
+  } else if (ts > newest_ts_[id]) {
+    window_advance_(id, ts);
+  }
+
+  if (ts < newest_ts_[id] - (kWindow - 1)) return false;
+
+  const int i = slot_idx(ts);
+  const std::size_t slot = static_cast<std::size_t>(id) * kWindow + i;
+  const uint64_t bit = uint64_t{1} << i;
+  const bool occupied = (slot_valid_[id] & bit) != 0;
+  if (occupied) window_remove_(id, slot);
+
+  if (occupied && cfg_.same_second == SameSecond::Average) {
+    // Running mean of the second's samples, as RollingWindow::merge().
+    const double n = static_cast<double>(++slot_n_[slot]);
+    slot_rtt_[slot] += (m.rtt_ms - slot_rtt_[slot]) / n;
+    slot_tp_[slot] += (m.throughput_mbps - slot_tp_[slot]) / n;
+    slot_loss_[slot] += (m.loss_pct - slot_loss_[slot]) / n;
+    slot_jit_[slot] += (m.jitter_ms - slot_jit_[slot]) / n;
+  } else {
+    slot_ts_[slot] = ts;
+    slot_n_[slot] = 1;
+    slot_rtt_[slot] = m.rtt_ms;
+    slot_tp_[slot] = m.throughput_mbps;
+    slot_loss_[slot] = m.loss_pct;
+    slot_jit_[slot] = m.jitter_ms;
+    slot_valid_[id] |= bit;
+  }
+
+  sum_rtt_[id] += slot_rtt_[slot];
+  sum_tp_[id] += slot_tp_[slot];
+  sum_loss_[id] += slot_loss_[slot];
+  sum_jit_[id] += slot_jit_[slot];
+  ++count_[id];
+  return true;
+}
+
+// --- scoring (same pipeline as InterfaceTracker::recompute_) ---
+
+void ColumnarTelemetryAgent::summarize_(InterfaceId id) {
+  const int n = count_[id];
+  confidence_[id] = static_cast<double>(n) / static_cast<double>(kWindow);
+  if (n > 0) {
+    avg_rtt_[id] = sum_rtt_[id] / n;
+    avg_tp_[id] = sum_tp_[id] / n;
+    avg_loss_[id] = sum_loss_[id] / n;
+    avg_jit_[id] = sum_jit_[id] / n;
+  } else {
+    avg_rtt_[id] = avg_tp_[id] = avg_loss_[id] = avg_jit_[id] = 0.0;
+  }
+}
+
+void ColumnarTelemetryAgent::score_(InterfaceId first, std::size_t n, const ScoreConfig& c) {
+  ScoreBatch b;
+  b.avg_tp_mbps = avg_tp_.data() + first;
+  b.avg_rtt_ms = avg_rtt_.data() + first;
+  b.avg_loss_pct = avg_loss_.data() + first;
+  b.avg_jitter_ms = avg_jit_.data() + first;
+  b.confidence = confidence_.data() + first;
+  b.score_avg = score_avg_.data() + first;
+  b.score_ewma = score_ewma_.data() + first;
+  b.have_ewma = have_ewma_.data() + first;
+  b.score_used = score_used_.data() + first;
+  b.n = n;
+  score_batch(c, b);
+}
+
+void ColumnarTelemetryAgent::evaluate_fsm_(InterfaceId first, std::size_t n, int64_t now_ts, const FsmConfig& f) {
+  FsmBatch b;
+  b.status = status_.data() + first;
+  b.last_transition_ts = last_transition_ts_.data() + first;
+  b.cnt_below_healthy_exit = cnt_below_healthy_exit_.data() + first;
+  b.cnt_above_healthy_enter = cnt_above_healthy_enter_.data() + first;
+  b.cnt_below_down_enter = cnt_below_down_enter_.data() + first;
+  b.cnt_above_down_exit = cnt_above_down_exit_.data() + first;
+  b.score = score_used_.data() + first;
+  b.confidence = confidence_.data() + first;
+  b.n = n;
+  const std::size_t changes = fsm_update_batch(f, b, now_ts, fsm_changes_);
+  for (std::size_t i = 0; i < changes; ++i) {
+    const FsmChange& c = fsm_changes_[i];
+    transitions_.push(TransitionEvent{first + c.index, now_ts, c.from, c.to, c.reason});
+  }
+}
+
+void ColumnarTelemetryAgent::recompute_(InterfaceId id, int64_t now_ts) {
+  const ConfigProfile& p = profiles_.get(profiles_.of(id));
+  summarize_(id);
+  score_(id, 1, p.score);
+  evaluate_fsm_(id, 1, now_ts, p.fsm);
+}
+
+// --- public API ---
+
+void ColumnarTelemetryAgent::ingest(InterfaceId id, int64_t ts, const Metrics& m) {
+  window_ingest_(id, ts, m);
+  if (cfg_.recompute == RecomputeMode::Eager) {
+    recompute_(id, newest_ts_[id]);
+  } else {
+    dirty_[id] = 1;
+  }
+}
+
+void ColumnarTelemetryAgent::ingest(const std::string& iface, int64_t ts, const Metrics& m) {
+  ingest(register_interface(iface), ts, m);
+}
+
+void ColumnarTelemetryAgent::note_time(int64_t ts_now) {
+  const auto n = static_cast<InterfaceId>(names_.size());
+  for (InterfaceId id = 0; id < n; ++id) {
+    if (newest_ts_[id] == kNoTs) {
+      newest_ts_[id] = ts_now;
+    } else if (ts_now > newest_ts_[id]) {
+      window_advance_(id, ts_now);
+    }
+    summarize_(id);
+  }
+  if (cfg_.recompute == RecomputeMode::PerTick && ts_now == last_tick_ts_) {
+    // Repeated tick: only interfaces with new samples are evaluated again.
+    for (InterfaceId id = 0; id < n; ++id) {
+      if (dirty_[id]) recompute_(id, ts_now);
+    }
+  } else {
+    // Interfaces are independent, so scoring a run of them in one vector
+    // pass and then stepping their FSMs in another is equivalent to
+    // recompute_() per interface; with a single profile the run is every
+    // interface.
+    for (InterfaceId first = 0; first < n;) {
+      const ProfileId p = profiles_.of(first);
+      InterfaceId end = first + 1;
+      while (end < n && profiles_.of(end) == p) ++end;
+      const ConfigProfile& prof = profiles_.get(p);
+      score_(first, end - first, prof.score);
+      evaluate_fsm_(first, end - first, ts_now, prof.fsm);
+      first = end;
+    }
+  }
+  if (cfg_.recompute == RecomputeMode::PerTick) std::fill(dirty_.begin(), dirty_.end(), uint8_t{0});
+  last_tick_ts_ = ts_now;
+}
+
+InterfaceSnapshot ColumnarTelemetryAgent::snapshot(InterfaceId id) const {
+  InterfaceSnapshot s;
+  s.iface = names_[id];
+  s.status = static_cast<IfStatus>(status_[id]);
+  s.score_raw = score_avg_[id];
+  s.score_smoothed = score_ewma_[id];
+  s.score_used = score_used_[id];
+  s.confidence = confidence_[id];
+  s.missing_rate = 1.0 - confidence_[id];
+  s.avg_tp_mbps = avg_tp_[id];
+  s.avg_rtt_ms = avg_rtt_[id];
+  s.avg_loss_pct = avg_loss_[id];
+  s.avg_jitter_ms = avg_jit_[id];
+  return s;
+}
+
+std::vector<InterfaceSnapshot> ColumnarTelemetryAgent::snapshots() const {
+  std::vector<InterfaceSnapshot> out;
+  out.reserve(names_.size());
+  for (InterfaceId id = 0; id < names_.size(); ++id) out.push_back(snapshot(id));
+  return out;
+}
+
+std::vector<TransitionEvent> ColumnarTelemetryAgent::drain_transitions() {
+  std::vector<TransitionEvent> out;
+  out.reserve(transitions_.size());
+  transitions_.drain([&out](const TransitionEvent& ev) { out.push_back(ev); });
+  return out;
+}
+
+void ColumnarTelemetryAgent::record_tick() {
+  for (std::size_t id = 0; id < score_used_.size(); ++id) {
+    score_sum_[id] += score_used_[id];
+    score_count_[id] += 1;
+  }
+}
+
+ProfileId ColumnarTelemetryAgent::add_profile(std::string_view name, const ConfigProfile& p) {
+  (void)means_only(p.score);
+  return profiles_.add(name, p);
+}
+
+void ColumnarTelemetryAgent::set_profile(ProfileId id, const ConfigProfile& p) {
+  (void)means_only(p.score);
+  profiles_.replace(id, p);
+}
+
+std::vector<TelemetryAgent::RunSummaryItem> ColumnarTelemetryAgent::summary_ranked() const {
+  std::vector<TelemetryAgent::RunSummaryItem> out;
+  out.reserve(names_.size());
+  for (InterfaceId id = 0; id < names_.size(); ++id) {
+    const int n = score_count_[id];
+    const double avg = (n > 0) ? (score_sum_[id] / n) : 0.0;
+    out.push_back(TelemetryAgent::RunSummaryItem{names_[id], avg, status(id)});
+  }
+  std::sort(out.begin(), out.end(),
+            [](const auto& a, const auto& b){ return a.avg_score > b.avg_score; });
+  return out;
+}
+
+} // namespace telemetry
@@ -0,0 +1,193 @@
+// compact_agent.cpp
+#include "compact_agent.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace telemetry {
+
+namespace {
+constexpr std::size_t kTp = DefaultMetrics::index_of<ThroughputMetric>();
+constexpr std::size_t kRtt = DefaultMetrics::index_of<RttMetric>();
+constexpr std::size_t kLoss = DefaultMetrics::index_of<LossMetric>();
+constexpr std::size_t kJit = DefaultMetrics::index_of<JitterMetric>();
+
+static_assert(RollingWindow::kWindow <= std::numeric_limits<uint8_t>::max(), "eval_count_ is 8-bit");
+
+void check_config(const AgentConfig& cfg) {
+  if (uses_window_quantiles(cfg.score)) {
+    throw std::invalid_argument("CompactTelemetryAgent: quantile scoring is not supported");
+  }
+}
+
+// InterfaceTracker::update_ewma_().
+double update_ewma(const ScoreConfig& c, double prev, double current) {
+  double ewma = c.ewma_alpha * current + (1.0 - c.ewma_alpha) * prev;
+  if (c.enable_downtrend_penalty && current < prev) ewma -= c.downtrend_penalty;
+  return InterfaceTracker::clamp01(ewma);
+}
+} // namespace
+
+// --- CompactInterfaceTracker (same pipeline as InterfaceTracker::recompute_) ---
+
+CompactInterfaceTracker::CompactInterfaceTracker(const AgentConfig* cfg) : cfg_(cfg) { check_config(*cfg_); }
+
+void CompactInterfaceTracker::recompute_(int64_t now_ts) {
+  dirty_ = false;
+  last_eval_ts_ = now_ts;
+  const auto s = window_.summary();
+  const ScoreConfig& c = cfg_->score;
+
+  score_avg_ = InterfaceTracker::clamp01(c.w_tp * normalize<ThroughputMetric>(s.avg[kTp], c.ranges.tp) +
+                                         c.w_rtt * normalize<RttMetric>(s.avg[kRtt], c.ranges.rtt) +
+                                         c.w_loss * normalize<LossMetric>(s.avg[kLoss], c.ranges.loss) +
+                                         c.w_jit * normalize<JitterMetric>(s.avg[kJit], c.ranges.jitter));
+
+  if (!have_ewma_) {
+    score_ewma_ = score_avg_;
+    have_ewma_ = true;
+  } else if (c.useEwma) {
+    score_ewma_ = update_ewma(c, score_ewma_, score_avg_);
+  } else {
+    score_ewma_ = score_avg_;
+  }
+
+  double candidate = c.useEwma ? score_ewma_ : score_avg_;
+  if (c.enable_confidence_cap && s.confidence < c.min_confidence_for_promotion) {
+    candidate = std::min(candidate, c.score_cap_when_low_conf);
+  }
+  score_used_ = candidate;
+
+  const IfStatus before = fsm_.status;
+  const FsmUpdate upd = fsm_update(cfg_->fsm, fsm_, now_ts, score_used_, s.confidence);
+  if (upd.transitioned) {
+    pending_ = upd.reason;
+    pending_from_ = before;
+  }
+
+  for (std::size_t k = 0; k < eval_avg_.size(); ++k) eval_avg_[k] = static_cast<float>(s.avg[k]);
+  eval_count_ = static_cast<uint8_t>(s.count);
+}
+
+CompactInterfaceTracker::Window::IngestResult CompactInterfaceTracker::ingest(int64_t ts, const Metrics& m) {
+  const auto v = RollingWindow::to_values(m);
+  const auto res = cfg_->same_second == SameSecond::Average ? window_.merge(ts, v) : window_.insert(ts, v);
+  dirty_ = true;
+  if (cfg_->recompute == RecomputeMode::Eager) recompute_(window_.newest_ts());
+  return res;
+}
+
+bool CompactInterfaceTracker::note_time(int64_t ts_now) {
+  window_.note_time(ts_now);
+  if (cfg_->recompute == RecomputeMode::PerTick && !dirty_ && ts_now == last_eval_ts_) return false;
+  recompute_(ts_now);
+  return true;
+}
+
+InterfaceSnapshot CompactInterfaceTracker::snapshot(std::string_view iface) const {
+  InterfaceSnapshot s;
+  s.iface = iface;
+  s.status = fsm_.status;
+  s.score_raw = score_avg_;
+  s.score_smoothed = score_ewma_;
+  s.score_used = score_used_;
+  s.confidence = confidence();
+  s.missing_rate = 1.0 - s.confidence;
+  s.avg_tp_mbps = eval_avg_[kTp];
+  s.avg_rtt_ms = eval_avg_[kRtt];
+  s.avg_loss_pct = eval_avg_[kLoss];
+  s.avg_jitter_ms = eval_avg_[kJit];
+  return s;
+}
+
+std::optional<TransitionEvent> CompactInterfaceTracker::drain_transition(InterfaceId id) {
+  if (pending_ == TransitionReason::None) return std::nullopt;
+  const TransitionEvent ev{id, fsm_.last_transition_ts, pending_from_, fsm_.status, pending_};
+  pending_ = TransitionReason::None;
+  return ev;
+}
+
+// --- CompactTelemetryAgent ---
+
+CompactTelemetryAgent::CompactTelemetryAgent(AgentConfig cfg, std::size_t reserve_ifaces,
+                                             TransitionLogConfig log)
+  : cfg_(std::make_unique<const AgentConfig>(cfg)), transitions_(log) {
+  check_config(*cfg_);
+  trackers_.reserve(reserve_ifaces);
+  index_.reserve(reserve_ifaces);
+  score_sum_.reserve(reserve_ifaces);
+  score_count_.reserve(reserve_ifaces);
+}
+
+InterfaceId CompactTelemetryAgent::register_interface(std::string_view iface) {
+  if (auto it = index_.find(iface); it != index_.end()) return it->second;
+
+  const auto id = static_cast<InterfaceId>(trackers_.size());
+  const std::string& name = names_.emplace_back(iface);
+  index_.emplace(name, id);
+  trackers_.emplace_back(cfg_.get());
+  score_sum_.push_back(0.0);
+  score_count_.push_back(0);
+  return id;
+}
+
+std::optional<InterfaceId> CompactTelemetryAgent::find_interface(std::string_view iface) const {
+  if (auto it = index_.find(iface); it != index_.end()) return it->second;
+  return std::nullopt;
+}
+
+void CompactTelemetryAgent::collect_(InterfaceId id) {
+  if (const auto ev = trackers_[id].drain_transition(id)) transitions_.push(*ev);
+}
+
+void CompactTelemetryAgent::ingest(InterfaceId id, int64_t ts, const Metrics& m) {
+  trackers_[id].ingest(ts, m);
+  collect_(id);
+}
+
+void CompactTelemetryAgent::ingest(const std::string& iface, int64_t ts, const Metrics& m) {
+  ingest(register_interface(iface), ts, m);
+}
+
+void CompactTelemetryAgent::note_time(int64_t ts_now) {
+  const auto n = static_cast<InterfaceId>(trackers_.size());
+  for (InterfaceId id = 0; id < n; ++id) {
+    if (trackers_[id].note_time(ts_now)) collect_(id);
+  }
+}
+
+std::vector<InterfaceSnapshot> CompactTelemetryAgent::snapshots() const {
+  std::vector<InterfaceSnapshot> out;
+  out.reserve(trackers_.size());
+  for (InterfaceId id = 0; id < trackers_.size(); ++id) out.push_back(snapshot(id));
+  return out;
+}
+
+std::vector<TransitionEvent> CompactTelemetryAgent::drain_transitions() {
+  std::vector<TransitionEvent> out;
+  out.reserve(transitions_.size());
+  transitions_.drain([&out](const TransitionEvent& ev) { out.push_back(ev); });
+  return out;
+}
+
+void CompactTelemetryAgent::record_tick() {
+  for (std::size_t id = 0; id < trackers_.size(); ++id) {
+    score_sum_[id] += trackers_[id].score_used();
+    score_count_[id] += 1;
+  }
+}
+
+std::vector<TelemetryAgent::RunSummaryItem> CompactTelemetryAgent::summary_ranked() const {
+  std::vector<TelemetryAgent::RunSummaryItem> out;
+  out.reserve(trackers_.size());
+  for (InterfaceId id = 0; id < trackers_.size(); ++id) {
+    const int n = score_count_[id];
+    const double avg = (n > 0) ? (score_sum_[id] / n) : 0.0;
+    out.push_back(TelemetryAgent::RunSummaryItem{names_[id], avg, status(id)});
+  }
+  std::sort(out.begin(), out.end(),
+            [](const auto& a, const auto& b){ return a.avg_score > b.avg_score; });
+  return out;
+}
+
+} // namespace telemetry
@@ -0,0 +1,109 @@
+// config_profile.cpp
+#include "config_profile.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace telemetry {
+
+namespace {
+constexpr std::size_t kMaxProfiles = 65536;
+
+void check_range(const MetricRange& r, const char* metric) {
+  if (!(std::isfinite(r.lo) && std::isfinite(r.hi) && r.hi > r.lo)) {
+    std::string msg = "ConfigProfile: bad ";
+    msg += metric;
+    msg += " range";
+    throw std::invalid_argument(msg);
+  }
+}
+} // namespace
+
+ConfigProfile wired_profile() { return ConfigProfile{}; }
+
+ConfigProfile cellular_profile() {
+  ConfigProfile p;
+  p.score.ranges.tp = {0.0, 100.0};
+  p.score.ranges.rtt = {30.0, 1500.0};
+  p.score.ranges.jitter = {0.0, 400.0};
+  p.score.ewma_alpha = 0.15;
+  p.fsm.healthy_enter_N = 8;
+  p.fsm.healthy_exit_N = 8;
+  p.fsm.down_enter_N = 5;
+  p.fsm.down_exit_N = 8;
+  p.fsm.min_dwell_sec = 10;
+  return p;
+}
+
+ConfigProfile satellite_profile() {
+  ConfigProfile p;
+  p.score.ranges.tp = {0.0, 50.0};
+  p.score.ranges.rtt = {450.0, 2000.0}; // geostationary hops start near 500 ms
+  p.score.ranges.jitter = {0.0, 300.0};
+  p.score.ewma_alpha = 0.10;
+  p.fsm.healthy_enter_N = 10;
+  p.fsm.healthy_exit_N = 10;
+  p.fsm.down_enter_N = 6;
+  p.fsm.down_exit_N = 10;
+  p.fsm.min_dwell_sec = 15;
+  return p;
+}
+
+void check_profile(const ConfigProfile& p) {
+  check_range(p.score.ranges.tp, ThroughputMetric::name);
+  check_range(p.score.ranges.rtt, RttMetric::name);
+  check_range(p.score.ranges.loss, LossMetric::name);
+  check_range(p.score.ranges.jitter, JitterMetric::name);
+}
+
+ProfileTable::ProfileTable(const ConfigProfile& default_profile) {
+  check_profile(default_profile);
+  slots_.push_back(Slot{"default", std::make_unique<ConfigProfile>(default_profile), {}});
+}
+
+ProfileId ProfileTable::add(std::string_view name, const ConfigProfile& p) {
+  if (const auto id = find(name)) {
+    if (get(*id) != p) throw std::invalid_argument("ProfileTable: name taken by a different profile");
+    return *id;
+  }
+  check_profile(p);
+  if (slots_.size() >= kMaxProfiles) throw std::length_error("ProfileTable: too many profiles");
+  slots_.push_back(Slot{std::string(name), std::make_unique<ConfigProfile>(p), {}});
+  return static_cast<ProfileId>(slots_.size() - 1);
+}
+
+std::optional<ProfileId> ProfileTable::find(std::string_view name) const {
+  for (std::size_t i = 0; i < slots_.size(); ++i) {
+    if (slots_[i].name == name) return static_cast<ProfileId>(i);
+  }
+  return std::nullopt;
+}
+
+void ProfileTable::replace(ProfileId id, const ConfigProfile& p) {
+  check_profile(p);
+  *slots_[id].profile = p;
+}
+
+void ProfileTable::reserve(std::size_t interfaces) {
+  of_.reserve(interfaces);
+  slots_[kDefaultProfile].members.reserve(interfaces);
+}
+
+void ProfileTable::add_member(InterfaceId id) {
+  of_.push_back(kDefaultProfile);
+  slots_[kDefaultProfile].members.push_back(id);
+}
+
+ProfileId ProfileTable::assign(InterfaceId id, ProfileId p) {
+  const ProfileId old = of_[id];
+  if (old == p) return old;
+  auto& from = slots_[old].members;
+  from.erase(std::lower_bound(from.begin(), from.end(), id));
+  auto& to = slots_[p].members;
+  to.insert(std::lower_bound(to.begin(), to.end(), id), id);
+  of_[id] = p;
+  return old;
+}
+
+} // namespace telemetry
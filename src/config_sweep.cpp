@@ -0,0 +1,305 @@
+// config_sweep.cpp
+#include "config_sweep.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace telemetry {
+
+namespace {
+
+int severity(IfStatus s) {
+  switch (s) {
+    case IfStatus::Healthy: return 0;
+    case IfStatus::Degraded: return 1;
+    case IfStatus::Down: return 2;
+  }
+  return 1;
+}
+
+// Feeds the trace to agent through the recorded calls; on_event sees every
+// transition as it is drained and on_tick runs after each tick's transitions.
+template <typename OnEvent, typename OnTick>
+void replay(TelemetryAgent& agent, const SweepTrace& trace, OnEvent&& on_event, OnTick&& on_tick) {
+  for (const std::string& name : trace.names()) agent.register_interface(name);
+  std::vector<Sample> batch;
+  bool in_batch = false;
+  for (const TraceRecord& r : trace.records()) {
+    if (r.is_sample()) {
+      if (in_batch) {
+        batch.push_back(Sample{r.iface, r.ts, r.metrics()});
+      } else {
+        agent.ingest(r.iface, r.ts, r.metrics());
+      }
+      continue;
+    }
+    if (r.iface == TraceRecord::kBatchBegin) {
+      in_batch = true;
+      continue;
+    }
+    if (r.iface == TraceRecord::kBatchEnd) {
+      agent.ingest_batch(batch);
+      batch.clear();
+      in_batch = false;
+      continue;
+    }
+    agent.note_time(r.ts);
+    agent.drain_transitions(on_event);
+    on_tick(r.ts);
+  }
+  if (!batch.empty()) agent.ingest_batch(batch);
+  agent.drain_transitions(on_event);
+}
+
+// Per-worker deques: the owner pops from the back, idle workers steal from
+// the front of the others. Tasks never spawn tasks, so a worker that finds
+// every deque empty is done.
+class StealingPool {
+public:
+  StealingPool(std::size_t tasks, unsigned workers) : queues_(workers) {
+    const std::size_t per = (tasks + workers - 1) / workers;
+    for (std::size_t i = 0; i < tasks; ++i) queues_[i / per].q.push_back(i);
+  }
+
+  template <typename Fn>
+  void run(const Fn& fn) {
+    std::vector<std::thread> threads;
+    threads.reserve(queues_.size());
+    for (std::size_t w = 0; w < queues_.size(); ++w) {
+      threads.emplace_back([this, w, &fn] { work_(w, fn); });
+    }
+    for (auto& t : threads) t.join();
+    if (error_) std::rethrow_exception(error_);
+  }
+
+private:
+  struct Queue {
+    std::mutex m;
+    std::deque<std::size_t> q;
+  };
+
+  std::optional<std::size_t> pop_(std::size_t w) {
+    {
+      Queue& own = queues_[w];
+      std::lock_guard<std::mutex> lock(own.m);
+      if (!own.q.empty()) {
+        const std::size_t i = own.q.back();
+        own.q.pop_back();
+        return i;
+      }
+    }
+    for (std::size_t k = 1; k < queues_.size(); ++k) {
+      Queue& victim = queues_[(w + k) % queues_.size()];
+      std::lock_guard<std::mutex> lock(victim.m);
+      if (!victim.q.empty()) {
+        const std::size_t i = victim.q.front();
+        victim.q.pop_front();
+        return i;
+      }
+    }
+    return std::nullopt;
+  }
+
+  template <typename Fn>
+  void work_(std::size_t w, const Fn& fn) {
+    while (const auto i = pop_(w)) {
+      try {
+        fn(*i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_m_);
+        if (!error_) error_ = std::current_exception();
+      }
+    }
+  }
+
+  std::deque<Queue> queues_; // deque: Queue holds a mutex and cannot move
+  std::mutex error_m_;
+  std::exception_ptr error_;
+};
+
+} // namespace
+
+SweepTrace SweepTrace::view(const TraceReader& reader) {
+  SweepTrace t;
+  t.external_ = reader.records();
+  t.names_ = reader.names();
+  t.index_();
+  return t;
+}
+
+SweepTrace SweepTrace::scenario(ScenarioId sid, int seconds, ImperfectDataConfig imp) {
+  SweepTrace t;
+  t.names_ = {"eth0", "wifi0", "lte0", "sat0"};
+  const ScenarioGenerator gen(sid, imp);
+  t.owned_.reserve(static_cast<std::size_t>(std::max(0, seconds)) * (1 + t.names_.size()));
+  for (int64_t s = 0; s < seconds; ++s) {
+    t.owned_.push_back(TraceRecord{TraceRecord::kTick, 0, s, 0.0, 0.0, 0.0, 0.0});
+    for (InterfaceId id = 0; id < t.names_.size(); ++id) {
+      const auto g = gen.sample(t.names_[id], s);
+      if (!g) continue;
+      t.owned_.push_back(TraceRecord{id, 0, g->ts, g->m.rtt_ms, g->m.throughput_mbps, g->m.loss_pct, g->m.jitter_ms});
+    }
+  }
+  t.index_();
+  return t;
+}
+
+// Sample ids are below names_.size(): TraceReader rejects a trace whose
+// samples name an unlisted interface, and scenario() names all of its own.
+void SweepTrace::index_() {
+  for (std::size_t id = 0; id < names_.size(); ++id) {
+    if (names_[id].empty()) names_[id] = "if" + std::to_string(id);
+  }
+}
+
+SweepResult evaluate(const SweepTrace& trace, const AgentConfig& cfg, const SweepOptions& opt) {
+  const std::size_t n = trace.interfaces();
+  SweepResult out;
+
+  struct IfaceState {
+    IfStatus status = IfStatus::Degraded;
+    int64_t since = 0;     // when status was entered (or the first record)
+    bool moved = false;    // has transitioned at least once
+    IfStatus before = IfStatus::Degraded; // status left by the last transition
+    int64_t last_ts = 0;
+    std::vector<std::size_t> incidents; // indices into opt.incidents
+  };
+  std::vector<IfaceState> st(n);
+  std::vector<bool> done(opt.incidents.size(), false);
+  std::vector<std::size_t> by_start(opt.incidents.size());
+  for (std::size_t k = 0; k < opt.incidents.size(); ++k) {
+    by_start[k] = k;
+    if (opt.incidents[k].id < n) st[opt.incidents[k].id].incidents.push_back(k);
+  }
+  std::sort(by_start.begin(), by_start.end(), [&](std::size_t a, std::size_t b) {
+    return opt.incidents[a].start_ts < opt.incidents[b].start_ts;
+  });
+  std::size_t armed = 0;
+  int64_t ttd_sum = 0;
+
+  const auto detect = [&](std::size_t k, int64_t ts) {
+    const int64_t ttd = std::max<int64_t>(0, ts - opt.incidents[k].start_ts);
+    done[k] = true;
+    ++out.detected;
+    ttd_sum += ttd;
+    out.max_ttd_sec = std::max(out.max_ttd_sec, ttd);
+  };
+
+  const auto records = trace.records();
+  const bool started = !records.empty();
+  const int64_t first_ts = started ? records.front().ts : 0;
+  int64_t last_ts = first_ts;
+  for (IfaceState& s : st) s.since = first_ts;
+  const auto on_event = [&](const TransitionEvent& ev) {
+    IfaceState& s = st[ev.id];
+    ++out.transitions;
+    if (s.moved && ev.to == s.before && ev.ts - s.last_ts <= opt.flap_window_sec) ++out.flaps;
+    out.status_seconds[static_cast<int>(s.status)] += std::max<int64_t>(0, ev.ts - s.since);
+    s.before = s.status;
+    s.status = ev.to;
+    s.since = ev.ts;
+    s.last_ts = ev.ts;
+    s.moved = true;
+    for (const std::size_t k : s.incidents) {
+      if (!done[k] && opt.incidents[k].start_ts <= ev.ts && severity(ev.to) >= severity(opt.incidents[k].expect)) {
+        detect(k, ev.ts);
+      }
+    }
+  };
+  const auto on_tick = [&](int64_t ts) {
+    last_ts = std::max(last_ts, ts);
+    // Incidents starting now that the config had already reached.
+    for (; armed < by_start.size() && opt.incidents[by_start[armed]].start_ts <= ts; ++armed) {
+      const std::size_t k = by_start[armed];
+      const SweepIncident& inc = opt.incidents[k];
+      if (!done[k] && inc.id < n && severity(st[inc.id].status) >= severity(inc.expect)) detect(k, inc.start_ts);
+    }
+  };
+
+  TelemetryAgent agent(cfg);
+  replay(agent, trace, on_event, on_tick);
+
+  const int64_t end = started ? last_ts + 1 : 0;
+  for (const IfaceState& s : st) {
+    if (started) out.status_seconds[static_cast<int>(s.status)] += std::max<int64_t>(0, end - s.since);
+  }
+  out.missed = opt.incidents.size() - out.detected;
+  if (out.detected > 0) out.mean_ttd_sec = static_cast<double>(ttd_sum) / static_cast<double>(out.detected);
+  const double iface_hours = static_cast<double>(n) * static_cast<double>(end - first_ts) / 3600.0;
+  if (iface_hours > 0.0) out.flaps_per_iface_hour = static_cast<double>(out.flaps) / iface_hours;
+  return out;
+}
+
+std::vector<SweepResult> run_sweep(const SweepTrace& trace, std::span<const AgentConfig> configs,
+                                   const SweepOptions& opt) {
+  std::vector<SweepResult> out(configs.size());
+  unsigned workers = opt.threads != 0 ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+  workers = static_cast<unsigned>(std::min<std::size_t>(workers, configs.size()));
+  if (workers <= 1) {
+    for (std::size_t i = 0; i < configs.size(); ++i) out[i] = evaluate(trace, configs[i], opt);
+    return out;
+  }
+  StealingPool pool(configs.size(), workers);
+  pool.run([&](std::size_t i) { out[i] = evaluate(trace, configs[i], opt); });
+  return out;
+}
+
+std::vector<AgentConfig> expand(const AgentConfig& base, const FsmGrid& grid) {
+  std::vector<AgentConfig> out{base};
+  // Multiplies the current points by one axis.
+  const auto axis = [&out](const auto& values, auto field) {
+    if (values.empty()) return;
+    std::vector<AgentConfig> next;
+    next.reserve(out.size() * values.size());
+    for (const AgentConfig& c : out) {
+      for (const auto& v : values) {
+        next.push_back(c);
+        next.back().fsm.*field = v;
+      }
+    }
+    out = std::move(next);
+  };
+  axis(grid.healthy_enter, &FsmConfig::healthy_enter);
+  axis(grid.healthy_exit, &FsmConfig::healthy_exit);
+  axis(grid.down_enter, &FsmConfig::down_enter);
+  axis(grid.down_exit, &FsmConfig::down_exit);
+  axis(grid.healthy_enter_N, &FsmConfig::healthy_enter_N);
+  axis(grid.healthy_exit_N, &FsmConfig::healthy_exit_N);
+  axis(grid.down_enter_N, &FsmConfig::down_enter_N);
+  axis(grid.down_exit_N, &FsmConfig::down_exit_N);
+  axis(grid.min_dwell_sec, &FsmConfig::min_dwell_sec);
+
+  std::erase_if(out, [](const AgentConfig& c) {
+    const FsmConfig& f = c.fsm;
+    return !(f.down_enter <= f.down_exit && f.down_exit < f.healthy_exit && f.healthy_exit <= f.healthy_enter);
+  });
+  return out;
+}
+
+AgentConfig sharp_reference(AgentConfig base) {
+  base.score.useEwma = false;
+  base.fsm.healthy_enter_N = 1;
+  base.fsm.healthy_exit_N = 1;
+  base.fsm.down_enter_N = 1;
+  base.fsm.down_exit_N = 1;
+  base.fsm.min_dwell_sec = 0;
+  return base;
+}
+
+std::vector<SweepIncident> reference_incidents(const SweepTrace& trace, const AgentConfig& reference) {
+  std::vector<SweepIncident> out;
+  TelemetryAgent agent(reference);
+  replay(
+    agent, trace,
+    [&](const TransitionEvent& ev) {
+      if (severity(ev.to) > severity(ev.from)) out.push_back(SweepIncident{ev.id, ev.ts, ev.to});
+    },
+    [](int64_t) {});
+  return out;
+}
+
+} // namespace telemetry
@@ -0,0 +1,125 @@
+// fleet_generator.cpp
+#include "fleet_generator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace telemetry {
+
+namespace {
+
+uint64_t mix(uint64_t x) { // splitmix64 finaliser
+  x += 0x9E3779B97F4A7C15ull;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+  return x ^ (x >> 31);
+}
+
+double unit(uint64_t h) { return static_cast<double>(h >> 11) * 0x1p-53; } // [0, 1)
+
+int64_t pos_mod(int64_t a, int64_t n) {
+  const int64_t r = a % n;
+  return r < 0 ? r + n : r;
+}
+
+} // namespace
+
+const char* fleet_profile_name(FleetProfile p) {
+  switch (p) {
+    case FleetProfile::Stable: return "stable";
+    case FleetProfile::Ramp: return "ramp";
+    case FleetProfile::Spike: return "spike";
+    case FleetProfile::Noisy: return "noisy";
+  }
+  return "?";
+}
+
+FleetGenerator::FleetGenerator(FleetConfig cfg) : cfg_(cfg) {
+  if (!(cfg.missing_rate >= 0.0 && cfg.missing_rate <= 1.0) || !(cfg.late_rate >= 0.0 && cfg.late_rate <= 1.0)) {
+    throw std::invalid_argument("FleetGenerator: rates must be in [0, 1]");
+  }
+  if (cfg.ramp_period_sec <= 0 || cfg.spike_period_sec <= 0 || cfg.spike_len_sec <= 0 || cfg.late_by_sec < 0) {
+    throw std::invalid_argument("FleetGenerator: periods and spike length must be positive");
+  }
+
+  params_.resize(cfg.interfaces);
+  for (std::size_t id = 0; id < params_.size(); ++id) {
+    Params& p = params_[id];
+    const uint64_t h = mix(cfg.seed ^ mix(id));
+    const double scale = 0.8 + 0.4 * unit(h); // baseline spread across the fleet
+    const uint64_t phase = mix(h);
+    p.ramp_phase = static_cast<int32_t>(phase % static_cast<uint64_t>(cfg.ramp_period_sec));
+    p.spike_phase = static_cast<int32_t>(phase % static_cast<uint64_t>(cfg.spike_period_sec));
+
+    auto set = [](double (&dst)[4], double rtt, double tp, double loss, double jit) {
+      dst[0] = rtt;
+      dst[1] = tp;
+      dst[2] = loss;
+      dst[3] = jit;
+    };
+    switch (profile(static_cast<InterfaceId>(id))) {
+      case FleetProfile::Stable:
+        set(p.base, 20 * scale, 180 / scale, 0.1, 3 * scale);
+        set(p.noise, 2, 10, 0.1, 1);
+        break;
+      case FleetProfile::Ramp: // to {600, 5, 25, 150} at the bottom
+        set(p.base, 35 * scale, 110 / scale, 0.5, 6 * scale);
+        set(p.ramp, 600 - p.base[0], 5 - p.base[1], 24.5, 150 - p.base[3]);
+        set(p.noise, 4, 8, 0.2, 2);
+        break;
+      case FleetProfile::Spike: // to {350, 90, 10, 70} during a spike
+        set(p.base, 35 * scale, 110 / scale, 0.5, 6 * scale);
+        set(p.spike, 350 - p.base[0], 90 - p.base[1], 9.5, 70 - p.base[3]);
+        set(p.noise, 4, 8, 0.2, 2);
+        break;
+      case FleetProfile::Noisy:
+        set(p.base, 95 * scale, 160 / scale, 8.0, 60 * scale);
+        set(p.noise, 80, 120, 8.0, 60);
+        break;
+    }
+  }
+}
+
+std::size_t FleetGenerator::tick(int64_t t, std::span<Sample> out) const {
+  if (out.size() < params_.size()) throw std::length_error("FleetGenerator::tick: output shorter than size()");
+  const int32_t ramp_period = cfg_.ramp_period_sec;
+  const int32_t spike_period = cfg_.spike_period_sec;
+  const auto ramp_t = static_cast<int32_t>(pos_mod(t, ramp_period));
+  const auto spike_t = static_cast<int32_t>(pos_mod(t, spike_period));
+  const double inv_ramp = 1.0 / static_cast<double>(ramp_period);
+  const uint64_t tick_key = mix(cfg_.seed + static_cast<uint64_t>(t) * 0xD1B54A32D192ED03ull);
+
+  std::size_t n = 0;
+  for (std::size_t id = 0; id < params_.size(); ++id) {
+    const Params& p = params_[id];
+    const uint64_t h = mix(tick_key ^ id);
+    if (unit(h) < cfg_.missing_rate) continue;
+    const uint64_t h_late = mix(h);
+    const uint64_t h_noise = mix(h_late);
+
+    // Ramp: degrade over 30% of the period, hold 30%, recover over 20%,
+    // good for the rest. Spikes are 0 or 1.
+    int32_t r = ramp_t + p.ramp_phase;
+    if (r >= ramp_period) r -= ramp_period;
+    int32_t sp = spike_t + p.spike_phase;
+    if (sp >= spike_period) sp -= spike_period;
+    const double x = static_cast<double>(r) * inv_ramp;
+    const double ramp = std::clamp(std::min(x / 0.3, (0.8 - x) / 0.2), 0.0, 1.0);
+    const double spike = sp < cfg_.spike_len_sec ? 1.0 : 0.0;
+
+    double v[4];
+    for (int k = 0; k < 4; ++k) {
+      const double noise = static_cast<double>((h_noise >> (16 * k)) & 0xFFFF) / 65535.0 - 0.5;
+      v[k] = std::max(0.0, p.base[k] + ramp * p.ramp[k] + spike * p.spike[k] + noise * p.noise[k]);
+    }
+
+    Sample& s = out[n++];
+    s.id = static_cast<InterfaceId>(id);
+    s.ts = unit(h_late) < cfg_.late_rate ? t - cfg_.late_by_sec : t;
+    s.m = Metrics{v[0], v[1], v[2], v[3]};
+  }
+  return n;
+}
+
+} // namespace telemetry
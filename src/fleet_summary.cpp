@@ -0,0 +1,379 @@
+// fleet_summary.cpp
+#include "fleet_summary.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace telemetry {
+
+static_assert(ValueSketch::kBuckets <= 256, "bucket indices are encoded as uint8");
+
+namespace {
+
+constexpr uint32_t kPushMagic = 0x444D4C54; // "TLMD"
+constexpr uint16_t kPushVersion = 1;
+constexpr uint32_t kEndian = 0x01020304;
+
+template <typename T>
+void put(std::vector<std::byte>& out, const T& v) {
+  const std::size_t at = out.size();
+  out.resize(at + sizeof(T));
+  std::memcpy(out.data() + at, &v, sizeof(T));
+}
+
+template <typename T>
+bool get(std::span<const std::byte>& in, T& v) {
+  if (in.size() < sizeof(T)) return false;
+  std::memcpy(&v, in.data(), sizeof(T));
+  in = in.subspan(sizeof(T));
+  return true;
+}
+
+void put_string(std::vector<std::byte>& out, std::string_view s) {
+  if (s.size() > 0xFFFF) throw std::length_error("encode_push: name longer than 65535 bytes");
+  put(out, static_cast<uint16_t>(s.size()));
+  const std::size_t at = out.size();
+  out.resize(at + s.size());
+  std::memcpy(out.data() + at, s.data(), s.size());
+}
+
+bool get_string(std::span<const std::byte>& in, std::string& s) {
+  uint16_t n = 0;
+  if (!get(in, n) || in.size() < n) return false;
+  s.assign(reinterpret_cast<const char*>(in.data()), n);
+  in = in.subspan(n);
+  return true;
+}
+
+void put_sketch(std::vector<std::byte>& out, const ValueSketch& s) {
+  uint16_t n = 0;
+  s.for_each_bucket([&n](std::size_t, uint32_t) { ++n; });
+  put(out, n);
+  put(out, s.min());
+  put(out, s.max());
+  s.for_each_bucket([&out](std::size_t i, uint32_t c) {
+    put(out, static_cast<uint8_t>(i));
+    put(out, c);
+  });
+}
+
+bool get_sketch(std::span<const std::byte>& in, ValueSketch& s) {
+  uint16_t n = 0;
+  double lo = 0.0, hi = 0.0;
+  if (!get(in, n) || !get(in, lo) || !get(in, hi)) return false;
+  int prev = -1;
+  for (uint16_t k = 0; k < n; ++k) {
+    uint8_t i = 0;
+    uint32_t c = 0;
+    if (!get(in, i) || !get(in, c)) return false;
+    if (i >= ValueSketch::kBuckets || static_cast<int>(i) <= prev || c == 0) return false;
+    prev = i;
+    s.add_bucket(i, c);
+  }
+  if (n > 0 && !(lo <= hi)) return false;
+  s.set_range(lo, hi);
+  return true;
+}
+
+} // namespace
+
+// --- ValueSketch -----------------------------------------------------------
+
+std::size_t ValueSketch::index_(double x) {
+  if (!(x >= std::ldexp(1.0, kMinExp))) return 0; // zero, tiny (and negative)
+  int exp = 0;
+  const double f = std::frexp(x, &exp); // x = f * 2^exp, f in [0.5, 1)
+  const int e = exp - 1;
+  if (e >= kMaxExp) return kBuckets - 1;
+  const auto sub = static_cast<std::size_t>((2.0 * f - 1.0) * kSub);
+  return 1 + static_cast<std::size_t>(e - kMinExp) * kSub + std::min<std::size_t>(sub, kSub - 1);
+}
+
+double ValueSketch::lower_bound_(std::size_t i) {
+  if (i == 0) return 0.0;
+  const std::size_t j = i - 1;
+  const int e = kMinExp + static_cast<int>(j / kSub);
+  return std::ldexp(1.0 + static_cast<double>(j % kSub) / kSub, e);
+}
+
+void ValueSketch::add(double x, uint32_t n) {
+  if (std::isnan(x) || n == 0) return;
+  x = std::max(0.0, x);
+  buckets_[index_(x)] += n;
+  if (count_ == 0) {
+    min_ = max_ = x;
+  } else {
+    min_ = std::min(min_, x);
+    max_ = std::max(max_, x);
+  }
+  count_ += n;
+}
+
+void ValueSketch::merge(const ValueSketch& o) {
+  if (o.count_ == 0) return;
+  for (std::size_t i = 0; i < kBuckets; ++i) buckets_[i] += o.buckets_[i];
+  min_ = count_ ? std::min(min_, o.min_) : o.min_;
+  max_ = count_ ? std::max(max_, o.max_) : o.max_;
+  count_ += o.count_;
+}
+
+void ValueSketch::add_bucket(std::size_t i, uint32_t count) {
+  buckets_[i] += count;
+  count_ += count;
+}
+
+void ValueSketch::set_range(double lo, double hi) {
+  min_ = lo;
+  max_ = hi;
+}
+
+double ValueSketch::quantile(double q) const {
+  if (count_ == 0) return 0.0;
+  const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(count_))));
+  uint64_t seen = 0;
+  std::size_t i = 0;
+  for (; i + 1 < kBuckets; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) break;
+  }
+  if (i == 0) return min_;              // below 2^kMinExp
+  if (i + 1 == kBuckets) return max_;   // at or past 2^kMaxExp
+  return std::clamp(0.5 * (lower_bound_(i) + lower_bound_(i + 1)), min_, max_);
+}
+
+// --- WindowDigest ----------------------------------------------------------
+
+void WindowDigest::add(const InterfaceTracker& tr) {
+  using M = DefaultMetrics;
+  constexpr std::size_t kRtt = M::index_of<RttMetric>();
+  constexpr std::size_t kTp = M::index_of<ThroughputMetric>();
+  constexpr std::size_t kLoss = M::index_of<LossMetric>();
+  constexpr std::size_t kJit = M::index_of<JitterMetric>();
+
+  tr.window().storage().for_each_second([this](const RollingWindow::Storage::Second& s) {
+    ++seconds;
+    newest_ts = std::max(newest_ts, s.ts);
+    rtt_sum += s.v[kRtt];
+    throughput_sum += s.v[kTp];
+    loss_sum += s.v[kLoss];
+    jitter_sum += s.v[kJit];
+    max_loss_pct = std::max(max_loss_pct, s.v[kLoss]);
+    rtt_ms.add(s.v[kRtt]);
+    jitter_ms.add(s.v[kJit]);
+  });
+  ++interfaces;
+  ++status_counts[static_cast<std::size_t>(tr.snapshot().status)];
+  score_used_sum += tr.snapshot().score_used;
+}
+
+void WindowDigest::merge(const WindowDigest& o) {
+  interfaces += o.interfaces;
+  seconds += o.seconds;
+  newest_ts = std::max(newest_ts, o.newest_ts);
+  rtt_sum += o.rtt_sum;
+  throughput_sum += o.throughput_sum;
+  loss_sum += o.loss_sum;
+  jitter_sum += o.jitter_sum;
+  max_loss_pct = std::max(max_loss_pct, o.max_loss_pct);
+  score_used_sum += o.score_used_sum;
+  for (std::size_t i = 0; i < kStatuses; ++i) status_counts[i] += o.status_counts[i];
+  rtt_ms.merge(o.rtt_ms);
+  jitter_ms.merge(o.jitter_ms);
+}
+
+double WindowDigest::confidence() const {
+  if (interfaces == 0) return 0.0;
+  return static_cast<double>(seconds) / (static_cast<double>(interfaces) * RollingWindow::kWindow);
+}
+
+void WindowDigest::encode(std::vector<std::byte>& out) const {
+  put(out, interfaces);
+  for (const uint32_t c : status_counts) put(out, c);
+  put(out, seconds);
+  put(out, newest_ts);
+  for (const double v : {rtt_sum, throughput_sum, loss_sum, jitter_sum, max_loss_pct, score_used_sum}) put(out, v);
+  put_sketch(out, rtt_ms);
+  put_sketch(out, jitter_ms);
+}
+
+std::optional<WindowDigest> WindowDigest::decode(std::span<const std::byte>& in) {
+  WindowDigest d;
+  std::span<const std::byte> p = in;
+  bool ok = get(p, d.interfaces);
+  for (uint32_t& c : d.status_counts) ok = ok && get(p, c);
+  ok = ok && get(p, d.seconds) && get(p, d.newest_ts);
+  for (double* v : {&d.rtt_sum, &d.throughput_sum, &d.loss_sum, &d.jitter_sum, &d.max_loss_pct, &d.score_used_sum}) {
+    ok = ok && get(p, *v);
+  }
+  ok = ok && get_sketch(p, d.rtt_ms) && get_sketch(p, d.jitter_ms);
+  if (!ok) return std::nullopt;
+
+  uint64_t statuses = 0;
+  for (const uint32_t c : d.status_counts) statuses += c;
+  const uint64_t capacity = uint64_t{d.interfaces} * RollingWindow::kWindow;
+  if (statuses != d.interfaces || d.seconds > capacity || d.rtt_ms.count() > d.seconds ||
+      d.jitter_ms.count() > d.seconds) { // sketches skip NaN seconds
+    return std::nullopt;
+  }
+  in = p;
+  return d;
+}
+
+// --- pushes ----------------------------------------------------------------
+
+DigestPush make_push(const TelemetryAgent& agent, std::string site, std::string node, int64_t tick_ts,
+                     const GroupOf& group_of) {
+  std::map<std::string, WindowDigest, std::less<>> groups;
+  for (InterfaceId id = 0; id < agent.size(); ++id) {
+    const std::string_view name = group_of ? group_of(id) : std::string_view(agent.tracker(id).iface());
+    if (name.empty()) continue;
+    auto it = groups.find(name);
+    if (it == groups.end()) it = groups.emplace(std::string(name), WindowDigest{}).first;
+    it->second.add(agent.tracker(id));
+  }
+  DigestPush push{std::move(site), std::move(node), tick_ts, {}};
+  push.groups.reserve(groups.size());
+  for (auto& [name, d] : groups) push.groups.emplace_back(name, d);
+  return push;
+}
+
+void encode_push(const DigestPush& push, std::vector<std::byte>& out) {
+  if (push.groups.size() > 0xFFFF) throw std::length_error("encode_push: more than 65535 groups");
+  out.clear();
+  put(out, kPushMagic);
+  put(out, kPushVersion);
+  put(out, static_cast<uint16_t>(push.groups.size()));
+  put(out, kEndian);
+  put(out, push.tick_ts);
+  put_string(out, push.site);
+  put_string(out, push.node);
+  for (const auto& [name, d] : push.groups) {
+    put_string(out, name);
+    d.encode(out);
+  }
+}
+
+std::optional<DigestPush> decode_push(std::span<const std::byte> in) {
+  uint32_t magic = 0, endian = 0;
+  uint16_t version = 0, groups = 0;
+  DigestPush push;
+  if (!get(in, magic) || !get(in, version) || !get(in, groups) || !get(in, endian) || !get(in, push.tick_ts)) {
+    return std::nullopt;
+  }
+  if (magic != kPushMagic || version != kPushVersion || endian != kEndian) return std::nullopt;
+  if (!get_string(in, push.site) || !get_string(in, push.node)) return std::nullopt;
+  push.groups.reserve(groups);
+  for (uint16_t g = 0; g < groups; ++g) {
+    std::string name;
+    if (!get_string(in, name)) return std::nullopt;
+    if (!push.groups.empty() && !(push.groups.back().first < name)) return std::nullopt; // sorted, unique
+    auto d = WindowDigest::decode(in);
+    if (!d) return std::nullopt;
+    push.groups.emplace_back(std::move(name), *d);
+  }
+  if (!in.empty()) return std::nullopt;
+  return push;
+}
+
+// --- FleetAggregator -------------------------------------------------------
+
+bool FleetAggregator::ingest(std::span<const std::byte> datagram) {
+  auto push = decode_push(datagram);
+  if (!push) {
+    ++stats_.bad;
+    return false;
+  }
+  return ingest(std::move(*push));
+}
+
+bool FleetAggregator::ingest(DigestPush push) {
+  auto& g = push.groups;
+  const auto not_ascending = [](const auto& a, const auto& b) { return !(a.first < b.first); };
+  if (std::adjacent_find(g.begin(), g.end(), not_ascending) != g.end()) {
+    std::stable_sort(g.begin(), g.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    std::size_t out = 0;
+    for (std::size_t i = 0; i < g.size(); ++i) {
+      if (out > 0 && g[out - 1].first == g[i].first) {
+        g[out - 1].second.merge(g[i].second);
+      } else {
+        if (out != i) g[out] = std::move(g[i]);
+        ++out;
+      }
+    }
+    g.resize(out);
+  }
+
+  Nodes& nodes = sites_[push.site];
+  auto it = nodes.find(push.node);
+  if (it != nodes.end()) {
+    if (push.tick_ts < it->second.tick_ts) {
+      ++stats_.stale;
+      return false;
+    }
+    it->second = std::move(push);
+  } else {
+    std::string node = push.node;
+    nodes.emplace(std::move(node), std::move(push));
+  }
+  ++stats_.pushes;
+  return true;
+}
+
+std::size_t FleetAggregator::expire(int64_t now, int64_t max_age) {
+  std::size_t n = 0;
+  for (auto s = sites_.begin(); s != sites_.end();) {
+    n += std::erase_if(s->second, [&](const auto& kv) { return kv.second.tick_ts < now - max_age; });
+    s = s->second.empty() ? sites_.erase(s) : std::next(s);
+  }
+  stats_.expired += n;
+  return n;
+}
+
+std::vector<std::string> FleetAggregator::sites() const {
+  std::vector<std::string> out;
+  for (const auto& [name, nodes] : sites_) out.push_back(name);
+  return out;
+}
+
+std::vector<std::string> FleetAggregator::uplinks(std::string_view site) const {
+  std::vector<std::string> out;
+  const auto s = sites_.find(site);
+  if (s == sites_.end()) return out;
+  for (const auto& [node, push] : s->second) {
+    for (const auto& [name, d] : push.groups) out.push_back(name);
+  }
+  std::sort(out.begin(), out.end());
+  out.erase(std::unique(out.begin(), out.end()), out.end());
+  return out;
+}
+
+std::size_t FleetAggregator::nodes(std::string_view site) const {
+  const auto s = sites_.find(site);
+  return s == sites_.end() ? 0 : s->second.size();
+}
+
+WindowDigest FleetAggregator::site(std::string_view site) const {
+  WindowDigest out;
+  const auto s = sites_.find(site);
+  if (s == sites_.end()) return out;
+  for (const auto& [node, push] : s->second) {
+    for (const auto& [name, d] : push.groups) out.merge(d);
+  }
+  return out;
+}
+
+WindowDigest FleetAggregator::uplink(std::string_view site, std::string_view uplink) const {
+  WindowDigest out;
+  const auto s = sites_.find(site);
+  if (s == sites_.end()) return out;
+  for (const auto& [node, push] : s->second) {
+    const auto g = std::lower_bound(push.groups.begin(), push.groups.end(), uplink,
+                                    [](const auto& kv, std::string_view u) { return kv.first < u; });
+    if (g != push.groups.end() && g->first == uplink) out.merge(g->second);
+  }
+  return out;
+}
+
+} // namespace telemetry
@@ -0,0 +1,242 @@
+// fsm_batch.cpp
+#include "fsm_batch.hpp"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define TELEMETRY_HAVE_AVX2_KERNEL 1
+#include <immintrin.h>
+#endif
+
+namespace telemetry {
+
+namespace {
+
+constexpr int64_t kNoTs = std::numeric_limits<int64_t>::min();
+
+constexpr uint8_t kHealthy = static_cast<uint8_t>(IfStatus::Healthy);
+constexpr uint8_t kDegraded = static_cast<uint8_t>(IfStatus::Degraded);
+constexpr uint8_t kDown = static_cast<uint8_t>(IfStatus::Down);
+static_assert(kHealthy == 0 && kDegraded == 1 && kDown == 2);
+
+// Status after a transition, indexed by TransitionReason (None keeps it).
+constexpr uint8_t kNextStatus[] = {0, kDown, kDegraded, kDown, kHealthy, kDegraded};
+static_assert(static_cast<int>(TransitionReason::DownExit) == 5);
+
+// a if m else b, without a branch.
+inline int pick(bool m, int a, int b) { return b ^ ((a ^ b) & -static_cast<int>(m)); }
+
+} // namespace
+
+// --- scalar (reference, also used for tails) ---
+
+static std::size_t fsm_range_scalar(const FsmConfig& cfg, const FsmBatch& b, int64_t ts_now, std::size_t begin,
+                                    std::size_t end, FsmChange* out) {
+  // Local copies: stores through the uint8_t status column may alias cfg
+  // and b, which would reload every field per entry.
+  const FsmConfig c = cfg;
+  const bool force_on = c.force_down_if_confidence_below >= 0.0;
+  const bool dwell_off = c.min_dwell_sec <= 0;
+  uint8_t* const status = b.status;
+  int64_t* const last_ts = b.last_transition_ts;
+  int* const cnt_hx = b.cnt_below_healthy_exit;
+  int* const cnt_he = b.cnt_above_healthy_enter;
+  int* const cnt_de = b.cnt_below_down_enter;
+  int* const cnt_dx = b.cnt_above_down_exit;
+  const double* const scores = b.score;
+  const double* const confs = b.confidence;
+  std::size_t k = 0;
+  for (std::size_t i = begin; i < end; ++i) {
+    const uint8_t st = status[i];
+    const double score = scores[i];
+    const double conf = confs[i];
+    const int64_t last = last_ts[i];
+    const bool is_h = st == kHealthy;
+    const bool is_d = st == kDegraded;
+    const bool is_down = st == kDown;
+
+    // Only the current state's counters move: up while their condition
+    // holds, back to 0 when it fails.
+    const bool promo = conf >= c.min_confidence_for_promotion;
+    const int hx = pick(is_h, pick(score <= c.healthy_exit, cnt_hx[i] + 1, 0), cnt_hx[i]);
+    const int de = pick(is_d, pick(score <= c.down_enter, cnt_de[i] + 1, 0), cnt_de[i]);
+    const int he = pick(is_d, pick(promo & (score >= c.healthy_enter), cnt_he[i] + 1, 0), cnt_he[i]);
+    const int dx = pick(is_down, pick(score >= c.down_exit, cnt_dx[i] + 1, 0), cnt_dx[i]);
+
+    // Wrapping difference: only read when last is a real timestamp.
+    const auto since = static_cast<int64_t>(static_cast<uint64_t>(ts_now) - static_cast<uint64_t>(last));
+    const bool dwell = dwell_off | (last == kNoTs) | (since >= c.min_dwell_sec);
+    const bool force = force_on & (conf < c.force_down_if_confidence_below) & !is_down;
+    const bool down_enter = is_d & (de >= c.down_enter_N);
+    // At most one of these holds; force-down beats them all and down_enter
+    // ignores the dwell.
+    const int evidence = 2 * (is_h & (hx >= c.healthy_exit_N) & dwell) + 3 * down_enter +
+                         4 * (is_d & !down_enter & (he >= c.healthy_enter_N) & dwell) +
+                         5 * (is_down & (dx >= c.down_exit_N) & dwell);
+    const int reason = pick(force, 1, evidence);
+    const bool changed = reason != 0;
+    const int keep = -static_cast<int>(!changed);
+
+    const auto next = static_cast<uint8_t>(pick(changed, kNextStatus[reason], st));
+    status[i] = next;
+    last_ts[i] = last ^ ((last ^ ts_now) & -static_cast<int64_t>(changed));
+    cnt_hx[i] = hx & keep;
+    cnt_de[i] = de & keep;
+    cnt_he[i] = he & keep;
+    cnt_dx[i] = dx & keep;
+
+    out[k] = FsmChange{static_cast<uint32_t>(i), static_cast<IfStatus>(st), static_cast<IfStatus>(next),
+                       static_cast<TransitionReason>(reason)};
+    k += changed;
+  }
+  return k;
+}
+
+// --- AVX2 (4 lanes, every field widened to 64 bits) ---
+
+#ifdef TELEMETRY_HAVE_AVX2_KERNEL
+__attribute__((target("avx2")))
+static inline __m256i load_counts(const int* p) {
+  return _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+
+__attribute__((target("avx2")))
+static inline void store_counts(int* p, __m256i v) {
+  const __m256i low = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_castsi256_si128(low));
+}
+
+// All ones in the lanes where a >= n.
+__attribute__((target("avx2")))
+static inline __m256i at_least(__m256i a, __m256i n) {
+  return _mm256_xor_si256(_mm256_cmpgt_epi64(n, a), _mm256_set1_epi64x(-1));
+}
+
+__attribute__((target("avx2")))
+static std::size_t fsm_batch_avx2(const FsmConfig& c, const FsmBatch& b, int64_t ts_now, FsmChange* out) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i one = _mm256_set1_epi64x(1);
+  const __m256i degraded = _mm256_set1_epi64x(kDegraded);
+  const __m256i down = _mm256_set1_epi64x(kDown);
+  const __m256d healthy_exit = _mm256_set1_pd(c.healthy_exit);
+  const __m256d healthy_enter = _mm256_set1_pd(c.healthy_enter);
+  const __m256d down_enter = _mm256_set1_pd(c.down_enter);
+  const __m256d down_exit = _mm256_set1_pd(c.down_exit);
+  const __m256d min_conf = _mm256_set1_pd(c.min_confidence_for_promotion);
+  const __m256d force_below = _mm256_set1_pd(c.force_down_if_confidence_below);
+  const __m256i force_on = _mm256_set1_epi64x(c.force_down_if_confidence_below >= 0.0 ? -1 : 0);
+  const __m256i dwell_off = _mm256_set1_epi64x(c.min_dwell_sec <= 0 ? -1 : 0);
+  const __m256i dwell = _mm256_set1_epi64x(c.min_dwell_sec);
+  const __m256i no_ts = _mm256_set1_epi64x(kNoTs);
+  const __m256i now = _mm256_set1_epi64x(ts_now);
+  const __m256i hx_n = _mm256_set1_epi64x(c.healthy_exit_N);
+  const __m256i he_n = _mm256_set1_epi64x(c.healthy_enter_N);
+  const __m256i de_n = _mm256_set1_epi64x(c.down_enter_N);
+  const __m256i dx_n = _mm256_set1_epi64x(c.down_exit_N);
+  const __m256i r_force = _mm256_set1_epi64x(static_cast<int64_t>(TransitionReason::ForceDown));
+  const __m256i r_hx = _mm256_set1_epi64x(static_cast<int64_t>(TransitionReason::HealthyExit));
+  const __m256i r_de = _mm256_set1_epi64x(static_cast<int64_t>(TransitionReason::DownEnter));
+  const __m256i r_he = _mm256_set1_epi64x(static_cast<int64_t>(TransitionReason::HealthyEnter));
+  const __m256i r_dx = _mm256_set1_epi64x(static_cast<int64_t>(TransitionReason::DownExit));
+
+  std::size_t k = 0;
+  const std::size_t n4 = b.n & ~std::size_t{3};
+  for (std::size_t i = 0; i < n4; i += 4) {
+    uint32_t st4;
+    std::memcpy(&st4, b.status + i, sizeof st4);
+    const __m256i st = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(static_cast<int>(st4)));
+    const __m256d score = _mm256_loadu_pd(b.score + i);
+    const __m256d conf = _mm256_loadu_pd(b.confidence + i);
+    const __m256i last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b.last_transition_ts + i));
+    const __m256i is_h = _mm256_cmpeq_epi64(st, zero);
+    const __m256i is_d = _mm256_cmpeq_epi64(st, degraded);
+    const __m256i is_down = _mm256_cmpeq_epi64(st, down);
+
+    // Ordered compares: a NaN score or confidence satisfies none, as in
+    // the scalar FSM.
+    const __m256i hx_holds = _mm256_castpd_si256(_mm256_cmp_pd(score, healthy_exit, _CMP_LE_OQ));
+    const __m256i de_holds = _mm256_castpd_si256(_mm256_cmp_pd(score, down_enter, _CMP_LE_OQ));
+    const __m256i he_holds = _mm256_and_si256(_mm256_castpd_si256(_mm256_cmp_pd(conf, min_conf, _CMP_GE_OQ)),
+                                              _mm256_castpd_si256(_mm256_cmp_pd(score, healthy_enter, _CMP_GE_OQ)));
+    const __m256i dx_holds = _mm256_castpd_si256(_mm256_cmp_pd(score, down_exit, _CMP_GE_OQ));
+
+    const __m256i hx0 = load_counts(b.cnt_below_healthy_exit + i);
+    const __m256i de0 = load_counts(b.cnt_below_down_enter + i);
+    const __m256i he0 = load_counts(b.cnt_above_healthy_enter + i);
+    const __m256i dx0 = load_counts(b.cnt_above_down_exit + i);
+    const __m256i hx = _mm256_blendv_epi8(hx0, _mm256_and_si256(hx_holds, _mm256_add_epi64(hx0, one)), is_h);
+    const __m256i de = _mm256_blendv_epi8(de0, _mm256_and_si256(de_holds, _mm256_add_epi64(de0, one)), is_d);
+    const __m256i he = _mm256_blendv_epi8(he0, _mm256_and_si256(he_holds, _mm256_add_epi64(he0, one)), is_d);
+    const __m256i dx = _mm256_blendv_epi8(dx0, _mm256_and_si256(dx_holds, _mm256_add_epi64(dx0, one)), is_down);
+
+    const __m256i dwell_ok = _mm256_or_si256(
+      _mm256_or_si256(dwell_off, _mm256_cmpeq_epi64(last, no_ts)),
+      at_least(_mm256_sub_epi64(now, last), dwell));
+    const __m256i force = _mm256_andnot_si256(
+      is_down, _mm256_and_si256(force_on, _mm256_castpd_si256(_mm256_cmp_pd(conf, force_below, _CMP_LT_OQ))));
+    const __m256i t_de = _mm256_and_si256(is_d, at_least(de, de_n));
+    __m256i t_hx = _mm256_and_si256(_mm256_and_si256(is_h, at_least(hx, hx_n)), dwell_ok);
+    __m256i t_he = _mm256_andnot_si256(t_de, _mm256_and_si256(_mm256_and_si256(is_d, at_least(he, he_n)), dwell_ok));
+    __m256i t_dx = _mm256_and_si256(_mm256_and_si256(is_down, at_least(dx, dx_n)), dwell_ok);
+    const __m256i t_de_f = _mm256_andnot_si256(force, t_de);
+    t_hx = _mm256_andnot_si256(force, t_hx);
+    t_he = _mm256_andnot_si256(force, t_he);
+    t_dx = _mm256_andnot_si256(force, t_dx);
+
+    // The masks are exclusive, so OR-ing the selected codes is the lookup.
+    const __m256i changed =
+      _mm256_or_si256(_mm256_or_si256(force, t_hx), _mm256_or_si256(_mm256_or_si256(t_de_f, t_he), t_dx));
+    const __m256i reason = _mm256_or_si256(
+      _mm256_or_si256(_mm256_and_si256(force, r_force), _mm256_and_si256(t_hx, r_hx)),
+      _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(t_de_f, r_de), _mm256_and_si256(t_he, r_he)),
+                      _mm256_and_si256(t_dx, r_dx)));
+    const __m256i next = _mm256_or_si256(
+      _mm256_andnot_si256(changed, st),
+      _mm256_or_si256(_mm256_and_si256(_mm256_or_si256(force, t_de_f), down),
+                      _mm256_and_si256(_mm256_or_si256(t_hx, t_dx), degraded))); // HealthyEnter -> 0
+
+    store_counts(b.cnt_below_healthy_exit + i, _mm256_andnot_si256(changed, hx));
+    store_counts(b.cnt_below_down_enter + i, _mm256_andnot_si256(changed, de));
+    store_counts(b.cnt_above_healthy_enter + i, _mm256_andnot_si256(changed, he));
+    store_counts(b.cnt_above_down_exit + i, _mm256_andnot_si256(changed, dx));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(b.last_transition_ts + i), _mm256_blendv_epi8(last, now, changed));
+
+    alignas(32) int64_t next4[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(next4), next);
+    for (int l = 0; l < 4; ++l) b.status[i + l] = static_cast<uint8_t>(next4[l]);
+
+    // Transitions are rare: one predictable branch per four entries.
+    if (const int mask = _mm256_movemask_pd(_mm256_castsi256_pd(changed))) {
+      alignas(32) int64_t reason4[4];
+      _mm256_store_si256(reinterpret_cast<__m256i*>(reason4), reason);
+      for (int l = 0; l < 4; ++l) {
+        out[k] = FsmChange{static_cast<uint32_t>(i + l), static_cast<IfStatus>((st4 >> (8 * l)) & 0xff),
+                           static_cast<IfStatus>(next4[l]), static_cast<TransitionReason>(reason4[l])};
+        k += (mask >> l) & 1;
+      }
+    }
+  }
+  return k + fsm_range_scalar(c, b, ts_now, n4, b.n, out + k);
+}
+#endif
+
+// --- dispatch ---
+
+std::size_t fsm_update_batch_with(ScoreKernel k, const FsmConfig& cfg, const FsmBatch& b, int64_t ts_now,
+                                  std::span<FsmChange> out) {
+  if (out.size() < b.n) throw std::length_error("fsm_update_batch: out is smaller than the batch");
+  switch (k) {
+#ifdef TELEMETRY_HAVE_AVX2_KERNEL
+    case ScoreKernel::Avx2: return fsm_batch_avx2(cfg, b, ts_now, out.data());
+#endif
+    default: return fsm_range_scalar(cfg, b, ts_now, 0, b.n, out.data());
+  }
+}
+
+std::size_t fsm_update_batch(const FsmConfig& cfg, const FsmBatch& b, int64_t ts_now, std::span<FsmChange> out) {
+  return fsm_update_batch_with(active_score_kernel(), cfg, b, ts_now, out);
+}
+
+} // namespace telemetry
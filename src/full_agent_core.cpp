@@ -0,0 +1,146 @@
+// full_agent_core.cpp
+#include "full_agent.hpp"
+
+#include <stdexcept>
+
+namespace full_agent {
+
+std::string statusToString(Status s) {
+    switch (s) {
+        case Status::Healthy: return "Healthy";
+        case Status::Degraded: return "Degraded";
+        case Status::Down: return "Down";
+    }
+    return "Unknown";
+}
+
+DiscardLog& discardLog() {
+    static DiscardLog log;
+    return log;
+}
+
+void TelemetryAgent::tick(int current_time) {
+    for (auto& [iface, state] : interfaces) {
+        state.computeScore(use_ewma);
+        auto [score, status] = state.getLatest();
+        if (out) {
+            std::fprintf(out, "t=%d %s: score=%.2f status=%s\n",
+                         current_time,
+                         iface.c_str(),
+                         score,
+                         statusToString(status).c_str());
+
+            if (last_statuses.count(iface) && last_statuses[iface] != status) {
+                std::fprintf(out, "Transition: %s from %s to %s (score=%.2f)\n",
+                             iface.c_str(),
+                             statusToString(last_statuses[iface]).c_str(),
+                             statusToString(status).c_str(),
+                             score);
+            }
+        }
+        last_statuses[iface] = status;
+    }
+}
+
+void TelemetryAgent::printSummary() {
+    if (!out) return;
+    std::vector<std::pair<std::string, double>> rankings;
+    for (const auto& [iface, state] : interfaces) {
+        rankings.emplace_back(iface, state.getAvgScore());
+    }
+    std::sort(rankings.begin(), rankings.end(), [](const auto& a, const auto& b) {
+        return a.second > b.second;
+    });
+    std::fprintf(out, "End-of-run summary (ranked by avg score):\n");
+    for (const auto& [iface, avg] : rankings) {
+        std::fprintf(out, "%s: %.2f\n", iface.c_str(), avg);
+    }
+}
+
+namespace Simulator {
+    // Deterministic generation; hardcode qualitative behaviors
+    // For imperfections: hardcoded missing (e.g., skip t=10,20) and late (add at t+2)
+    ScenarioSequences generateScenarioA(int duration) {
+        ScenarioSequences seq;
+        for (int t = 0; t < duration; ++t) {
+            // eth0: stable good
+            seq["eth0"].push_back({t, 20.0, 100.0, 0.0, 5.0});
+            // wifi0: degrade over 40s (rtt up, tp down), recover
+            double deg_factor = (t < 40) ? t / 40.0 : (t < 80 ? (80 - t) / 40.0 : 0.0);
+            seq["wifi0"].push_back({t, 20.0 + 300.0 * deg_factor, 100.0 - 80.0 * deg_factor, 0.0 + 10.0 * deg_factor, 5.0 + 50.0 * deg_factor});
+            // lte0: moderate stable
+            seq["lte0"].push_back({t, 50.0, 50.0, 2.0, 10.0});
+            // sat0: high latency stable
+            seq["sat0"].push_back({t, 500.0, 20.0, 1.0, 20.0});
+        }
+        // Imperfections: miss some, late some (deterministic)
+        seq["wifi0"].erase(seq["wifi0"].begin() + 10);  // miss t=10
+        // Late: move t=15 to later (will add at t=17)
+        Measurement late = seq["wifi0"][15];
+        seq["wifi0"].erase(seq["wifi0"].begin() + 15);
+        seq["wifi0"].insert(seq["wifi0"].begin() + 17, late);  // But timestamp still 15
+        return seq;
+    }
+
+    ScenarioSequences generateScenarioB(int duration) {
+        ScenarioSequences seq;
+        for (int t = 0; t < duration; ++t) {
+            // eth0: stable
+            seq["eth0"].push_back({t, 20.0, 100.0, 0.0, 5.0});
+            // wifi0: spikes every 15s, 3-5s long
+            bool spike = (t % 15 < 5 && t % 15 > 1);
+            seq["wifi0"].push_back({t, spike ? 200.0 : 30.0, spike ? 20.0 : 80.0, spike ? 15.0 : 1.0, spike ? 100.0 : 10.0});
+            // lte0: mild noise
+            seq["lte0"].push_back({t, 50.0 + (t % 10), 50.0 - (t % 5), 2.0 + (t % 3), 10.0});
+            // sat0: stable high RTT
+            seq["sat0"].push_back({t, 500.0, 20.0, 1.0, 20.0});
+        }
+        // Imperfections similar
+        seq["lte0"].erase(seq["lte0"].begin() + 20);
+        Measurement late = seq["wifi0"][30];
+        seq["wifi0"].erase(seq["wifi0"].begin() + 30);
+        seq["wifi0"].insert(seq["wifi0"].begin() + 33, late);
+        return seq;
+    }
+
+    ScenarioSequences generateScenarioC(int duration) {
+        ScenarioSequences seq;
+        for (int t = 0; t < duration; ++t) {
+            // eth0: strong
+            seq["eth0"].push_back({t, 20.0, 100.0, 0.0, 5.0});
+            // wifi0: low tp but low loss/jitter
+            seq["wifi0"].push_back({t, 30.0, 30.0, 0.5, 5.0});
+            // lte0: high tp but high loss/jitter
+            seq["lte0"].push_back({t, 50.0, 150.0, 10.0, 100.0});
+            // sat0: mod tp, high RTT, low loss
+            seq["sat0"].push_back({t, 600.0, 50.0, 0.5, 10.0});
+        }
+        // Imperfections
+        seq["sat0"].erase(seq["sat0"].begin() + 40);
+        Measurement late = seq["lte0"][50];
+        seq["lte0"].erase(seq["lte0"].begin() + 50);
+        seq["lte0"].insert(seq["lte0"].begin() + 52, late);
+        return seq;
+    }
+
+    ScenarioSequences getScenario(char id, int duration) {
+        if (id == 'A') return generateScenarioA(duration);
+        if (id == 'B') return generateScenarioB(duration);
+        if (id == 'C') return generateScenarioC(duration);
+        throw std::invalid_argument("Invalid scenario");
+    }
+}
+
+void runScenario(TelemetryAgent& agent, const ScenarioSequences& sequences, int duration) {
+    for (int current_time = 0; current_time < duration; ++current_time) {
+        for (const auto& [iface, meas_vec] : sequences) {
+            // Feed if sample at this time (vectors are indexed by t, but with erasures for missing)
+            if (static_cast<size_t>(current_time) < meas_vec.size()) {
+                agent.processMeasurement(iface, meas_vec[current_time], current_time);
+            }
+        }
+        agent.tick(current_time);
+    }
+}
+
+} // namespace full_agent
@@ -1,92 +1,117 @@
 // hysteresis_fsm.cpp
 #include "hysteresis_fsm.hpp"
 
+#include <algorithm>
+
 namespace telemetry {
 
-HysteresisFsm::HysteresisFsm(FsmConfig cfg, IfStatus initial)
-  : cfg_(cfg), status_(initial) {
-  reset_counters_for_state_(status_);
+namespace {
+
+FsmUpdate transition(FsmState& st, int64_t ts_now, IfStatus next, TransitionReason reason) {
+  st.status = next;
+  st.last_transition_ts = ts_now;
+  st.cnt_below_healthy_exit = 0;
+  st.cnt_above_healthy_enter = 0;
+  st.cnt_below_down_enter = 0;
+  st.cnt_above_down_exit = 0;
+  return FsmUpdate{st.status, true, reason};
 }
 
-FsmUpdate HysteresisFsm::transition_(int64_t ts_now, IfStatus next, std::string reason) {
-  status_ = next;
-  last_transition_ts_ = ts_now;
-  reset_counters_for_state_(status_);
-  return FsmUpdate{status_, true, std::move(reason)};
+bool dwell_ok(const FsmConfig& cfg, const FsmState& st, int64_t ts_now) {
+  if (cfg.min_dwell_sec <= 0) return true;
+  if (st.last_transition_ts == std::numeric_limits<int64_t>::min()) return true;
+  return (ts_now - st.last_transition_ts) >= cfg.min_dwell_sec;
 }
 
-void HysteresisFsm::reset_counters_for_state_(IfStatus s) {
-  cnt_below_healthy_exit_ = 0;
-  cnt_above_healthy_enter_ = 0;
-  cnt_below_down_enter_ = 0;
-  cnt_above_down_exit_ = 0;
+} // namespace
 
-  (void)s;
-}
+HysteresisFsm::HysteresisFsm(FsmConfig cfg, IfStatus initial) : cfg_(cfg) { st_.status = initial; }
+
+int64_t fsm_next_change_ts(const FsmConfig& cfg, const FsmState& st, double score, double confidence) {
+  if (cfg.force_down_if_confidence_below >= 0.0 &&
+      confidence < cfg.force_down_if_confidence_below &&
+      st.status != IfStatus::Down) {
+    return kChangeNow;
+  }
 
-bool HysteresisFsm::dwell_ok_(int64_t ts_now) const {
-  if (cfg_.min_dwell_sec <= 0) return true;
-  if (last_transition_ts_ == std::numeric_limits<int64_t>::min()) return true;
-  return (ts_now - last_transition_ts_) >= cfg_.min_dwell_sec;
+  // A counter whose condition fails is reset (a no-op once it is 0); one
+  // whose condition holds counts up to N, then only the dwell can hold the
+  // transition back and further counting changes nothing.
+  const int64_t dwell_end = (cfg.min_dwell_sec <= 0 || st.last_transition_ts == std::numeric_limits<int64_t>::min())
+                              ? kChangeNow
+                              : st.last_transition_ts + cfg.min_dwell_sec;
+  auto evidence = [&](bool holds, int count, int n, bool dwell_gated) -> int64_t {
+    if (!holds) return count == 0 ? kChangeNever : kChangeNow;
+    if (count < n || !dwell_gated) return kChangeNow;
+    return dwell_end;
+  };
+
+  const bool allow_promotion = (confidence >= cfg.min_confidence_for_promotion);
+
+  if (st.status == IfStatus::Healthy) {
+    return evidence(score <= cfg.healthy_exit, st.cnt_below_healthy_exit, cfg.healthy_exit_N, true);
+  }
+  if (st.status == IfStatus::Degraded) {
+    return std::min(evidence(score <= cfg.down_enter, st.cnt_below_down_enter, cfg.down_enter_N, false),
+                    evidence(allow_promotion && score >= cfg.healthy_enter, st.cnt_above_healthy_enter,
+                             cfg.healthy_enter_N, true));
+  }
+  return evidence(score >= cfg.down_exit, st.cnt_above_down_exit, cfg.down_exit_N, true);
 }
 
-FsmUpdate HysteresisFsm::update(int64_t ts_now, double score, double confidence) {
+FsmUpdate fsm_update(const FsmConfig& cfg, FsmState& st, int64_t ts_now, double score, double confidence) {
   // Optional hard force-down when confidence is extremely low.
-  if (cfg_.force_down_if_confidence_below >= 0.0 &&
-      confidence < cfg_.force_down_if_confidence_below &&
-      status_ != IfStatus::Down) {
-    return transition_(ts_now, IfStatus::Down, "confidence below force-down threshold");
+  if (cfg.force_down_if_confidence_below >= 0.0 &&
+      confidence < cfg.force_down_if_confidence_below &&
+      st.status != IfStatus::Down) {
+    return transition(st, ts_now, IfStatus::Down, TransitionReason::ForceDown);
   }
 
-  const bool allow_promotion = (confidence >= cfg_.min_confidence_for_promotion);
+  const bool allow_promotion = (confidence >= cfg.min_confidence_for_promotion);
 
-  if (status_ == IfStatus::Healthy) {
-    if (score <= cfg_.healthy_exit) {
-      ++cnt_below_healthy_exit_;
+  if (st.status == IfStatus::Healthy) {
+    if (score <= cfg.healthy_exit) {
+      ++st.cnt_below_healthy_exit;
     } else {
-      cnt_below_healthy_exit_ = 0;
+      st.cnt_below_healthy_exit = 0;
     }
 
-    if (cnt_below_healthy_exit_ >= cfg_.healthy_exit_N && dwell_ok_(ts_now)) {
-      return transition_(ts_now, IfStatus::Degraded,
-                         "score <= healthy_exit for N ticks");
+    if (st.cnt_below_healthy_exit >= cfg.healthy_exit_N && dwell_ok(cfg, st, ts_now)) {
+      return transition(st, ts_now, IfStatus::Degraded, TransitionReason::HealthyExit);
     }
-  } else if (status_ == IfStatus::Degraded) {
-    if (score <= cfg_.down_enter) {
-      ++cnt_below_down_enter_;
+  } else if (st.status == IfStatus::Degraded) {
+    if (score <= cfg.down_enter) {
+      ++st.cnt_below_down_enter;
     } else {
-      cnt_below_down_enter_ = 0;
+      st.cnt_below_down_enter = 0;
     }
 
-    if (allow_promotion && score >= cfg_.healthy_enter) {
-      ++cnt_above_healthy_enter_;
+    if (allow_promotion && score >= cfg.healthy_enter) {
+      ++st.cnt_above_healthy_enter;
     } else {
-      cnt_above_healthy_enter_ = 0;
+      st.cnt_above_healthy_enter = 0;
     }
 
-    if (cnt_below_down_enter_ >= cfg_.down_enter_N) {
+    if (st.cnt_below_down_enter >= cfg.down_enter_N) {
       // Allow fast drop to Down (safety) regardless of dwell time.
-      return transition_(ts_now, IfStatus::Down,
-                         "score <= down_enter for M ticks");
+      return transition(st, ts_now, IfStatus::Down, TransitionReason::DownEnter);
     }
-    if (cnt_above_healthy_enter_ >= cfg_.healthy_enter_N && dwell_ok_(ts_now)) {
-      return transition_(ts_now, IfStatus::Healthy,
-                         "score >= healthy_enter for N ticks");
+    if (st.cnt_above_healthy_enter >= cfg.healthy_enter_N && dwell_ok(cfg, st, ts_now)) {
+      return transition(st, ts_now, IfStatus::Healthy, TransitionReason::HealthyEnter);
     }
   } else { // Down
-    if (score >= cfg_.down_exit) {
-      ++cnt_above_down_exit_;
+    if (score >= cfg.down_exit) {
+      ++st.cnt_above_down_exit;
     } else {
-      cnt_above_down_exit_ = 0;
+      st.cnt_above_down_exit = 0;
     }
 
-    if (cnt_above_down_exit_ >= cfg_.down_exit_N && dwell_ok_(ts_now)) {
-      return transition_(ts_now, IfStatus::Degraded,
-                         "score >= down_exit for P ticks");
+    if (st.cnt_above_down_exit >= cfg.down_exit_N && dwell_ok(cfg, st, ts_now)) {
+      return transition(st, ts_now, IfStatus::Degraded, TransitionReason::DownExit);
     }
   }
 
-  return FsmUpdate{status_, false, ""};
+  return FsmUpdate{st.status, false, TransitionReason::None};
 }
 
 } // namespace telemetry
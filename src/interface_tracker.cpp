@@ -5,12 +5,39 @@
 
 namespace telemetry {
 
-InterfaceTracker::InterfaceTracker(std::string iface, AgentConfig cfg)
+InterfaceTracker::InterfaceTracker(std::string iface, AgentConfig cfg, InterfaceId id)
+  : InterfaceTracker(std::move(iface), nullptr, cfg, id) {
+  own_profile_ = std::make_shared<const ConfigProfile>(ConfigProfile{cfg.score, cfg.fsm});
+  set_profile(own_profile_.get());
+}
+
+InterfaceTracker::InterfaceTracker(std::string iface, const ConfigProfile* profile, const AgentConfig& cfg,
+                                   InterfaceId id)
   : iface_(std::move(iface)),
-    cfg_(cfg),
-    fsm_(cfg_.fsm, IfStatus::Degraded) {
+    id_(id),
+    profile_(profile),
+    recompute_mode_(cfg.recompute),
+    same_second_(cfg.same_second) {
   last_snapshot_.iface = iface_;
+  if (profile_) set_profile(profile_);
+}
+
+void InterfaceTracker::set_profile(const ConfigProfile* profile) {
+  profile_ = profile;
+  if (uses_window_quantiles(profile_->score)) window_.enable_quantiles();
+}
+
+namespace {
+double pick(WindowStat stat, double mean, double p50, double p95, double p99) {
+  switch (stat) {
+    case WindowStat::Mean: return mean;
+    case WindowStat::P50: return p50;
+    case WindowStat::P95: return p95;
+    case WindowStat::P99: return p99;
+  }
+  return mean;
 }
+} // namespace
 
 double InterfaceTracker::clamp01(double x) {
   if (x < 0.0) return 0.0;
@@ -18,64 +45,71 @@ double InterfaceTracker::clamp01(double x) {
   return x;
 }
 
-double InterfaceTracker::norm_tp(double mbps) { return clamp01(mbps / 200.0); }
-double InterfaceTracker::norm_rtt(double ms) { return clamp01(1.0 - (ms - 10.0) / 790.0); }
-double InterfaceTracker::norm_loss(double pct) { return clamp01(1.0 - pct / 30.0); }
-double InterfaceTracker::norm_jit(double ms) { return clamp01(1.0 - ms / 200.0); }
+double InterfaceTracker::norm_tp(double mbps) { return normalize<ThroughputMetric>(mbps); }
+double InterfaceTracker::norm_rtt(double ms) { return normalize<RttMetric>(ms); }
+double InterfaceTracker::norm_loss(double pct) { return normalize<LossMetric>(pct); }
+double InterfaceTracker::norm_jit(double ms) { return normalize<JitterMetric>(ms); }
 
 double InterfaceTracker::compute_avg_score_(const RollingWindow::Summary& s) const {
-  const double n_tp = norm_tp(s.avg_throughput_mbps);
-  const double n_rtt = norm_rtt(s.avg_rtt_ms);
-  const double n_loss = norm_loss(s.avg_loss_pct);
-  const double n_jit = norm_jit(s.avg_jitter_ms);
-
-  const double score = cfg_.score.w_tp * n_tp +
-                       cfg_.score.w_rtt * n_rtt +
-                       cfg_.score.w_loss * n_loss +
-                       cfg_.score.w_jit * n_jit;
+  const ScoreConfig& c = profile_->score;
+  const double n_tp = normalize<ThroughputMetric>(s.avg_throughput_mbps, c.ranges.tp);
+  const double n_rtt = normalize<RttMetric>(pick(c.rtt_stat, s.avg_rtt_ms, s.p50_rtt_ms, s.p95_rtt_ms,
+                                                 s.p99_rtt_ms), c.ranges.rtt);
+  const double n_loss = normalize<LossMetric>(c.loss_use_max ? s.max_loss_pct : s.avg_loss_pct, c.ranges.loss);
+  const double n_jit = normalize<JitterMetric>(pick(c.jitter_stat, s.avg_jitter_ms, s.p50_jitter_ms,
+                                                    s.p95_jitter_ms, s.p99_jitter_ms), c.ranges.jitter);
+
+  const double score = c.w_tp * n_tp +
+                       c.w_rtt * n_rtt +
+                       c.w_loss * n_loss +
+                       c.w_jit * n_jit;
   return clamp01(score);
 }
 
 double InterfaceTracker::update_ewma_(double prev, double current) const {
-  const double a = cfg_.score.ewma_alpha;
+  const ScoreConfig& c = profile_->score;
+  const double a = c.ewma_alpha;
   double ewma = a * current + (1.0 - a) * prev;
-  if (cfg_.score.enable_downtrend_penalty && current < prev) {
-    ewma -= cfg_.score.downtrend_penalty;
+  if (c.enable_downtrend_penalty && current < prev) {
+    ewma -= c.downtrend_penalty;
   }
   return clamp01(ewma);
 }
 
 void InterfaceTracker::recompute_(int64_t now_ts) {
+  dirty_ = false;
+  last_eval_ts_ = now_ts;
   const auto s = window_.summary();
 
+  const ScoreConfig& c = profile_->score;
+
   score_avg_ = compute_avg_score_(s);
 
   if (!have_ewma_) {
     score_ewma_ = score_avg_;
     have_ewma_ = true;
-  } else if (cfg_.score.useEwma) {
+  } else if (c.useEwma) {
     score_ewma_ = update_ewma_(score_ewma_, score_avg_);
   } else {
     score_ewma_ = score_avg_;
   }
 
-  double candidate = cfg_.score.useEwma ? score_ewma_ : score_avg_;
+  double candidate = c.useEwma ? score_ewma_ : score_avg_;
 
-  const bool low_conf = (s.confidence < cfg_.score.min_confidence_for_promotion);
-  if (cfg_.score.enable_confidence_cap && low_conf) {
-    candidate = std::min(candidate, cfg_.score.score_cap_when_low_conf);
+  const bool low_conf = (s.confidence < c.min_confidence_for_promotion);
+  if (c.enable_confidence_cap && low_conf) {
+    candidate = std::min(candidate, c.score_cap_when_low_conf);
   }
   score_used_ = candidate;
 
-  const IfStatus before = fsm_.status();
-  const FsmUpdate upd = fsm_.update(now_ts, score_used_, s.confidence);
+  const IfStatus before = fsm_.status;
+  const FsmUpdate upd = fsm_update(profile_->fsm, fsm_, now_ts, score_used_, s.confidence);
   const IfStatus after = upd.status;
 
   if (upd.transitioned) {
-    pending_transition_ = TransitionEvent{iface_, now_ts, before, after, upd.reason};
+    pending_transition_ = TransitionEvent{id_, now_ts, before, after, upd.reason};
   }
 
-  last_snapshot_.iface = iface_;
   last_snapshot_.status = after;
   last_snapshot_.score_raw = score_avg_;
   last_snapshot_.score_smoothed = score_ewma_;
@@ -88,14 +122,83 @@ void InterfaceTracker::recompute_(int64_t now_ts) {
   last_snapshot_.avg_jitter_ms = s.avg_jitter_ms;
 }
 
-void InterfaceTracker::ingest(int64_t ts, const Metrics& m) {
-  window_.ingest(ts, m);
+RollingWindow::IngestResult InterfaceTracker::ingest(int64_t ts, const Metrics& m) {
+  const auto res = stage(ts, m);
+  flush();
+  return res;
+}
+
+RollingWindow::IngestResult InterfaceTracker::stage(int64_t ts, const Metrics& m) {
+  dirty_ = true;
+  return same_second_ == SameSecond::Average ? window_.merge(ts, m) : window_.insert(ts, m);
+}
+
+bool InterfaceTracker::flush() {
+  if (recompute_mode_ != RecomputeMode::Eager || !dirty_) return false;
   recompute_(window_.newest_ts());
+  return true;
 }
 
-void InterfaceTracker::note_time(int64_t ts_now) {
+bool InterfaceTracker::note_time(int64_t ts_now) {
   window_.note_time(ts_now);
+  if (recompute_mode_ == RecomputeMode::PerTick && !dirty_ && ts_now == last_eval_ts_) return false;
   recompute_(ts_now);
+  return true;
+}
+
+int64_t InterfaceTracker::next_change_ts() const {
+  if (dirty_ || !have_ewma_) return kChangeNow;
+  // Window summary unchanged until a sample expires; the tick is then a
+  // no-op iff the EWMA sits at its fixed point and the FSM is idle.
+  const double next_ewma = profile_->score.useEwma ? update_ewma_(score_ewma_, score_avg_) : score_avg_;
+  if (next_ewma != score_ewma_) return kChangeNow;
+  int64_t at = fsm_next_change_ts(profile_->fsm, fsm_, score_used_, last_snapshot_.confidence);
+  if (at == kChangeNow) return at;
+  if (const auto oldest = window_.oldest_sample_ts()) at = std::min(at, *oldest + RollingWindow::kWindow);
+  return at;
+}
+
+TrackerState InterfaceTracker::state() const {
+  TrackerState st;
+  st.fsm = fsm_;
+  st.score_avg = score_avg_;
+  st.score_ewma = score_ewma_;
+  st.score_used = score_used_;
+  st.have_ewma = have_ewma_;
+  st.dirty = dirty_;
+  st.last_eval_ts = last_eval_ts_;
+  st.confidence = last_snapshot_.confidence;
+  st.avg_tp_mbps = last_snapshot_.avg_tp_mbps;
+  st.avg_rtt_ms = last_snapshot_.avg_rtt_ms;
+  st.avg_loss_pct = last_snapshot_.avg_loss_pct;
+  st.avg_jitter_ms = last_snapshot_.avg_jitter_ms;
+  return st;
+}
+
+bool InterfaceTracker::restore(const TrackerState& st, int64_t window_newest_ts,
+                               const DefaultMetrics::Values& window_sums,
+                               std::span<const RollingWindow::Storage::Second> seconds) {
+  const bool ok = window_.restore(window_newest_ts, window_sums, seconds);
+  fsm_ = st.fsm;
+  score_avg_ = st.score_avg;
+  score_ewma_ = st.score_ewma;
+  score_used_ = st.score_used;
+  have_ewma_ = st.have_ewma;
+  dirty_ = st.dirty;
+  last_eval_ts_ = st.last_eval_ts;
+  pending_transition_.reset();
+
+  last_snapshot_.status = st.fsm.status;
+  last_snapshot_.score_raw = score_avg_;
+  last_snapshot_.score_smoothed = score_ewma_;
+  last_snapshot_.score_used = score_used_;
+  last_snapshot_.confidence = st.confidence;
+  last_snapshot_.missing_rate = 1.0 - st.confidence;
+  last_snapshot_.avg_tp_mbps = st.avg_tp_mbps;
+  last_snapshot_.avg_rtt_ms = st.avg_rtt_ms;
+  last_snapshot_.avg_loss_pct = st.avg_loss_pct;
+  last_snapshot_.avg_jitter_ms = st.avg_jitter_ms;
+  return ok;
 }
 
 std::optional<TransitionEvent> InterfaceTracker::drain_transition() {
@@ -0,0 +1,304 @@
+// sample_collector.cpp
+#include "sample_collector.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+#define TELEMETRY_COLLECTOR_LINUX 1
+#else
+#define TELEMETRY_COLLECTOR_LINUX 0
+#endif
+
+namespace telemetry {
+
+namespace {
+constexpr std::size_t kRecordWords = sizeof(WireSample) / 8;
+constexpr std::size_t kMaxSamplesPerDatagram = 0xFFFF;
+
+[[noreturn]] void fail_errno(const std::string& what) {
+  throw std::runtime_error("sample collector: " + what + ": " + std::strerror(errno));
+}
+} // namespace
+
+void encode_samples(std::span<const Sample> samples, std::vector<uint64_t>& out) {
+  if (samples.size() > kMaxSamplesPerDatagram) throw std::length_error("encode_samples: more than 65535 samples");
+  out.resize(1 + samples.size() * kRecordWords);
+  WireSampleHeader h;
+  h.count = static_cast<uint16_t>(samples.size());
+  std::memcpy(out.data(), &h, sizeof h);
+  for (std::size_t k = 0; k < samples.size(); ++k) {
+    const Sample& s = samples[k];
+    WireSample w;
+    w.id = s.id;
+    w.ts = s.ts;
+    w.rtt_ms = s.m.rtt_ms;
+    w.throughput_mbps = s.m.throughput_mbps;
+    w.loss_pct = s.m.loss_pct;
+    w.jitter_ms = s.m.jitter_ms;
+    std::memcpy(out.data() + 1 + k * kRecordWords, &w, sizeof w);
+  }
+}
+
+std::optional<std::span<const WireSample>> parse_samples(std::span<const std::byte> datagram) {
+  WireSampleHeader h;
+  if (datagram.size() < sizeof h) return std::nullopt;
+  std::memcpy(&h, datagram.data(), sizeof h);
+  if (h.magic != WireSampleHeader::kMagic || h.version != WireSampleHeader::kVersion) return std::nullopt;
+  if (datagram.size() != sizeof h + std::size_t{h.count} * sizeof(WireSample)) return std::nullopt;
+  return std::span<const WireSample>(reinterpret_cast<const WireSample*>(datagram.data() + sizeof h), h.count);
+}
+
+#if TELEMETRY_COLLECTOR_LINUX
+
+// One receive slot per datagram of a recvmmsg() call.
+struct SampleCollector::Rx {
+  std::size_t slot_words = 0;
+  std::vector<uint64_t> buf; // 8-byte aligned slots, so records parse in place
+  std::vector<iovec> iov;
+  std::vector<mmsghdr> msgs;
+};
+
+SampleCollector::SampleCollector(TelemetryAgent& agent, CollectorConfig cfg)
+    : agent_(agent), cfg_(std::move(cfg)), rx_(std::make_unique<Rx>()) {
+  if (cfg_.batch == 0 || cfg_.calls_per_wakeup == 0) throw std::invalid_argument("SampleCollector: empty batch");
+  if (cfg_.max_datagram < sizeof(WireSampleHeader)) throw std::invalid_argument("SampleCollector: max_datagram too small");
+  if (cfg_.tick_ms < 0) throw std::invalid_argument("SampleCollector: negative tick_ms");
+
+  rx_->slot_words = (cfg_.max_datagram + 7) / 8;
+  rx_->buf.resize(cfg_.batch * rx_->slot_words);
+  rx_->iov.resize(cfg_.batch);
+  rx_->msgs.resize(cfg_.batch);
+  for (uint32_t i = 0; i < cfg_.batch; ++i) {
+    rx_->iov[i] = {rx_->buf.data() + i * rx_->slot_words, rx_->slot_words * 8};
+    rx_->msgs[i] = {};
+    rx_->msgs[i].msg_hdr.msg_iov = &rx_->iov[i];
+    rx_->msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+  samples_.reserve(cfg_.batch * (rx_->slot_words * 8 / sizeof(WireSample)));
+
+  epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+  stop_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (epoll_fd_ < 0 || stop_fd_ < 0) {
+    const int err = errno;
+    if (epoll_fd_ >= 0) ::close(epoll_fd_);
+    if (stop_fd_ >= 0) ::close(stop_fd_);
+    errno = err;
+    fail_errno("epoll");
+  }
+  epoll_event ev{};
+  ev.events = EPOLLIN;
+  ev.data.fd = stop_fd_;
+  ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, stop_fd_, &ev);
+
+  if (cfg_.tick_ms > 0) {
+    timer_fd_ = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd_ < 0) {
+      ::close(epoll_fd_);
+      ::close(stop_fd_);
+      fail_errno("timerfd");
+    }
+    itimerspec its{};
+    its.it_interval.tv_sec = cfg_.tick_ms / 1000;
+    its.it_interval.tv_nsec = static_cast<long>(cfg_.tick_ms % 1000) * 1000000L;
+    its.it_value = its.it_interval;
+    ::timerfd_settime(timer_fd_, 0, &its, nullptr);
+    ev.data.fd = timer_fd_;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, timer_fd_, &ev);
+  }
+}
+
+SampleCollector::~SampleCollector() {
+  for (const int fd : sockets_) ::close(fd);
+  for (const std::string& p : unix_paths_) ::unlink(p.c_str());
+  if (timer_fd_ >= 0) ::close(timer_fd_);
+  ::close(stop_fd_);
+  ::close(epoll_fd_);
+}
+
+void SampleCollector::add_socket(int fd) {
+  if (fd < 0) throw std::invalid_argument("SampleCollector: invalid fd");
+  const int flags = ::fcntl(fd, F_GETFL);
+  epoll_event ev{};
+  ev.events = EPOLLIN;
+  ev.data.fd = fd;
+  if (flags < 0 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0 || ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+    const int err = errno;
+    ::close(fd);
+    errno = err;
+    fail_errno("add socket");
+  }
+  sockets_.push_back(fd);
+}
+
+namespace {
+// Closes fd and throws if rc failed.
+void check_or_close(int rc, int fd, const std::string& what) {
+  if (rc == 0) return;
+  const int err = errno;
+  ::close(fd);
+  errno = err;
+  fail_errno(what);
+}
+
+void set_rcvbuf(int fd, int bytes) {
+  if (bytes > 0) ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bytes, sizeof bytes); // best effort (rmem_max caps it)
+}
+} // namespace
+
+uint16_t SampleCollector::bind_udp(const std::string& addr, uint16_t port) {
+  sockaddr_in sa{};
+  sa.sin_family = AF_INET;
+  sa.sin_port = htons(port);
+  if (::inet_pton(AF_INET, addr.c_str(), &sa.sin_addr) != 1) {
+    throw std::invalid_argument("SampleCollector: not an IPv4 address: " + addr);
+  }
+  const std::string what = "udp " + addr + ":" + std::to_string(port);
+  const int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) fail_errno(what);
+  set_rcvbuf(fd, cfg_.rcvbuf_bytes);
+  check_or_close(::bind(fd, reinterpret_cast<const sockaddr*>(&sa), sizeof sa), fd, what);
+  socklen_t len = sizeof sa;
+  check_or_close(::getsockname(fd, reinterpret_cast<sockaddr*>(&sa), &len), fd, what);
+  add_socket(fd);
+  return ntohs(sa.sin_port);
+}
+
+void SampleCollector::bind_unix(const std::string& path) {
+  sockaddr_un sa{};
+  if (path.empty() || path.size() >= sizeof sa.sun_path) throw std::invalid_argument("SampleCollector: bad socket path");
+  sa.sun_family = AF_UNIX;
+  std::memcpy(sa.sun_path, path.c_str(), path.size() + 1);
+  const std::string what = "unix " + path;
+  const int fd = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) fail_errno(what);
+  set_rcvbuf(fd, cfg_.rcvbuf_bytes);
+  check_or_close(::bind(fd, reinterpret_cast<const sockaddr*>(&sa), sizeof sa), fd, what);
+  unix_paths_.push_back(path);
+  add_socket(fd);
+}
+
+void SampleCollector::drain_(int fd) {
+  const std::size_t n_ifaces = agent_.size();
+  for (uint32_t call = 0; call < cfg_.calls_per_wakeup; ++call) {
+    const int n = ::recvmmsg(fd, rx_->msgs.data(), cfg_.batch, MSG_DONTWAIT, nullptr);
+    if (n < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+      if (errno == EINTR) continue;
+      fail_errno("recvmmsg");
+    }
+    ++stats_.recv_calls;
+    stats_.datagrams += static_cast<uint64_t>(n);
+
+    samples_.clear();
+    for (int i = 0; i < n; ++i) {
+      const mmsghdr& m = rx_->msgs[i];
+      if (m.msg_hdr.msg_flags & MSG_TRUNC) {
+        ++stats_.oversize_datagrams;
+        continue;
+      }
+      const auto* data = reinterpret_cast<const std::byte*>(rx_->buf.data() + i * rx_->slot_words);
+      const auto records = parse_samples({data, m.msg_len});
+      if (!records) {
+        ++stats_.bad_datagrams;
+        continue;
+      }
+      for (const WireSample& r : *records) {
+        if (r.id >= n_ifaces) {
+          ++stats_.unknown_interface;
+          continue;
+        }
+        samples_.push_back(Sample{r.id, r.ts, Metrics{r.rtt_ms, r.throughput_mbps, r.loss_pct, r.jitter_ms}});
+      }
+    }
+    if (!samples_.empty()) agent_.ingest_batch(samples_);
+    stats_.samples += samples_.size();
+    if (static_cast<uint32_t>(n) < cfg_.batch) return; // drained
+  }
+}
+
+void SampleCollector::tick_() {
+  uint64_t expirations = 0;
+  if (::read(timer_fd_, &expirations, sizeof expirations) != sizeof expirations || expirations == 0) return;
+  stats_.missed_ticks += expirations - 1;
+  int64_t ts = 0;
+  if (cfg_.clock) {
+    ts = cfg_.clock();
+  } else {
+    timespec now{};
+    ::clock_gettime(CLOCK_REALTIME, &now);
+    ts = static_cast<int64_t>(now.tv_sec);
+  }
+  agent_.note_time(ts);
+  ++stats_.ticks;
+  if (on_tick_) on_tick_(ts);
+}
+
+std::size_t SampleCollector::poll(int timeout_ms) {
+  epoll_event events[16];
+  const int n = ::epoll_wait(epoll_fd_, events, 16, timeout_ms);
+  if (n < 0) {
+    if (errno == EINTR) return 0;
+    fail_errno("epoll_wait");
+  }
+  const uint64_t before = stats_.samples;
+  bool tick = false;
+  for (int i = 0; i < n; ++i) {
+    const int fd = events[i].data.fd;
+    if (fd == stop_fd_) {
+      uint64_t v = 0;
+      (void)!::read(stop_fd_, &v, sizeof v);
+      stopping_ = true;
+    } else if (fd == timer_fd_) {
+      tick = true;
+    } else {
+      drain_(fd);
+    }
+  }
+  // After the sockets, so a tick sees everything that arrived before it.
+  if (tick) tick_();
+  return static_cast<std::size_t>(stats_.samples - before);
+}
+
+void SampleCollector::run() {
+  stopping_ = false;
+  while (!stopping_) poll(-1);
+}
+
+void SampleCollector::stop() {
+  const uint64_t one = 1;
+  (void)!::write(stop_fd_, &one, sizeof one);
+}
+
+#else
+
+struct SampleCollector::Rx {};
+
+SampleCollector::SampleCollector(TelemetryAgent& agent, CollectorConfig cfg) : agent_(agent), cfg_(std::move(cfg)) {
+  throw std::runtime_error("sample collector: not supported on this platform");
+}
+
+SampleCollector::~SampleCollector() = default;
+uint16_t SampleCollector::bind_udp(const std::string&, uint16_t) { return 0; }
+void SampleCollector::bind_unix(const std::string&) {}
+void SampleCollector::add_socket(int) {}
+void SampleCollector::drain_(int) {}
+void SampleCollector::tick_() {}
+std::size_t SampleCollector::poll(int) { return 0; }
+void SampleCollector::run() {}
+void SampleCollector::stop() {}
+
+#endif
+
+} // namespace telemetry
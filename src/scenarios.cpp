@@ -6,7 +6,12 @@
 namespace telemetry {
 
 ScenarioGenerator::ScenarioGenerator(ScenarioId id, ImperfectDataConfig imp)
-  : id_(id), imp_(imp) {}
+  : id_(id), imp_(imp) {
+  if (id_ == ScenarioId::D) { // D always has missing and late samples
+    imp_.enable_missing = true;
+    imp_.enable_late = true;
+  }
+}
 
 const char* scenario_name(ScenarioId id) {
   switch (id) {
@@ -25,12 +30,7 @@ double ScenarioGenerator::lerp(double a, double b, double u) {
 
 std::optional<ScenarioGenerator::Generated>
 ScenarioGenerator::sample(const std::string& iface, int64_t t) const {
-  ImperfectDataConfig imp = imp_;
-  if (id_ == ScenarioId::D) {
-    imp.enable_missing = true;
-    imp.enable_late = true;
-  }
-
+  const ImperfectDataConfig& imp = imp_;
   if (imp.enable_missing && imp.drop_every_n > 0) {
     const int salt = static_cast<int>(iface.size());
     if (((t + salt) % imp.drop_every_n) == 0) return std::nullopt;
@@ -0,0 +1,41 @@
+// score_ranking.cpp
+#include "score_ranking.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace telemetry {
+
+namespace {
+// Keeps the ordering a strict weak order.
+double rank_score(double score) { return std::isnan(score) ? -std::numeric_limits<double>::infinity() : score; }
+} // namespace
+
+void ScoreRanking::resize(std::size_t n) {
+  for (std::size_t id = where_.size(); id < n; ++id) {
+    const Key k{static_cast<uint8_t>(IfStatus::Degraded), 0.0, static_cast<InterfaceId>(id)};
+    where_.push_back(set_.insert(k).first);
+  }
+}
+
+void ScoreRanking::update(InterfaceId id, IfStatus status, double score) {
+  const auto s = static_cast<uint8_t>(status);
+  const double r = rank_score(score);
+  const Key& cur = *where_[id];
+  if (cur.status == s && cur.score == r) return;
+  auto node = set_.extract(where_[id]);
+  node.value().status = s;
+  node.value().score = r;
+  where_[id] = set_.insert(std::move(node)).position;
+}
+
+std::size_t ScoreRanking::best(std::size_t k, IfStatus min_status, std::span<InterfaceId> out) const {
+  k = std::min(k, out.size());
+  const auto worst = static_cast<uint8_t>(min_status);
+  std::size_t n = 0;
+  for (auto it = set_.begin(); n < k && it != set_.end() && it->status <= worst; ++it) out[n++] = it->id;
+  return n;
+}
+
+} // namespace telemetry
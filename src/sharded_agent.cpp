@@ -0,0 +1,178 @@
+// sharded_agent.cpp
+#include "sharded_agent.hpp"
+
+#include <cassert>
+
+namespace telemetry {
+
+namespace {
+// Spin this many empty polls before a worker goes to sleep.
+constexpr int kIdleSpins = 256;
+}
+
+ShardedTelemetryAgent::ShardedTelemetryAgent(AgentConfig cfg, std::size_t shards,
+                                             std::size_t queue_capacity, TransitionLogConfig log)
+  : merged_transitions_(log) {
+  if (shards == 0) shards = 1;
+  shards_.reserve(shards);
+  for (std::size_t i = 0; i < shards; ++i) {
+    shards_.push_back(std::make_unique<Shard>(cfg, queue_capacity, log, static_cast<uint32_t>(i)));
+  }
+  for (auto& sh : shards_) {
+    Shard* p = sh.get();
+    sh->worker = std::thread([this, p] { run_shard_(*p); });
+  }
+}
+
+ShardedTelemetryAgent::~ShardedTelemetryAgent() {
+  Command stop;
+  stop.kind = CmdKind::Stop;
+  for (auto& sh : shards_) push_blocking_(*sh, stop);
+  for (auto& sh : shards_) sh->worker.join();
+}
+
+InterfaceId ShardedTelemetryAgent::register_interface(std::string_view iface) {
+  std::lock_guard<std::mutex> lk(reg_mu_);
+  if (auto it = index_.find(iface); it != index_.end()) return it->second;
+
+  const auto id = static_cast<InterfaceId>(names_.size());
+  names_.emplace_back(iface);
+  index_.emplace(std::string(iface), id);
+
+  // Under reg_mu_, each shard sees its names in local-id order.
+  Shard& sh = shard_of(id);
+  std::lock_guard<std::mutex> slk(sh.reg_mu);
+  sh.pending_names.emplace_back(iface);
+  return id;
+}
+
+std::optional<InterfaceId> ShardedTelemetryAgent::find_interface(std::string_view iface) const {
+  std::lock_guard<std::mutex> lk(reg_mu_);
+  if (auto it = index_.find(iface); it != index_.end()) return it->second;
+  return std::nullopt;
+}
+
+std::size_t ShardedTelemetryAgent::size() const {
+  std::lock_guard<std::mutex> lk(reg_mu_);
+  return names_.size();
+}
+
+void ShardedTelemetryAgent::wake_(Shard& sh) {
+  // Pairs with the fence in run_shard_(): either the worker sees the new
+  // command on its re-check, or we see it sleeping and bump the generation.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (sh.sleeping.load(std::memory_order_relaxed)) {
+    sh.wake_gen.fetch_add(1, std::memory_order_release);
+    sh.wake_gen.notify_one();
+  }
+}
+
+void ShardedTelemetryAgent::push_blocking_(Shard& sh, const Command& cmd) {
+  while (!sh.queue.try_push(cmd)) {
+    wake_(sh);
+    std::this_thread::yield();
+  }
+  wake_(sh);
+}
+
+bool ShardedTelemetryAgent::try_ingest(InterfaceId id, int64_t ts, const Metrics& m) {
+  Shard& sh = shard_of(id);
+  if (!sh.queue.try_push(Command{CmdKind::Sample, local_of(id), ts, m})) return false;
+  wake_(sh);
+  return true;
+}
+
+void ShardedTelemetryAgent::ingest(InterfaceId id, int64_t ts, const Metrics& m) {
+  push_blocking_(shard_of(id), Command{CmdKind::Sample, local_of(id), ts, m});
+}
+
+void ShardedTelemetryAgent::note_time(int64_t ts_now) {
+  tick_pending_.store(shards_.size(), std::memory_order_relaxed);
+  Command tick;
+  tick.kind = CmdKind::Tick;
+  tick.ts = ts_now;
+  for (auto& sh : shards_) push_blocking_(*sh, tick);
+
+  // Barrier: wait for every shard to finish the tick.
+  for (std::size_t left = tick_pending_.load(std::memory_order_acquire); left != 0;
+       left = tick_pending_.load(std::memory_order_acquire)) {
+    tick_pending_.wait(left, std::memory_order_acquire);
+  }
+
+  // Merge: global id g lives in shard g % S at local index g / S.
+  const std::size_t n_shards = shards_.size();
+  std::size_t total = 0;
+  for (const auto& sh : shards_) total += sh->snapshots.size();
+  merged_.resize(total);
+  for (std::size_t g = 0; g < total; ++g) {
+    const auto& snaps = shards_[g % n_shards]->snapshots;
+    const std::size_t local = g / n_shards;
+    if (local < snaps.size()) merged_[g] = snaps[local];
+  }
+  for (auto& sh : shards_) {
+    sh->transitions.drain([this](const TransitionEvent& ev) { merged_transitions_.push(ev); });
+  }
+}
+
+std::vector<TransitionEvent> ShardedTelemetryAgent::drain_transitions() {
+  std::vector<TransitionEvent> out;
+  out.reserve(merged_transitions_.size());
+  merged_transitions_.drain([&out](const TransitionEvent& ev) { out.push_back(ev); });
+  return out;
+}
+
+void ShardedTelemetryAgent::sync_registrations_(Shard& sh) {
+  std::vector<std::string> names;
+  {
+    std::lock_guard<std::mutex> lk(sh.reg_mu);
+    names.swap(sh.pending_names);
+  }
+  for (const auto& n : names) {
+    [[maybe_unused]] const InterfaceId local = sh.agent.register_interface(n);
+    assert(local + 1 == sh.agent.size());
+  }
+}
+
+void ShardedTelemetryAgent::run_shard_(Shard& sh) {
+  Command cmd;
+  int idle = 0;
+  for (;;) {
+    if (!sh.queue.try_pop(cmd)) {
+      if (++idle < kIdleSpins) continue;
+      const uint32_t gen = sh.wake_gen.load(std::memory_order_acquire);
+      sh.sleeping.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (sh.queue.empty()) sh.wake_gen.wait(gen, std::memory_order_acquire);
+      sh.sleeping.store(false, std::memory_order_relaxed);
+      idle = 0;
+      continue;
+    }
+    idle = 0;
+
+    switch (cmd.kind) {
+      case CmdKind::Sample:
+        if (cmd.local >= sh.agent.size()) sync_registrations_(sh);
+        sh.agent.ingest(cmd.local, cmd.ts, cmd.m);
+        break;
+
+      case CmdKind::Tick: {
+        sync_registrations_(sh);
+        sh.agent.note_time(cmd.ts);
+        sh.snapshots.resize(sh.agent.size());
+        for (InterfaceId i = 0; i < sh.agent.size(); ++i) sh.snapshots[i] = sh.agent.snapshot(i);
+        const auto n_shards = static_cast<InterfaceId>(shards_.size());
+        sh.agent.drain_transitions([&sh, n_shards](TransitionEvent ev) {
+          ev.id = ev.id * n_shards + sh.index;
+          sh.transitions.push(ev);
+        });
+        if (tick_pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) tick_pending_.notify_all();
+        break;
+      }
+
+      case CmdKind::Stop:
+        return;
+    }
+  }
+}
+
+} // namespace telemetry
@@ -0,0 +1,509 @@
+// snapshot_export.cpp
+#include "snapshot_export.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define TELEMETRY_EXPORT_POSIX 1
+#else
+#define TELEMETRY_EXPORT_POSIX 0
+#endif
+
+namespace telemetry {
+
+namespace {
+constexpr auto kRelaxed = std::memory_order_relaxed;
+constexpr std::size_t kHeaderWords = sizeof(WireFrameHeader) / 8;
+constexpr uint32_t kMaxPayload = 1u << 28;
+constexpr uint32_t kMaxNamedId = 1u << 24;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && sizeof(std::atomic<uint64_t>) == 8,
+              "shared-memory ring needs address-free 64-bit atomics");
+
+[[noreturn]] void fail(const char* what) { throw std::runtime_error(std::string("snapshot frame: ") + what); }
+
+[[noreturn]] void fail_errno(const std::string& what) {
+  throw std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+template <typename T>
+void store_words(std::atomic<uint64_t>* dst, const T& v) {
+  static_assert(sizeof(T) % 8 == 0);
+  const auto w = std::bit_cast<std::array<uint64_t, sizeof(T) / 8>>(v);
+  for (std::size_t i = 0; i < w.size(); ++i) dst[i].store(w[i], kRelaxed);
+}
+
+// Appends name entries for ids [from, to) to out; returns how many.
+uint32_t append_names(const TelemetryAgent& agent, std::size_t from, std::size_t to, std::vector<uint64_t>& out) {
+  uint32_t count = 0;
+  for (std::size_t id = from; id < to; ++id) {
+    const std::string& name = agent.snapshot(static_cast<InterfaceId>(id)).iface;
+    const std::size_t at = out.size();
+    out.resize(at + 1 + (name.size() + 7) / 8, 0);
+    out[at] = static_cast<uint64_t>(id) | static_cast<uint64_t>(name.size()) << 32;
+    std::memcpy(out.data() + at + 1, name.data(), name.size());
+    ++count;
+  }
+  return count;
+}
+
+WireFrameHeader tick_header(uint64_t seq, int64_t tick_ts, std::size_t n, std::size_t events) {
+  WireFrameHeader h;
+  h.kind = FrameKind::Tick;
+  h.seq = seq;
+  h.tick_ts = tick_ts;
+  h.snapshot_count = static_cast<uint32_t>(n);
+  h.event_count = static_cast<uint32_t>(events);
+  h.payload_bytes = static_cast<uint32_t>(n * sizeof(WireSnapshot) + events * sizeof(WireTransition));
+  return h;
+}
+} // namespace
+
+WireSnapshot to_wire(InterfaceId id, const InterfaceSnapshot& s) {
+  WireSnapshot w;
+  w.id = id;
+  w.status = static_cast<uint8_t>(s.status);
+  w.score_raw = s.score_raw;
+  w.score_smoothed = s.score_smoothed;
+  w.score_used = s.score_used;
+  w.confidence = s.confidence;
+  w.missing_rate = s.missing_rate;
+  w.avg_tp_mbps = s.avg_tp_mbps;
+  w.avg_rtt_ms = s.avg_rtt_ms;
+  w.avg_loss_pct = s.avg_loss_pct;
+  w.avg_jitter_ms = s.avg_jitter_ms;
+  return w;
+}
+
+WireTransition to_wire(const TransitionEvent& ev) {
+  WireTransition w;
+  w.id = ev.id;
+  w.from = static_cast<uint8_t>(ev.from);
+  w.to = static_cast<uint8_t>(ev.to);
+  w.reason = static_cast<uint8_t>(ev.reason);
+  w.ts = ev.ts;
+  return w;
+}
+
+FrameView parse_frame(std::span<const uint64_t> words) {
+  if (words.size() < kHeaderWords) fail("truncated header");
+  FrameView f;
+  std::memcpy(static_cast<void*>(&f.header), words.data(), sizeof f.header);
+  const WireFrameHeader& h = f.header;
+  if (h.magic != WireFrameHeader::kMagic) fail("bad magic");
+  if (h.version != WireFrameHeader::kVersion) fail("unsupported version");
+  if (h.header_size != sizeof(WireFrameHeader) || h.snapshot_size != sizeof(WireSnapshot) ||
+      h.event_size != sizeof(WireTransition)) {
+    fail("unexpected record size");
+  }
+  if (h.payload_bytes != (words.size() - kHeaderWords) * 8) fail("payload size mismatch");
+
+  const auto* payload = reinterpret_cast<const std::byte*>(words.data() + kHeaderWords);
+  switch (h.kind) {
+    case FrameKind::Tick:
+      if (static_cast<uint64_t>(h.snapshot_count) * sizeof(WireSnapshot) +
+              static_cast<uint64_t>(h.event_count) * sizeof(WireTransition) != h.payload_bytes) {
+        fail("payload size mismatch");
+      }
+      f.snapshots = {reinterpret_cast<const WireSnapshot*>(payload), h.snapshot_count};
+      f.events = {reinterpret_cast<const WireTransition*>(payload + h.snapshot_count * sizeof(WireSnapshot)),
+                  h.event_count};
+      break;
+    case FrameKind::Names:
+      f.name_table = {payload, h.payload_bytes};
+      break;
+    default:
+      fail("unknown frame kind");
+  }
+  return f;
+}
+
+void decode_names(const FrameView& f, std::vector<std::string>& names) {
+  std::span<const std::byte> t = f.name_table;
+  for (uint32_t k = 0; k < f.header.name_count; ++k) {
+    uint64_t entry = 0;
+    if (t.size() < sizeof entry) fail("truncated name table");
+    std::memcpy(&entry, t.data(), sizeof entry);
+    const auto id = static_cast<uint32_t>(entry);
+    const auto len = static_cast<std::size_t>(entry >> 32);
+    const std::size_t padded = (len + 7) / 8 * 8;
+    if (id >= kMaxNamedId || t.size() - sizeof entry < padded) fail("corrupt name table");
+    if (id >= names.size()) names.resize(static_cast<std::size_t>(id) + 1);
+    names[id].assign(reinterpret_cast<const char*>(t.data() + sizeof entry), len);
+    t = t.subspan(sizeof entry + padded);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Socket sink
+
+SocketSnapshotSink::SocketSnapshotSink(int fd) : fd_(fd) {
+  if (fd_ < 0) throw std::invalid_argument("SocketSnapshotSink: invalid fd");
+#if TELEMETRY_EXPORT_POSIX && defined(SO_NOSIGPIPE)
+  const int one = 1;
+  ::setsockopt(fd_, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof one);
+#endif
+}
+
+SocketSnapshotSink SocketSnapshotSink::connect(const std::string& path) {
+#if TELEMETRY_EXPORT_POSIX
+  sockaddr_un addr{};
+  if (path.size() >= sizeof addr.sun_path) throw std::invalid_argument("SocketSnapshotSink: socket path too long");
+  addr.sun_family = AF_UNIX;
+  std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+  const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) fail_errno("snapshot socket " + path);
+  if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) != 0) {
+    const int err = errno;
+    ::close(fd);
+    errno = err;
+    fail_errno("snapshot socket " + path);
+  }
+  return SocketSnapshotSink(fd);
+#else
+  throw std::runtime_error("snapshot socket " + path + ": not supported on this platform");
+#endif
+}
+
+SocketSnapshotSink::SocketSnapshotSink(SocketSnapshotSink&& other) noexcept
+    : fd_(other.fd_),
+      seq_(other.seq_),
+      names_sent_(other.names_sent_),
+      snaps_(std::move(other.snaps_)),
+      events_(std::move(other.events_)),
+      names_(std::move(other.names_)) {
+  other.fd_ = -1;
+}
+
+SocketSnapshotSink::~SocketSnapshotSink() {
+#if TELEMETRY_EXPORT_POSIX
+  if (fd_ >= 0) ::close(fd_);
+#endif
+}
+
+void SocketSnapshotSink::send_(const WireFrameHeader& h, std::span<const std::span<const std::byte>> parts) {
+#if TELEMETRY_EXPORT_POSIX
+  std::array<iovec, 4> iov{};
+  std::size_t n = 0;
+  iov[n++] = {const_cast<WireFrameHeader*>(&h), sizeof h};
+  for (const auto& p : parts) {
+    if (!p.empty()) iov[n++] = {const_cast<std::byte*>(p.data()), p.size()};
+  }
+
+  // Gather write; a stream socket may take it in pieces.
+  std::size_t first = 0;
+  while (first < n) {
+    msghdr msg{};
+    msg.msg_iov = iov.data() + first;
+    msg.msg_iovlen = static_cast<decltype(msg.msg_iovlen)>(n - first);
+#ifdef MSG_NOSIGNAL
+    const ssize_t sent = ::sendmsg(fd_, &msg, MSG_NOSIGNAL);
+#else
+    const ssize_t sent = ::sendmsg(fd_, &msg, 0);
+#endif
+    if (sent < 0) {
+      if (errno == EINTR) continue;
+      fail_errno("snapshot socket");
+    }
+    auto left = static_cast<std::size_t>(sent);
+    while (first < n && left >= iov[first].iov_len) left -= iov[first++].iov_len;
+    if (first < n) {
+      iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + left;
+      iov[first].iov_len -= left;
+    }
+  }
+#else
+  (void)h;
+  (void)parts;
+  throw std::runtime_error("snapshot socket: not supported on this platform");
+#endif
+}
+
+void SocketSnapshotSink::publish(const TelemetryAgent& agent, int64_t tick_ts,
+                                 std::span<const TransitionEvent> events) {
+  const std::size_t n = agent.size();
+  // Refuse before anything is written: read_frame() would reject the frame
+  // and the peer would lose the stream.
+  if (n * sizeof(WireSnapshot) + events.size() * sizeof(WireTransition) > kMaxPayload) {
+    throw std::length_error("SocketSnapshotSink: tick frame exceeds the payload limit");
+  }
+  if (n > names_sent_) {
+    names_.clear();
+    WireFrameHeader h;
+    h.kind = FrameKind::Names;
+    h.seq = seq_;
+    h.tick_ts = tick_ts;
+    h.name_count = append_names(agent, names_sent_, n, names_);
+    if (names_.size() * 8 > kMaxPayload) throw std::length_error("SocketSnapshotSink: names exceed the payload limit");
+    h.payload_bytes = static_cast<uint32_t>(names_.size() * 8);
+    const std::span<const std::byte> parts[] = {std::as_bytes(std::span<const uint64_t>(names_))};
+    send_(h, parts);
+    ++seq_;
+    names_sent_ = n;
+  }
+
+  snaps_.resize(n);
+  for (std::size_t i = 0; i < n; ++i) snaps_[i] = to_wire(static_cast<InterfaceId>(i), agent.snapshot(static_cast<InterfaceId>(i)));
+  events_.resize(events.size());
+  for (std::size_t k = 0; k < events.size(); ++k) events_[k] = to_wire(events[k]);
+
+  const WireFrameHeader h = tick_header(seq_, tick_ts, n, events.size());
+  const std::span<const std::byte> parts[] = {std::as_bytes(std::span<const WireSnapshot>(snaps_)),
+                                              std::as_bytes(std::span<const WireTransition>(events_))};
+  send_(h, parts);
+  ++seq_;
+}
+
+#if TELEMETRY_EXPORT_POSIX
+namespace {
+// 1 = filled, 0 = clean EOF before the first byte; throws on errors and on
+// EOF part way through.
+int read_full(int fd, void* dst, std::size_t len) {
+  auto* p = static_cast<char*>(dst);
+  std::size_t got = 0;
+  while (got < len) {
+    const ssize_t r = ::read(fd, p + got, len - got);
+    if (r < 0) {
+      if (errno == EINTR) continue;
+      fail_errno("snapshot socket");
+    }
+    if (r == 0) {
+      if (got == 0) return 0;
+      fail("truncated frame");
+    }
+    got += static_cast<std::size_t>(r);
+  }
+  return 1;
+}
+} // namespace
+#endif
+
+bool read_frame(int fd, std::vector<uint64_t>& words) {
+#if TELEMETRY_EXPORT_POSIX
+  WireFrameHeader h;
+  if (read_full(fd, &h, sizeof h) == 0) return false;
+  if (h.magic != WireFrameHeader::kMagic) fail("bad magic");
+  if (h.payload_bytes > kMaxPayload || h.payload_bytes % 8 != 0) fail("bad payload size");
+  words.resize(kHeaderWords + h.payload_bytes / 8);
+  std::memcpy(words.data(), &h, sizeof h);
+  if (h.payload_bytes > 0 && read_full(fd, words.data() + kHeaderWords, h.payload_bytes) == 0) {
+    fail("truncated frame");
+  }
+  return true;
+#else
+  (void)fd;
+  (void)words;
+  throw std::runtime_error("snapshot socket: not supported on this platform");
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Shared-memory ring
+//
+// All 64-bit words:
+//   [0, 8)            ring header (kMagicWord last to be written)
+//   [8, 8 + N)        name table: seq, byte length, count, entries
+//   then slot_count x {seq, slot_words of frame}
+
+struct ShmSnapshotRing::Layout {
+  static constexpr uint64_t kMagicWord = 0x31524D48534D4C54; // "TLMSHMR1"
+  static constexpr uint64_t kVersion = 1;
+  enum : std::size_t { kMagic, kVersionWord, kSlotCount, kSlotWords, kNameWords, kPublished, kHeaderWords = 8 };
+
+  uint32_t slot_count;
+  uint32_t slot_words;
+  uint32_t name_words; // including seq, length and count
+
+  static Layout of(const ShmRingConfig& c) {
+    const uint64_t frame = sizeof(WireFrameHeader) + static_cast<uint64_t>(c.max_interfaces) * sizeof(WireSnapshot) +
+                           static_cast<uint64_t>(c.max_events) * sizeof(WireTransition);
+    return Layout{c.slot_count, static_cast<uint32_t>(frame / 8), 3 + (c.name_bytes + 7) / 8};
+  }
+  std::size_t names_at() const { return kHeaderWords; }
+  std::size_t slot_at(uint64_t k) const {
+    return kHeaderWords + name_words + static_cast<std::size_t>(k % slot_count) * (1 + slot_words);
+  }
+  std::size_t words() const { return kHeaderWords + name_words + static_cast<std::size_t>(slot_count) * (1 + slot_words); }
+};
+
+ShmSnapshotRing::ShmSnapshotRing(const std::string& name, ShmRingConfig cfg) : name_(name), cfg_(cfg) {
+  if (name.size() < 2 || name[0] != '/') throw std::invalid_argument("ShmSnapshotRing: name must look like /name");
+  if (cfg.slot_count == 0 || cfg.max_interfaces == 0) throw std::invalid_argument("ShmSnapshotRing: empty ring");
+  if (static_cast<uint64_t>(cfg.max_interfaces) * sizeof(WireSnapshot) > kMaxPayload) {
+    throw std::length_error("ShmSnapshotRing: slots too large");
+  }
+#if TELEMETRY_EXPORT_POSIX
+  const Layout L = Layout::of(cfg);
+  bytes_ = L.words() * 8;
+  const int fd = ::shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+  if (fd < 0) fail_errno("shm " + name);
+  void* p = MAP_FAILED;
+  if (::ftruncate(fd, static_cast<off_t>(bytes_)) == 0) {
+    p = ::mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  const int err = errno;
+  ::close(fd);
+  if (p == MAP_FAILED) {
+    ::shm_unlink(name.c_str());
+    errno = err;
+    fail_errno("shm " + name);
+  }
+  base_ = static_cast<std::atomic<uint64_t>*>(p);
+  base_[Layout::kVersionWord].store(Layout::kVersion, kRelaxed);
+  base_[Layout::kSlotCount].store(L.slot_count, kRelaxed);
+  base_[Layout::kSlotWords].store(L.slot_words, kRelaxed);
+  base_[Layout::kNameWords].store(L.name_words, kRelaxed);
+  base_[Layout::kMagic].store(Layout::kMagicWord, std::memory_order_release);
+#else
+  throw std::runtime_error("shm " + name + ": not supported on this platform");
+#endif
+}
+
+ShmSnapshotRing::~ShmSnapshotRing() {
+#if TELEMETRY_EXPORT_POSIX
+  if (base_) {
+    ::munmap(base_, bytes_);
+    ::shm_unlink(name_.c_str());
+  }
+#endif
+}
+
+void ShmSnapshotRing::publish(const TelemetryAgent& agent, int64_t tick_ts, std::span<const TransitionEvent> events) {
+  const std::size_t n = agent.size();
+  if (n > cfg_.max_interfaces) throw std::length_error("ShmSnapshotRing: more interfaces than max_interfaces");
+  if (events.size() > cfg_.max_events) throw std::length_error("ShmSnapshotRing: more transitions than max_events");
+  const Layout L = Layout::of(cfg_);
+
+  if (n != names_written_) {
+    names_.clear();
+    const uint32_t count = append_names(agent, 0, n, names_);
+    if (3 + names_.size() > L.name_words) throw std::length_error("ShmSnapshotRing: names exceed name_bytes");
+    std::atomic<uint64_t>* t = base_ + L.names_at();
+    const uint64_t s = t[0].load(kRelaxed);
+    t[0].store(s + 1, kRelaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    t[1].store(names_.size() * 8, kRelaxed);
+    t[2].store(count, kRelaxed);
+    for (std::size_t i = 0; i < names_.size(); ++i) t[3 + i].store(names_[i], kRelaxed);
+    t[0].store(s + 2, std::memory_order_release);
+    names_written_ = n;
+  }
+
+  std::atomic<uint64_t>* slot = base_ + L.slot_at(seq_);
+  slot[0].store(2 * seq_ + 1, kRelaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  std::atomic<uint64_t>* w = slot + 1;
+  store_words(w, tick_header(seq_, tick_ts, n, events.size()));
+  w += kHeaderWords;
+  for (std::size_t i = 0; i < n; ++i, w += sizeof(WireSnapshot) / 8) {
+    store_words(w, to_wire(static_cast<InterfaceId>(i), agent.snapshot(static_cast<InterfaceId>(i))));
+  }
+  for (const TransitionEvent& ev : events) {
+    store_words(w, to_wire(ev));
+    w += sizeof(WireTransition) / 8;
+  }
+  slot[0].store(2 * seq_ + 2, std::memory_order_release);
+  ++seq_;
+  base_[Layout::kPublished].store(seq_, std::memory_order_release);
+}
+
+ShmSnapshotReader::ShmSnapshotReader(const std::string& name) {
+#if TELEMETRY_EXPORT_POSIX
+  const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) fail_errno("shm " + name);
+  struct stat st {};
+  void* p = MAP_FAILED;
+  if (::fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= 8 * ShmSnapshotRing::Layout::kHeaderWords) {
+    bytes_ = static_cast<std::size_t>(st.st_size);
+    p = ::mmap(nullptr, bytes_, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  ::close(fd);
+  if (p == MAP_FAILED) throw std::runtime_error("shm " + name + ": not a snapshot ring");
+  base_ = static_cast<const std::atomic<uint64_t>*>(p);
+
+  using L = ShmSnapshotRing::Layout;
+  const bool ok = base_[L::kMagic].load(std::memory_order_acquire) == L::kMagicWord &&
+                  base_[L::kVersionWord].load(kRelaxed) == L::kVersion;
+  slot_count_ = static_cast<uint32_t>(base_[L::kSlotCount].load(kRelaxed));
+  slot_words_ = static_cast<uint32_t>(base_[L::kSlotWords].load(kRelaxed));
+  name_words_ = static_cast<uint32_t>(base_[L::kNameWords].load(kRelaxed));
+  const L layout{slot_count_, slot_words_, name_words_};
+  if (!ok || slot_count_ == 0 || name_words_ < 3 || slot_words_ < kHeaderWords || layout.words() * 8 > bytes_) {
+    ::munmap(const_cast<std::atomic<uint64_t>*>(base_), bytes_);
+    base_ = nullptr;
+    throw std::runtime_error("shm " + name + ": not a snapshot ring");
+  }
+#else
+  throw std::runtime_error("shm " + name + ": not supported on this platform");
+#endif
+}
+
+ShmSnapshotReader::~ShmSnapshotReader() {
+#if TELEMETRY_EXPORT_POSIX
+  if (base_) ::munmap(const_cast<std::atomic<uint64_t>*>(base_), bytes_);
+#endif
+}
+
+uint64_t ShmSnapshotReader::published() const {
+  return base_[ShmSnapshotRing::Layout::kPublished].load(std::memory_order_acquire);
+}
+
+ShmRead ShmSnapshotReader::read(uint64_t k, std::vector<uint64_t>& words) const {
+  if (k >= published()) return ShmRead::NotReady;
+  const ShmSnapshotRing::Layout L{slot_count_, slot_words_, name_words_};
+  const std::atomic<uint64_t>* slot = base_ + L.slot_at(k);
+  const uint64_t s1 = slot[0].load(std::memory_order_acquire);
+  if (s1 != 2 * k + 2) return ShmRead::Overrun; // published, so only a lap moves it
+
+  // The payload length comes from the slot itself; clamp it so a torn
+  // header cannot run the copy off the slot.
+  words.resize(kHeaderWords);
+  for (std::size_t i = 0; i < kHeaderWords; ++i) words[i] = slot[1 + i].load(kRelaxed);
+  WireFrameHeader h;
+  std::memcpy(static_cast<void*>(&h), words.data(), sizeof h);
+  const std::size_t payload = std::min<std::size_t>(h.payload_bytes / 8, slot_words_ - kHeaderWords);
+  words.resize(kHeaderWords + payload);
+  for (std::size_t i = kHeaderWords; i < words.size(); ++i) words[i] = slot[1 + i].load(kRelaxed);
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return slot[0].load(kRelaxed) == s1 ? ShmRead::Ok : ShmRead::Overrun;
+}
+
+bool ShmSnapshotReader::read_latest(std::vector<uint64_t>& words) const {
+  for (;;) {
+    const uint64_t p = published();
+    if (p == 0) return false;
+    if (read(p - 1, words) == ShmRead::Ok) return true;
+  }
+}
+
+bool ShmSnapshotReader::names(std::vector<std::string>& out) const {
+  const std::atomic<uint64_t>* t = base_ + ShmSnapshotRing::Layout::kHeaderWords;
+  const uint64_t s1 = t[0].load(std::memory_order_acquire);
+  if (s1 % 2 != 0) return false;
+  const std::size_t len = std::min<std::size_t>(t[1].load(kRelaxed) / 8, name_words_ - 3);
+  FrameView f;
+  f.header.name_count = static_cast<uint32_t>(t[2].load(kRelaxed));
+  std::vector<uint64_t> table(len);
+  for (std::size_t i = 0; i < len; ++i) table[i] = t[3 + i].load(kRelaxed);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (t[0].load(kRelaxed) != s1) return false;
+  f.name_table = std::as_bytes(std::span<const uint64_t>(table));
+  out.clear();
+  decode_names(f, out);
+  return true;
+}
+
+} // namespace telemetry
@@ -0,0 +1,132 @@
+// snapshot_table.cpp
+#include "snapshot_table.hpp"
+
+#include <bit>
+#include <stdexcept>
+
+namespace telemetry {
+
+namespace {
+constexpr auto kRelaxed = std::memory_order_relaxed;
+
+uint64_t bits(double v) { return std::bit_cast<uint64_t>(v); }
+double from_bits(uint64_t v) { return std::bit_cast<double>(v); }
+}
+
+void SnapshotTable::store_(Entry& e, const InterfaceSnapshot& s) {
+  e[0].store(static_cast<uint64_t>(s.status), kRelaxed);
+  e[1].store(bits(s.score_raw), kRelaxed);
+  e[2].store(bits(s.score_smoothed), kRelaxed);
+  e[3].store(bits(s.score_used), kRelaxed);
+  e[4].store(bits(s.confidence), kRelaxed);
+  e[5].store(bits(s.missing_rate), kRelaxed);
+  e[6].store(bits(s.avg_tp_mbps), kRelaxed);
+  e[7].store(bits(s.avg_rtt_ms), kRelaxed);
+  e[8].store(bits(s.avg_loss_pct), kRelaxed);
+  e[9].store(bits(s.avg_jitter_ms), kRelaxed);
+}
+
+void SnapshotTable::load_(const Entry& e, PublishedSnapshot& out) {
+  out.status = static_cast<IfStatus>(e[0].load(kRelaxed));
+  out.score_raw = from_bits(e[1].load(kRelaxed));
+  out.score_smoothed = from_bits(e[2].load(kRelaxed));
+  out.score_used = from_bits(e[3].load(kRelaxed));
+  out.confidence = from_bits(e[4].load(kRelaxed));
+  out.missing_rate = from_bits(e[5].load(kRelaxed));
+  out.avg_tp_mbps = from_bits(e[6].load(kRelaxed));
+  out.avg_rtt_ms = from_bits(e[7].load(kRelaxed));
+  out.avg_loss_pct = from_bits(e[8].load(kRelaxed));
+  out.avg_jitter_ms = from_bits(e[9].load(kRelaxed));
+}
+
+void SnapshotTable::reserve(std::size_t n) {
+  if (n > kChunk * kMaxChunks) throw std::length_error("SnapshotTable: too many interfaces");
+  owned_.reserve(2 * ((n + kChunk - 1) / kChunk));
+  for (Buffer& b : buf_) allocate_chunks_(b, n);
+  prev_changed_.reserve(n);
+}
+
+// Chunks never move or shrink, so readers may hold pointers into them.
+void SnapshotTable::allocate_chunks_(Buffer& b, std::size_t n) {
+  for (std::size_t c = 0; c * kChunk < n; ++c) {
+    if (b.chunks[c].load(kRelaxed) != nullptr) continue;
+    owned_.push_back(std::make_unique<Entry[]>(kChunk));
+    b.chunks[c].store(owned_.back().get(), std::memory_order_release);
+  }
+}
+
+SnapshotTable::Buffer& SnapshotTable::begin_write_(std::size_t n) {
+  if (n > kChunk * kMaxChunks) throw std::length_error("SnapshotTable: too many interfaces");
+
+  Buffer& b = buf_[1 - front_.load(kRelaxed)];
+  allocate_chunks_(b, n); // before entering the write section
+
+  b.seq.store(b.seq.load(kRelaxed) + 1, kRelaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  return b;
+}
+
+void SnapshotTable::end_write_(Buffer& b, int64_t tick_ts, std::size_t n) {
+  b.count.store(n, kRelaxed);
+  b.tick_ts.store(tick_ts, kRelaxed);
+  b.seq.store(b.seq.load(kRelaxed) + 1, std::memory_order_release);
+  front_.store(static_cast<uint32_t>(&b - buf_), std::memory_order_release);
+  version_.fetch_add(1, std::memory_order_release);
+}
+
+// Reader protocol: snapshot seq (must be even), copy, then confirm seq is
+// unchanged; otherwise the writer reused this buffer mid-copy and we retry.
+
+std::size_t SnapshotTable::size() const {
+  for (;;) {
+    const Buffer& b = buf_[front_.load(std::memory_order_acquire)];
+    const uint64_t s0 = b.seq.load(std::memory_order_acquire);
+    if (s0 & 1) continue;
+    const std::size_t n = b.count.load(kRelaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (b.seq.load(kRelaxed) == s0) return n;
+  }
+}
+
+bool SnapshotTable::read(InterfaceId id, PublishedSnapshot& out, int64_t* tick_ts) const {
+  for (;;) {
+    const Buffer& b = buf_[front_.load(std::memory_order_acquire)];
+    const uint64_t s0 = b.seq.load(std::memory_order_acquire);
+    if (s0 & 1) continue;
+    const bool found = id < b.count.load(kRelaxed);
+    if (found) {
+      const Entry* e = entry_(b, id);
+      if (!e) continue;
+      load_(*e, out);
+    }
+    const int64_t ts = b.tick_ts.load(kRelaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (b.seq.load(kRelaxed) != s0) continue;
+    if (tick_ts) *tick_ts = ts;
+    return found;
+  }
+}
+
+std::size_t SnapshotTable::read_all(std::span<PublishedSnapshot> out, int64_t* tick_ts) const {
+  for (;;) {
+    const Buffer& b = buf_[front_.load(std::memory_order_acquire)];
+    const uint64_t s0 = b.seq.load(std::memory_order_acquire);
+    if (s0 & 1) continue;
+    std::size_t n = b.count.load(kRelaxed);
+    if (n > out.size()) n = out.size();
+    bool torn = false;
+    for (std::size_t i = 0; i < n && !torn; ++i) {
+      const Entry* e = entry_(b, i);
+      if (e) load_(*e, out[i]);
+      else torn = true;
+    }
+    if (torn) continue;
+    const int64_t ts = b.tick_ts.load(kRelaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (b.seq.load(kRelaxed) != s0) continue;
+    if (tick_ts) *tick_ts = ts;
+    return n;
+  }
+}
+
+} // namespace telemetry
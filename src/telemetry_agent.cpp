@@ -2,60 +2,354 @@
 #include "telemetry_agent.hpp"
 
 #include <algorithm>
+#include <bit>
+#include <chrono>
 
 namespace telemetry {
 
-TelemetryAgent::TelemetryAgent(AgentConfig cfg) : cfg_(cfg) {}
+#if TELEMETRY_INSTRUMENTATION
+namespace {
+using Clock = std::chrono::steady_clock;
 
-void TelemetryAgent::ensure_interface(const std::string& iface) {
-  if (trackers_.find(iface) != trackers_.end()) return;
-  trackers_.emplace(iface, InterfaceTracker(iface, cfg_));
-  score_sum_[iface] = 0.0;
-  score_count_[iface] = 0;
+uint64_t ns_since(Clock::time_point t0) {
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count());
+}
+
+void count_ingest(IngestCounters& c, RollingWindow::IngestResult res, bool future, bool recomputed,
+                  bool transitioned) {
+  switch (res) {
+    case RollingWindow::IngestResult::Inserted: ++c.ingested; break;
+    case RollingWindow::IngestResult::Overwritten: ++c.ingested; ++c.overwritten; break;
+    case RollingWindow::IngestResult::Merged: ++c.ingested; ++c.merged; break;
+    case RollingWindow::IngestResult::TooOld: ++c.dropped_late; break;
+  }
+  c.future += future;
+  c.recomputes += recomputed;
+  c.transitions += transitioned;
+}
+} // namespace
+#endif
+
+TelemetryAgent::TelemetryAgent(AgentConfig cfg, TransitionLogConfig log)
+  : cfg_(cfg), profiles_(ConfigProfile{cfg.score, cfg.fsm}), transitions_(log) {}
+
+void TelemetryAgent::reserve(std::size_t max_interfaces) {
+  const std::size_t n = max_interfaces;
+  trackers_.reserve(n);
+  profiles_.reserve(n);
+  index_.reserve(n);
+  score_sum_.reserve(n);
+  score_count_.reserve(n);
+  published_.reserve(n);
+  batch_touched_.reserve(n);
+  active_.reserve((n + 63) / 64);
+  wheel_.resize(n);
+  tick_ids_.reserve(n);
+  ranking_.reserve(n);
+  rank_dirty_.reserve((n + 63) / 64);
+  rank_queue_.reserve(n);
+#if TELEMETRY_INSTRUMENTATION
+  iface_stats_.reserve(n);
+#endif
+}
+
+InterfaceId TelemetryAgent::register_interface(std::string_view iface) {
+  if (auto it = index_.find(iface); it != index_.end()) return it->second;
+  const auto id = static_cast<InterfaceId>(trackers_.size());
+  trackers_.emplace_back(std::string(iface), &profiles_.get(kDefaultProfile), cfg_, id);
+  profiles_.add_member(id);
+  index_.emplace(std::string(iface), id);
+  if (recorder_) recorder_->name(id, iface);
+  score_sum_.push_back(0.0);
+  score_count_.push_back(0);
+  if (id % 64 == 0) active_.push_back(0);
+  active_[id / 64] |= uint64_t{1} << (id % 64);
+  wheel_.resize(trackers_.size());
+  ranking_.resize(trackers_.size());
+  if (id % 64 == 0) rank_dirty_.push_back(0);
+#if TELEMETRY_INSTRUMENTATION
+  iface_stats_.emplace_back();
+#endif
+  return id;
+}
+
+std::optional<InterfaceId> TelemetryAgent::find_interface(std::string_view iface) const {
+  if (auto it = index_.find(iface); it != index_.end()) return it->second;
+  return std::nullopt;
+}
+
+void TelemetryAgent::ingest(InterfaceId id, int64_t ts, const Metrics& m) {
+#if TELEMETRY_INSTRUMENTATION
+  const bool timed = (++ingest_calls_ % AgentStats::kIngestTimingEvery) == 0;
+  const auto t0 = timed ? Clock::now() : Clock::time_point{};
+#endif
+  if (recorder_) recorder_->sample(id, ts, m);
+  if (cfg_.tick_scan == TickScan::Active) wake_(id);
+  auto& tr = trackers_[id];
+  [[maybe_unused]] const auto res = tr.ingest(ts, m);
+  const bool eager = cfg_.recompute == RecomputeMode::Eager;
+  if (eager) mark_ranked_(id);
+  const auto ev = tr.drain_transition();
+  if (ev) transitions_.push(*ev);
+#if TELEMETRY_INSTRUMENTATION
+  const bool future = last_tick_ts_ != std::numeric_limits<int64_t>::min() && ts > last_tick_ts_;
+  count_ingest(iface_stats_[id], res, future, eager, ev.has_value());
+  count_ingest(stats_.totals, res, future, eager, ev.has_value());
+  if (timed) stats_.ingest_ns.record(ns_since(t0));
+#endif
 }
 
 void TelemetryAgent::ingest(const std::string& iface, int64_t ts, const Metrics& m) {
-  ensure_interface(iface);
-  auto& tr = trackers_.at(iface);
-  tr.ingest(ts, m);
-  if (auto ev = tr.drain_transition()) pending_transitions_.push_back(*ev);
+  ingest(register_interface(iface), ts, m);
+}
+
+void TelemetryAgent::ingest_batch(std::span<const Sample> batch) {
+  // Windows are independent, so arrival order already keeps each interface's
+  // own sample order; only the evaluation is deferred to the end.
+  const bool eager = cfg_.recompute == RecomputeMode::Eager;
+  const bool scan_active = cfg_.tick_scan == TickScan::Active;
+  batch_touched_.clear();
+  if (recorder_ && !batch.empty()) recorder_->batch_begin();
+  for (const Sample& s : batch) {
+    if (recorder_) recorder_->sample(s.id, s.ts, s.m);
+    if (scan_active) wake_(s.id);
+    auto& tr = trackers_[s.id];
+    if (eager && !tr.dirty()) batch_touched_.push_back(s.id);
+    [[maybe_unused]] const auto res = tr.stage(s.ts, s.m);
+#if TELEMETRY_INSTRUMENTATION
+    const bool future = last_tick_ts_ != std::numeric_limits<int64_t>::min() && s.ts > last_tick_ts_;
+    count_ingest(iface_stats_[s.id], res, future, false, false);
+    count_ingest(stats_.totals, res, future, false, false);
+#endif
+  }
+  if (recorder_ && !batch.empty()) recorder_->batch_end();
+  for (const InterfaceId id : batch_touched_) {
+    auto& tr = trackers_[id];
+    [[maybe_unused]] const bool evaluated = tr.flush();
+    mark_ranked_(id);
+    const auto ev = tr.drain_transition();
+    if (ev) transitions_.push(*ev);
+#if TELEMETRY_INSTRUMENTATION
+    auto& c = iface_stats_[id];
+    c.recomputes += evaluated;
+    c.transitions += ev.has_value();
+    stats_.totals.recomputes += evaluated;
+    stats_.totals.transitions += ev.has_value();
+#endif
+  }
 }
 
 void TelemetryAgent::note_time(int64_t ts_now) {
-  for (auto& [iface, tr] : trackers_) {
-    tr.note_time(ts_now);
-    if (auto ev = tr.drain_transition()) pending_transitions_.push_back(*ev);
+#if TELEMETRY_INSTRUMENTATION
+  const auto t0 = Clock::now();
+#endif
+  if (recorder_) recorder_->tick(ts_now);
+  auto snapshot_of = [this](InterfaceId id) -> const InterfaceSnapshot& { return trackers_[id].snapshot(); };
+  if (cfg_.tick_scan == TickScan::All) {
+    for (InterfaceId id = 0; id < trackers_.size(); ++id) evaluate_(id, ts_now);
+    published_.publish(ts_now, trackers_.size(), snapshot_of);
+  } else {
+    wheel_.advance(ts_now, [this](InterfaceId id) { wake_(id); });
+    tick_ids_.clear();
+    for (std::size_t w = 0; w < active_.size(); ++w) {
+      for (uint64_t bits = active_[w]; bits != 0; bits &= bits - 1) {
+        const auto bit = static_cast<unsigned>(std::countr_zero(bits));
+        const auto id = static_cast<InterfaceId>(w * 64 + bit);
+        evaluate_(id, ts_now);
+        tick_ids_.push_back(id);
+        const int64_t at = trackers_[id].next_change_ts();
+        if (at == kChangeNow) continue;
+        active_[w] &= ~(uint64_t{1} << bit);
+        if (at == kChangeNever) {
+          wheel_.cancel(id);
+        } else {
+          wheel_.schedule(id, at);
+        }
+      }
+    }
+    published_.publish_changed(ts_now, trackers_.size(), tick_ids_, snapshot_of);
   }
+  last_tick_ts_ = ts_now;
+#if TELEMETRY_INSTRUMENTATION
+  ++stats_.ticks;
+  stats_.tick_ns.record(ns_since(t0));
+#endif
+}
+
+void TelemetryAgent::evaluate_(InterfaceId id, int64_t ts_now) {
+  auto& tr = trackers_[id];
+  const bool evaluated = tr.note_time(ts_now);
+  if (evaluated) mark_ranked_(id);
+  const auto ev = tr.drain_transition();
+  if (ev) transitions_.push(*ev);
+#if TELEMETRY_INSTRUMENTATION
+  auto& c = iface_stats_[id];
+  c.recomputes += evaluated;
+  c.transitions += ev.has_value();
+  stats_.totals.recomputes += evaluated;
+  stats_.totals.transitions += ev.has_value();
+#endif
+}
+
+// A sleeper only missed no-op ticks, but its window must catch up with them
+// before it takes a sample.
+void TelemetryAgent::wake_(InterfaceId id) {
+  uint64_t& word = active_[id / 64];
+  const uint64_t bit = uint64_t{1} << (id % 64);
+  if (word & bit) return;
+  word |= bit;
+  trackers_[id].advance_window(last_tick_ts_);
+}
+
+bool TelemetryAgent::restore_tracker(InterfaceId id, int64_t tick_ts, const TrackerState& st,
+                                     int64_t window_newest_ts, const DefaultMetrics::Values& window_sums,
+                                     std::span<const RollingWindow::Storage::Second> seconds) {
+  const bool ok = trackers_[id].restore(st, window_newest_ts, window_sums, seconds);
+  mark_ranked_(id);
+  if (last_tick_ts_ == std::numeric_limits<int64_t>::min()) last_tick_ts_ = tick_ts;
+  reschedule_(id);
+  return ok;
+}
+
+// A sleeper's wake time was computed from its old state or profile.
+void TelemetryAgent::reschedule_(InterfaceId id) {
+  if (cfg_.tick_scan != TickScan::Active) return;
+  wheel_.cancel(id);
+  wake_(id);
+}
+
+void TelemetryAgent::set_profile(ProfileId id, const ConfigProfile& p) {
+  profiles_.replace(id, p);
+  if (id == kDefaultProfile) {
+    cfg_.score = p.score;
+    cfg_.fsm = p.fsm;
+  }
+  for (const InterfaceId m : profiles_.members(id)) {
+    trackers_[m].set_profile(&profiles_.get(id));
+    reschedule_(m);
+  }
+}
+
+void TelemetryAgent::assign_profile(InterfaceId id, ProfileId profile) {
+  if (profiles_.assign(id, profile) == profile) return;
+  trackers_[id].set_profile(&profiles_.get(profile));
+  reschedule_(id);
+}
+
+void TelemetryAgent::mark_ranked_(InterfaceId id) {
+  uint64_t& word = rank_dirty_[id / 64];
+  const uint64_t bit = uint64_t{1} << (id % 64);
+  if (word & bit) return;
+  word |= bit;
+  rank_queue_.push_back(id);
+}
+
+std::size_t TelemetryAgent::best_interfaces(std::size_t k, IfStatus min_status, std::span<InterfaceId> out) {
+  for (const InterfaceId id : rank_queue_) {
+    const auto& snap = trackers_[id].snapshot();
+    ranking_.update(id, snap.status, snap.score_used);
+    rank_dirty_[id / 64] &= ~(uint64_t{1} << (id % 64));
+  }
+  rank_queue_.clear();
+  return ranking_.best(k, min_status, out);
+}
+
+std::vector<InterfaceId> TelemetryAgent::best_interfaces(std::size_t k, IfStatus min_status) {
+  std::vector<InterfaceId> out(std::min(k, trackers_.size()));
+  out.resize(best_interfaces(k, min_status, out));
+  return out;
+}
+
+std::size_t TelemetryAgent::active_count() const {
+  if (cfg_.tick_scan == TickScan::All) return trackers_.size();
+  std::size_t n = 0;
+  for (const uint64_t w : active_) n += static_cast<std::size_t>(std::popcount(w));
+  return n;
 }
 
 std::vector<InterfaceSnapshot> TelemetryAgent::snapshots() const {
   std::vector<InterfaceSnapshot> out;
   out.reserve(trackers_.size());
-  for (const auto& [iface, tr] : trackers_) out.push_back(tr.snapshot());
+  for (const auto& tr : trackers_) out.push_back(tr.snapshot());
+  return out;
+}
+
+std::pmr::vector<PublishedSnapshot> TelemetryAgent::snapshots(std::pmr::memory_resource* mr) const {
+  std::pmr::vector<PublishedSnapshot> out(trackers_.size(), mr);
+  for (std::size_t id = 0; id < trackers_.size(); ++id) {
+    const InterfaceSnapshot& s = trackers_[id].snapshot();
+    out[id] = PublishedSnapshot{s.status, s.score_raw, s.score_smoothed, s.score_used, s.confidence,
+                                s.missing_rate, s.avg_tp_mbps, s.avg_rtt_ms, s.avg_loss_pct, s.avg_jitter_ms};
+  }
   return out;
 }
 
 std::vector<TransitionEvent> TelemetryAgent::drain_transitions() {
-  auto out = pending_transitions_;
-  pending_transitions_.clear();
+  std::vector<TransitionEvent> out;
+  out.reserve(transitions_.size());
+  transitions_.drain([&out](const TransitionEvent& ev) { out.push_back(ev); });
   return out;
 }
 
+std::pmr::vector<TransitionEvent> TelemetryAgent::drain_transitions(std::pmr::memory_resource* mr) {
+  std::pmr::vector<TransitionEvent> out(mr);
+  out.reserve(transitions_.size());
+  transitions_.drain([&out](const TransitionEvent& ev) { out.push_back(ev); });
+  return out;
+}
+
+#if TELEMETRY_INSTRUMENTATION
+const AgentStats& TelemetryAgent::stats() const { return stats_; }
+
+const IngestCounters& TelemetryAgent::interface_stats(InterfaceId id) const { return iface_stats_[id]; }
+
+void TelemetryAgent::reset_stats() {
+  stats_ = AgentStats{};
+  for (auto& c : iface_stats_) c = IngestCounters{};
+  ingest_calls_ = 0;
+}
+#else
+namespace {
+const AgentStats kNoStats{};
+const IngestCounters kNoCounters{};
+} // namespace
+
+const AgentStats& TelemetryAgent::stats() const { return kNoStats; }
+const IngestCounters& TelemetryAgent::interface_stats(InterfaceId) const { return kNoCounters; }
+void TelemetryAgent::reset_stats() {}
+#endif
+
+void TelemetryAgent::record_to(TraceWriter* w) {
+  recorder_ = w;
+  if (!w) return;
+  w->config(cfg_);
+  for (InterfaceId id = 0; id < trackers_.size(); ++id) w->name(id, trackers_[id].iface());
+}
+
 void TelemetryAgent::record_tick() {
-  for (const auto& [iface, tr] : trackers_) {
-    const auto s = tr.snapshot();
-    score_sum_[iface] += s.score_used;
-    score_count_[iface] += 1;
+  for (std::size_t id = 0; id < trackers_.size(); ++id) {
+    score_sum_[id] += trackers_[id].snapshot().score_used;
+    score_count_[id] += 1;
   }
 }
 
 std::vector<TelemetryAgent::RunSummaryItem> TelemetryAgent::summary_ranked() const {
   std::vector<RunSummaryItem> out;
   out.reserve(trackers_.size());
-  for (const auto& [iface, tr] : trackers_) {
-    const int n = score_count_.at(iface);
-    const double avg = (n > 0) ? (score_sum_.at(iface) / n) : 0.0;
-    out.push_back(RunSummaryItem{iface, avg, tr.snapshot().status});
+  for (const RankedInterface& r : summary_ranked(std::pmr::get_default_resource())) {
+    out.push_back(RunSummaryItem{trackers_[r.id].iface(), r.avg_score, r.last_status});
+  }
+  return out;
+}
+
+std::pmr::vector<TelemetryAgent::RankedInterface> TelemetryAgent::summary_ranked(std::pmr::memory_resource* mr) const {
+  std::pmr::vector<RankedInterface> out(mr);
+  out.reserve(trackers_.size());
+  for (std::size_t id = 0; id < trackers_.size(); ++id) {
+    const int n = score_count_[id];
+    const double avg = (n > 0) ? (score_sum_[id] / n) : 0.0;
+    out.push_back(RankedInterface{static_cast<InterfaceId>(id), avg, trackers_[id].snapshot().status});
   }
   std::sort(out.begin(), out.end(),
             [](const auto& a, const auto& b){ return a.avg_score > b.avg_score; });
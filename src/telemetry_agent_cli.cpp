@@ -1,13 +1,26 @@
 // telemetry_agent_cli.cpp
 #include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstdarg>
 #include <cstdint>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
 #include <iostream>
+#include <memory>
+#include <span>
 #include <string>
+#include <string_view>
+#include <system_error>
 #include <vector>
 
 #include "telemetry_agent.hpp"
 #include "scenarios.hpp"
+#include "snapshot_export.hpp"
+#include "trace_file.hpp"
 
 using namespace telemetry;
 
@@ -38,6 +51,142 @@ static AgentConfig default_config() {
   return cfg;
 }
 
+// Table: the per-tick table and transitions (default).
+// Quiet: per-run throughput, final status counts and the ranking.
+// Transitions: TRANSITION lines and the ranking.
+// Csv / Jsonl: one record per interface per tick and per transition on
+//   stdout; run summaries go to stderr.
+enum class OutputMode { Table, Quiet, Transitions, Csv, Jsonl };
+
+struct CliOptions {
+  std::string scenario = "A";
+  int seconds = 90;
+  int ifaces = 4;
+  std::vector<bool> strategies = {false, true}; // useEwma per run
+  OutputMode mode = OutputMode::Table;
+  int flush_ticks = 64;
+  std::string record_path;
+  std::string export_arg; // unix:PATH or shm:/NAME
+};
+
+[[noreturn]] static void usage(int code) {
+  std::fprintf(code == 0 ? stdout : stderr,
+    "Usage: telemetry_agent_cli [--scenario A|B|C|D|all] [--seconds N] [--ifaces N]\n"
+    "                           [--ewma on|off|both] [--quiet | --transitions-only | --csv | --jsonl]\n"
+    "                           [--flush-ticks N] [--record PATH] [--export unix:PATH|shm:/NAME]\n\n"
+    "  --ifaces N          N interfaces cycling eth/wifi/lte/sat, each copy phase-shifted\n"
+    "  --quiet             throughput, final status counts and ranking only\n"
+    "  --transitions-only  transitions and ranking only\n"
+    "  --csv, --jsonl      machine-readable stream, written every --flush-ticks ticks\n");
+  std::exit(code);
+}
+
+static int parse_positive(const char* s, const char* flag) {
+  char* end = nullptr;
+  const long v = std::strtol(s, &end, 10);
+  if (end == s || *end != '\0' || v <= 0 || v > 1'000'000'000) {
+    std::cerr << flag << " needs a positive integer\n";
+    std::exit(2);
+  }
+  return static_cast<int>(v);
+}
+
+static CliOptions parse_args(int argc, char** argv) {
+  CliOptions opt;
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    if (a == "--scenario" && i + 1 < argc) opt.scenario = argv[++i];
+    else if (a == "--seconds" && i + 1 < argc) opt.seconds = std::stoi(argv[++i]);
+    else if (a == "--ifaces" && i + 1 < argc) opt.ifaces = parse_positive(argv[++i], "--ifaces");
+    else if (a == "--flush-ticks" && i + 1 < argc) opt.flush_ticks = parse_positive(argv[++i], "--flush-ticks");
+    else if (a == "--record" && i + 1 < argc) opt.record_path = argv[++i];
+    else if (a == "--export" && i + 1 < argc) opt.export_arg = argv[++i];
+    else if (a == "--quiet") opt.mode = OutputMode::Quiet;
+    else if (a == "--transitions-only") opt.mode = OutputMode::Transitions;
+    else if (a == "--csv") opt.mode = OutputMode::Csv;
+    else if (a == "--jsonl") opt.mode = OutputMode::Jsonl;
+    else if (a == "--ewma" && i + 1 < argc) {
+      const std::string m = argv[++i];
+      if (m == "on") opt.strategies = {true};
+      else if (m == "off") opt.strategies = {false};
+      else if (m == "both") opt.strategies = {false, true};
+      else usage(2);
+    }
+    else if (a == "--help" || a == "-h") usage(0);
+  }
+  return opt;
+}
+
+// One large buffer for the streaming modes: records are formatted in place
+// (to_chars for the per-interface rows) and written with a single fwrite
+// every flush_ticks ticks, so stdio costs one call per batch.
+class OutputBuffer {
+public:
+  explicit OutputBuffer(std::FILE* f) : f_(f) { buf_.resize(1 << 20); }
+  ~OutputBuffer() { flush(); }
+
+  OutputBuffer(const OutputBuffer&) = delete;
+  OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+#if defined(__GNUC__)
+  __attribute__((format(printf, 2, 3)))
+#endif
+  void printf(const char* fmt, ...) {
+    for (;;) {
+      std::va_list ap;
+      va_start(ap, fmt);
+      const int n = std::vsnprintf(buf_.data() + len_, buf_.size() - len_, fmt, ap);
+      va_end(ap);
+      if (n < 0) return;
+      if (static_cast<std::size_t>(n) < buf_.size() - len_) {
+        len_ += static_cast<std::size_t>(n);
+        return;
+      }
+      if (len_ > 0) flush();
+      else buf_.resize(static_cast<std::size_t>(n) + 1);
+    }
+  }
+
+  // Append without format parsing; the CSV/JSONL rows use these.
+  OutputBuffer& put(std::string_view v) {
+    char* p = reserve_(v.size());
+    std::memcpy(p, v.data(), v.size());
+    len_ += v.size();
+    return *this;
+  }
+  OutputBuffer& put(long long v) {
+    char* p = reserve_(24);
+    len_ += static_cast<std::size_t>(std::to_chars(p, p + 24, v).ptr - p);
+    return *this;
+  }
+  OutputBuffer& put_fixed(double v, int precision) {
+    constexpr std::size_t kMax = 64;
+    char* p = reserve_(kMax);
+    const auto r = std::to_chars(p, p + kMax, v, std::chars_format::fixed, precision);
+    len_ += r.ec == std::errc{} ? static_cast<std::size_t>(r.ptr - p) : 0;
+    return *this;
+  }
+
+  void flush() {
+    if (len_ > 0) std::fwrite(buf_.data(), 1, len_, f_);
+    len_ = 0;
+    std::fflush(f_);
+  }
+
+private:
+  char* reserve_(std::size_t n) {
+    if (buf_.size() - len_ < n) {
+      flush();
+      if (buf_.size() < n) buf_.resize(n);
+    }
+    return buf_.data() + len_;
+  }
+
+  std::FILE* f_;
+  std::vector<char> buf_;
+  std::size_t len_ = 0;
+};
+
 static void print_table(int64_t t, const std::vector<InterfaceSnapshot>& snaps, bool useEwma) {
   std::printf("\n[t=%llds] (useEwma=%s)\n",
               static_cast<long long>(t),
@@ -65,75 +214,238 @@ static void print_table(int64_t t, const std::vector<InterfaceSnapshot>& snaps,
   }
 }
 
-static void run_once(ScenarioId sid, bool useEwma, int seconds) {
+static void write_snapshot(OutputBuffer& out, OutputMode mode, bool useEwma, int64_t t, const InterfaceSnapshot& s) {
+  if (mode == OutputMode::Csv) {
+    out.put("snapshot,").put(useEwma ? "1," : "0,").put(static_cast<long long>(t)).put(",")
+       .put(s.iface).put(",").put(to_string(s.status)).put(",")
+       .put_fixed(s.score_used, 4).put(",").put_fixed(s.score_raw, 4).put(",")
+       .put_fixed(s.score_smoothed, 4).put(",").put_fixed(s.confidence, 4).put(",")
+       .put_fixed(s.avg_tp_mbps, 2).put(",").put_fixed(s.avg_rtt_ms, 2).put(",")
+       .put_fixed(s.avg_loss_pct, 3).put(",").put_fixed(s.avg_jitter_ms, 2).put(",,\n");
+  } else {
+    out.put("{\"type\":\"snapshot\",\"ewma\":").put(useEwma ? "true" : "false")
+       .put(",\"t\":").put(static_cast<long long>(t))
+       .put(",\"iface\":\"").put(s.iface).put("\",\"status\":\"").put(to_string(s.status))
+       .put("\",\"used\":").put_fixed(s.score_used, 4).put(",\"raw\":").put_fixed(s.score_raw, 4)
+       .put(",\"smoothed\":").put_fixed(s.score_smoothed, 4).put(",\"conf\":").put_fixed(s.confidence, 4)
+       .put(",\"tp\":").put_fixed(s.avg_tp_mbps, 2).put(",\"rtt\":").put_fixed(s.avg_rtt_ms, 2)
+       .put(",\"loss\":").put_fixed(s.avg_loss_pct, 3).put(",\"jit\":").put_fixed(s.avg_jitter_ms, 2)
+       .put("}\n");
+  }
+}
+
+static void write_transition(OutputBuffer& out, OutputMode mode, bool useEwma, const std::string& iface,
+                             const TransitionEvent& ev) {
+  switch (mode) {
+    case OutputMode::Csv:
+      out.printf("transition,%d,%lld,%s,%s,,,,,,,,,%s,%s\n",
+                 useEwma ? 1 : 0, static_cast<long long>(ev.ts), iface.c_str(), to_string(ev.to),
+                 to_string(ev.from), to_string(ev.reason));
+      break;
+    case OutputMode::Jsonl:
+      out.printf("{\"type\":\"transition\",\"ewma\":%s,\"t\":%lld,\"iface\":\"%s\",\"from\":\"%s\","
+                 "\"to\":\"%s\",\"reason\":\"%s\"}\n",
+                 useEwma ? "true" : "false", static_cast<long long>(ev.ts), iface.c_str(),
+                 to_string(ev.from), to_string(ev.to), to_string(ev.reason));
+      break;
+    default:
+      out.printf("  TRANSITION [%llds] %s %s->%s | %s\n",
+                 static_cast<long long>(ev.ts), iface.c_str(),
+                 to_string(ev.from), to_string(ev.to), to_string(ev.reason));
+      break;
+  }
+}
+
+// Binary frame sinks for --export; at most one is set.
+struct Exporter {
+  std::unique_ptr<SocketSnapshotSink> socket;
+  std::unique_ptr<ShmSnapshotRing> shm;
+
+  void publish(const TelemetryAgent& agent, int64_t t, std::span<const TransitionEvent> events) {
+    if (socket) socket->publish(agent, t, events);
+    if (shm) shm->publish(agent, t, events);
+  }
+};
+
+// Interface k replays generator profile k % 4 (eth0/wifi0/lte0/sat0),
+// shifted by a per-copy phase so a synthesised fleet does not change state
+// in lockstep. The first four are the plain scenario interfaces.
+struct SyntheticIface {
+  std::string name;
+  const std::string* profile;
+  int64_t phase;
+};
+
+static const std::array<std::string, 4> kProfiles = {"eth0", "wifi0", "lte0", "sat0"};
+static const std::array<const char*, 4> kPrefixes = {"eth", "wifi", "lte", "sat"};
+
+static std::vector<SyntheticIface> make_ifaces(int n) {
+  std::vector<SyntheticIface> out;
+  out.reserve(static_cast<std::size_t>(n));
+  for (int k = 0; k < n; ++k) {
+    const int copy = k / 4;
+    out.push_back(SyntheticIface{kPrefixes[k % 4] + std::to_string(copy), &kProfiles[k % 4],
+                                 static_cast<int64_t>(copy) * 7});
+  }
+  return out;
+}
+
+static void print_ranking(std::FILE* f, const TelemetryAgent& agent) {
+  constexpr std::size_t kMaxRows = 20;
+  const auto ranked = agent.summary_ranked();
+  std::fprintf(f, "\n=== Ranking by avg score_used ===\n");
+  for (std::size_t k = 0; k < ranked.size() && k < kMaxRows; ++k) {
+    std::fprintf(f, "  %s avg=%.3f last=%s\n",
+                 ranked[k].iface.c_str(),
+                 ranked[k].avg_score,
+                 to_string(ranked[k].last_status));
+  }
+  if (ranked.size() > kMaxRows) std::fprintf(f, "  ... %zu more\n", ranked.size() - kMaxRows);
+}
+
+static void run_once(const CliOptions& opt, ScenarioId sid, bool useEwma, OutputBuffer* out,
+                     TraceWriter* recorder = nullptr, Exporter* exporter = nullptr) {
+  using Clock = std::chrono::steady_clock;
+
   AgentConfig cfg = default_config();
   cfg.score.useEwma = useEwma;
 
   TelemetryAgent agent(cfg);
-  const std::vector<std::string> ifaces = {"eth0","wifi0","lte0","sat0"};
-  for (auto& i : ifaces) agent.ensure_interface(i);
+  agent.record_to(recorder);
+  const std::vector<SyntheticIface> ifaces = make_ifaces(opt.ifaces);
+  std::vector<InterfaceId> ids;
+  for (auto& i : ifaces) ids.push_back(agent.register_interface(i.name));
 
   ScenarioGenerator gen(sid);
+  std::vector<Sample> batch;
+  batch.reserve(ifaces.size());
+  std::vector<TransitionEvent> events;
+  const bool table = opt.mode == OutputMode::Table;
+  const bool rows = opt.mode == OutputMode::Csv || opt.mode == OutputMode::Jsonl;
+  uint64_t samples = 0, transitions = 0;
 
-  for (int64_t t = 0; t < seconds; ++t) {
+  const auto start = Clock::now();
+  for (int64_t t = 0; t < opt.seconds; ++t) {
     agent.note_time(t);
-    for (const auto& iface : ifaces) {
-      auto g = gen.sample(iface, t);
+    batch.clear();
+    for (std::size_t k = 0; k < ifaces.size(); ++k) {
+      auto g = gen.sample(*ifaces[k].profile, t + ifaces[k].phase);
       if (!g) continue;
-      agent.ingest(iface, g->ts, g->m);
+      batch.push_back(Sample{ids[k], g->ts - ifaces[k].phase, g->m});
     }
+    agent.ingest_batch(batch);
+    samples += batch.size();
 
-    print_table(t, agent.snapshots(), useEwma);
-
-    for (const auto& ev : agent.drain_transitions()) {
-      std::printf("  TRANSITION [%llds] %s %s->%s | %s\n",
-                  static_cast<long long>(ev.ts),
-                  ev.iface.c_str(),
-                  to_string(ev.from),
-                  to_string(ev.to),
-                  ev.reason.c_str());
+    if (table) print_table(t, agent.snapshots(), useEwma);
+    if (rows) {
+      for (InterfaceId id = 0; id < agent.size(); ++id) write_snapshot(*out, opt.mode, useEwma, t, agent.snapshot(id));
     }
 
+    events.clear();
+    agent.drain_transitions([&](const TransitionEvent& ev) {
+      if (table) {
+        std::printf("  TRANSITION [%llds] %s %s->%s | %s\n",
+                    static_cast<long long>(ev.ts),
+                    agent.snapshot(ev.id).iface.c_str(),
+                    to_string(ev.from),
+                    to_string(ev.to),
+                    to_string(ev.reason));
+      } else if (opt.mode != OutputMode::Quiet) {
+        write_transition(*out, opt.mode, useEwma, agent.snapshot(ev.id).iface, ev);
+      }
+      events.push_back(ev);
+    });
+    transitions += events.size();
+    if (exporter) exporter->publish(agent, t, events);
+
     agent.record_tick();
+    if (out && (t + 1) % opt.flush_ticks == 0) out->flush();
   }
+  const std::chrono::duration<double> elapsed = Clock::now() - start;
+  if (out) out->flush();
 
-  std::printf("\n=== Ranking by avg score_used ===\n");
-  for (const auto& it : agent.summary_ranked()) {
-    std::printf("  %s avg=%.3f last=%s\n",
-                it.iface.c_str(),
-                it.avg_score,
-                to_string(it.last_status));
+  if (table) {
+    print_ranking(stdout, agent);
+    return;
+  }
+  std::FILE* summary = rows ? stderr : stdout;
+  if (opt.mode == OutputMode::Quiet || rows) {
+    std::size_t count[3] = {0, 0, 0};
+    for (InterfaceId id = 0; id < agent.size(); ++id) ++count[static_cast<int>(agent.snapshot(id).status)];
+    const double secs = elapsed.count();
+    std::fprintf(summary, "  ticks=%d interfaces=%zu samples=%llu elapsed_s=%.3f samples/s=%.0f ticks/s=%.0f\n",
+                 opt.seconds, agent.size(), static_cast<unsigned long long>(samples), secs,
+                 secs > 0.0 ? static_cast<double>(samples) / secs : 0.0,
+                 secs > 0.0 ? static_cast<double>(opt.seconds) / secs : 0.0);
+    std::fprintf(summary, "  final: Healthy=%zu Degraded=%zu Down=%zu transitions=%llu\n",
+                 count[static_cast<int>(IfStatus::Healthy)],
+                 count[static_cast<int>(IfStatus::Degraded)],
+                 count[static_cast<int>(IfStatus::Down)],
+                 static_cast<unsigned long long>(transitions));
   }
+  print_ranking(summary, agent);
 }
 
 int main(int argc, char** argv) {
-  std::string scenario_arg = "A";
-  int seconds = 90;
+  const CliOptions opt = parse_args(argc, argv);
+  const bool rows = opt.mode == OutputMode::Csv || opt.mode == OutputMode::Jsonl;
+  std::FILE* banner = rows ? stderr : stdout;
 
-  for (int i = 1; i < argc; ++i) {
-    std::string a = argv[i];
-    if (a == "--scenario" && i + 1 < argc) scenario_arg = argv[++i];
-    else if (a == "--seconds" && i + 1 < argc) seconds = std::stoi(argv[++i]);
+  std::unique_ptr<OutputBuffer> out;
+  if (opt.mode != OutputMode::Table) out = std::make_unique<OutputBuffer>(stdout);
+  if (opt.mode == OutputMode::Csv) {
+    out->printf("kind,ewma,t,iface,status,used,raw,smoothed,conf,tp,rtt,loss,jit,from,reason\n");
   }
 
-  if (scenario_arg == "all" || scenario_arg == "ALL") {
+  const auto run = [&](ScenarioId sid, bool useEwma, TraceWriter* recorder, Exporter* exporter) {
+    if (out) out->flush(); // keep the banner after the previous run's records
+    std::fprintf(banner, "\n\n=== Scenario %s useEwma=%s ===\n",
+                 scenario_name(sid),
+                 useEwma ? "true" : "false");
+    run_once(opt, sid, useEwma, out.get(), recorder, exporter);
+  };
+
+  if (opt.scenario == "all" || opt.scenario == "ALL") {
+    if (!opt.record_path.empty() || !opt.export_arg.empty()) {
+      std::cerr << "--record and --export need a single --scenario\n";
+      return 2;
+    }
     for (ScenarioId sid : {ScenarioId::A, ScenarioId::B, ScenarioId::C, ScenarioId::D}) {
-      for (bool useEwma : {false, true}) {
-        std::printf("\n\n=== Scenario %s useEwma=%s ===\n",
-                    scenario_name(sid),
-                    useEwma ? "true" : "false");
-        run_once(sid, useEwma, seconds);
-      }
+      for (bool useEwma : opt.strategies) run(sid, useEwma, nullptr, nullptr);
     }
     return 0;
   }
 
-  const ScenarioId sid = parse_scenario(scenario_arg);
-  for (bool useEwma : {false, true}) {
-    std::printf("\n\n=== Scenario %s useEwma=%s ===\n",
-                scenario_name(sid),
-                useEwma ? "true" : "false");
-    run_once(sid, useEwma, seconds);
+  const ScenarioId sid = parse_scenario(opt.scenario);
+  try {
+    // Every run sees the same samples; record the first one.
+    std::unique_ptr<TraceWriter> recorder;
+    if (!opt.record_path.empty()) recorder = std::make_unique<TraceWriter>(opt.record_path);
+    Exporter exporter;
+    if (opt.export_arg.rfind("unix:", 0) == 0) {
+      exporter.socket = std::make_unique<SocketSnapshotSink>(SocketSnapshotSink::connect(opt.export_arg.substr(5)));
+    } else if (opt.export_arg.rfind("shm:", 0) == 0) {
+      ShmRingConfig ring;
+      ring.max_interfaces = std::max<uint32_t>(ring.max_interfaces, static_cast<uint32_t>(opt.ifaces));
+      ring.name_bytes = std::max<uint32_t>(ring.name_bytes, static_cast<uint32_t>(opt.ifaces) * 24);
+      exporter.shm = std::make_unique<ShmSnapshotRing>(opt.export_arg.substr(4), ring);
+    } else if (!opt.export_arg.empty()) {
+      std::cerr << "--export takes unix:PATH or shm:/NAME\n";
+      return 2;
+    }
+    for (std::size_t r = 0; r < opt.strategies.size(); ++r) {
+      // Export the last run: the default strategy when both are run.
+      const bool last = r + 1 == opt.strategies.size();
+      run(sid, opt.strategies[r], recorder.get(), last ? &exporter : nullptr);
+      if (recorder) {
+        recorder->close();
+        recorder.reset();
+      }
+    }
+  } catch (const std::exception& e) {
+    if (out) out->flush();
+    std::cerr << e.what() << "\n";
+    return 1;
   }
   return 0;
 }
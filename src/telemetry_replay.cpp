@@ -0,0 +1,258 @@
+// telemetry_replay.cpp
+//
+// Drives a TelemetryAgent from a recorded trace (see trace_file.hpp), as fast
+// as possible or paced by the trace's tick timestamps, and reports throughput.
+// Interfaces are registered in trace id order, recorded batches go through
+// ingest_batch() again and the agent takes the settings the trace header
+// recorded, so handles and transition output match the recorded run (unless
+// --batch regroups the loose samples or a flag overrides a recorded setting).
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "telemetry_agent.hpp"
+#include "trace_file.hpp"
+
+using namespace telemetry;
+
+struct Options {
+  std::string path;
+  bool realtime = false;
+  double speed = 1.0;
+  bool batch = false;       // loose samples: one ingest_batch() per tick instead of ingest() each
+  bool transitions = false; // print every transition
+  int repeat = 1;
+  bool no_ewma = false;
+  std::optional<RecomputeMode> recompute; // unset: as recorded
+  TickScan tick_scan = TickScan::All;
+};
+
+[[noreturn]] static void usage(int code) {
+  std::fprintf(code == 0 ? stdout : stderr,
+    "Usage: telemetry_replay TRACE [--realtime] [--speed X] [--batch] [--transitions]\n"
+    "                        [--recompute eager|pertick] [--tick-scan all|active]\n"
+    "                        [--no-ewma] [--repeat N]\n\n"
+    "  --realtime     pace ticks by trace time (--speed multiplies it)\n"
+    "  --batch        feed each tick's loose samples through one ingest_batch()\n"
+    "                 (recorded batches always replay as recorded)\n"
+    "  --transitions  print transitions as they happen\n"
+    "  --repeat N     replay N times into fresh agents (throughput runs)\n\n"
+    "  EWMA, recompute and same-second settings come from the trace header;\n"
+    "  --no-ewma and --recompute override them (with a warning if they differ).\n"
+    "  Weights and thresholds are not recorded: AgentConfig defaults are used.\n");
+  std::exit(code);
+}
+
+static Options parse_args(int argc, char** argv) {
+  Options opt;
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    if (a == "--realtime") {
+      opt.realtime = true;
+    } else if (a == "--speed" && i + 1 < argc) {
+      opt.speed = std::atof(argv[++i]);
+      opt.realtime = true;
+    } else if (a == "--batch") {
+      opt.batch = true;
+    } else if (a == "--transitions") {
+      opt.transitions = true;
+    } else if (a == "--no-ewma") {
+      opt.no_ewma = true;
+    } else if (a == "--repeat" && i + 1 < argc) {
+      opt.repeat = std::atoi(argv[++i]);
+    } else if (a == "--recompute" && i + 1 < argc) {
+      const std::string m = argv[++i];
+      if (m == "eager") opt.recompute = RecomputeMode::Eager;
+      else if (m == "pertick") opt.recompute = RecomputeMode::PerTick;
+      else usage(2);
+    } else if (a == "--tick-scan" && i + 1 < argc) {
+      const std::string m = argv[++i];
+      if (m == "all") opt.tick_scan = TickScan::All;
+      else if (m == "active") opt.tick_scan = TickScan::Active;
+      else usage(2);
+    } else if (a == "--help" || a == "-h") {
+      usage(0);
+    } else if (!a.empty() && a[0] != '-' && opt.path.empty()) {
+      opt.path = a;
+    } else {
+      std::cerr << "Unknown argument: " << a << "\n";
+      usage(2);
+    }
+  }
+  if (opt.path.empty() || opt.repeat <= 0 || opt.speed <= 0.0) usage(2);
+  return opt;
+}
+
+struct TraceStats {
+  uint64_t samples = 0;
+  uint64_t ticks = 0;
+  uint32_t ifaces = 0; // listed in the name table (the reader bounds sample ids by it)
+  int64_t first_ts = 0;
+  int64_t last_ts = 0;
+};
+
+// One pass before timing: counts records and faults the mapping in so the
+// timed replay measures the agent, not the page cache.
+static TraceStats scan(const TraceReader& trace) {
+  TraceStats s;
+  s.ifaces = static_cast<uint32_t>(trace.names().size());
+  bool first = true;
+  for (const TraceRecord& r : trace.records()) {
+    if (!r.is_tick() && !r.is_sample()) continue; // batch markers carry no ts
+    if (first) s.first_ts = r.ts;
+    first = false;
+    s.last_ts = r.ts;
+    if (r.is_tick()) {
+      ++s.ticks;
+    } else {
+      ++s.samples;
+    }
+  }
+  return s;
+}
+
+struct ReplayResult {
+  std::chrono::duration<double> elapsed{0};
+  uint64_t transitions = 0;
+  std::size_t status_count[3] = {0, 0, 0};
+};
+
+// The recorded settings with the command line's overrides on top.
+static AgentConfig replay_config(const Options& opt, const TraceHeader& h) {
+  AgentConfig cfg;
+  h.apply_config(cfg);
+  const AgentConfig recorded = cfg;
+  if (opt.no_ewma) cfg.score.useEwma = false;
+  if (opt.recompute) cfg.recompute = *opt.recompute;
+  cfg.tick_scan = opt.tick_scan; // same snapshots either way
+  if (cfg.score.useEwma != recorded.score.useEwma || cfg.recompute != recorded.recompute) {
+    std::cerr << "warning: settings differ from the recorded run; its transitions will not reproduce\n";
+  }
+  return cfg;
+}
+
+static ReplayResult replay(const Options& opt, const AgentConfig& cfg, const TraceReader& trace,
+                           const TraceStats& st) {
+  using Clock = std::chrono::steady_clock;
+
+  TelemetryAgent agent(cfg);
+  const auto& names = trace.names();
+  for (uint32_t id = 0; id < st.ifaces; ++id) {
+    const bool named = id < names.size() && !names[id].empty();
+    agent.register_interface(named ? names[id] : "if" + std::to_string(id));
+  }
+
+  ReplayResult out;
+  std::vector<Sample> batch;
+  const auto on_transition = [&](const TransitionEvent& ev) {
+    ++out.transitions;
+    if (!opt.transitions) return;
+    std::printf("  TRANSITION [%llds] %s %s->%s | %s\n",
+                static_cast<long long>(ev.ts),
+                agent.snapshot(ev.id).iface.c_str(),
+                to_string(ev.from),
+                to_string(ev.to),
+                to_string(ev.reason));
+  };
+
+  bool paced = false;
+  int64_t ts0 = 0;
+  Clock::time_point wall0{};
+  const auto start = Clock::now();
+  bool in_batch = false;
+  for (const TraceRecord& r : trace.records()) {
+    if (r.is_sample()) {
+      if (opt.batch || in_batch) {
+        batch.push_back(Sample{r.iface, r.ts, r.metrics()});
+      } else {
+        agent.ingest(r.iface, r.ts, r.metrics());
+      }
+      continue;
+    }
+    if (r.iface == TraceRecord::kBatchBegin) {
+      // Loose samples gathered by --batch go first, in their own batch.
+      if (!batch.empty()) agent.ingest_batch(batch);
+      batch.clear();
+      in_batch = true;
+      continue;
+    }
+    if (r.iface == TraceRecord::kBatchEnd) {
+      agent.ingest_batch(batch);
+      batch.clear();
+      in_batch = false;
+      continue;
+    }
+    if (opt.batch) {
+      agent.ingest_batch(batch);
+      batch.clear();
+    }
+    if (opt.realtime) {
+      if (!paced) {
+        paced = true;
+        ts0 = r.ts;
+        wall0 = Clock::now();
+      }
+      const std::chrono::duration<double> due(static_cast<double>(r.ts - ts0) / opt.speed);
+      std::this_thread::sleep_until(wall0 + std::chrono::duration_cast<Clock::duration>(due));
+    }
+    agent.note_time(r.ts);
+    agent.drain_transitions(on_transition);
+  }
+  if (!batch.empty()) agent.ingest_batch(batch);
+  agent.drain_transitions(on_transition);
+  out.elapsed = Clock::now() - start;
+
+  for (InterfaceId id = 0; id < agent.size(); ++id) {
+    ++out.status_count[static_cast<int>(agent.snapshot(id).status)];
+  }
+  return out;
+}
+
+int main(int argc, char** argv) {
+  const Options opt = parse_args(argc, argv);
+  try {
+    const TraceReader trace(opt.path);
+    const TraceStats st = scan(trace);
+    const AgentConfig cfg = replay_config(opt, trace.header());
+    std::printf("trace %s\n", opt.path.c_str());
+    std::printf("  records=%llu samples=%llu ticks=%llu interfaces=%u ts=[%lld, %lld]\n",
+                static_cast<unsigned long long>(trace.records().size()),
+                static_cast<unsigned long long>(st.samples),
+                static_cast<unsigned long long>(st.ticks),
+                st.ifaces,
+                static_cast<long long>(st.first_ts),
+                static_cast<long long>(st.last_ts));
+    std::printf("  config: ewma=%s recompute=%s same_second=%s\n",
+                cfg.score.useEwma ? "on" : "off",
+                cfg.recompute == RecomputeMode::PerTick ? "pertick" : "eager",
+                cfg.same_second == SameSecond::Average ? "average" : "replace");
+
+    for (int run = 0; run < opt.repeat; ++run) {
+      const ReplayResult r = replay(opt, cfg, trace, st);
+      const double secs = r.elapsed.count();
+      std::printf("replay %d/%d: %s%s elapsed_s=%.3f samples/s=%.0f ticks/s=%.0f transitions=%llu\n",
+                  run + 1, opt.repeat,
+                  opt.realtime ? "realtime" : "max-speed",
+                  opt.batch ? " batch" : "",
+                  secs,
+                  secs > 0.0 ? static_cast<double>(st.samples) / secs : 0.0,
+                  secs > 0.0 ? static_cast<double>(st.ticks) / secs : 0.0,
+                  static_cast<unsigned long long>(r.transitions));
+      std::printf("  final: Healthy=%zu Degraded=%zu Down=%zu\n",
+                  r.status_count[static_cast<int>(IfStatus::Healthy)],
+                  r.status_count[static_cast<int>(IfStatus::Degraded)],
+                  r.status_count[static_cast<int>(IfStatus::Down)]);
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
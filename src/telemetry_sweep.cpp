@@ -0,0 +1,179 @@
+// telemetry_sweep.cpp
+//
+// Evaluates a grid of FsmConfig thresholds against a recorded trace (or a
+// generated scenario) on all cores and ranks the configs: fewest missed
+// incidents, then fewest flaps, then fastest detection. Incidents are the
+// degradations a deliberately twitchy reference config sees on the same
+// input (see sharp_reference()).
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "config_sweep.hpp"
+#include "scenarios.hpp"
+#include "trace_file.hpp"
+
+using namespace telemetry;
+
+struct Options {
+  std::string trace_path;
+  std::string scenario = "B";
+  int seconds = 600;
+  ImperfectDataConfig imp;
+  unsigned threads = 0;
+  std::size_t top = 10;
+  bool useEwma = true;
+  SweepOptions sweep;
+  FsmGrid grid;
+};
+
+[[noreturn]] static void usage(int code) {
+  std::fprintf(code == 0 ? stdout : stderr,
+    "Usage: telemetry_sweep [TRACE | --scenario A|B|C|D [--seconds N] [--missing] [--late]]\n"
+    "                       [--threads N] [--top K] [--flap-window S] [--no-ewma]\n"
+    "                       [--healthy-enter LIST] [--healthy-exit LIST] [--down-enter LIST]\n"
+    "                       [--down-exit LIST] [--healthy-enter-n LIST] [--healthy-exit-n LIST]\n"
+    "                       [--down-enter-n LIST] [--down-exit-n LIST] [--dwell LIST]\n\n"
+    "  LIST is comma-separated, e.g. --healthy-enter 0.70,0.75,0.80. Axes not\n"
+    "  given use a built-in grid.\n");
+  std::exit(code);
+}
+
+template <typename T>
+static std::vector<T> parse_list(const char* s) {
+  std::vector<T> out;
+  std::stringstream in(s);
+  std::string item;
+  while (std::getline(in, item, ',')) {
+    std::stringstream v(item);
+    T x{};
+    if (!(v >> x)) usage(2);
+    out.push_back(x);
+  }
+  if (out.empty()) usage(2);
+  return out;
+}
+
+static Options parse_args(int argc, char** argv) {
+  Options opt;
+  FsmGrid& g = opt.grid;
+  g.healthy_enter = {0.68, 0.72, 0.76, 0.80};
+  g.healthy_exit = {0.60, 0.64, 0.66, 0.70};
+  g.down_enter = {0.30, 0.35, 0.40};
+  g.down_exit = {0.45, 0.50};
+  g.healthy_enter_N = {2, 4, 6, 8};
+  g.healthy_exit_N = {2, 4, 6};
+  g.down_enter_N = {1, 2, 3};
+  g.down_exit_N = {3, 5};
+  g.min_dwell_sec = {0, 5, 10};
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    const bool has = i + 1 < argc;
+    if (a == "--scenario" && has) opt.scenario = argv[++i];
+    else if (a == "--seconds" && has) opt.seconds = std::atoi(argv[++i]);
+    else if (a == "--missing") opt.imp.enable_missing = true;
+    else if (a == "--late") opt.imp.enable_late = true;
+    else if (a == "--threads" && has) opt.threads = static_cast<unsigned>(std::atoi(argv[++i]));
+    else if (a == "--top" && has) opt.top = static_cast<std::size_t>(std::atoi(argv[++i]));
+    else if (a == "--flap-window" && has) opt.sweep.flap_window_sec = std::atoll(argv[++i]);
+    else if (a == "--no-ewma") opt.useEwma = false;
+    else if (a == "--healthy-enter" && has) g.healthy_enter = parse_list<double>(argv[++i]);
+    else if (a == "--healthy-exit" && has) g.healthy_exit = parse_list<double>(argv[++i]);
+    else if (a == "--down-enter" && has) g.down_enter = parse_list<double>(argv[++i]);
+    else if (a == "--down-exit" && has) g.down_exit = parse_list<double>(argv[++i]);
+    else if (a == "--healthy-enter-n" && has) g.healthy_enter_N = parse_list<int>(argv[++i]);
+    else if (a == "--healthy-exit-n" && has) g.healthy_exit_N = parse_list<int>(argv[++i]);
+    else if (a == "--down-enter-n" && has) g.down_enter_N = parse_list<int>(argv[++i]);
+    else if (a == "--down-exit-n" && has) g.down_exit_N = parse_list<int>(argv[++i]);
+    else if (a == "--dwell" && has) g.min_dwell_sec = parse_list<int64_t>(argv[++i]);
+    else if (a == "--help" || a == "-h") usage(0);
+    else if (!a.empty() && a[0] != '-' && opt.trace_path.empty()) opt.trace_path = a;
+    else {
+      std::cerr << "Unknown argument: " << a << "\n";
+      usage(2);
+    }
+  }
+  if (opt.seconds <= 0) usage(2);
+  return opt;
+}
+
+static ScenarioId parse_scenario(const std::string& s) {
+  if (s == "A" || s == "a") return ScenarioId::A;
+  if (s == "B" || s == "b") return ScenarioId::B;
+  if (s == "C" || s == "c") return ScenarioId::C;
+  if (s == "D" || s == "d") return ScenarioId::D;
+  std::cerr << "Unknown scenario: " << s << " (use A|B|C|D)\n";
+  std::exit(2);
+}
+
+int main(int argc, char** argv) {
+  Options opt = parse_args(argc, argv);
+  try {
+    std::unique_ptr<TraceReader> reader;
+    SweepTrace trace;
+    if (!opt.trace_path.empty()) {
+      reader = std::make_unique<TraceReader>(opt.trace_path);
+      trace = SweepTrace::view(*reader);
+    } else {
+      trace = SweepTrace::scenario(parse_scenario(opt.scenario), opt.seconds, opt.imp);
+    }
+
+    AgentConfig base;
+    base.score.useEwma = opt.useEwma;
+    const std::vector<AgentConfig> configs = expand(base, opt.grid);
+    const std::vector<SweepIncident> incidents = reference_incidents(trace, sharp_reference(base));
+    opt.sweep.incidents = incidents;
+    opt.sweep.threads = opt.threads != 0 ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<SweepResult> results = run_sweep(trace, configs, opt.sweep);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::printf("sweep %s\n", opt.trace_path.empty() ? ("scenario " + opt.scenario).c_str() : opt.trace_path.c_str());
+    std::printf("  records=%zu interfaces=%zu incidents=%zu configs=%zu threads=%u elapsed_s=%.3f configs/s=%.1f\n",
+                trace.records().size(), trace.interfaces(), incidents.size(), configs.size(), opt.sweep.threads,
+                elapsed.count(), elapsed.count() > 0.0 ? static_cast<double>(configs.size()) / elapsed.count() : 0.0);
+
+    std::vector<std::size_t> order(configs.size());
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+      const SweepResult& x = results[a];
+      const SweepResult& y = results[b];
+      if (x.missed != y.missed) return x.missed < y.missed;
+      if (x.flaps != y.flaps) return x.flaps < y.flaps;
+      return x.mean_ttd_sec < y.mean_ttd_sec;
+    });
+
+    std::printf("\n%-5s%-6s%-6s%-6s%-6s%-5s%-5s%-5s%-5s%-7s%-8s%-7s%-10s%-10s%-9s%-8s\n",
+                "rank", "h_in", "h_out", "d_in", "d_out", "hiN", "hoN", "diN", "doN", "dwell",
+                "trans", "flaps", "flaps/ifh", "detected", "ttd_avg", "ttd_max");
+    for (std::size_t r = 0; r < order.size() && r < opt.top; ++r) {
+      const FsmConfig& f = configs[order[r]].fsm;
+      const SweepResult& s = results[order[r]];
+      std::printf("%-5zu%-6.2f%-6.2f%-6.2f%-6.2f%-5d%-5d%-5d%-5d%-7lld%-8llu%-7llu%-10.3f%-10s%-9.1f%-8lld\n",
+                  r + 1, f.healthy_enter, f.healthy_exit, f.down_enter, f.down_exit,
+                  f.healthy_enter_N, f.healthy_exit_N, f.down_enter_N, f.down_exit_N,
+                  static_cast<long long>(f.min_dwell_sec),
+                  static_cast<unsigned long long>(s.transitions),
+                  static_cast<unsigned long long>(s.flaps),
+                  s.flaps_per_iface_hour,
+                  (std::to_string(s.detected) + "/" + std::to_string(s.detected + s.missed)).c_str(),
+                  s.mean_ttd_sec,
+                  static_cast<long long>(s.max_ttd_sec));
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
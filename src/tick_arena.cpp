@@ -0,0 +1,29 @@
+// tick_arena.cpp
+#include "tick_arena.hpp"
+
+namespace telemetry {
+
+TickArena::TickArena(std::size_t bytes, std::pmr::memory_resource* upstream)
+  : block_(std::make_unique<std::byte[]>(bytes)), capacity_(bytes), upstream_(upstream) {}
+
+void* TickArena::do_allocate(std::size_t bytes, std::size_t align) {
+  if (bytes == 0) bytes = 1; // so every pointer handed out lies inside the block
+  const auto base = reinterpret_cast<std::uintptr_t>(block_.get());
+  const std::uintptr_t at = (base + used_ + (align - 1)) & ~(std::uintptr_t{align} - 1);
+  const std::size_t end = static_cast<std::size_t>(at - base) + bytes;
+  if (end > high_water_) high_water_ = end;
+  if (end > capacity_) {
+    ++overflows_;
+    return upstream_->allocate(bytes, align);
+  }
+  used_ = end;
+  return reinterpret_cast<void*>(at);
+}
+
+void TickArena::do_deallocate(void* p, std::size_t bytes, std::size_t align) {
+  const auto* b = static_cast<const std::byte*>(p);
+  if (b >= block_.get() && b < block_.get() + capacity_) return; // freed by reset()
+  upstream_->deallocate(p, bytes, align);
+}
+
+} // namespace telemetry
@@ -0,0 +1,136 @@
+// timer_wheel.cpp
+#include "timer_wheel.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace telemetry {
+
+namespace {
+constexpr uint64_t kSlotMask = TimerWheel::kSlotsPerLevel - 1;
+constexpr int kSpanBits = TimerWheel::kLevelBits * TimerWheel::kLevels; // bits covered by the wheel
+
+// Start of the level-L slot s inside the level-(L+1) block holding `now`.
+uint64_t slot_start(uint64_t now, int level, uint64_t s) {
+  const int shift = TimerWheel::kLevelBits * level;
+  const uint64_t block = now >> (shift + TimerWheel::kLevelBits) << (shift + TimerWheel::kLevelBits);
+  return block | (s << shift);
+}
+} // namespace
+
+void TimerWheel::resize(std::size_t n) {
+  if (n > nodes_.size()) nodes_.resize(n);
+}
+
+void TimerWheel::schedule(Id id, int64_t at) {
+  if (nodes_[id].where != kNone) {
+    unlink_(id);
+  } else {
+    ++size_;
+  }
+  nodes_[id].at = to_key_(at);
+  place_(id);
+}
+
+void TimerWheel::cancel(Id id) {
+  if (nodes_[id].where == kNone) return;
+  unlink_(id);
+  --size_;
+}
+
+void TimerWheel::link_(Id id, uint32_t where) {
+  Node& n = nodes_[id];
+  n.where = where;
+  n.prev = kNil;
+  n.next = heads_[where];
+  if (n.next != kNil) nodes_[n.next].prev = id;
+  heads_[where] = id;
+  if (where < kOverflow) occupied_[where / kSlotsPerLevel] |= uint64_t{1} << (where % kSlotsPerLevel);
+}
+
+void TimerWheel::unlink_(Id id) {
+  Node& n = nodes_[id];
+  if (n.prev != kNil) {
+    nodes_[n.prev].next = n.next;
+  } else {
+    heads_[n.where] = n.next;
+    if (n.next == kNil && n.where < kOverflow) {
+      occupied_[n.where / kSlotsPerLevel] &= ~(uint64_t{1} << (n.where % kSlotsPerLevel));
+    }
+  }
+  if (n.next != kNil) nodes_[n.next].prev = n.prev;
+  n.prev = n.next = kNil;
+  n.where = kNone;
+}
+
+// Level = the 6-bit group holding the highest bit where the deadline differs
+// from now_; within one level-(L+1) block that makes the slot strictly ahead
+// of now_'s, so the wheel reaches it before the deadline passes.
+void TimerWheel::place_(Id id) {
+  const uint64_t at = nodes_[id].at;
+  if (at <= now_) {
+    link_(id, kDue);
+    return;
+  }
+  const int level = (std::bit_width(at ^ now_) - 1) / kLevelBits;
+  if (level >= kLevels) {
+    link_(id, kOverflow);
+    return;
+  }
+  const auto s = static_cast<uint32_t>((at >> (kLevelBits * level)) & kSlotMask);
+  link_(id, static_cast<uint32_t>(level * kSlotsPerLevel) + s);
+}
+
+TimerWheel::Id TimerWheel::pop_expired_(uint64_t t) {
+  for (;;) {
+    if (const Id id = heads_[kDue]; id != kNil) {
+      unlink_(id);
+      --size_;
+      return id;
+    }
+
+    // Next occupied slot: the lowest level with a slot ahead of now_ wins,
+    // since every lower-level timer lies inside the higher levels' current slot.
+    int level = kLevels;
+    uint64_t s = 0;
+    for (int l = 0; l < kLevels; ++l) {
+      const uint64_t cur = (now_ >> (kLevelBits * l)) & kSlotMask;
+      const uint64_t ahead = cur == kSlotMask ? 0 : occupied_[l] & (~uint64_t{0} << (cur + 1));
+      if (ahead != 0) {
+        level = l;
+        s = static_cast<uint64_t>(std::countr_zero(ahead));
+        break;
+      }
+    }
+
+    uint64_t event = 0;
+    if (level < kLevels) {
+      event = slot_start(now_, level, s);
+    } else if (heads_[kOverflow] != kNil) {
+      // Straight to the block of the earliest overflow timer.
+      uint64_t earliest = ~uint64_t{0};
+      for (Id id = heads_[kOverflow]; id != kNil; id = nodes_[id].next) earliest = std::min(earliest, nodes_[id].at);
+      event = earliest >> kSpanBits << kSpanBits;
+    } else {
+      now_ = std::max(now_, t);
+      return kNil;
+    }
+    if (event > t) {
+      now_ = std::max(now_, t);
+      return kNil;
+    }
+
+    // Reach the slot and redistribute it; deadlines now due land in kDue.
+    now_ = event;
+    const uint32_t where = level < kLevels ? static_cast<uint32_t>(level * kSlotsPerLevel + s) : kOverflow;
+    Id id = heads_[where];
+    while (id != kNil) {
+      const Id next = nodes_[id].next;
+      unlink_(id);
+      place_(id);
+      id = next;
+    }
+  }
+}
+
+} // namespace telemetry
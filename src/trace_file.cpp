@@ -0,0 +1,179 @@
+// trace_file.cpp
+#include "trace_file.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TELEMETRY_TRACE_MMAP 1
+#else
+#define TELEMETRY_TRACE_MMAP 0
+#endif
+
+namespace telemetry {
+
+namespace {
+constexpr uint32_t kMaxNamedId = 1u << 24;
+
+[[noreturn]] void fail(const std::string& path, const char* what) {
+  throw std::runtime_error("trace " + path + ": " + what);
+}
+} // namespace
+
+uint32_t TraceHeader::config_flags(const AgentConfig& cfg) {
+  uint32_t f = 0;
+  if (!cfg.score.useEwma) f |= kNoEwma;
+  if (cfg.recompute == RecomputeMode::PerTick) f |= kPerTick;
+  if (cfg.same_second == SameSecond::Average) f |= kSameSecondAverage;
+  return f;
+}
+
+void TraceHeader::apply_config(AgentConfig& cfg) const {
+  cfg.score.useEwma = (flags & kNoEwma) == 0;
+  cfg.recompute = (flags & kPerTick) ? RecomputeMode::PerTick : RecomputeMode::Eager;
+  cfg.same_second = (flags & kSameSecondAverage) ? SameSecond::Average : SameSecond::Replace;
+}
+
+TraceWriter::TraceWriter(const std::string& path) : path_(path) {
+  f_ = std::fopen(path.c_str(), "wb");
+  if (!f_) fail(path_, "cannot open for writing");
+  buf_.reserve(kBufferRecords);
+  const TraceHeader placeholder{}; // magic stays zero until close() succeeds
+  if (std::fwrite(&placeholder, sizeof placeholder, 1, f_) != 1) {
+    std::fclose(f_);
+    f_ = nullptr;
+    fail(path_, "write failed");
+  }
+}
+
+TraceWriter::~TraceWriter() {
+  try {
+    close();
+  } catch (...) {
+  }
+}
+
+void TraceWriter::name(InterfaceId id, std::string_view iface) {
+  if (id >= names_.size()) names_.resize(static_cast<std::size_t>(id) + 1);
+  names_[id] = std::string(iface);
+}
+
+void TraceWriter::flush_() {
+  if (buf_.empty()) return;
+  if (!f_ || std::fwrite(buf_.data(), sizeof(TraceRecord), buf_.size(), f_) != buf_.size()) {
+    fail(path_, "write failed");
+  }
+  buf_.clear();
+}
+
+void TraceWriter::close() {
+  if (!f_) return;
+  std::FILE* f = f_;
+  try {
+    flush_();
+    TraceHeader h;
+    std::memcpy(h.magic, TraceHeader::kMagic, sizeof h.magic);
+    h.record_size = sizeof(TraceRecord);
+    h.flags = flags_;
+    h.record_count = count_;
+    h.names_offset = sizeof(TraceHeader) + count_ * sizeof(TraceRecord);
+    // Every id up to the highest named one is listed, so the reader can
+    // bound sample ids by the table.
+    for (std::size_t id = 0; id < names_.size(); ++id) {
+      const uint32_t entry[2] = {static_cast<uint32_t>(id), static_cast<uint32_t>(names_[id].size())};
+      if (std::fwrite(entry, sizeof entry, 1, f) != 1 ||
+          std::fwrite(names_[id].data(), 1, names_[id].size(), f) != names_[id].size()) {
+        fail(path_, "write failed");
+      }
+      ++h.name_count;
+    }
+    if (std::fseek(f, 0, SEEK_SET) != 0 || std::fwrite(&h, sizeof h, 1, f) != 1) fail(path_, "write failed");
+  } catch (...) {
+    std::fclose(f);
+    f_ = nullptr;
+    throw;
+  }
+  f_ = nullptr;
+  if (std::fclose(f) != 0) fail(path_, "close failed");
+}
+
+TraceReader::TraceReader(const std::string& path) {
+#if TELEMETRY_TRACE_MMAP
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) fail(path, "cannot open");
+  struct stat st {};
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    fail(path, "cannot stat");
+  }
+  size_ = static_cast<std::size_t>(st.st_size);
+  if (size_ >= sizeof(TraceHeader)) {
+    void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p != MAP_FAILED) {
+      data_ = static_cast<const unsigned char*>(p);
+      mapped_ = true;
+    }
+  }
+  ::close(fd);
+#endif
+  if (!mapped_) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) fail(path, "cannot open");
+    unsigned char chunk[1 << 16];
+    for (std::size_t n; (n = std::fread(chunk, 1, sizeof chunk, f)) > 0;) owned_.insert(owned_.end(), chunk, chunk + n);
+    std::fclose(f);
+    data_ = owned_.data();
+    size_ = owned_.size();
+  }
+
+  try {
+    if (size_ < sizeof(TraceHeader)) fail(path, "truncated header");
+    std::memcpy(&header_, data_, sizeof header_);
+    if (std::memcmp(header_.magic, TraceHeader::kMagic, sizeof header_.magic) != 0) fail(path, "not a trace file");
+    if (header_.endian != TraceHeader::kEndian) fail(path, "written with the other byte order");
+    if (header_.version != TraceHeader::kVersion) fail(path, "unsupported version");
+    if (header_.record_size != sizeof(TraceRecord)) fail(path, "unexpected record size");
+    const uint64_t records_end = sizeof(TraceHeader) + header_.record_count * sizeof(TraceRecord);
+    if (header_.record_count > size_ / sizeof(TraceRecord) || records_end > size_ ||
+        header_.names_offset < records_end || header_.names_offset > size_) {
+      fail(path, "truncated records");
+    }
+    records_ = {reinterpret_cast<const TraceRecord*>(data_ + sizeof(TraceHeader)),
+                static_cast<std::size_t>(header_.record_count)};
+
+    std::size_t off = static_cast<std::size_t>(header_.names_offset);
+    for (uint32_t i = 0; i < header_.name_count; ++i) {
+      uint32_t entry[2];
+      if (size_ - off < sizeof entry) fail(path, "truncated name table");
+      std::memcpy(entry, data_ + off, sizeof entry);
+      off += sizeof entry;
+      if (size_ - off < entry[1]) fail(path, "truncated name table");
+      if (entry[0] >= kMaxNamedId) fail(path, "corrupt name table");
+      if (entry[0] >= names_.size()) names_.resize(static_cast<std::size_t>(entry[0]) + 1);
+      names_[entry[0]].assign(reinterpret_cast<const char*>(data_ + off), entry[1]);
+      off += entry[1];
+    }
+
+    // A corrupt id would have a replay register billions of interfaces.
+    for (const TraceRecord& r : records_) {
+      if (r.is_sample() && r.iface >= names_.size()) fail(path, "sample for an unlisted interface");
+    }
+  } catch (...) {
+#if TELEMETRY_TRACE_MMAP
+    if (mapped_) ::munmap(const_cast<unsigned char*>(data_), size_);
+#endif
+    throw;
+  }
+}
+
+TraceReader::~TraceReader() {
+#if TELEMETRY_TRACE_MMAP
+  if (mapped_) ::munmap(const_cast<unsigned char*>(data_), size_);
+#endif
+}
+
+} // namespace telemetry
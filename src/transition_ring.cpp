@@ -0,0 +1,36 @@
+// transition_ring.cpp
+#include "transition_ring.hpp"
+
+namespace telemetry {
+
+TransitionRing::TransitionRing(TransitionLogConfig cfg)
+  : buf_(cfg.capacity > 0 ? cfg.capacity : 1), overflow_(cfg.overflow) {}
+
+void TransitionRing::push(const TransitionEvent& ev) {
+  if (size_ == buf_.size()) {
+    if (overflow_ == OverflowPolicy::DropNewest) {
+      ++stats_.dropped;
+      return;
+    }
+    // Full ring: the slot at head_ is the oldest; overwrite it and advance.
+    buf_[head_] = ev;
+    head_ = wrap_(head_ + 1);
+    ++stats_.overwritten;
+    ++stats_.recorded;
+    return;
+  }
+  buf_[wrap_(head_ + size_)] = ev;
+  ++size_;
+  ++stats_.recorded;
+}
+
+std::size_t TransitionRing::drain(std::span<TransitionEvent> out) {
+  const std::size_t n = out.size() < size_ ? out.size() : size_;
+  for (std::size_t i = 0; i < n; ++i) out[i] = buf_[wrap_(head_ + i)];
+  head_ = wrap_(head_ + n);
+  size_ -= n;
+  if (size_ == 0) head_ = 0;
+  return n;
+}
+
+} // namespace telemetry
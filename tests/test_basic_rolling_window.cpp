@@ -0,0 +1,95 @@
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include "basic_rolling_window.hpp"
+#include "interface_tracker.hpp"
+
+using namespace telemetry;
+
+using RadioMetrics = MetricSet<ThroughputMetric, RttMetric, LossMetric, JitterMetric,
+                               RetransmitMetric, SignalStrengthMetric>;
+using Window64 = BasicRollingWindow<64, RadioMetrics>;
+
+static_assert(Window64::kSlots == 64 && Window64::kMetrics == 6);
+static_assert(RollingWindow::Storage::kSlots == 64 && RollingWindow::Storage::kWindow == 45);
+static_assert(RadioMetrics::index_of<RttMetric>() == 1);
+static_assert(RadioMetrics::index_of<SignalStrengthMetric>() == 5);
+
+// Everything needed to score is usable in constant expressions.
+static_assert(normalize<ThroughputMetric>(100.0) == 0.5);
+static_assert(normalize<SignalStrengthMetric>(-50.0) == 1.0 && normalize<SignalStrengthMetric>(-120.0) == 0.0);
+static_assert(DefaultMetrics::score({200.0, 10.0, 0.0, 0.0}) == 1.0);
+
+[[maybe_unused]] static bool near(double a, double b) { return std::abs(a - b) <= 1e-9; }
+
+int main() {
+  // Basic semantics on a 64 s window with six metrics.
+  {
+    Window64 w;
+    const RadioMetrics::Values v{100, 20, 1, 5, 2, -70};
+    const WindowIngestResult first = w.insert(1000, v);
+    const WindowIngestResult repeat = w.insert(1000, v);
+    const WindowIngestResult oldest = w.insert(1000 - 63, v);  // oldest second still fits
+    const WindowIngestResult too_old = w.insert(1000 - 64, v);
+    assert(first == WindowIngestResult::Inserted && repeat == WindowIngestResult::Overwritten);
+    assert(oldest == WindowIngestResult::Inserted && too_old == WindowIngestResult::TooOld);
+    assert(w.summary().count == 2);
+    assert(near(w.summary().avg[5], -70.0));
+
+    w.note_time(1001); // evicts 937
+    assert(w.summary().count == 1 && !w.has_sample(937) && w.has_sample(1000));
+    w.note_time(1000 + 64); // evicts 1000
+    assert(w.summary().count == 0);
+    assert(w.summary().confidence == 0.0);
+  }
+
+  // Negative timestamps map through the mask like any other.
+  {
+    Window64 w;
+    for (int64_t t = -10; t <= 10; ++t) w.insert(t, RadioMetrics::Values{double(t), 0, 0, 0, 0, 0});
+    assert(w.summary().count == 21);
+    assert(near(w.summary().avg[0], 0.0));
+    assert(w.get(-3).has_value() && (*w.get(-3))[0] == -3.0);
+  }
+
+  // Running sums agree with the rescan under random out-of-order traffic.
+  {
+    Window64 w;
+    std::mt19937_64 rng(5);
+    std::uniform_int_distribution<int> jump(-70, 3);
+    std::uniform_real_distribution<double> val(0.0, 100.0);
+    int64_t now = 0;
+    for (int i = 0; i < 50000; ++i) {
+      if (i % 97 == 0) now += 200; // idle gap: the whole window expires
+      now += (i % 3 == 0) ? 1 : 0;
+      w.note_time(now);
+      RadioMetrics::Values v{};
+      for (auto& x : v) x = val(rng);
+      w.insert(now + jump(rng), v);
+      const auto a = w.summary();
+      const auto b = w.summary_scan();
+      assert(a.count == b.count && a.newest_ts == b.newest_ts);
+      for (std::size_t k = 0; k < RadioMetrics::size; ++k) assert(near(a.avg[k], b.avg[k]));
+    }
+  }
+
+  // The default metric set scores exactly like InterfaceTracker's normalisers.
+  {
+    const ScoreConfig c;
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> tp(-10, 300), rtt(0, 1000), loss(-1, 40), jit(-5, 250);
+    for (int i = 0; i < 10000; ++i) {
+      const DefaultMetrics::Values v{tp(rng), rtt(rng), loss(rng), jit(rng)};
+      const double ref = InterfaceTracker::clamp01(c.w_tp * InterfaceTracker::norm_tp(v[0]) +
+                                                   c.w_rtt * InterfaceTracker::norm_rtt(v[1]) +
+                                                   c.w_loss * InterfaceTracker::norm_loss(v[2]) +
+                                                   c.w_jit * InterfaceTracker::norm_jit(v[3]));
+      assert(std::abs(DefaultMetrics::score(v) - ref) <= 1e-12);
+    }
+  }
+
+  std::printf("test_basic_rolling_window OK\n");
+  return 0;
+}
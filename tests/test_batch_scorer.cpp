@@ -0,0 +1,147 @@
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "batch_scorer.hpp"
+#include "interface_tracker.hpp"
+
+using namespace telemetry;
+
+// Documented tolerance between kernels (see batch_scorer.hpp).
+static constexpr double kTol = 1e-12;
+
+struct Columns {
+  std::vector<double> tp, rtt, loss, jit, conf;
+  std::vector<double> avg, ewma, used;
+  std::vector<uint8_t> have;
+
+  explicit Columns(std::size_t n)
+    : tp(n), rtt(n), loss(n), jit(n), conf(n), avg(n), ewma(n), used(n), have(n) {}
+
+  ScoreBatch batch() {
+    ScoreBatch b;
+    b.avg_tp_mbps = tp.data();
+    b.avg_rtt_ms = rtt.data();
+    b.avg_loss_pct = loss.data();
+    b.avg_jitter_ms = jit.data();
+    b.confidence = conf.data();
+    b.score_avg = avg.data();
+    b.score_ewma = ewma.data();
+    b.have_ewma = have.data();
+    b.score_used = used.data();
+    b.n = tp.size();
+    return b;
+  }
+};
+
+static void assert_close(const Columns& a, [[maybe_unused]] const Columns& b) {
+  for (std::size_t i = 0; i < a.avg.size(); ++i) {
+    assert(std::abs(a.avg[i] - b.avg[i]) <= kTol);
+    assert(std::abs(a.ewma[i] - b.ewma[i]) <= kTol);
+    assert(std::abs(a.used[i] - b.used[i]) <= kTol);
+    assert(a.have[i] == b.have[i]);
+  }
+}
+
+// Randomized inputs, including out-of-range values and exact range edges.
+static void fill(Columns& c, std::mt19937& rng) {
+  std::uniform_real_distribution<double> u(-0.2, 1.2);
+  std::uniform_int_distribution<int> edge(0, 9);
+  for (std::size_t i = 0; i < c.tp.size(); ++i) {
+    c.tp[i] = edge(rng) == 0 ? 200.0 : 200.0 * u(rng);
+    c.rtt[i] = edge(rng) == 0 ? 10.0 : 10.0 + 790.0 * u(rng);
+    c.loss[i] = edge(rng) == 0 ? 0.0 : 30.0 * u(rng);
+    c.jit[i] = edge(rng) == 0 ? 200.0 : 200.0 * u(rng);
+    c.conf[i] = edge(rng) == 0 ? 0.60 : std::abs(u(rng));
+  }
+}
+
+static void check_kernels(const ScoreConfig& cfg, std::size_t n, uint32_t seed) {
+  std::mt19937 rng(seed);
+  Columns ref(n);
+  std::vector<Columns> others;
+  std::vector<ScoreKernel> kernels;
+  for (ScoreKernel k : {ScoreKernel::Avx2, ScoreKernel::Neon}) {
+    if (!score_kernel_available(k)) continue;
+    kernels.push_back(k);
+    others.emplace_back(n);
+  }
+  // Interfaces start without EWMA history, except a few that already have some.
+  for (std::size_t i = 0; i < n; i += 3) {
+    ref.have[i] = 1;
+    ref.ewma[i] = 0.5;
+  }
+  for (auto& o : others) { o.have = ref.have; o.ewma = ref.ewma; }
+
+  for (int tick = 0; tick < 50; ++tick) {
+    fill(ref, rng);
+    score_batch_with(ScoreKernel::Scalar, cfg, ref.batch());
+    for (std::size_t k = 0; k < kernels.size(); ++k) {
+      others[k].tp = ref.tp; others[k].rtt = ref.rtt; others[k].loss = ref.loss;
+      others[k].jit = ref.jit; others[k].conf = ref.conf;
+      score_batch_with(kernels[k], cfg, others[k].batch());
+      assert_close(ref, others[k]);
+    }
+  }
+}
+
+// The batch path must reproduce InterfaceTracker's own scores, EWMA included.
+static void check_against_tracker(const AgentConfig& cfg) {
+  InterfaceTracker tr("wifi0", cfg);
+  constexpr std::size_t kLanes = 7; // one full AVX2 vector plus a scalar tail
+  Columns c(kLanes);
+
+  for (int64_t t = 0; t < 150; ++t) {
+    const double u = 0.5 + 0.5 * std::sin(static_cast<double>(t) / 9.0);
+    // Ingest before note_time(t) so both recomputes of this tick see the
+    // same window; a tick without a sample recomputes once.
+    const bool have_sample = (t % 11 != 0);
+    if (have_sample) tr.ingest(t, Metrics{20 + 500 * u, 150 - 100 * u, 10 * u, 80 * u});
+    tr.note_time(t);
+    const auto& s = tr.snapshot();
+
+    for (std::size_t i = 0; i < kLanes; ++i) {
+      c.tp[i] = s.avg_tp_mbps;
+      c.rtt[i] = s.avg_rtt_ms;
+      c.loss[i] = s.avg_loss_pct;
+      c.jit[i] = s.avg_jitter_ms;
+      c.conf[i] = s.confidence;
+    }
+    for (int r = 0; r < (have_sample ? 2 : 1); ++r) score_batch(cfg.score, c.batch());
+
+    for (std::size_t i = 0; i < kLanes; ++i) {
+      assert(std::abs(c.avg[i] - s.score_raw) <= kTol);
+      assert(std::abs(c.ewma[i] - s.score_smoothed) <= kTol);
+      assert(std::abs(c.used[i] - s.score_used) <= kTol);
+    }
+  }
+}
+
+int main() {
+  ScoreConfig base;
+  for (bool useEwma : {false, true}) {
+    for (bool penalty : {false, true}) {
+      for (bool cap : {false, true}) {
+        ScoreConfig cfg = base;
+        cfg.useEwma = useEwma;
+        cfg.enable_downtrend_penalty = penalty;
+        cfg.downtrend_penalty = 0.05;
+        cfg.enable_confidence_cap = cap;
+        for (std::size_t n : {0u, 1u, 3u, 4u, 5u, 64u, 1001u}) check_kernels(cfg, n, 7u + static_cast<uint32_t>(n));
+      }
+    }
+  }
+
+  for (bool useEwma : {false, true}) {
+    AgentConfig acfg;
+    acfg.score.useEwma = useEwma;
+    acfg.score.enable_downtrend_penalty = true;
+    acfg.score.downtrend_penalty = 0.02;
+    check_against_tracker(acfg);
+  }
+
+  std::printf("test_batch_scorer OK (active=%s)\n", to_string(active_score_kernel()));
+  return 0;
+}
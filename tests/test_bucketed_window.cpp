@@ -0,0 +1,171 @@
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bucketed_window.hpp"
+#include "columnar_agent.hpp"
+#include "telemetry_agent.hpp"
+
+using namespace telemetry;
+
+using Fine = BucketedWindow<45, DefaultMetrics>;
+constexpr std::size_t kRtt = DefaultMetrics::index_of<RttMetric>();
+
+[[maybe_unused]] static bool near(double a, double b) { return std::abs(a - b) <= 1e-9; }
+
+static DefaultMetrics::Values rtt(double ms) {
+  DefaultMetrics::Values v{};
+  v[kRtt] = ms;
+  return v;
+}
+
+int main() {
+  // 10 Hz probes: every sample is kept, one bucket per second.
+  {
+    Fine w;
+    for (int64_t t = 0; t < 45; ++t) {
+      for (int k = 0; k < 10; ++k) {
+        const auto res = w.insert(t, rtt(10.0 * static_cast<double>(k)));
+        assert(res == (k == 0 ? WindowIngestResult::Inserted : WindowIngestResult::Merged));
+      }
+    }
+    const auto s = w.summary();
+    assert(s.buckets == 45 && s.samples == 450 && s.confidence == 1.0);
+    assert(near(s.avg[kRtt], 45.0));
+    assert(w.min(kRtt) == 0.0 && w.max(kRtt) == 90.0);
+    const auto* b = w.bucket(0);
+    assert(b && b->n == 10 && b->min[kRtt] == 0.0 && b->max[kRtt] == 90.0 && near(b->mean(kRtt), 45.0));
+
+    w.note_time(45); // second 0 expires
+    assert(w.summary().buckets == 44 && w.summary().samples == 440);
+    const WindowIngestResult expired = w.insert(0, rtt(1.0));
+    assert(expired == WindowIngestResult::TooOld);
+    w.note_time(45 + 100); // idle gap: everything expires
+    assert(w.summary().samples == 0 && w.bucket(0) == nullptr);
+  }
+
+  // Running totals match a brute-force recount under random late traffic.
+  {
+    Fine w;
+    std::map<int64_t, std::vector<double>> ref;
+    std::mt19937 rng(9);
+    std::uniform_int_distribution<int> late(-50, 1);
+    std::uniform_real_distribution<double> val(5.0, 500.0);
+    int64_t now = -200; // negative time buckets by floor
+    for (int i = 0; i < 20000; ++i) {
+      if (i % 7 == 0) ++now;
+      w.note_time(now);
+      const int64_t ts = now + late(rng);
+      const double v = val(rng);
+      if (w.insert(ts, rtt(v)) != WindowIngestResult::TooOld) ref[ts].push_back(v);
+
+      const int64_t newest = w.summary().newest_bucket;
+      double sum = 0.0, lo = 1e300, hi = -1e300;
+      uint64_t n = 0;
+      int buckets = 0;
+      for (auto& [sec, vs] : ref) {
+        if (sec < newest - 44 || sec > newest) continue;
+        ++buckets;
+        for (double x : vs) {
+          sum += x;
+          lo = std::min(lo, x);
+          hi = std::max(hi, x);
+          ++n;
+        }
+      }
+      const auto s = w.summary();
+      assert(s.samples == n && s.buckets == buckets);
+      if (n > 0) {
+        assert(std::abs(s.avg[kRtt] - sum / n) <= 1e-6);
+        assert(w.min(kRtt) == lo && w.max(kRtt) == hi);
+      }
+    }
+  }
+
+  // Coarse tiers: RTT rising by one unit per second shows as +60 per minute.
+  {
+    BucketRing<60, 15, DefaultMetrics> minutes;
+    for (int64_t t = 0; t < 15 * 60; ++t) minutes.insert(t, rtt(static_cast<double>(t)));
+    const auto s = minutes.summary();
+    assert(s.buckets == 15 && s.samples == 900);
+    assert(near(minutes.trend(kRtt), 60.0));
+    assert(near(minutes.bucket(0)->mean(kRtt), 869.5));
+    assert(near(minutes.bucket(14)->mean(kRtt), 29.5));
+
+    minutes.note_time(15 * 60 + 59); // oldest minute leaves
+    assert(minutes.summary().buckets == 14 && minutes.bucket(0) == nullptr);
+  }
+
+  // Multi-resolution: one insert feeds every tier; tiers keep their own horizon.
+  {
+    ProbeWindow w;
+    for (int64_t t = 0; t < 3600; ++t) {
+      w.note_time(t);
+      w.insert(t, rtt(20.0));
+      w.insert(t, rtt(40.0));
+    }
+    assert(w.fine().summary().samples == 90);
+    assert(w.tier<0>().summary().samples == 15 * 60 * 2);
+    assert(w.tier<1>().summary().samples == 3600 * 2);
+    assert(near(w.tier<1>().summary().avg[kRtt], 30.0));
+
+    // Too old for the fine window, still inside the 15-minute tier.
+    const WindowIngestResult late = w.insert(3599 - 300, rtt(30.0));
+    assert(late == WindowIngestResult::TooOld);
+    assert(w.tier<0>().summary().samples == 15 * 60 * 2 + 1);
+  }
+
+  // Agents: SameSecond::Average keeps the mean of sub-second samples.
+  {
+    AgentConfig cfg;
+    cfg.same_second = SameSecond::Average;
+    TelemetryAgent agent(cfg);
+    ColumnarTelemetryAgent col(cfg);
+    TelemetryAgent replace; // default: last sample wins
+    const InterfaceId id = agent.register_interface("eth0");
+    col.register_interface("eth0");
+    replace.register_interface("eth0");
+
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<double> jitter(0.5, 1.5);
+    for (int64_t t = 0; t < 200; ++t) {
+      agent.note_time(t);
+      col.note_time(t);
+      replace.note_time(t);
+      for (int k = 0; k < 10; ++k) {
+        const double u = jitter(rng);
+        const Metrics m{(t % 50 < 25 ? 30.0 : 400.0) * u, 150.0 * u, 0.5 * u, 5.0 * u};
+        const int64_t ts = (k == 9) ? t - 3 : t; // a late one merges into an older second
+        agent.ingest(id, ts, m);
+        col.ingest(id, ts, m);
+        replace.ingest(id, ts, m);
+      }
+      const auto& a = agent.snapshot(id);
+      const auto c = col.snapshot(id);
+      assert(a.status == c.status);
+      assert(std::abs(a.score_used - c.score_used) <= 1e-12);
+      assert(std::abs(a.avg_rtt_ms - c.avg_rtt_ms) <= 1e-9);
+      assert(a.confidence == replace.snapshot(id).confidence);
+    }
+
+    // The window mean is the mean of per-second means.
+    TelemetryAgent probe(cfg);
+    probe.register_interface("eth0");
+    probe.note_time(10);
+    for (double r : {10.0, 20.0, 60.0}) probe.ingest(InterfaceId{0}, 10, Metrics{r, 100, 0, 0});
+    probe.ingest(InterfaceId{0}, 9, Metrics{70.0, 100, 0, 0});
+    assert(near(probe.snapshot(0).avg_rtt_ms, (30.0 + 70.0) / 2.0));
+
+    if constexpr (kInstrumentationEnabled) {
+      const auto& s = probe.stats().totals;
+      assert(s.ingested == 4 && s.merged == 2 && s.overwritten == 0);
+    }
+  }
+
+  std::printf("test_bucketed_window OK\n");
+  return 0;
+}
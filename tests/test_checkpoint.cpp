@@ -0,0 +1,219 @@
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "checkpoint.hpp"
+#include "scenarios.hpp"
+#include "telemetry_agent.hpp"
+
+using namespace telemetry;
+
+static const std::vector<std::string> kIfaces = {"eth0", "wifi0", "lte0", "sat0"};
+
+[[maybe_unused]] static bool same(const InterfaceSnapshot& a, const InterfaceSnapshot& b) {
+  return a.iface == b.iface && a.status == b.status && a.score_raw == b.score_raw &&
+         a.score_smoothed == b.score_smoothed && a.score_used == b.score_used && a.confidence == b.confidence &&
+         a.missing_rate == b.missing_rate && a.avg_tp_mbps == b.avg_tp_mbps && a.avg_rtt_ms == b.avg_rtt_ms &&
+         a.avg_loss_pct == b.avg_loss_pct && a.avg_jitter_ms == b.avg_jitter_ms;
+}
+
+[[maybe_unused]] static bool same(const std::vector<TransitionEvent>& a, const std::vector<TransitionEvent>& b) {
+  if (a.size() != b.size()) return false;
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    if (a[i].id != b[i].id || a[i].ts != b[i].ts || a[i].from != b[i].from || a[i].to != b[i].to ||
+        a[i].reason != b[i].reason) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void feed(TelemetryAgent& agent, const ScenarioGenerator& gen, int64_t t) {
+  agent.note_time(t);
+  for (const auto& iface : kIfaces) {
+    if (const auto g = gen.sample(iface, t)) agent.ingest(iface, g->ts, g->m);
+  }
+}
+
+static bool restore_throws(TelemetryAgent& agent, const std::string& path) {
+  try {
+    (void)restore_checkpoint(agent, path);
+  } catch (const std::runtime_error&) {
+    return true;
+  }
+  return false;
+}
+
+// Runs a scenario to `at`, checkpoints, restores into a fresh agent and
+// checks that both continue identically to the end. Returns transitions seen
+// after the restore.
+static int check_continuation(ScenarioId sid, const AgentConfig& cfg, const std::string& path, int64_t at) {
+  ImperfectDataConfig imp;
+  imp.enable_missing = true;
+  imp.enable_late = true;
+  imp.drop_every_n = 5;
+  imp.late_every_n = 4;
+  const ScenarioGenerator gen(sid, imp);
+
+  TelemetryAgent ref(cfg);
+  for (int64_t t = 0; t <= at; ++t) feed(ref, gen, t);
+  ref.drain_transitions();
+  save_checkpoint(ref, at, path);
+
+  TelemetryAgent restored(cfg);
+  const CheckpointInfo info = restore_checkpoint(restored, path);
+  assert(info.tick_ts == at && info.interfaces == kIfaces.size());
+  for (InterfaceId id = 0; id < ref.size(); ++id) assert(same(restored.snapshot(id), ref.snapshot(id)));
+
+  int transitions = 0;
+  for (int64_t t = at + 1; t < 300; ++t) {
+    feed(ref, gen, t);
+    feed(restored, gen, t);
+    const auto a = ref.drain_transitions();
+    const auto b = restored.drain_transitions();
+    assert(same(a, b));
+    transitions += static_cast<int>(a.size());
+    for (InterfaceId id = 0; id < ref.size(); ++id) assert(same(restored.snapshot(id), ref.snapshot(id)));
+  }
+  return transitions;
+}
+
+int main() {
+  const std::string path = "/tmp/test_checkpoint_" + std::to_string(::getpid()) + ".ckpt";
+
+  AgentConfig base;
+  base.fsm.min_dwell_sec = 3;
+
+  AgentConfig per_tick = base;
+  per_tick.recompute = RecomputeMode::PerTick;
+  per_tick.same_second = SameSecond::Average;
+
+  AgentConfig tails = base;
+  tails.score.rtt_stat = WindowStat::P95;
+  tails.score.loss_use_max = true;
+  tails.tick_scan = TickScan::Active;
+
+  int transitions = 0;
+  for (ScenarioId sid : {ScenarioId::A, ScenarioId::B, ScenarioId::C, ScenarioId::D}) {
+    for (const AgentConfig& cfg : {base, per_tick, tails}) {
+      for (int64_t at : {10, 120, 200}) transitions += check_continuation(sid, cfg, path, at);
+    }
+  }
+  assert(transitions > 0);
+
+  // Restore is by name: a different registration order and an extra
+  // interface are fine; statuses are warm before the first tick.
+  {
+    const ScenarioGenerator gen(ScenarioId::B);
+    TelemetryAgent ref;
+    for (int64_t t = 0; t < 90; ++t) feed(ref, gen, t);
+    save_checkpoint(ref, 89, path);
+
+    TelemetryAgent other;
+    other.register_interface("tun9");
+    other.register_interface("sat0");
+    const CheckpointInfo info = restore_checkpoint(other, path);
+    assert(info.interfaces == 4 && other.size() == 5);
+    for (InterfaceId id = 0; id < ref.size(); ++id) {
+      const InterfaceId oid = *other.find_interface(kIfaces[id]);
+      assert(same(other.snapshot(oid), ref.snapshot(id)));
+    }
+    assert(other.snapshot(*other.find_interface("eth0")).confidence > 0.9);
+
+    ref.note_time(90);
+    other.note_time(90);
+    for (InterfaceId id = 0; id < ref.size(); ++id) {
+      PublishedSnapshot p;
+      const bool got = other.published().read(*other.find_interface(kIfaces[id]), p);
+      assert(got);
+      assert(p.status == ref.snapshot(id).status && p.score_used == ref.snapshot(id).score_used);
+    }
+  }
+
+  // Refused, with the agent untouched: another config, a foreign or
+  // truncated file, a corrupt record.
+  {
+    TelemetryAgent ref;
+    for (const auto& i : kIfaces) ref.register_interface(i);
+    ref.ingest(InterfaceId{0}, 5, Metrics{20.0, 200.0, 0.0, 1.0});
+    ref.note_time(5);
+    std::vector<uint64_t> words;
+    encode_checkpoint(ref, 5, words);
+
+    AgentConfig other_cfg;
+    other_cfg.fsm.healthy_enter = 0.8;
+    assert(config_hash(other_cfg) != config_hash(AgentConfig{}));
+    AgentConfig scan_only;
+    scan_only.tick_scan = TickScan::Active;
+    assert(config_hash(scan_only) == config_hash(AgentConfig{}));
+
+    TelemetryAgent a(other_cfg);
+    write_checkpoint_file(path, words);
+    const bool mismatched = restore_throws(a, path);
+    assert(mismatched && a.size() == 0);
+
+    TelemetryAgent b;
+    write_checkpoint_file(path, std::span<const uint64_t>(words).first(words.size() - 40));
+    const bool truncated = restore_throws(b, path);
+    assert(truncated && b.size() == 0);
+
+    auto bad = words;
+    bad[0] ^= 1;
+    write_checkpoint_file(path, bad);
+    const bool bad_magic = restore_throws(b, path);
+    assert(bad_magic);
+
+    bad = words;
+    CheckpointRecord r;
+    std::memcpy(static_cast<void*>(&r), bad.data() + 8 + sizeof(CheckpointRecord) / 8, sizeof r);
+    r.status = 9;
+    std::memcpy(bad.data() + 8 + sizeof(CheckpointRecord) / 8, &r, sizeof r);
+    write_checkpoint_file(path, bad);
+    const bool bad_status = restore_throws(b, path);
+    assert(bad_status && b.size() == 0);
+
+    const bool missing = restore_throws(b, path + ".missing");
+    assert(missing);
+  }
+
+  // Background writer: the file holds the last capture.
+  {
+    const ScenarioGenerator gen(ScenarioId::C);
+    TelemetryAgent agent;
+    CheckpointWriter writer(path);
+    int64_t last = -1;
+    for (int64_t t = 0; t < 100; ++t) {
+      feed(agent, gen, t);
+      if (t % 10 != 9) continue;
+      if (t == 99) writer.wait(); // so the last capture is never skipped
+      if (writer.capture(agent, t)) last = t;
+    }
+    writer.wait();
+    assert(writer.written() + writer.skipped() == 10 && last == 99);
+
+    TelemetryAgent restored;
+    const int64_t tick_ts = restore_checkpoint(restored, path).tick_ts;
+    assert(tick_ts == 99);
+    for (InterfaceId id = 0; id < agent.size(); ++id) assert(same(restored.snapshot(id), agent.snapshot(id)));
+
+    CheckpointWriter broken("/nonexistent-dir/x.ckpt");
+    const bool queued = broken.capture(agent, 100);
+    assert(queued);
+    bool threw = false;
+    try {
+      broken.wait();
+    } catch (const std::runtime_error&) {
+      threw = true;
+    }
+    assert(threw);
+  }
+
+  std::remove(path.c_str());
+  std::printf("test_checkpoint OK (transitions=%d record=%zuB)\n", transitions, sizeof(CheckpointRecord));
+  return 0;
+}
@@ -0,0 +1,183 @@
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "columnar_agent.hpp"
+#include "telemetry_agent.hpp"
+#include "scenarios.hpp"
+
+using namespace telemetry;
+
+static AgentConfig cfg_for(bool useEwma) {
+  AgentConfig cfg;
+  cfg.score.useEwma = useEwma;
+  cfg.score.ewma_alpha = 0.25;
+  cfg.score.enable_downtrend_penalty = false;
+
+  cfg.fsm.healthy_enter = 0.72;
+  cfg.fsm.healthy_exit  = 0.66;
+  cfg.fsm.down_enter    = 0.35;
+  cfg.fsm.down_exit     = 0.45;
+  cfg.fsm.healthy_enter_N = 6;
+  cfg.fsm.healthy_exit_N  = 6;
+  cfg.fsm.down_enter_N    = 3;
+  cfg.fsm.down_exit_N     = 5;
+  cfg.fsm.min_dwell_sec   = 5;
+  return cfg;
+}
+
+// Scores may differ in the last bits if the compiler contracts differently.
+[[maybe_unused]] static bool near(double a, double b) { return std::abs(a - b) <= 1e-12; }
+
+static void assert_same(const TelemetryAgent& ref, const ColumnarTelemetryAgent& col) {
+  const auto snaps = ref.snapshots();
+  assert(snaps.size() == col.size());
+  for (const auto& r : snaps) {
+    const auto id = col.find_interface(r.iface);
+    assert(id.has_value());
+    const auto c = col.snapshot(*id);
+    assert(c.iface == r.iface);
+    assert(c.status == r.status);
+    assert(near(c.score_raw, r.score_raw));
+    assert(near(c.score_smoothed, r.score_smoothed));
+    assert(near(c.score_used, r.score_used));
+    assert(near(c.confidence, r.confidence));
+    assert(near(c.missing_rate, r.missing_rate));
+    assert(near(c.avg_tp_mbps, r.avg_tp_mbps));
+    assert(near(c.avg_rtt_ms, r.avg_rtt_ms));
+    assert(near(c.avg_loss_pct, r.avg_loss_pct));
+    assert(near(c.avg_jitter_ms, r.avg_jitter_ms));
+  }
+}
+
+// Transition order across interfaces differs (hash order vs handle order),
+// so compare per-interface sequences.
+using TransitionLog = std::map<InterfaceId, std::vector<TransitionEvent>>;
+
+static void append(TransitionLog& log, const std::vector<TransitionEvent>& evs) {
+  for (const auto& e : evs) log[e.id].push_back(e);
+}
+
+static void assert_same(const TransitionLog& a, const TransitionLog& b) {
+  assert(a.size() == b.size());
+  for (const auto& [id, evs] : a) {
+    const auto& other = b.at(id);
+    assert(evs.size() == other.size());
+    for (std::size_t i = 0; i < evs.size(); ++i) {
+      assert(evs[i].ts == other[i].ts);
+      assert(evs[i].from == other[i].from);
+      assert(evs[i].to == other[i].to);
+      assert(evs[i].reason == other[i].reason);
+    }
+  }
+}
+
+static int run_scenario(ScenarioId sid, const AgentConfig& cfg, ImperfectDataConfig imp) {
+  const std::vector<std::string> ifaces = {"eth0","wifi0","lte0","sat0"};
+  TelemetryAgent ref(cfg);
+  ColumnarTelemetryAgent col(cfg);
+  for (auto& i : ifaces) {
+    ref.ensure_interface(i);
+    col.register_interface(i);
+  }
+  ScenarioGenerator gen(sid, imp);
+  TransitionLog ref_log, col_log;
+
+  for (int64_t t = 0; t < 200; ++t) {
+    ref.note_time(t);
+    col.note_time(t);
+    for (const auto& iface : ifaces) {
+      auto g = gen.sample(iface, t);
+      if (!g) continue;
+      ref.ingest(iface, g->ts, g->m);
+      col.ingest(iface, g->ts, g->m);
+    }
+    append(ref_log, ref.drain_transitions());
+    append(col_log, col.drain_transitions());
+    ref.record_tick();
+    col.record_tick();
+    assert_same(ref, col);
+  }
+  assert_same(ref_log, col_log);
+
+  const auto rr = ref.summary_ranked();
+  const auto cr = col.summary_ranked();
+  assert(rr.size() == cr.size());
+  for (std::size_t i = 0; i < rr.size(); ++i) {
+    assert(near(rr[i].avg_score, cr[i].avg_score));
+    assert(rr[i].last_status == cr[i].last_status);
+  }
+
+  int n = 0;
+  for (const auto& [id, evs] : ref_log) n += static_cast<int>(evs.size());
+  return n;
+}
+
+static void run_random(const AgentConfig& cfg, uint32_t seed) {
+  constexpr int kIfaces = 64;
+  TelemetryAgent ref(cfg);
+  ColumnarTelemetryAgent col(cfg, kIfaces);
+  std::vector<std::string> names;
+  for (int i = 0; i < kIfaces; ++i) names.push_back("if" + std::to_string(i));
+
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> pick(0, kIfaces - 1);
+  std::uniform_int_distribution<int> pct(0, 99);
+  std::uniform_real_distribution<double> level(0.0, 1.0);
+  TransitionLog ref_log, col_log;
+
+  for (int64_t t = 0; t < 400; ++t) {
+    if (pct(rng) < 5) t += 30 + pct(rng); // occasional clock jump
+    ref.note_time(t);
+    col.note_time(t);
+    for (int k = 0; k < kIfaces; ++k) {
+      const auto& iface = names[pick(rng)];
+      const double q = level(rng);
+      const Metrics m{10 + 700 * q, 200 * (1 - q), 25 * q, 150 * q};
+      const int64_t ts = (pct(rng) < 10) ? t - pct(rng) % 60 : t;
+      ref.ingest(iface, ts, m);
+      col.ingest(iface, ts, m);
+    }
+    append(ref_log, ref.drain_transitions());
+    append(col_log, col.drain_transitions());
+    assert_same(ref, col);
+  }
+  assert_same(ref_log, col_log);
+}
+
+int main() {
+  int total = 0;
+  for (ScenarioId sid : {ScenarioId::A, ScenarioId::B, ScenarioId::C, ScenarioId::D}) {
+    for (bool useEwma : {false, true}) {
+      total += run_scenario(sid, cfg_for(useEwma), {});
+
+      ImperfectDataConfig imp;
+      imp.enable_missing = true;
+      imp.enable_late = true;
+      imp.drop_every_n = 4;
+      imp.late_every_n = 3;
+      total += run_scenario(sid, cfg_for(useEwma), imp);
+    }
+  }
+  assert(total > 0);
+
+  // Exercise the less common rules: penalty, force-down, no dwell.
+  AgentConfig odd = cfg_for(true);
+  odd.score.enable_downtrend_penalty = true;
+  odd.score.downtrend_penalty = 0.03;
+  odd.fsm.force_down_if_confidence_below = 0.2;
+  odd.fsm.min_dwell_sec = 0;
+  odd.fsm.healthy_enter_N = 2;
+  odd.fsm.healthy_exit_N = 2;
+  for (uint32_t seed : {1u, 2u, 3u}) {
+    run_random(odd, seed);
+    run_random(cfg_for(false), seed);
+  }
+
+  std::printf("test_columnar_agent OK (transitions=%d)\n", total);
+  return 0;
+}
@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "compact_agent.hpp"
+#include "scenarios.hpp"
+#include "telemetry_agent.hpp"
+
+using namespace telemetry;
+
+// Window values are floats (24-bit mantissa); averages, scores and the
+// EWMA built on them stay this close to the double-precision tracker.
+constexpr double kScoreTol = 1e-6;
+constexpr double kMetricRelTol = 1e-6;
+
+static double max_score_diff = 0.0;
+
+static AgentConfig cfg_for(bool useEwma) {
+  AgentConfig cfg;
+  cfg.score.useEwma = useEwma;
+  cfg.fsm.healthy_enter = 0.72;
+  cfg.fsm.healthy_exit = 0.66;
+  cfg.fsm.down_enter = 0.35;
+  cfg.fsm.down_exit = 0.45;
+  cfg.fsm.min_dwell_sec = 5;
+  return cfg;
+}
+
+[[maybe_unused]] static bool near_rel(double a, double b) {
+  return std::abs(a - b) <= kMetricRelTol * std::max(1.0, std::abs(b));
+}
+
+[[maybe_unused]] static bool near_score(double a, double b) {
+  max_score_diff = std::max(max_score_diff, std::abs(a - b));
+  return std::abs(a - b) <= kScoreTol;
+}
+
+// Returns the number of interfaces whose status differs.
+static int compare(const TelemetryAgent& ref, const CompactTelemetryAgent& cmp) {
+  assert(ref.size() == cmp.size());
+  int status_diffs = 0;
+  for (InterfaceId id = 0; id < ref.size(); ++id) {
+    const InterfaceSnapshot& r = ref.snapshot(id);
+    const InterfaceSnapshot c = cmp.snapshot(id);
+    assert(c.iface == r.iface);
+    assert(near_score(c.score_raw, r.score_raw));
+    assert(near_score(c.score_smoothed, r.score_smoothed));
+    assert(near_score(c.score_used, r.score_used));
+    assert(c.confidence == r.confidence && c.missing_rate == r.missing_rate);
+    assert(near_rel(c.avg_tp_mbps, r.avg_tp_mbps));
+    assert(near_rel(c.avg_rtt_ms, r.avg_rtt_ms));
+    assert(near_rel(c.avg_loss_pct, r.avg_loss_pct));
+    assert(near_rel(c.avg_jitter_ms, r.avg_jitter_ms));
+    status_diffs += c.status != r.status;
+  }
+  return status_diffs;
+}
+
+using TransitionLog = std::map<InterfaceId, std::vector<TransitionEvent>>;
+
+static void append(TransitionLog& log, const std::vector<TransitionEvent>& evs) {
+  for (const auto& e : evs) log[e.id].push_back(e);
+}
+
+static void assert_same(const TransitionLog& a, const TransitionLog& b) {
+  assert(a.size() == b.size());
+  for (const auto& [id, evs] : a) {
+    const auto& other = b.at(id);
+    assert(evs.size() == other.size());
+    for (std::size_t i = 0; i < evs.size(); ++i) {
+      assert(evs[i].ts == other[i].ts && evs[i].from == other[i].from && evs[i].to == other[i].to);
+      assert(evs[i].reason == other[i].reason);
+    }
+  }
+}
+
+// The window against BasicRollingWindow on an out-of-order stream with
+// overwrites, merges, late samples, negative timestamps and clock jumps.
+static void check_window(uint32_t seed) {
+  using Ref = BasicRollingWindow<45, DefaultMetrics>;
+  using Cmp = CompactRollingWindow<45, DefaultMetrics>;
+  Ref ref;
+  Cmp cmp;
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> pct(0, 99);
+  std::uniform_real_distribution<double> val(0.0, 500.0);
+
+  int64_t t = -100;
+  for (int step = 0; step < 5000; ++step) {
+    if (pct(rng) < 3) t += 20 + pct(rng); // jump, sometimes past the window
+    else if (pct(rng) < 60) ++t;
+    if (pct(rng) < 10) {
+      ref.note_time(t);
+      cmp.note_time(t);
+    }
+    const int64_t ts = t - (pct(rng) < 20 ? pct(rng) % 50 : 0);
+    const DefaultMetrics::Values v{val(rng), val(rng), val(rng) / 20.0, val(rng) / 3.0};
+    const bool merge = pct(rng) < 30;
+    const auto rr = merge ? ref.merge(ts, v) : ref.insert(ts, v);
+    const auto cr = merge ? cmp.merge(ts, v) : cmp.insert(ts, v);
+    assert(rr == cr);
+
+    const auto rs = ref.summary();
+    const auto cs = cmp.summary();
+    assert(rs.newest_ts == cs.newest_ts && rs.oldest_ts == cs.oldest_ts && rs.count == cs.count);
+    assert(rs.confidence == cs.confidence);
+    for (std::size_t k = 0; k < DefaultMetrics::size; ++k) assert(near_rel(cs.avg[k], rs.avg[k]));
+    assert(ref.oldest_sample_ts() == cmp.oldest_sample_ts());
+    for (int64_t q = t - 50; q <= t + 1; ++q) {
+      assert(ref.has_sample(q) == cmp.has_sample(q));
+      assert(ref.samples_at(q) == cmp.samples_at(q));
+    }
+  }
+}
+
+static int run_scenario(ScenarioId sid, const AgentConfig& cfg, ImperfectDataConfig imp) {
+  const std::vector<std::string> ifaces = {"eth0", "wifi0", "lte0", "sat0"};
+  TelemetryAgent ref(cfg);
+  CompactTelemetryAgent cmp(cfg);
+  for (const auto& i : ifaces) {
+    ref.register_interface(i);
+    cmp.register_interface(i);
+  }
+  ScenarioGenerator gen(sid, imp);
+  TransitionLog ref_log, cmp_log;
+
+  for (int64_t t = 0; t < 300; ++t) {
+    ref.note_time(t);
+    cmp.note_time(t);
+    for (const auto& iface : ifaces) {
+      const auto g = gen.sample(iface, t);
+      if (!g) continue;
+      ref.ingest(iface, g->ts, g->m);
+      cmp.ingest(iface, g->ts, g->m);
+    }
+    append(ref_log, ref.drain_transitions());
+    append(cmp_log, cmp.drain_transitions());
+    ref.record_tick();
+    cmp.record_tick();
+    assert(compare(ref, cmp) == 0);
+  }
+  assert_same(ref_log, cmp_log);
+
+  const auto rr = ref.summary_ranked();
+  const auto cr = cmp.summary_ranked();
+  assert(rr.size() == cr.size());
+  for (std::size_t i = 0; i < rr.size(); ++i) {
+    assert(rr[i].iface == cr[i].iface && rr[i].last_status == cr[i].last_status);
+    assert(near_score(rr[i].avg_score, cr[i].avg_score));
+  }
+
+  int n = 0;
+  for (const auto& [id, evs] : ref_log) n += static_cast<int>(evs.size());
+  return n;
+}
+
+// Random levels hover around the thresholds, so a score may land within
+// float rounding of one and flip a status: scores must stay in tolerance,
+// statuses may differ only rarely.
+static void run_random(const AgentConfig& cfg, uint32_t seed) {
+  constexpr int kIfaces = 64;
+  TelemetryAgent ref(cfg);
+  CompactTelemetryAgent cmp(cfg, kIfaces);
+  for (int i = 0; i < kIfaces; ++i) {
+    ref.register_interface("if" + std::to_string(i));
+    cmp.register_interface("if" + std::to_string(i));
+  }
+
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> pick(0, kIfaces - 1);
+  std::uniform_int_distribution<int> pct(0, 99);
+  std::uniform_real_distribution<double> level(0.0, 1.0);
+  long checks = 0, status_diffs = 0;
+
+  for (int64_t t = 0; t < 400; ++t) {
+    if (pct(rng) < 5) t += 30 + pct(rng);
+    ref.note_time(t);
+    cmp.note_time(t);
+    for (int k = 0; k < kIfaces; ++k) {
+      const auto id = static_cast<InterfaceId>(pick(rng));
+      const double q = level(rng);
+      const Metrics m{10 + 700 * q, 200 * (1 - q), 25 * q, 150 * q};
+      const int64_t ts = (pct(rng) < 10) ? t - pct(rng) % 60 : t;
+      ref.ingest(id, ts, m);
+      cmp.ingest(id, ts, m);
+    }
+    status_diffs += compare(ref, cmp);
+    checks += kIfaces;
+  }
+  assert(status_diffs * 100 <= checks);
+}
+
+int main() {
+  // Roughly a quarter of InterfaceTracker, under 1 KB.
+  static_assert(sizeof(CompactInterfaceTracker) <= 1024);
+  static_assert(sizeof(CompactInterfaceTracker) * 3 < sizeof(InterfaceTracker));
+
+  for (uint32_t seed : {1u, 2u, 3u}) check_window(seed);
+
+  int total = 0;
+  for (ScenarioId sid : {ScenarioId::A, ScenarioId::B, ScenarioId::C, ScenarioId::D}) {
+    for (bool useEwma : {false, true}) {
+      AgentConfig cfg = cfg_for(useEwma);
+      total += run_scenario(sid, cfg, {});
+
+      ImperfectDataConfig imp;
+      imp.enable_missing = true;
+      imp.enable_late = true;
+      imp.drop_every_n = 4;
+      imp.late_every_n = 3;
+      total += run_scenario(sid, cfg, imp);
+
+      cfg.recompute = RecomputeMode::PerTick;
+      cfg.same_second = SameSecond::Average;
+      total += run_scenario(sid, cfg, imp);
+    }
+  }
+  assert(total > 0);
+
+  AgentConfig odd = cfg_for(true);
+  odd.score.enable_downtrend_penalty = true;
+  odd.fsm.force_down_if_confidence_below = 0.2;
+  odd.fsm.min_dwell_sec = 0;
+  for (uint32_t seed : {1u, 2u, 3u}) {
+    run_random(odd, seed);
+    run_random(cfg_for(false), seed);
+  }
+
+  // Names are interned once; handles and lookups survive moving the agent
+  // (trackers point at a heap-held config).
+  {
+    CompactTelemetryAgent a;
+    const InterfaceId id = a.register_interface("tun0");
+    const InterfaceId again = a.register_interface("tun0");
+    assert(again == id && a.name(id) == "tun0");
+    for (int64_t t = 0; t < 20; ++t) a.ingest(id, t, Metrics{20.0, 150.0, 0.0, 2.0});
+    CompactTelemetryAgent b = std::move(a);
+    b.ingest("tun1", 20, Metrics{20.0, 150.0, 0.0, 2.0});
+    b.note_time(21);
+    assert(b.find_interface("tun0") == id && b.find_interface("tun1") == InterfaceId{1});
+    assert(!b.find_interface("tun2"));
+    assert(b.snapshot(id).iface == "tun0" && b.confidence(id) == 20.0 / RollingWindow::kWindow);
+    assert(b.config().fsm.healthy_enter == AgentConfig{}.fsm.healthy_enter);
+  }
+
+  bool threw = false;
+  try {
+    AgentConfig q;
+    q.score.rtt_stat = WindowStat::P95;
+    CompactTelemetryAgent bad(q);
+  } catch (const std::invalid_argument&) {
+    threw = true;
+  }
+  assert(threw);
+
+  std::printf("test_compact_agent OK (transitions=%d max_score_diff=%.2e tracker=%zuB vs %zuB)\n", total,
+              max_score_diff, sizeof(CompactInterfaceTracker), sizeof(InterfaceTracker));
+  return 0;
+}
@@ -0,0 +1,242 @@
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "checkpoint.hpp"
+#include "columnar_agent.hpp"
+#include "config_profile.hpp"
+#include "fleet_generator.hpp"
+#include "telemetry_agent.hpp"
+
+using namespace telemetry;
+
+// A descriptor's own range reproduces the compile-time normaliser exactly.
+static_assert(normalize<ThroughputMetric>(123.0, range_of<ThroughputMetric>()) == normalize<ThroughputMetric>(123.0));
+static_assert(normalize<RttMetric>(333.0, range_of<RttMetric>()) == normalize<RttMetric>(333.0));
+static_assert(normalize<LossMetric>(-1.0, range_of<LossMetric>()) == normalize<LossMetric>(-1.0));
+static_assert(normalize<JitterMetric>(7.5, range_of<JitterMetric>()) == normalize<JitterMetric>(7.5));
+
+[[maybe_unused]] static bool near(double a, double b) { return std::abs(a - b) <= 1e-12; }
+
+[[maybe_unused]] static bool same(const InterfaceSnapshot& a, const InterfaceSnapshot& b) {
+  return a.status == b.status && a.score_raw == b.score_raw && a.score_smoothed == b.score_smoothed &&
+         a.score_used == b.score_used && a.confidence == b.confidence && a.avg_rtt_ms == b.avg_rtt_ms;
+}
+
+static bool throws_invalid(const auto& fn) {
+  try {
+    fn();
+  } catch (const std::invalid_argument&) {
+    return true;
+  }
+  return false;
+}
+
+// A healthy geostationary link: fine for a satellite, terrible for Ethernet.
+static Metrics sat_sample(int64_t t) {
+  return Metrics{620.0 + (t % 7), 20.0, 0.5, 25.0 + (t % 3)};
+}
+
+static AgentConfig with(const ConfigProfile& p) {
+  AgentConfig cfg;
+  cfg.score = p.score;
+  cfg.fsm = p.fsm;
+  return cfg;
+}
+
+int main() {
+  // ProfileTable: interning, validation, membership.
+  {
+    ProfileTable t(wired_profile());
+    assert(t.size() == 1 && t.name(kDefaultProfile) == "default");
+    const ProfileId sat = t.add("sat", satellite_profile());
+    const ProfileId again = t.add("sat", satellite_profile());
+    assert(again == sat && t.size() == 2 && *t.find("sat") == sat);
+    assert(!t.find("lte"));
+    assert(throws_invalid([&] { (void)t.add("sat", cellular_profile()); }));
+    ConfigProfile bad;
+    bad.score.ranges.rtt = {800.0, 10.0};
+    assert(throws_invalid([&] { (void)t.add("bad", bad); }));
+    assert(throws_invalid([&] { t.replace(sat, bad); }));
+    check_profile(cellular_profile());
+
+    for (InterfaceId id = 0; id < 6; ++id) t.add_member(id);
+    const ProfileId was4 = t.assign(4, sat);
+    const ProfileId was1 = t.assign(1, sat);
+    assert(was4 == kDefaultProfile && was1 == kDefaultProfile);
+    assert(t.of(4) == sat && t.of(0) == kDefaultProfile);
+    assert((std::vector<InterfaceId>(t.members(sat).begin(), t.members(sat).end()) == std::vector<InterfaceId>{1, 4}));
+    assert(t.members(kDefaultProfile).size() == 4);
+
+    const ConfigProfile* slot = &t.get(sat);
+    ConfigProfile swapped = satellite_profile();
+    swapped.fsm.min_dwell_sec = 30;
+    t.replace(sat, swapped);
+    assert(&t.get(sat) == slot && slot->fsm.min_dwell_sec == 30);
+  }
+
+  // An agent interface on a profile behaves as a standalone tracker built
+  // from that profile; the same link on the default profile is scored down.
+  {
+    TelemetryAgent agent;
+    const InterfaceId eth = agent.register_interface("eth0");
+    const InterfaceId sat = agent.register_interface("sat0");
+    const ProfileId sp = agent.add_profile("sat", satellite_profile());
+    agent.assign_profile(sat, sp);
+    assert(agent.profile_of(sat) == sp && agent.profile_of(eth) == kDefaultProfile);
+    assert(&agent.tracker(sat).profile() == &agent.profiles().get(sp));
+
+    InterfaceTracker ref("sat0", with(satellite_profile()), sat);
+    for (int64_t t = 0; t < 120; ++t) {
+      agent.ingest(eth, t, sat_sample(t));
+      agent.ingest(sat, t, sat_sample(t));
+      (void)ref.ingest(t, sat_sample(t));
+      agent.note_time(t);
+      (void)ref.note_time(t);
+      assert(same(agent.snapshot(sat), ref.snapshot()));
+    }
+    assert(agent.snapshot(sat).status == IfStatus::Healthy);
+    assert(agent.snapshot(eth).status != IfStatus::Healthy);
+    assert(agent.snapshot(sat).score_used > agent.snapshot(eth).score_used + 0.2);
+  }
+
+  // Hot swap: set_profile() reaches every member at its next evaluation,
+  // keeping EWMA and FSM state, the same whether the agent scans every
+  // tracker or only active ones; a swap to quantile scoring seeds the
+  // quantiles from the current window.
+  {
+    FleetConfig fc;
+    fc.interfaces = 200;
+    fc.missing_rate = 0.05;
+    const FleetGenerator fleet(fc);
+    AgentConfig active_cfg;
+    active_cfg.tick_scan = TickScan::Active;
+    TelemetryAgent all, active(active_cfg);
+    InterfaceTracker ref("if3", AgentConfig{}, 3);
+    ProfileId lte = 0;
+    for (TelemetryAgent* a : {&all, &active}) {
+      for (std::size_t i = 0; i < fleet.size(); ++i) a->register_interface("if" + std::to_string(i));
+      lte = a->add_profile("lte", cellular_profile());
+      for (InterfaceId id = 0; id < a->size(); id += 3) a->assign_profile(id, lte);
+    }
+    ref.set_profile(&all.profiles().get(lte));
+
+    ConfigProfile tail = cellular_profile();
+    tail.score.rtt_stat = WindowStat::P95;
+    tail.fsm.min_dwell_sec = 2;
+    std::vector<Sample> s(fleet.size());
+    std::size_t transitions = 0;
+    for (int64_t t = 0; t < 240; ++t) {
+      if (t == 120) {
+        all.set_profile(lte, tail);
+        active.set_profile(lte, tail);
+        assert(all.tracker(3).window().quantiles_enabled() && !all.tracker(1).window().quantiles_enabled());
+        ref.set_profile(&all.profiles().get(lte));
+        assert(ref.window().summary().p95_rtt_ms == all.tracker(3).window().summary().p95_rtt_ms);
+      }
+      const std::size_t n = fleet.tick(t, s);
+      all.ingest_batch(std::span<const Sample>(s.data(), n));
+      active.ingest_batch(std::span<const Sample>(s.data(), n));
+      for (std::size_t i = 0; i < n; ++i) {
+        if (s[i].id == 3) (void)ref.ingest(s[i].ts, s[i].m);
+      }
+      all.note_time(t);
+      active.note_time(t);
+      (void)ref.note_time(t);
+      for (InterfaceId id = 0; id < all.size(); ++id) assert(same(all.snapshot(id), active.snapshot(id)));
+      assert(same(all.snapshot(3), ref.snapshot()));
+      const auto ea = all.drain_transitions();
+      const auto eb = active.drain_transitions();
+      assert(ea.size() == eb.size());
+      transitions += ea.size();
+    }
+    assert(transitions > 0);
+    assert(all.config().fsm.min_dwell_sec == AgentConfig{}.fsm.min_dwell_sec);
+    all.set_profile(kDefaultProfile, tail);
+    assert(all.config().fsm.min_dwell_sec == 2 && all.tracker(1).window().quantiles_enabled());
+
+    // A quantile-scored profile's window after a swap equals one that
+    // tracked quantiles all along.
+    InterfaceTracker fresh("if3", with(tail), 3);
+    for (int64_t t = 0; t < 240; ++t) {
+      const std::size_t n = fleet.tick(t, s);
+      for (std::size_t i = 0; i < n; ++i) {
+        if (s[i].id == 3) (void)fresh.ingest(s[i].ts, s[i].m);
+      }
+      (void)fresh.note_time(t);
+    }
+    const auto a = fresh.window().summary(), b = all.tracker(3).window().summary();
+    assert(a.p50_rtt_ms == b.p50_rtt_ms && a.p95_rtt_ms == b.p95_rtt_ms && a.max_loss_pct == b.max_loss_pct);
+  }
+
+  // Columnar agent: per-run batch scoring with each profile's constants
+  // matches TelemetryAgent, with profiles interleaved so runs are short.
+  {
+    FleetConfig fc;
+    fc.interfaces = 64;
+    const FleetGenerator fleet(fc);
+    TelemetryAgent ref;
+    ColumnarTelemetryAgent col;
+    const ProfileId r_lte = ref.add_profile("lte", cellular_profile());
+    const ProfileId r_sat = ref.add_profile("sat", satellite_profile());
+    const ProfileId c_lte = col.add_profile("lte", cellular_profile());
+    const ProfileId c_sat = col.add_profile("sat", satellite_profile());
+    for (std::size_t i = 0; i < fleet.size(); ++i) {
+      const std::string name = "if" + std::to_string(i);
+      const InterfaceId a = ref.register_interface(name);
+      const InterfaceId b = col.register_interface(name);
+      if (i % 5 == 1 || i % 5 == 2) {
+        ref.assign_profile(a, r_lte);
+        col.assign_profile(b, c_lte);
+      } else if (i % 5 == 3) {
+        ref.assign_profile(a, r_sat);
+        col.assign_profile(b, c_sat);
+      }
+    }
+    ConfigProfile quantiles = cellular_profile();
+    quantiles.score.loss_use_max = true;
+    assert(throws_invalid([&] { (void)col.add_profile("tail", quantiles); }));
+    assert(throws_invalid([&] { col.set_profile(c_lte, quantiles); }));
+
+    std::vector<Sample> s(fleet.size());
+    for (int64_t t = 0; t < 200; ++t) {
+      if (t == 100) {
+        ConfigProfile sat2 = satellite_profile();
+        sat2.score.ranges.rtt = {300.0, 1200.0};
+        ref.set_profile(r_sat, sat2);
+        col.set_profile(c_sat, sat2);
+      }
+      const std::size_t n = fleet.tick(t, s);
+      for (std::size_t i = 0; i < n; ++i) {
+        ref.ingest(s[i].id, s[i].ts, s[i].m);
+        col.ingest(s[i].id, s[i].ts, s[i].m);
+      }
+      ref.note_time(t);
+      col.note_time(t);
+      for (InterfaceId id = 0; id < ref.size(); ++id) {
+        assert(ref.snapshot(id).status == col.status(id));
+        assert(near(ref.snapshot(id).score_used, col.score_used(id)));
+      }
+    }
+  }
+
+  // Checkpoints refuse an agent with other profiles.
+  {
+    TelemetryAgent a, b;
+    assert(config_hash(a) == config_hash(a.config()));
+    (void)a.add_profile("sat", satellite_profile());
+    assert(config_hash(a) != config_hash(b));
+    (void)b.add_profile("sat", satellite_profile());
+    assert(config_hash(a) == config_hash(b));
+    ConfigProfile wide;
+    wide.score.ranges.rtt = {10.0, 900.0};
+    b.set_profile(kDefaultProfile, wide);
+    assert(config_hash(a) != config_hash(b));
+  }
+
+  std::printf("test_config_profiles OK (sizeof(InterfaceTracker)=%zu)\n", sizeof(InterfaceTracker));
+  return 0;
+}
@@ -0,0 +1,98 @@
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "config_sweep.hpp"
+
+using namespace telemetry;
+
+[[maybe_unused]] static bool same(const SweepResult& a, const SweepResult& b) {
+  return a.transitions == b.transitions && a.flaps == b.flaps && a.flaps_per_iface_hour == b.flaps_per_iface_hour &&
+         a.detected == b.detected && a.missed == b.missed && a.mean_ttd_sec == b.mean_ttd_sec &&
+         a.max_ttd_sec == b.max_ttd_sec && a.status_seconds[0] == b.status_seconds[0] &&
+         a.status_seconds[1] == b.status_seconds[1] && a.status_seconds[2] == b.status_seconds[2];
+}
+
+int main() {
+  ImperfectDataConfig imp;
+  imp.enable_missing = true;
+  imp.enable_late = true;
+  const SweepTrace trace = SweepTrace::scenario(ScenarioId::A, 600, imp);
+  assert(trace.interfaces() == 4 && trace.names()[1] == "wifi0");
+
+  // Grid expansion: a full product minus points without hysteresis.
+  {
+    FsmGrid g;
+    g.healthy_enter = {0.70, 0.80};
+    g.healthy_exit = {0.65, 0.75};
+    g.down_enter_N = {1, 2, 3};
+    const auto configs = expand(AgentConfig{}, g);
+    assert(configs.size() == 3 * 3); // (0.70, 0.75) is dropped
+    for (const auto& c : configs) assert(c.fsm.healthy_exit <= c.fsm.healthy_enter);
+    assert(expand(AgentConfig{}, FsmGrid{}).size() == 1);
+  }
+
+  // The reference config detects its own incidents instantly; the sweep's
+  // accounting covers every interface-second.
+  const AgentConfig ref = sharp_reference(AgentConfig{});
+  const std::vector<SweepIncident> incidents = reference_incidents(trace, ref);
+  assert(!incidents.empty());
+  SweepOptions opt;
+  opt.incidents = incidents;
+  {
+    const SweepResult r = evaluate(trace, ref, opt);
+    assert(r.detected == incidents.size() && r.missed == 0 && r.mean_ttd_sec == 0.0);
+    assert(r.status_seconds[0] + r.status_seconds[1] + r.status_seconds[2] == 4 * 600);
+
+    // Smoothing and evidence counts trade detection delay for fewer flaps.
+    const SweepResult d = evaluate(trace, AgentConfig{}, opt);
+    assert(d.flaps <= r.flaps && d.transitions <= r.transitions);
+    assert(d.detected == 0 || d.mean_ttd_sec >= 0.0);
+  }
+
+  // The pool gives exactly the sequential answer, with any thread count.
+  {
+    FsmGrid g;
+    g.healthy_enter_N = {1, 3, 6};
+    g.down_enter_N = {1, 3};
+    g.min_dwell_sec = {0, 5, 10};
+    const auto configs = expand(AgentConfig{}, g);
+    std::vector<SweepResult> serial;
+    for (const auto& c : configs) serial.push_back(evaluate(trace, c, opt));
+    for (unsigned threads : {1u, 2u, 5u, 64u}) {
+      opt.threads = threads;
+      const auto par = run_sweep(trace, configs, opt);
+      assert(par.size() == configs.size());
+      for (std::size_t i = 0; i < configs.size(); ++i) assert(same(par[i], serial[i]));
+    }
+    assert(run_sweep(trace, {}, opt).empty());
+  }
+
+  // A trace with a corrupt interface id is refused before anything is
+  // registered for it.
+  {
+    const std::string path = (std::filesystem::temp_directory_path() / "test_config_sweep.trace").string();
+    {
+      TraceWriter w(path);
+      w.name(0, "eth0");
+      w.tick(0);
+      w.sample(0xFFFFFFF0u, 0, Metrics{20.0, 100.0, 0.0, 1.0});
+      w.close();
+    }
+    bool rejected = false;
+    try {
+      const TraceReader reader(path);
+      (void)evaluate(SweepTrace::view(reader), AgentConfig{}, opt);
+    } catch (const std::runtime_error&) {
+      rejected = true;
+    }
+    assert(rejected);
+    std::filesystem::remove(path);
+  }
+
+  std::printf("test_config_sweep OK\n");
+  return 0;
+}
@@ -0,0 +1,124 @@
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "fleet_generator.hpp"
+#include "telemetry_agent.hpp"
+
+using namespace telemetry;
+
+static bool same(const Sample& a, const Sample& b) {
+  return a.id == b.id && a.ts == b.ts && a.m.rtt_ms == b.m.rtt_ms && a.m.throughput_mbps == b.m.throughput_mbps &&
+         a.m.loss_pct == b.m.loss_pct && a.m.jitter_ms == b.m.jitter_ms;
+}
+
+[[maybe_unused]] static bool throws_invalid(FleetConfig cfg) {
+  try {
+    FleetGenerator gen(cfg);
+  } catch (const std::invalid_argument&) {
+    return true;
+  }
+  return false;
+}
+
+int main() {
+  FleetConfig cfg;
+  cfg.interfaces = 2000;
+  cfg.seed = 42;
+  cfg.missing_rate = 0.05;
+  cfg.late_rate = 0.02;
+  const FleetGenerator gen(cfg);
+  assert(gen.size() == 2000);
+  assert(gen.profile(0) == FleetProfile::Stable && gen.profile(5) == FleetProfile::Ramp);
+  assert(std::string(fleet_profile_name(FleetProfile::Noisy)) == "noisy");
+
+  // Deterministic and order-independent: a tick is the same whether it is
+  // generated first, again later, or by another generator with the same seed.
+  std::vector<Sample> a(gen.size()), b(gen.size());
+  const std::size_t n = gen.tick(100, a);
+  for (int64_t t = 0; t < 50; ++t) (void)gen.tick(t, b);
+  const FleetGenerator twin(cfg);
+  const std::size_t twin_n = twin.tick(100, b);
+  assert(twin_n == n);
+  for (std::size_t i = 0; i < n; ++i) assert(same(a[i], b[i]));
+
+  // Another seed gives another fleet.
+  FleetConfig other = cfg;
+  other.seed = 43;
+  const std::size_t n_other = FleetGenerator(other).tick(100, b);
+  bool differs = n_other != n;
+  for (std::size_t i = 0; !differs && i < n; ++i) differs = !same(a[i], b[i]);
+  assert(differs);
+
+  // Rates, ordering and sanity over many ticks.
+  std::size_t produced = 0, late = 0;
+  for (int64_t t = 0; t < 200; ++t) {
+    const std::size_t k = gen.tick(t, a);
+    produced += k;
+    for (std::size_t i = 0; i < k; ++i) {
+      assert(i == 0 || a[i - 1].id < a[i].id);
+      assert(a[i].ts == t || a[i].ts == t - cfg.late_by_sec);
+      late += a[i].ts != t;
+      const Metrics& m = a[i].m;
+      assert(m.rtt_ms >= 0 && m.throughput_mbps >= 0 && m.loss_pct >= 0 && m.jitter_ms >= 0);
+      assert(std::isfinite(m.rtt_ms + m.throughput_mbps + m.loss_pct + m.jitter_ms));
+    }
+  }
+  const double total = 200.0 * cfg.interfaces;
+  const double missing = 1.0 - produced / total;
+  const double late_rate = late / static_cast<double>(produced);
+  assert(missing > 0.04 && missing < 0.06);
+  assert(late_rate > 0.015 && late_rate < 0.025);
+
+  // Profiles show up in the agent: stable links end Healthy, spiking and
+  // noisy ones do not all stay there, and ramps pass through Down.
+  {
+    FleetConfig fc;
+    fc.interfaces = 400;
+    const FleetGenerator fleet(fc);
+    TelemetryAgent agent;
+    for (std::size_t i = 0; i < fleet.size(); ++i) agent.register_interface("if" + std::to_string(i));
+    std::vector<Sample> s(fleet.size());
+    std::vector<int> down(4, 0), healthy(4, 0);
+    for (int64_t t = 0; t < 300; ++t) {
+      agent.ingest_batch(std::span<const Sample>(s.data(), fleet.tick(t, s)));
+      agent.note_time(t);
+      if (t < 60) continue;
+      for (InterfaceId id = 0; id < agent.size(); ++id) {
+        const auto p = static_cast<int>(fleet.profile(id));
+        down[p] += agent.snapshot(id).status == IfStatus::Down;
+        healthy[p] += agent.snapshot(id).status == IfStatus::Healthy;
+      }
+    }
+    assert(down[static_cast<int>(FleetProfile::Stable)] == 0);
+    assert(healthy[static_cast<int>(FleetProfile::Stable)] > 0);
+    assert(down[static_cast<int>(FleetProfile::Ramp)] > 0);
+  }
+
+  // Misuse.
+  FleetConfig bad = cfg;
+  bad.missing_rate = 1.5;
+  assert(throws_invalid(bad));
+  bad = cfg;
+  bad.spike_period_sec = 0;
+  assert(throws_invalid(bad));
+  bool threw = false;
+  try {
+    std::vector<Sample> small(10);
+    (void)gen.tick(0, small);
+  } catch (const std::length_error&) {
+    threw = true;
+  }
+  assert(threw);
+
+  FleetConfig all_missing = cfg;
+  all_missing.missing_rate = 1.0;
+  const std::size_t none = FleetGenerator(all_missing).tick(7, a);
+  assert(none == 0);
+
+  std::printf("test_fleet_generator OK (missing=%.3f late=%.3f)\n", missing, late_rate);
+  return 0;
+}
@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "fleet_generator.hpp"
+#include "fleet_summary.hpp"
+#include "telemetry_agent.hpp"
+
+using namespace telemetry;
+
+static bool near(double a, double b, double rel = 1e-9) { return std::abs(a - b) <= rel * std::max(1.0, std::abs(b)); }
+
+static bool same_buckets(const ValueSketch& a, const ValueSketch& b) {
+  std::vector<std::pair<std::size_t, uint32_t>> x, y;
+  a.for_each_bucket([&x](std::size_t i, uint32_t c) { x.emplace_back(i, c); });
+  b.for_each_bucket([&y](std::size_t i, uint32_t c) { y.emplace_back(i, c); });
+  return x == y && a.count() == b.count() && a.min() == b.min() && a.max() == b.max();
+}
+
+[[maybe_unused]] static bool same(const WindowDigest& a, const WindowDigest& b, double rel) {
+  return a.interfaces == b.interfaces && a.seconds == b.seconds && a.newest_ts == b.newest_ts &&
+         a.status_counts == b.status_counts && near(a.rtt_sum, b.rtt_sum, rel) &&
+         near(a.throughput_sum, b.throughput_sum, rel) && near(a.loss_sum, b.loss_sum, rel) &&
+         near(a.jitter_sum, b.jitter_sum, rel) && a.max_loss_pct == b.max_loss_pct &&
+         near(a.score_used_sum, b.score_used_sum, rel) && same_buckets(a.rtt_ms, b.rtt_ms) &&
+         same_buckets(a.jitter_ms, b.jitter_ms);
+}
+
+// Feeds every interface of fleet for ticks [from, to).
+static void run(TelemetryAgent& agent, const FleetGenerator& fleet, int64_t from, int64_t to) {
+  std::vector<Sample> s(fleet.size());
+  for (int64_t t = from; t < to; ++t) {
+    agent.ingest_batch(std::span<const Sample>(s.data(), fleet.tick(t, s)));
+    agent.note_time(t);
+  }
+}
+
+int main() {
+  // ValueSketch: quantiles within the bucket resolution, merge == union.
+  {
+    std::mt19937_64 rng(3);
+    std::lognormal_distribution<double> d(4.0, 1.0);
+    ValueSketch all, a, b;
+    std::vector<double> xs;
+    for (int i = 0; i < 20000; ++i) {
+      const double x = d(rng);
+      xs.push_back(x);
+      all.add(x);
+      (i % 3 ? a : b).add(x);
+    }
+    all.add(0.0);
+    a.add(0.0);
+    xs.push_back(0.0);
+    std::sort(xs.begin(), xs.end());
+    for (const double q : {0.01, 0.5, 0.9, 0.95, 0.99, 1.0}) {
+      const double exact = xs[static_cast<std::size_t>(std::ceil(q * xs.size())) - 1];
+      assert(std::abs(all.quantile(q) - exact) <= 0.0625 * exact);
+    }
+    assert(all.min() == 0.0 && all.max() == xs.back() && all.quantile(0.0) == 0.0);
+    ValueSketch ab = a;
+    ab.merge(b);
+    ValueSketch ba = b;
+    ba.merge(a);
+    assert(same_buckets(ab, all) && same_buckets(ba, all));
+
+    ValueSketch empty;
+    assert(empty.quantile(0.5) == 0.0 && empty.count() == 0);
+    empty.add(std::nan(""));
+    empty.add(1e12); // past the top bucket
+    assert(empty.count() == 1 && empty.quantile(0.5) == 1e12);
+  }
+
+  FleetConfig fc;
+  fc.interfaces = 240;
+  fc.missing_rate = 0.1;
+  const FleetGenerator fleet(fc);
+  TelemetryAgent agent;
+  for (std::size_t i = 0; i < fleet.size(); ++i) agent.register_interface("if" + std::to_string(i));
+  run(agent, fleet, 0, 150);
+
+  // A digest of every interface against brute force, and equal to the merge
+  // of digests over any partition.
+  {
+    WindowDigest all, even, odd;
+    double rtt = 0.0;
+    uint64_t seconds = 0;
+    std::array<uint32_t, 3> statuses{};
+    for (InterfaceId id = 0; id < agent.size(); ++id) {
+      all.add(agent.tracker(id));
+      (id % 2 ? odd : even).add(agent.tracker(id));
+      agent.tracker(id).window().storage().for_each_second([&](const RollingWindow::Storage::Second& s) {
+        rtt += s.v[DefaultMetrics::index_of<RttMetric>()];
+        ++seconds;
+      });
+      ++statuses[static_cast<std::size_t>(agent.snapshot(id).status)];
+    }
+    assert(all.interfaces == agent.size() && all.seconds == seconds && all.status_counts == statuses);
+    assert(near(all.avg_rtt_ms(), rtt / seconds));
+    assert(all.confidence() > 0.85 && all.confidence() < 0.95);
+    assert(all.count(IfStatus::Healthy) > 0 && all.count(IfStatus::Down) > 0);
+    assert(all.rtt_ms.quantile(0.5) <= all.rtt_ms.quantile(0.99));
+    WindowDigest merged = odd;
+    merged.merge(even);
+    assert(same(merged, all, 1e-9));
+
+    // Round trip, and refusal of damaged encodings.
+    std::vector<std::byte> bytes;
+    all.encode(bytes);
+    std::span<const std::byte> in(bytes);
+    const auto back = WindowDigest::decode(in);
+    assert(back && in.empty() && same(*back, all, 0.0));
+    for (const std::size_t cut : {std::size_t{0}, std::size_t{10}, bytes.size() - 1}) {
+      std::span<const std::byte> part(bytes.data(), cut);
+      assert(!WindowDigest::decode(part) && part.size() == cut);
+    }
+    auto bad = bytes;
+    bad[0] = std::byte{0xFF}; // interfaces no longer match the status histogram
+    std::span<const std::byte> bad_in(bad);
+    assert(!WindowDigest::decode(bad_in));
+  }
+
+  // Pushes: grouped by uplink, far smaller than the raw window.
+  const auto uplink_of = [](InterfaceId id) -> std::string_view {
+    static const char* names[] = {"mpls", "inet", "lte"};
+    return names[id % 3];
+  };
+  std::vector<std::byte> datagram;
+  {
+    const DigestPush push = make_push(agent, "lon", "r1", 149, uplink_of);
+    assert(push.groups.size() == 3 && push.groups[0].first == "inet" && push.groups[2].first == "mpls");
+    encode_push(push, datagram);
+    const std::size_t raw = agent.size() * RollingWindow::kWindow * sizeof(Sample);
+    assert(datagram.size() * 20 < raw);
+
+    const auto back = decode_push(datagram);
+    assert(back && back->site == "lon" && back->node == "r1" && back->tick_ts == 149);
+    for (std::size_t g = 0; g < 3; ++g) {
+      assert(back->groups[g].first == push.groups[g].first);
+      assert(same(back->groups[g].second, push.groups[g].second, 0.0));
+    }
+    auto trailing = datagram;
+    trailing.push_back(std::byte{0});
+    assert(!decode_push(trailing));
+    assert(!decode_push(std::span<const std::byte>(datagram).first(datagram.size() / 2)));
+
+    const DigestPush per_iface = make_push(agent, "lon", "r1", 149);
+    assert(per_iface.groups.size() == agent.size());
+  }
+
+  // Aggregator: three sites of nodes, each node an agent over part of the
+  // fleet. Rollups equal merging the nodes' digests directly.
+  {
+    FleetAggregator agg;
+    std::vector<TelemetryAgent> nodes(6);
+    WindowDigest want_lon, want_lon_lte;
+    for (std::size_t n = 0; n < nodes.size(); ++n) {
+      FleetConfig nc = fc;
+      nc.interfaces = 30;
+      nc.seed = 100 + n;
+      const FleetGenerator g(nc);
+      for (std::size_t i = 0; i < g.size(); ++i) nodes[n].register_interface("if" + std::to_string(i));
+      run(nodes[n], g, 0, 80);
+      const std::string site = n < 3 ? "lon" : (n < 5 ? "nyc" : "sfo");
+      const DigestPush push = make_push(nodes[n], site, "r" + std::to_string(n), 79, uplink_of);
+      encode_push(push, datagram);
+      const bool first = agg.ingest(datagram);
+      const bool repeat = agg.ingest(datagram); // a repeat replaces, never double counts
+      assert(first && repeat);
+      if (site == "lon") {
+        for (const auto& [name, d] : push.groups) {
+          want_lon.merge(d);
+          if (name == "lte") want_lon_lte.merge(d);
+        }
+      }
+    }
+    assert((agg.sites() == std::vector<std::string>{"lon", "nyc", "sfo"}));
+    assert(agg.nodes("lon") == 3 && agg.nodes("nyc") == 2 && agg.nodes("nowhere") == 0);
+    assert((agg.uplinks("lon") == std::vector<std::string>{"inet", "lte", "mpls"}));
+    assert(same(agg.site("lon"), want_lon, 1e-9) && agg.site("lon").interfaces == 90);
+    assert(same(agg.uplink("lon", "lte"), want_lon_lte, 1e-9) && agg.uplink("lon", "lte").interfaces == 30);
+    assert(agg.uplink("lon", "sat").interfaces == 0);
+
+    // Stale and bad pushes are refused; a newer push replaces.
+    DigestPush older = make_push(nodes[0], "lon", "r0", 70, uplink_of);
+    const bool took_older = agg.ingest(older);
+    assert(!took_older && agg.stats().stale == 1);
+    const bool took_cut = agg.ingest(std::span<const std::byte>(datagram).first(7));
+    assert(!took_cut && agg.stats().bad == 1);
+    DigestPush newer = make_push(nodes[0], "lon", "r0", 90, [](InterfaceId) { return std::string_view("lte"); });
+    const bool took_newer = agg.ingest(newer);
+    assert(took_newer);
+    assert(agg.site("lon").interfaces == 90 && agg.uplink("lon", "lte").interfaces == 50);
+
+    // Hand-built pushes are normalised.
+    DigestPush manual{"ams", "x", 5, {}};
+    manual.groups.emplace_back("b", want_lon_lte);
+    manual.groups.emplace_back("a", want_lon_lte);
+    manual.groups.emplace_back("b", want_lon_lte);
+    const bool took_manual = agg.ingest(manual);
+    assert(took_manual);
+    assert(agg.uplink("ams", "b").interfaces == 60 && agg.uplink("ams", "a").interfaces == 30);
+
+    const std::size_t expired = agg.expire(100, 20);
+    assert(expired == 6 && agg.stats().expired == 6); // only r0 (90) survives
+    assert((agg.sites() == std::vector<std::string>{"lon"}) && agg.nodes("lon") == 1);
+    assert(agg.stats().pushes == 14);
+  }
+
+  std::printf("test_fleet_summary OK (push=%zuB for %zu interfaces)\n", datagram.size(), std::size_t{30});
+  return 0;
+}
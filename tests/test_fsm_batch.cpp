@@ -0,0 +1,184 @@
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "fsm_batch.hpp"
+
+using namespace telemetry;
+
+// FsmStates as columns, for the batch kernels.
+struct Columns {
+  std::vector<uint8_t> status;
+  std::vector<int64_t> last;
+  std::vector<int> hx, he, de, dx;
+  std::vector<double> score, conf;
+
+  explicit Columns(const std::vector<FsmState>& st)
+    : status(st.size()), last(st.size()), hx(st.size()), he(st.size()), de(st.size()), dx(st.size()),
+      score(st.size()), conf(st.size()) {
+    for (std::size_t i = 0; i < st.size(); ++i) {
+      status[i] = static_cast<uint8_t>(st[i].status);
+      last[i] = st[i].last_transition_ts;
+      hx[i] = st[i].cnt_below_healthy_exit;
+      he[i] = st[i].cnt_above_healthy_enter;
+      de[i] = st[i].cnt_below_down_enter;
+      dx[i] = st[i].cnt_above_down_exit;
+    }
+  }
+
+  FsmBatch batch() {
+    return FsmBatch{status.data(), last.data(), hx.data(), he.data(), de.data(), dx.data(),
+                    score.data(), conf.data(), status.size()};
+  }
+
+  bool matches(std::size_t i, const FsmState& s) const {
+    return status[i] == static_cast<uint8_t>(s.status) && last[i] == s.last_transition_ts &&
+           hx[i] == s.cnt_below_healthy_exit && he[i] == s.cnt_above_healthy_enter &&
+           de[i] == s.cnt_below_down_enter && dx[i] == s.cnt_above_down_exit;
+  }
+};
+
+static FsmConfig random_config(std::mt19937_64& rng) {
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  std::uniform_int_distribution<int> n(1, 6);
+  FsmConfig c;
+  c.down_enter = 0.2 + 0.2 * u(rng);
+  c.down_exit = c.down_enter + 0.1 * u(rng);
+  c.healthy_exit = 0.55 + 0.1 * u(rng);
+  c.healthy_enter = c.healthy_exit + 0.1 * u(rng);
+  c.healthy_enter_N = n(rng);
+  c.healthy_exit_N = n(rng);
+  c.down_enter_N = n(rng);
+  c.down_exit_N = n(rng);
+  c.min_dwell_sec = std::uniform_int_distribution<int>(-1, 8)(rng);
+  c.min_confidence_for_promotion = 0.4 + 0.4 * u(rng);
+  c.force_down_if_confidence_below = u(rng) < 0.5 ? -1.0 : 0.3 * u(rng);
+  return c;
+}
+
+// Scores cluster on the thresholds (and hit them exactly) so counters move
+// both ways; a few are NaN.
+static double random_score(std::mt19937_64& rng, const FsmConfig& c) {
+  const double marks[] = {c.down_enter, c.down_exit, c.healthy_exit, c.healthy_enter, 0.0, 1.0};
+  const auto r = std::uniform_int_distribution<int>(0, 99)(rng);
+  if (r == 0) return std::numeric_limits<double>::quiet_NaN();
+  if (r < 15) return marks[r % 6];
+  return std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+}
+
+// Drives n entries with kernel k against HysteresisFsm's fsm_update() for
+// many ticks; returns transitions seen.
+static std::size_t check_kernel(ScoreKernel k, std::size_t n, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  const FsmConfig cfg = random_config(rng);
+
+  // Random starting states, including checkpoint-restored ones with counters
+  // left in other states and old transition times.
+  std::vector<FsmState> ref(n);
+  for (auto& s : ref) {
+    s.status = static_cast<IfStatus>(std::uniform_int_distribution<int>(0, 2)(rng));
+    if (rng() % 2) s.last_transition_ts = std::uniform_int_distribution<int64_t>(-20, 5)(rng);
+    if (rng() % 4 == 0) {
+      s.cnt_below_healthy_exit = static_cast<int>(rng() % 5);
+      s.cnt_above_healthy_enter = static_cast<int>(rng() % 5);
+      s.cnt_below_down_enter = static_cast<int>(rng() % 5);
+      s.cnt_above_down_exit = static_cast<int>(rng() % 5);
+    }
+  }
+  Columns col(ref);
+  std::vector<FsmChange> out(n);
+
+  std::size_t transitions = 0;
+  int64_t ts = 0;
+  for (int tick = 0; tick < 400; ++tick) {
+    ts += std::uniform_int_distribution<int>(0, 3)(rng); // repeats and gaps
+    for (std::size_t i = 0; i < n; ++i) {
+      col.score[i] = random_score(rng, cfg);
+      col.conf[i] = rng() % 10 == 0 ? 0.1 * (rng() % 4) : std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+    }
+    const std::size_t changes = fsm_update_batch_with(k, cfg, col.batch(), ts, out);
+    std::size_t next = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      const IfStatus from = ref[i].status;
+      const FsmUpdate upd = fsm_update(cfg, ref[i], ts, col.score[i], col.conf[i]);
+      assert(col.matches(i, ref[i]));
+      if (!upd.transitioned) continue;
+      assert(next < changes);
+      const FsmChange& ch = out[next++];
+      assert(ch.index == i && ch.from == from && ch.to == upd.status && ch.reason == upd.reason);
+    }
+    assert(next == changes);
+    transitions += changes;
+  }
+  return transitions;
+}
+
+int main() {
+  std::size_t transitions = 0;
+  int kernels = 0;
+  for (ScoreKernel k : {ScoreKernel::Scalar, ScoreKernel::Avx2, ScoreKernel::Neon}) {
+    if (!score_kernel_available(k)) continue;
+    ++kernels;
+    for (uint64_t seed = 1; seed <= 40; ++seed) {
+      // Sizes around the lane counts exercise the scalar tails.
+      for (const std::size_t n : {std::size_t{1}, std::size_t{3}, std::size_t{4}, std::size_t{7}, std::size_t{64}}) {
+        transitions += check_kernel(k, n, seed * 131 + n);
+      }
+    }
+  }
+  assert(transitions > 10000);
+
+  // Every reason appears, including force-down and the dwell hold-off.
+  {
+    FsmConfig cfg;
+    cfg.force_down_if_confidence_below = 0.2;
+    cfg.min_dwell_sec = 3;
+    std::vector<FsmState> st(4);
+    st[0].status = IfStatus::Healthy;
+    st[1].status = IfStatus::Degraded;
+    st[2].status = IfStatus::Down;
+    st[3].status = IfStatus::Degraded;
+    Columns col(st);
+    col.score = {0.1, 0.9, 0.9, 0.1};
+    col.conf = {0.1, 1.0, 1.0, 1.0};
+    std::vector<FsmChange> out(4);
+    const std::size_t n = fsm_update_batch(cfg, col.batch(), 0, out);
+    assert(n == 1 && out[0].index == 0 && out[0].reason == TransitionReason::ForceDown);
+    assert(col.status[0] == static_cast<uint8_t>(IfStatus::Down) && col.last[0] == 0);
+
+    // Entry 1 has its evidence by t=5 but waits out the dwell; entry 3
+    // drops to Down at once although it transitioned at t=2 as well.
+    col.conf[0] = 1.0;
+    col.last = {0, 4, 0, 2};
+    std::size_t reasons = 0;
+    for (int64_t t = 1; t <= 8; ++t) {
+      const std::size_t m = fsm_update_batch(cfg, col.batch(), t, out);
+      for (std::size_t i = 0; i < m; ++i) {
+        reasons |= std::size_t{1} << static_cast<int>(out[i].reason);
+        if (out[i].reason == TransitionReason::HealthyEnter) assert(out[i].index == 1 && t == 7);
+        if (out[i].reason == TransitionReason::DownEnter) assert(out[i].index == 3 && t == 2);
+        if (out[i].reason == TransitionReason::DownExit) assert(out[i].index == 2 && t == 4);
+      }
+    }
+    const std::size_t want = (std::size_t{1} << static_cast<int>(TransitionReason::HealthyEnter)) |
+                             (std::size_t{1} << static_cast<int>(TransitionReason::DownEnter)) |
+                             (std::size_t{1} << static_cast<int>(TransitionReason::DownExit));
+    assert((reasons & want) == want);
+
+    bool threw = false;
+    try {
+      std::vector<FsmChange> small(3);
+      (void)fsm_update_batch(cfg, col.batch(), 7, small);
+    } catch (const std::length_error&) {
+      threw = true;
+    }
+    assert(threw);
+  }
+
+  std::printf("test_fsm_batch OK (kernels=%d transitions=%zu)\n", kernels, transitions);
+  return 0;
+}
@@ -0,0 +1,164 @@
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "scenarios.hpp"
+#include "telemetry_agent.hpp"
+
+using namespace telemetry;
+
+static bool near(double a, double b) { return std::abs(a - b) <= 1e-12; }
+
+[[maybe_unused]] static bool same(const InterfaceSnapshot& a, const InterfaceSnapshot& b) {
+  return a.status == b.status && near(a.score_raw, b.score_raw) && near(a.score_smoothed, b.score_smoothed) &&
+         near(a.score_used, b.score_used) && near(a.confidence, b.confidence) &&
+         near(a.avg_tp_mbps, b.avg_tp_mbps) && near(a.avg_rtt_ms, b.avg_rtt_ms) &&
+         near(a.avg_loss_pct, b.avg_loss_pct) && near(a.avg_jitter_ms, b.avg_jitter_ms);
+}
+
+[[maybe_unused]] static bool same(const std::vector<TransitionEvent>& a, const std::vector<TransitionEvent>& b) {
+  if (a.size() != b.size()) return false;
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    if (a[i].id != b[i].id || a[i].ts != b[i].ts || a[i].from != b[i].from || a[i].to != b[i].to ||
+        a[i].reason != b[i].reason) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main() {
+  const std::vector<std::string> ifaces = {"eth0", "wifi0", "lte0", "sat0"};
+
+  // One sample per interface per batch: identical to ingest() per sample,
+  // including transition order, for every scenario with imperfect data.
+  for (ScenarioId sid : {ScenarioId::A, ScenarioId::B, ScenarioId::C, ScenarioId::D}) {
+    ImperfectDataConfig imp{};
+    imp.enable_missing = true;
+    imp.enable_late = true;
+    ScenarioGenerator gen(sid, imp);
+
+    TelemetryAgent one, bulk;
+    for (const auto& n : ifaces) {
+      one.register_interface(n);
+      bulk.register_interface(n);
+    }
+    std::vector<Sample> batch;
+    for (int64_t t = 0; t < 180; ++t) {
+      one.note_time(t);
+      bulk.note_time(t);
+      batch.clear();
+      for (InterfaceId id = 0; id < ifaces.size(); ++id) {
+        const auto g = gen.sample(ifaces[id], t);
+        if (!g) continue;
+        one.ingest(id, g->ts, g->m);
+        batch.push_back(Sample{id, g->ts, g->m});
+      }
+      bulk.ingest_batch(batch);
+      for (InterfaceId id = 0; id < ifaces.size(); ++id) assert(same(one.snapshot(id), bulk.snapshot(id)));
+      const std::vector<TransitionEvent> want = one.drain_transitions();
+      const std::vector<TransitionEvent> got = bulk.drain_transitions();
+      assert(same(want, got));
+    }
+  }
+
+  // Duplicates, out-of-order and too-old samples land in the windows exactly
+  // as with ingest(); each touched interface is evaluated once.
+  {
+    TelemetryAgent one, bulk;
+    constexpr InterfaceId kIfaces = 8;
+    for (InterfaceId i = 0; i < kIfaces; ++i) {
+      one.register_interface("if" + std::to_string(i));
+      bulk.register_interface("if" + std::to_string(i));
+    }
+
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<InterfaceId> pick(0, kIfaces - 2); // last one never touched
+    std::uniform_int_distribution<int> back(-2, 60);
+    std::uniform_real_distribution<double> q(0.0, 1.0);
+
+    std::vector<Sample> batch;
+    uint64_t touched = 0;
+    for (int64_t t = 100; t < 160; ++t) {
+      batch.clear();
+      std::vector<bool> seen(kIfaces, false);
+      for (int k = 0; k < 40; ++k) {
+        const double u = q(rng);
+        batch.push_back(Sample{pick(rng), t - back(rng), Metrics{20 + 400 * u, 180 - 150 * u, 5 * u, 50 * u}});
+        if (!seen[batch.back().id]) ++touched;
+        seen[batch.back().id] = true;
+      }
+      one.note_time(t);
+      bulk.note_time(t);
+      for (const Sample& s : batch) one.ingest(s.id, s.ts, s.m);
+      bulk.ingest_batch(batch);
+
+      // Windows agree; only the EWMA/FSM cadence differs.
+      for (InterfaceId id = 0; id < kIfaces; ++id) {
+        const auto& a = one.snapshot(id);
+        const auto& b = bulk.snapshot(id);
+        assert(near(a.score_raw, b.score_raw) && near(a.confidence, b.confidence));
+        assert(near(a.avg_rtt_ms, b.avg_rtt_ms) && near(a.avg_tp_mbps, b.avg_tp_mbps));
+      }
+    }
+
+    if constexpr (kInstrumentationEnabled) {
+      const auto& a = one.stats().totals;
+      const auto& b = bulk.stats().totals;
+      assert(a.ingested == b.ingested && a.overwritten == b.overwritten);
+      assert(a.dropped_late == b.dropped_late && a.future == b.future);
+      assert(a.dropped_late > 0 && a.overwritten > 0);
+
+      // One evaluation per touched interface and batch, plus one per tick.
+      const uint64_t ticks = 60;
+      assert(bulk.interface_stats(kIfaces - 1).recomputes == ticks);
+      assert(b.recomputes == touched + ticks * kIfaces);
+      assert(a.recomputes == ticks * 40 + ticks * kIfaces);
+    }
+  }
+
+  // PerTick: ingest_batch() only fills windows, so it is exactly ingest().
+  {
+    AgentConfig cfg;
+    cfg.recompute = RecomputeMode::PerTick;
+    TelemetryAgent one(cfg), bulk(cfg);
+    for (const auto& n : ifaces) {
+      one.register_interface(n);
+      bulk.register_interface(n);
+    }
+    ScenarioGenerator gen(ScenarioId::B);
+    std::vector<Sample> batch;
+    for (int64_t t = 0; t < 120; ++t) {
+      batch.clear();
+      for (int rep = 0; rep < 3; ++rep) {
+        for (InterfaceId id = 0; id < ifaces.size(); ++id) {
+          const auto g = gen.sample(ifaces[id], t);
+          if (!g) continue;
+          one.ingest(id, g->ts, g->m);
+          batch.push_back(Sample{id, g->ts, g->m});
+        }
+      }
+      bulk.ingest_batch(batch);
+      one.note_time(t);
+      bulk.note_time(t);
+      for (InterfaceId id = 0; id < ifaces.size(); ++id) assert(same(one.snapshot(id), bulk.snapshot(id)));
+      const std::vector<TransitionEvent> want = one.drain_transitions();
+      const std::vector<TransitionEvent> got = bulk.drain_transitions();
+      assert(same(want, got));
+    }
+  }
+
+  // An empty batch is a no-op.
+  {
+    TelemetryAgent agent;
+    agent.register_interface("eth0");
+    agent.ingest_batch({});
+    assert(agent.snapshot(0).confidence == 0.0);
+  }
+
+  std::printf("test_ingest_batch OK\n");
+  return 0;
+}
@@ -0,0 +1,85 @@
+#include <cassert>
+#include <cstdio>
+
+#include "latency_histogram.hpp"
+#include "telemetry_agent.hpp"
+
+using namespace telemetry;
+
+int main() {
+  // Histogram: exact small values, bounded relative error, merge.
+  {
+    LatencyHistogram h;
+    assert(h.count() == 0 && h.percentile(0.5) == 0);
+    for (uint64_t v = 1; v <= 1000; ++v) h.record(v);
+    assert(h.count() == 1000 && h.max() == 1000);
+    assert(h.percentile(0.0) == 1);
+    assert(h.percentile(0.05) == 50);
+    const uint64_t p50 = h.percentile(0.5);
+    assert(p50 <= 500 && p50 >= 500 - 500 / 16);
+    const uint64_t p999 = h.percentile(0.999);
+    assert(p999 <= 999 && p999 >= 999 - 999 / 16);
+
+    LatencyHistogram big;
+    big.record(uint64_t{1} << 50); // beyond the last exponent: clamped, not lost
+    h.merge(big);
+    assert(h.count() == 1001 && h.max() == (uint64_t{1} << 50));
+    assert(h.percentile(1.0) > 1000);
+  }
+
+  TelemetryAgent agent;
+  const InterfaceId eth0 = agent.register_interface("eth0");
+  const InterfaceId wifi0 = agent.register_interface("wifi0");
+  const Metrics m{20, 180, 0.1, 3};
+
+  agent.note_time(100);
+  agent.ingest(eth0, 100, m);  // inserted
+  agent.ingest(eth0, 100, m);  // overwritten
+  agent.ingest(eth0, 40, m);   // too old (window is [56, 100])
+  agent.ingest(eth0, 101, m);  // ahead of the last tick
+  agent.ingest(wifi0, 99, m);  // inserted
+  agent.note_time(101);
+
+  const IngestCounters& e = agent.interface_stats(eth0);
+  const IngestCounters& w = agent.interface_stats(wifi0);
+  const AgentStats& s = agent.stats();
+
+  if constexpr (kInstrumentationEnabled) {
+    assert(e.ingested == 3 && e.overwritten == 1 && e.dropped_late == 1 && e.future == 1);
+    assert(e.recomputes == 4 + 2); // every ingest and every tick
+    assert(w.ingested == 1 && w.overwritten == 0 && w.dropped_late == 0 && w.future == 0);
+    assert(w.recomputes == 1 + 2);
+
+    assert(s.ticks == 2 && s.tick_ns.count() == 2);
+    assert(s.totals.ingested == 4 && s.totals.dropped_late == 1 && s.totals.future == 1);
+    assert(s.totals.recomputes == e.recomputes + w.recomputes);
+
+    // Transition counters agree with the event stream.
+    for (int64_t t = 102; t < 200; ++t) {
+      agent.note_time(t);
+      agent.ingest(eth0, t, m);
+    }
+    const uint64_t drained = agent.drain_transitions([](const TransitionEvent&) {});
+    assert(drained > 0);
+    assert(s.totals.transitions == drained);
+    assert(agent.interface_stats(eth0).transitions + agent.interface_stats(wifi0).transitions == drained);
+
+    // Ingest timing is sampled.
+    const uint64_t calls = 5 + 98;
+    assert(s.ingest_ns.count() == calls / AgentStats::kIngestTimingEvery);
+
+    // Interfaces registered later start from zero.
+    const InterfaceId lte0 = agent.register_interface("lte0");
+    assert(agent.interface_stats(lte0).recomputes == 0);
+
+    agent.reset_stats();
+    assert(s.ticks == 0 && s.totals.ingested == 0 && s.tick_ns.count() == 0);
+    assert(agent.interface_stats(eth0).ingested == 0);
+  } else {
+    assert(e.ingested == 0 && w.ingested == 0);
+    assert(s.ticks == 0 && s.totals.recomputes == 0 && s.tick_ns.count() == 0);
+  }
+
+  std::printf("test_instrumentation OK\n");
+  return 0;
+}
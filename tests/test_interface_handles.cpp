@@ -0,0 +1,89 @@
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "telemetry_agent.hpp"
+
+using namespace telemetry;
+
+// Count heap allocations so the handle path can be checked allocation-free.
+static long g_allocs = 0;
+
+void* operator new(std::size_t n) {
+  ++g_allocs;
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+int main() {
+  AgentConfig cfg;
+  cfg.fsm.force_down_if_confidence_below = -1.0;
+
+  // Stable, dense handles; re-registering returns the same handle.
+  {
+    TelemetryAgent agent(cfg);
+    const InterfaceId eth0 = agent.register_interface("eth0");
+    const InterfaceId wifi0 = agent.register_interface(std::string_view("wifi0"));
+    assert(eth0 == 0 && wifi0 == 1);
+    const InterfaceId again = agent.register_interface("eth0");
+    assert(again == eth0);
+    agent.ensure_interface("lte0");
+    assert(agent.size() == 3);
+    assert(agent.find_interface("lte0").value() == 2);
+    assert(!agent.find_interface("sat0").has_value());
+    assert(agent.snapshot(wifi0).iface == "wifi0");
+  }
+
+  // Handle and name ingest produce identical state.
+  {
+    TelemetryAgent by_name(cfg);
+    TelemetryAgent by_id(cfg);
+    by_name.ensure_interface("wifi0");
+    const InterfaceId id = by_id.register_interface("wifi0");
+    for (int64_t t = 0; t < 120; ++t) {
+      const Metrics m{30.0 + (t % 40) * 8.0, 120.0 - (t % 30), 0.5 + (t % 9), 6.0 + (t % 13)};
+      by_name.note_time(t);
+      by_id.note_time(t);
+      by_name.ingest("wifi0", t, m);
+      by_id.ingest(id, t, m);
+      const auto& a = by_name.snapshot(0);
+      const auto& b = by_id.snapshot(id);
+      assert(a.status == b.status);
+      assert(a.score_used == b.score_used);
+      assert(a.confidence == b.confidence);
+    }
+    const std::size_t named = by_name.drain_transitions().size();
+    const std::size_t handled = by_id.drain_transitions().size();
+    assert(named == handled);
+  }
+
+  // Steady state on the handle path does not touch the heap.
+  {
+    TelemetryAgent agent(cfg);
+    std::vector<InterfaceId> ids;
+    for (const char* n : {"eth0", "wifi0", "lte0", "sat0"}) ids.push_back(agent.register_interface(n));
+    const Metrics good{20, 180, 0.1, 3};
+    for (int64_t t = 0; t < 60; ++t) {
+      agent.note_time(t);
+      for (auto id : ids) agent.ingest(id, t, good);
+    }
+    agent.drain_transitions();
+
+    const long before = g_allocs;
+    for (int64_t t = 60; t < 600; ++t) {
+      agent.note_time(t);
+      for (auto id : ids) agent.ingest(id, t, good);
+    }
+    assert(g_allocs == before);
+    assert(agent.snapshot(ids[0]).status == IfStatus::Healthy);
+  }
+
+  std::printf("test_interface_handles OK\n");
+  return 0;
+}
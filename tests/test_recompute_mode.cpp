@@ -0,0 +1,154 @@
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "columnar_agent.hpp"
+#include "telemetry_agent.hpp"
+
+using namespace telemetry;
+
+static AgentConfig cfg_for(RecomputeMode mode) {
+  AgentConfig cfg;
+  cfg.recompute = mode;
+  cfg.score.useEwma = true;
+  cfg.score.ewma_alpha = 0.25;
+  cfg.fsm.healthy_enter_N = 4;
+  cfg.fsm.healthy_exit_N = 4;
+  cfg.fsm.down_enter_N = 3;
+  cfg.fsm.down_exit_N = 3;
+  cfg.fsm.min_dwell_sec = 3;
+  return cfg;
+}
+
+static bool near(double a, double b) { return std::abs(a - b) <= 1e-12; }
+
+[[maybe_unused]] static bool same(const InterfaceSnapshot& a, const InterfaceSnapshot& b) {
+  return a.status == b.status && near(a.score_raw, b.score_raw) && near(a.score_smoothed, b.score_smoothed) &&
+         near(a.score_used, b.score_used) && near(a.confidence, b.confidence) && near(a.avg_tp_mbps, b.avg_tp_mbps);
+}
+
+static Metrics metrics_at(int64_t t) {
+  // Good for a while, then bad, then good again.
+  const bool bad = (t / 40) % 2 == 1;
+  return bad ? Metrics{400, 5, 8.0, 60} : Metrics{20, 180, 0.1, 3};
+}
+
+int main() {
+  // Sample rate no longer drives EWMA/FSM: one sample per second and five
+  // copies of it per second give identical snapshots and transitions.
+  {
+    TelemetryAgent once(cfg_for(RecomputeMode::PerTick));
+    TelemetryAgent five(cfg_for(RecomputeMode::PerTick));
+    const InterfaceId a = once.register_interface("eth0");
+    const InterfaceId b = five.register_interface("eth0");
+
+    for (int64_t t = 0; t < 300; ++t) {
+      once.ingest(a, t, metrics_at(t));
+      for (int k = 0; k < 5; ++k) five.ingest(b, t, metrics_at(t));
+      once.note_time(t);
+      five.note_time(t);
+      assert(same(once.snapshot(a), five.snapshot(b)));
+    }
+    const auto ea = once.drain_transitions();
+    const auto eb = five.drain_transitions();
+    assert(!ea.empty() && ea.size() == eb.size());
+    for (std::size_t i = 0; i < ea.size(); ++i) {
+      assert(ea[i].ts == eb[i].ts && ea[i].to == eb[i].to && ea[i].reason == eb[i].reason);
+    }
+
+    // Eager mode, by contrast, advances the EWMA per sample.
+    TelemetryAgent eager1(cfg_for(RecomputeMode::Eager));
+    TelemetryAgent eager5(cfg_for(RecomputeMode::Eager));
+    eager1.register_interface("eth0");
+    eager5.register_interface("eth0");
+    for (int64_t t = 0; t < 60; ++t) {
+      eager1.ingest(0, t, metrics_at(t));
+      for (int k = 0; k < 5; ++k) eager5.ingest(0, t, metrics_at(t));
+      eager1.note_time(t);
+      eager5.note_time(t);
+    }
+    assert(!near(eager1.snapshot(0).score_smoothed, eager5.snapshot(0).score_smoothed));
+  }
+
+  // Nothing is evaluated before the tick, and a repeated tick with no new
+  // samples is a no-op; a repeated tick after a late sample is not.
+  {
+    TelemetryAgent agent(cfg_for(RecomputeMode::PerTick));
+    const InterfaceId id = agent.register_interface("eth0");
+    agent.note_time(100);
+    const InterfaceSnapshot before = agent.snapshot(id);
+    agent.ingest(id, 100, Metrics{20, 180, 0.1, 3});
+    assert(agent.snapshot(id).confidence == before.confidence);
+    agent.note_time(100);
+    const InterfaceSnapshot after = agent.snapshot(id);
+    assert(after.confidence > before.confidence);
+    agent.note_time(100);
+    assert(same(agent.snapshot(id), after));
+
+    if constexpr (kInstrumentationEnabled) {
+      // Two evaluations: the first tick and the tick after the sample.
+      assert(agent.interface_stats(id).recomputes == 2);
+      assert(agent.stats().totals.recomputes == 2);
+      assert(agent.stats().totals.ingested == 1);
+    }
+  }
+
+  // Row and columnar agents agree in PerTick mode, including bursts of
+  // sub-second samples, late samples and repeated ticks.
+  {
+    const AgentConfig cfg = cfg_for(RecomputeMode::PerTick);
+    TelemetryAgent ref(cfg);
+    ColumnarTelemetryAgent col(cfg);
+    constexpr int kIfaces = 12;
+    for (int i = 0; i < kIfaces; ++i) {
+      const std::string name = "if" + std::to_string(i);
+      ref.register_interface(name);
+      col.register_interface(name);
+    }
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> burst(0, 4);
+    std::uniform_real_distribution<double> noise(0.8, 1.2);
+    for (int64_t t = 0; t < 400; ++t) {
+      for (InterfaceId id = 0; id < kIfaces; ++id) {
+        const int n = burst(rng);
+        for (int k = 0; k < n; ++k) {
+          Metrics m = metrics_at(t + id * 7);
+          m.rtt_ms *= noise(rng);
+          m.throughput_mbps *= noise(rng);
+          const int64_t ts = (k == 3) ? t - 10 : t;
+          ref.ingest(id, ts, m);
+          col.ingest(id, ts, m);
+        }
+      }
+      ref.note_time(t);
+      col.note_time(t);
+      if (t % 5 == 0) {
+        // Late sample followed by a repeated tick.
+        ref.ingest(InterfaceId{3}, t - 1, metrics_at(t));
+        col.ingest(InterfaceId{3}, t - 1, metrics_at(t));
+        ref.note_time(t);
+        col.note_time(t);
+      }
+      for (InterfaceId id = 0; id < kIfaces; ++id) assert(same(ref.snapshot(id), col.snapshot(id)));
+    }
+
+    std::vector<std::vector<TransitionEvent>> rs(kIfaces), cs(kIfaces);
+    ref.drain_transitions([&](const TransitionEvent& ev) { rs[ev.id].push_back(ev); });
+    col.drain_transitions([&](const TransitionEvent& ev) { cs[ev.id].push_back(ev); });
+    std::size_t total = 0;
+    for (int i = 0; i < kIfaces; ++i) {
+      assert(rs[i].size() == cs[i].size());
+      for (std::size_t k = 0; k < rs[i].size(); ++k) {
+        assert(rs[i][k].ts == cs[i][k].ts && rs[i][k].to == cs[i][k].to && rs[i][k].reason == cs[i][k].reason);
+      }
+      total += rs[i].size();
+    }
+    assert(total > 0);
+  }
+
+  std::printf("test_recompute_mode OK\n");
+  return 0;
+}
@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include "rolling_window.hpp"
+
+using namespace telemetry;
+
+[[maybe_unused]] static bool near(double a, double b) {
+  return std::abs(a - b) <= 1e-9 * std::max(1.0, std::abs(b));
+}
+
+static void assert_parity(const RollingWindow& w) {
+  const auto fast = w.summary();
+  const auto ref = w.summary_scan();
+  assert(fast.newest_ts == ref.newest_ts);
+  assert(fast.oldest_ts == ref.oldest_ts);
+  assert(fast.count == ref.count);
+  assert(near(fast.confidence, ref.confidence));
+  assert(near(fast.missing_rate, ref.missing_rate));
+  assert(near(fast.avg_rtt_ms, ref.avg_rtt_ms));
+  assert(near(fast.avg_throughput_mbps, ref.avg_throughput_mbps));
+  assert(near(fast.avg_loss_pct, ref.avg_loss_pct));
+  assert(near(fast.avg_jitter_ms, ref.avg_jitter_ms));
+}
+
+int main() {
+  // Empty window.
+  {
+    RollingWindow w;
+    assert_parity(w);
+    w.note_time(5);
+    assert_parity(w);
+  }
+
+  // Overwrite of the same second replaces (not adds to) the running sums.
+  {
+    RollingWindow w;
+    w.ingest(3, Metrics{100, 10, 1, 1});
+    w.ingest(3, Metrics{300, 30, 3, 3});
+    assert(w.summary().count == 1);
+    assert(near(w.summary().avg_rtt_ms, 300.0));
+    assert_parity(w);
+  }
+
+  // Multi-second jump past the whole window evicts everything.
+  {
+    RollingWindow w;
+    for (int t = 0; t < 45; ++t) w.ingest(t, Metrics{50, 50, 1, 5});
+    w.note_time(44 + 45);
+    assert(w.summary().count == 0);
+    assert_parity(w);
+    w.ingest(90, Metrics{10, 10, 0, 0});
+    assert(w.summary().count == 1);
+    assert_parity(w);
+  }
+
+  // Randomized stream: in-order, late, too-old, duplicate, gaps and jumps.
+  std::mt19937 rng(12345);
+  std::uniform_real_distribution<double> val(0.0, 1000.0);
+  std::uniform_int_distribution<int> action(0, 99);
+
+  for (int run = 0; run < 20; ++run) {
+    RollingWindow w;
+    int64_t t = -100 + run * 7; // include negative timestamps
+    for (int step = 0; step < 5000; ++step) {
+      const int a = action(rng);
+      const Metrics m{val(rng), val(rng), val(rng) / 30.0, val(rng) / 5.0};
+      if (a < 55) {
+        w.ingest(t, m);
+        ++t;
+      } else if (a < 70) {
+        const int64_t late = t - 1 - (action(rng) % 60); // some too old
+        w.ingest(late, m);
+      } else if (a < 78) {
+        w.ingest(t - 1, m); // overwrite most recent second
+      } else if (a < 88) {
+        t += 1 + action(rng) % 10; // gap
+        w.note_time(t);
+      } else if (a < 91) {
+        t += 40 + action(rng) % 20; // jump around kWindow
+        w.ingest(t, m);
+      } else {
+        w.note_time(t - 5); // time going backwards is ignored
+      }
+      assert_parity(w);
+    }
+  }
+
+  std::printf("test_rolling_window_parity OK\n");
+  return 0;
+}
@@ -0,0 +1,213 @@
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "sample_collector.hpp"
+#include "scenarios.hpp"
+#include "telemetry_agent.hpp"
+
+using namespace telemetry;
+
+[[maybe_unused]] static bool same(const InterfaceSnapshot& a, const InterfaceSnapshot& b) {
+  return a.iface == b.iface && a.status == b.status && a.score_raw == b.score_raw &&
+         a.score_smoothed == b.score_smoothed && a.score_used == b.score_used && a.confidence == b.confidence &&
+         a.avg_tp_mbps == b.avg_tp_mbps && a.avg_rtt_ms == b.avg_rtt_ms && a.avg_loss_pct == b.avg_loss_pct &&
+         a.avg_jitter_ms == b.avg_jitter_ms;
+}
+
+static void send_words(int fd, const std::vector<uint64_t>& words) {
+  const ssize_t n = ::send(fd, words.data(), words.size() * 8, 0);
+  assert(n == static_cast<ssize_t>(words.size() * 8));
+}
+
+// Polls until the collector has seen n datagrams in total.
+static void poll_until(SampleCollector& c, uint64_t n) {
+  for (int i = 0; i < 1000 && c.stats().datagrams < n; ++i) c.poll(10);
+  assert(c.stats().datagrams == n);
+}
+
+int main() {
+  // Wire format round trip; malformed datagrams are rejected.
+  {
+    const std::vector<Sample> in = {{0, 10, Metrics{20.0, 300.0, 0.1, 2.0}}, {3, 11, Metrics{80.0, 5.0, 4.0, 30.0}}};
+    std::vector<uint64_t> words;
+    encode_samples(in, words);
+    assert(words.size() * 8 == sizeof(WireSampleHeader) + 2 * sizeof(WireSample));
+    const auto bytes = std::as_bytes(std::span<const uint64_t>(words));
+    const auto recs = parse_samples(bytes);
+    assert(recs && recs->size() == 2);
+    assert((*recs)[1].id == 3 && (*recs)[1].ts == 11 && (*recs)[1].rtt_ms == 80.0 && (*recs)[1].jitter_ms == 30.0);
+    assert(!parse_samples(bytes.first(bytes.size() - 8)));
+    assert(!parse_samples(bytes.first(4)));
+    auto bad = words;
+    bad[0] ^= 1; // magic
+    assert(!parse_samples(std::as_bytes(std::span<const uint64_t>(bad))));
+
+    std::vector<uint64_t> empty;
+    encode_samples({}, empty);
+    assert(parse_samples(std::as_bytes(std::span<const uint64_t>(empty)))->empty());
+    assert(kSamplesPerMtu == 30);
+  }
+
+  // Scenario B over a datagram socketpair matches direct ingest exactly
+  // (one sample per interface per datagram, so batching changes nothing).
+  {
+    const std::vector<std::string> ifaces = {"eth0", "wifi0", "lte0", "sat0"};
+    ImperfectDataConfig imp;
+    imp.enable_missing = true;
+    imp.enable_late = true;
+    const ScenarioGenerator gen(ScenarioId::B, imp);
+    TelemetryAgent ref, agent;
+    for (const auto& i : ifaces) {
+      ref.register_interface(i);
+      agent.register_interface(i);
+    }
+    int fds[2];
+    const int paired = ::socketpair(AF_UNIX, SOCK_DGRAM, 0, fds);
+    assert(paired == 0);
+    CollectorConfig cfg;
+    cfg.tick_ms = 0;
+    SampleCollector collector(agent, cfg);
+    collector.add_socket(fds[0]);
+
+    std::vector<Sample> batch;
+    std::vector<uint64_t> words;
+    uint64_t sent = 0, samples = 0;
+    for (int64_t t = 0; t < 200; ++t) {
+      ref.note_time(t);
+      agent.note_time(t);
+      batch.clear();
+      for (InterfaceId id = 0; id < ifaces.size(); ++id) {
+        if (const auto g = gen.sample(ifaces[id], t)) {
+          ref.ingest(id, g->ts, g->m);
+          batch.push_back(Sample{id, g->ts, g->m});
+        }
+      }
+      encode_samples(batch, words);
+      send_words(fds[1], words);
+      samples += batch.size();
+      poll_until(collector, ++sent);
+      for (InterfaceId id = 0; id < ifaces.size(); ++id) assert(same(agent.snapshot(id), ref.snapshot(id)));
+    }
+    assert(collector.stats().samples == samples && collector.stats().bad_datagrams == 0);
+    ::close(fds[1]);
+  }
+
+  // Bad input is counted, not thrown: foreign bytes, unknown interfaces and
+  // datagrams longer than max_datagram.
+  {
+    TelemetryAgent agent;
+    agent.register_interface("eth0");
+    int fds[2];
+    const int paired = ::socketpair(AF_UNIX, SOCK_DGRAM, 0, fds);
+    assert(paired == 0);
+    CollectorConfig cfg;
+    cfg.tick_ms = 0;
+    cfg.max_datagram = 256;
+    SampleCollector collector(agent, cfg);
+    collector.add_socket(fds[0]);
+
+    send_words(fds[1], {0x1234, 0x5678});
+    std::vector<uint64_t> words;
+    encode_samples(std::vector<Sample>{{0, 1, Metrics{}}, {7, 1, Metrics{}}}, words);
+    send_words(fds[1], words);
+    encode_samples(std::vector<Sample>(10), words); // 488 bytes
+    send_words(fds[1], words);
+    poll_until(collector, 3);
+    const CollectorStats& s = collector.stats();
+    assert(s.bad_datagrams == 1 && s.unknown_interface == 1 && s.oversize_datagrams == 1 && s.samples == 1);
+    ::close(fds[1]);
+  }
+
+  // UDP on loopback: datagrams queued before a wakeup come in one recvmmsg();
+  // a Unix datagram socket bound by path is unlinked with the collector.
+  const std::string path = "/tmp/test_sample_collector_" + std::to_string(::getpid()) + ".sock";
+  {
+    TelemetryAgent agent;
+    for (int i = 0; i < 8; ++i) agent.register_interface("if" + std::to_string(i));
+    CollectorConfig cfg;
+    cfg.tick_ms = 0;
+    SampleCollector collector(agent, cfg);
+    const uint16_t port = collector.bind_udp("127.0.0.1", 0);
+    assert(port != 0);
+    collector.bind_unix(path);
+    assert(::access(path.c_str(), F_OK) == 0);
+
+    sockaddr_in to{};
+    to.sin_family = AF_INET;
+    to.sin_port = htons(port);
+    ::inet_pton(AF_INET, "127.0.0.1", &to.sin_addr);
+    const int udp = ::socket(AF_INET, SOCK_DGRAM, 0);
+    assert(udp >= 0);
+    std::vector<uint64_t> words;
+    for (int k = 0; k < 10; ++k) {
+      std::vector<Sample> batch;
+      for (InterfaceId id = 0; id < 8; ++id) batch.push_back(Sample{id, k, Metrics{20.0, 200.0, 0.0, 1.0}});
+      encode_samples(batch, words);
+      const ssize_t n = ::sendto(udp, words.data(), words.size() * 8, 0, reinterpret_cast<const sockaddr*>(&to), sizeof to);
+      assert(n == static_cast<ssize_t>(words.size() * 8));
+    }
+    poll_until(collector, 10);
+    assert(collector.stats().recv_calls == 1 && collector.stats().samples == 80);
+    assert(agent.snapshot(3).confidence == 10.0 / RollingWindow::kWindow);
+
+    sockaddr_un un{};
+    un.sun_family = AF_UNIX;
+    std::memcpy(un.sun_path, path.c_str(), path.size() + 1);
+    const int ux = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+    encode_samples(std::vector<Sample>{{5, 10, Metrics{20.0, 200.0, 0.0, 1.0}}}, words);
+    const ssize_t sent = ::sendto(ux, words.data(), words.size() * 8, 0, reinterpret_cast<const sockaddr*>(&un), sizeof un);
+    assert(sent > 0);
+    poll_until(collector, 11);
+    assert(collector.stats().samples == 81);
+    ::close(udp);
+    ::close(ux);
+
+    bool threw = false;
+    try {
+      collector.bind_udp("not-an-address", 0);
+    } catch (const std::invalid_argument&) {
+      threw = true;
+    }
+    assert(threw);
+  }
+  assert(::access(path.c_str(), F_OK) != 0);
+
+  // The timerfd drives note_time(clock()) and the tick handler; stop() from
+  // the handler ends run().
+  {
+    TelemetryAgent agent;
+    const InterfaceId id = agent.register_interface("eth0");
+    agent.ingest(id, 100, Metrics{20.0, 200.0, 0.0, 1.0});
+    int64_t now = 100;
+    CollectorConfig cfg;
+    cfg.tick_ms = 2;
+    cfg.clock = [&now] { return now++; };
+    SampleCollector collector(agent, cfg);
+    std::vector<int64_t> ticks;
+    collector.on_tick([&](int64_t ts) {
+      ticks.push_back(ts);
+      PublishedSnapshot p;
+      int64_t published_ts = 0;
+      const bool got = agent.published().read(id, p, &published_ts);
+      assert(got && published_ts == ts);
+      if (ticks.size() == 3) collector.stop();
+    });
+    collector.run();
+    assert((ticks == std::vector<int64_t>{100, 101, 102}));
+    assert(collector.stats().ticks == 3);
+    assert(agent.snapshot(id).confidence == 1.0 / RollingWindow::kWindow);
+  }
+
+  std::printf("test_sample_collector OK\n");
+  return 0;
+}
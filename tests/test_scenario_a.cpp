@@ -26,8 +26,8 @@ static AgentConfig cfg_for(bool useEwma) {
   return cfg;
 }
 
-static int count_iface(const std::vector<TransitionEvent>& evs, const std::string& iface) {
-  int c=0; for (auto& e: evs) if (e.iface==iface) c++; return c;
+static int count_iface(const std::vector<TransitionEvent>& evs, InterfaceId id) {
+  int c=0; for (auto& e: evs) if (e.id==id) c++; return c;
 }
 
 int main() {
@@ -59,7 +59,7 @@ int main() {
       }
 
       auto evs = agent.drain_transitions();
-      int n = count_iface(evs, "wifi0");
+      int n = count_iface(evs, *agent.find_interface("wifi0"));
       if (useEwma) transitions_ewma += n; else transitions_raw += n;
 
       agent.record_tick();
@@ -26,8 +26,8 @@ static AgentConfig cfg_for(bool useEwma) {
   return cfg;
 }
 
-static int count_iface(const std::vector<TransitionEvent>& evs, const std::string& iface) {
-  int c=0; for (auto& e: evs) if (e.iface==iface) c++; return c;
+static int count_iface(const std::vector<TransitionEvent>& evs, InterfaceId id) {
+  int c=0; for (auto& e: evs) if (e.id==id) c++; return c;
 }
 
 int main() {
@@ -50,7 +50,7 @@ int main() {
         if (!g) continue;
         agent.ingest(iface, g->ts, g->m);
       }
-      transitions += count_iface(agent.drain_transitions(), "wifi0");
+      transitions += count_iface(agent.drain_transitions(), *agent.find_interface("wifi0"));
       agent.record_tick();
     }
 
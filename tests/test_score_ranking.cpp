@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "score_ranking.hpp"
+#include "telemetry_agent.hpp"
+
+using namespace telemetry;
+
+namespace {
+
+struct Ref {
+  IfStatus status = IfStatus::Degraded;
+  double score = 0.0;
+};
+
+// Brute force: sort every id, keep the first k at least as good as min_status.
+std::vector<InterfaceId> brute_best(const std::vector<Ref>& ref, std::size_t k, IfStatus min_status) {
+  auto key = [&](InterfaceId id) { return std::isnan(ref[id].score) ? -1e300 : ref[id].score; };
+  std::vector<InterfaceId> ids;
+  for (InterfaceId id = 0; id < ref.size(); ++id) {
+    if (ref[id].status <= min_status) ids.push_back(id);
+  }
+  std::sort(ids.begin(), ids.end(), [&](InterfaceId a, InterfaceId b) {
+    if (ref[a].status != ref[b].status) return ref[a].status < ref[b].status;
+    if (key(a) != key(b)) return key(a) > key(b);
+    return a < b;
+  });
+  if (ids.size() > k) ids.resize(k);
+  return ids;
+}
+
+std::vector<Ref> refs_of(const TelemetryAgent& agent) {
+  std::vector<Ref> ref;
+  for (InterfaceId id = 0; id < agent.size(); ++id) {
+    ref.push_back(Ref{agent.snapshot(id).status, agent.snapshot(id).score_used});
+  }
+  return ref;
+}
+
+// The agent's ranking against a full sort of its snapshots, every tick.
+void check_agent(AgentConfig cfg, bool batch, unsigned seed) {
+  constexpr int kIfaces = 300;
+  TelemetryAgent agent(cfg);
+  for (int i = 0; i < kIfaces; ++i) agent.register_interface("if" + std::to_string(i));
+
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  std::vector<Sample> samples;
+  std::vector<InterfaceId> out(16);
+  int64_t t = 1000;
+  int healthy_seen = 0;
+  for (int step = 0; step < 400; ++step) {
+    t += (step % 150 == 149) ? 60 : 1;
+
+    samples.clear();
+    for (int i = 0; i < kIfaces; ++i) {
+      // Some always report, some in bursts, the rest stop after a while.
+      bool reports = false;
+      if (i < 40) reports = true;
+      else if (i < 150) reports = ((t / 40 + i) % 5) == 0;
+      else reports = step < 50 + i / 2 && u(rng) < 0.8;
+      if (!reports) continue;
+      const double bad = ((t / 25 + i) % 4 == 0) ? 0.9 : 0.3 * u(rng);
+      const Metrics m{20.0 + 600.0 * bad, 190.0 - 150.0 * bad, 20.0 * bad, 120.0 * bad};
+      samples.push_back(Sample{static_cast<InterfaceId>(i), t, m});
+    }
+    if (batch) {
+      agent.ingest_batch(samples);
+    } else {
+      for (const Sample& s : samples) agent.ingest(s.id, s.ts, s.m);
+    }
+    // Queried between ingest and tick too, as a path selector might.
+    if (step % 7 == 3) (void)agent.best_interfaces(4, IfStatus::Degraded);
+    agent.note_time(t);
+
+    const auto ref = refs_of(agent);
+    for (const IfStatus min_status : {IfStatus::Healthy, IfStatus::Degraded, IfStatus::Down}) {
+      for (const std::size_t k : {std::size_t{1}, std::size_t{5}, std::size_t{16}}) {
+        const std::size_t n = agent.best_interfaces(k, min_status, out);
+        const auto want = brute_best(ref, k, min_status);
+        assert(n == want.size() && std::equal(want.begin(), want.end(), out.begin()));
+      }
+    }
+    healthy_seen += static_cast<int>(agent.best_interfaces(kIfaces, IfStatus::Healthy).size());
+  }
+  assert(healthy_seen > 0);
+  assert(agent.best_interfaces(kIfaces + 10).size() == kIfaces);
+}
+
+} // namespace
+
+int main() {
+  // ScoreRanking against brute force: random re-keys, repeated keys, ties
+  // and NaN.
+  {
+    constexpr std::size_t kIds = 200;
+    ScoreRanking r;
+    r.resize(kIds);
+    std::vector<Ref> ref(kIds);
+    std::mt19937_64 rng(11);
+    std::uniform_int_distribution<int> pick(0, kIds - 1);
+    std::uniform_int_distribution<int> status(0, 2);
+    std::uniform_int_distribution<int> coarse(0, 4);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    std::vector<InterfaceId> out(kIds);
+    for (int step = 0; step < 20000; ++step) {
+      const auto id = static_cast<InterfaceId>(pick(rng));
+      Ref k{static_cast<IfStatus>(status(rng)), u(rng) < 0.3 ? coarse(rng) / 4.0 : u(rng)};
+      if (u(rng) < 0.02) k.score = std::numeric_limits<double>::quiet_NaN();
+      if (u(rng) < 0.1) k = ref[id]; // unchanged key
+      r.update(id, k.status, k.score);
+      ref[id] = k;
+      if (step % 50 != 0) continue;
+      for (const IfStatus min_status : {IfStatus::Healthy, IfStatus::Degraded, IfStatus::Down}) {
+        for (const std::size_t kk : {std::size_t{0}, std::size_t{3}, kIds}) {
+          const std::size_t n = r.best(kk, min_status, out);
+          const auto want = brute_best(ref, kk, min_status);
+          assert(n == want.size() && std::equal(want.begin(), want.end(), out.begin()));
+        }
+      }
+    }
+    // k is capped at the output span.
+    assert(r.best(kIds, IfStatus::Down, std::span<InterfaceId>(out).first(2)) == 2);
+
+    r.resize(kIds + 1); // a new id enters as (Degraded, 0.0)
+    assert(r.size() == kIds + 1 && r.status(kIds) == IfStatus::Degraded && r.score(kIds) == 0.0);
+  }
+
+  AgentConfig base;
+  base.fsm.min_dwell_sec = 2;
+  AgentConfig per_tick = base;
+  per_tick.recompute = RecomputeMode::PerTick;
+  AgentConfig active = base;
+  active.tick_scan = TickScan::Active;
+  for (const AgentConfig& cfg : {base, per_tick, active}) {
+    check_agent(cfg, false, 3);
+    check_agent(cfg, true, 4);
+  }
+
+  // Fresh interfaces rank as registered: Degraded, score 0, by id.
+  {
+    TelemetryAgent agent;
+    agent.register_interface("a");
+    agent.register_interface("b");
+    assert(agent.best_interfaces(2, IfStatus::Healthy).empty());
+    assert((agent.best_interfaces(2) == std::vector<InterfaceId>{0, 1}));
+    agent.ingest(InterfaceId{1}, 1, Metrics{20.0, 200.0, 0.0, 1.0});
+    assert((agent.best_interfaces(2) == std::vector<InterfaceId>{1, 0}));
+  }
+
+  std::printf("test_score_ranking OK\n");
+  return 0;
+}
@@ -0,0 +1,182 @@
+#include <barrier>
+#include <cassert>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "scenarios.hpp"
+#include "sharded_agent.hpp"
+#include "telemetry_agent.hpp"
+
+using namespace telemetry;
+
+static AgentConfig cfg_for(bool useEwma) {
+  AgentConfig cfg;
+  cfg.score.useEwma = useEwma;
+  cfg.score.ewma_alpha = 0.25;
+  cfg.score.enable_downtrend_penalty = false;
+
+  cfg.fsm.healthy_enter = 0.72;
+  cfg.fsm.healthy_exit  = 0.66;
+  cfg.fsm.down_enter    = 0.35;
+  cfg.fsm.down_exit     = 0.45;
+  cfg.fsm.healthy_enter_N = 6;
+  cfg.fsm.healthy_exit_N  = 6;
+  cfg.fsm.down_enter_N    = 3;
+  cfg.fsm.down_exit_N     = 5;
+  cfg.fsm.min_dwell_sec   = 5;
+  return cfg;
+}
+
+static void assert_same(const TelemetryAgent& ref, const ShardedTelemetryAgent& sh) {
+  const auto& snaps = sh.snapshots();
+  assert(snaps.size() == ref.size());
+  for (InterfaceId id = 0; id < ref.size(); ++id) {
+    const auto& a = ref.snapshot(id);
+    const auto& b = snaps[id];
+    assert(a.iface == b.iface);
+    assert(a.status == b.status);
+    assert(a.score_used == b.score_used);
+    assert(a.score_smoothed == b.score_smoothed);
+    assert(a.confidence == b.confidence);
+  }
+}
+
+using TransitionLog = std::map<InterfaceId, std::vector<TransitionEvent>>;
+
+static void append(TransitionLog& log, const std::vector<TransitionEvent>& evs) {
+  for (const auto& e : evs) log[e.id].push_back(e);
+}
+
+static void assert_same(const TransitionLog& a, const TransitionLog& b) {
+  assert(a.size() == b.size());
+  for (const auto& [id, evs] : a) {
+    const auto& other = b.at(id);
+    assert(evs.size() == other.size());
+    for (std::size_t i = 0; i < evs.size(); ++i) {
+      assert(evs[i].ts == other[i].ts);
+      assert(evs[i].to == other[i].to);
+    }
+  }
+}
+
+// One producer (this thread), scenario data, 3 shards.
+static void single_producer(ScenarioId sid, bool useEwma) {
+  const std::vector<std::string> ifaces = {"eth0","wifi0","lte0","sat0"};
+  TelemetryAgent ref(cfg_for(useEwma));
+  ShardedTelemetryAgent sh(cfg_for(useEwma), 3, 64);
+  std::vector<InterfaceId> ids;
+  for (auto& i : ifaces) {
+    ids.push_back(sh.register_interface(i));
+    const InterfaceId ref_id = ref.register_interface(i);
+    assert(ref_id == ids.back());
+  }
+  ScenarioGenerator gen(sid);
+  TransitionLog ref_log, sh_log;
+
+  for (int64_t t = 0; t < 150; ++t) {
+    ref.note_time(t);
+    sh.note_time(t);
+    assert_same(ref, sh);
+    append(ref_log, ref.drain_transitions());
+    append(sh_log, sh.drain_transitions());
+
+    for (std::size_t k = 0; k < ifaces.size(); ++k) {
+      auto g = gen.sample(ifaces[k], t);
+      if (!g) continue;
+      ref.ingest(ids[k], g->ts, g->m);
+      sh.ingest(ids[k], g->ts, g->m);
+    }
+  }
+  ref.note_time(150);
+  sh.note_time(150);
+  assert_same(ref, sh);
+  append(ref_log, ref.drain_transitions());
+  append(sh_log, sh.drain_transitions());
+  assert_same(ref_log, sh_log);
+}
+
+// Several producer threads, each owning a slice of the interfaces.
+static void multi_producer() {
+  constexpr int kProducers = 4;
+  constexpr int kIfaces = 64;
+  constexpr int64_t kTicks = 120;
+
+  const AgentConfig cfg = cfg_for(true);
+  TelemetryAgent ref(cfg);
+  ShardedTelemetryAgent sh(cfg, 3, 128); // small queues exercise backpressure
+  for (int i = 0; i < kIfaces; ++i) {
+    const std::string n = "vlan" + std::to_string(i);
+    const InterfaceId sh_id = sh.register_interface(n);
+    const InterfaceId ref_id = ref.register_interface(n);
+    assert(sh_id == ref_id);
+  }
+
+  auto metrics_for = [](int iface, int64_t t) {
+    const double u = static_cast<double>((iface * 7 + t * 3) % 50) / 50.0;
+    return Metrics{20 + 600 * u, 180 - 150 * u, 12 * u, 90 * u};
+  };
+
+  std::barrier sync(kProducers + 1);
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&, p] {
+      for (int64_t t = 0; t < kTicks; ++t) {
+        sync.arrive_and_wait(); // tick t has been issued
+        for (int i = p; i < kIfaces; i += kProducers) {
+          if ((i + t) % 9 == 0) continue; // some missing samples
+          sh.ingest(static_cast<InterfaceId>(i), t, metrics_for(i, t));
+        }
+        sync.arrive_and_wait(); // samples for t pushed
+      }
+    });
+  }
+
+  TransitionLog ref_log, sh_log;
+  for (int64_t t = 0; t < kTicks; ++t) {
+    ref.note_time(t);
+    for (int i = 0; i < kIfaces; ++i) {
+      if ((i + t) % 9 == 0) continue;
+      ref.ingest(static_cast<InterfaceId>(i), t, metrics_for(i, t));
+    }
+    sh.note_time(t);
+    append(sh_log, sh.drain_transitions());
+    sync.arrive_and_wait();
+    sync.arrive_and_wait();
+  }
+  for (auto& th : producers) th.join();
+
+  ref.note_time(kTicks);
+  sh.note_time(kTicks);
+  append(ref_log, ref.drain_transitions());
+  append(sh_log, sh.drain_transitions());
+  assert_same(ref, sh);
+  assert_same(ref_log, sh_log);
+}
+
+int main() {
+  for (ScenarioId sid : {ScenarioId::A, ScenarioId::B, ScenarioId::C, ScenarioId::D}) {
+    for (bool useEwma : {false, true}) single_producer(sid, useEwma);
+  }
+  multi_producer();
+
+  // Registration after the workers started, then ingest by name lookup.
+  {
+    ShardedTelemetryAgent sh(cfg_for(true), 2);
+    sh.note_time(0);
+    const InterfaceId a = sh.register_interface("late0");
+    const InterfaceId again = sh.register_interface("late0");
+    assert(again == a);
+    assert(sh.find_interface("late0").value() == a);
+    sh.ingest(a, 1, Metrics{20, 180, 0.1, 3});
+    sh.note_time(1);
+    assert(sh.snapshots().size() == 1);
+    assert(sh.snapshots()[0].iface == "late0");
+    assert(sh.snapshots()[0].confidence > 0.0);
+  }
+
+  std::printf("test_sharded_agent OK\n");
+  return 0;
+}
@@ -0,0 +1,229 @@
+#include <cassert>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "scenarios.hpp"
+#include "snapshot_export.hpp"
+#include "telemetry_agent.hpp"
+
+using namespace telemetry;
+
+[[maybe_unused]] static bool same(const WireSnapshot& w, InterfaceId id, const InterfaceSnapshot& s) {
+  return w.id == id && w.status == static_cast<uint8_t>(s.status) && w.score_raw == s.score_raw &&
+         w.score_smoothed == s.score_smoothed && w.score_used == s.score_used && w.confidence == s.confidence &&
+         w.missing_rate == s.missing_rate && w.avg_tp_mbps == s.avg_tp_mbps && w.avg_rtt_ms == s.avg_rtt_ms &&
+         w.avg_loss_pct == s.avg_loss_pct && w.avg_jitter_ms == s.avg_jitter_ms;
+}
+
+[[maybe_unused]] static bool same(const WireTransition& w, const TransitionEvent& ev) {
+  return w.id == ev.id && w.ts == ev.ts && w.from == static_cast<uint8_t>(ev.from) &&
+         w.to == static_cast<uint8_t>(ev.to) && w.reason == static_cast<uint8_t>(ev.reason);
+}
+
+static void check_tick([[maybe_unused]] const FrameView& f, const TelemetryAgent& agent,
+                       [[maybe_unused]] int64_t t, const std::vector<TransitionEvent>& events) {
+  assert(f.header.kind == FrameKind::Tick && f.header.tick_ts == t);
+  assert(f.snapshots.size() == agent.size() && f.events.size() == events.size());
+  for (InterfaceId id = 0; id < agent.size(); ++id) assert(same(f.snapshots[id], id, agent.snapshot(id)));
+  for (std::size_t k = 0; k < events.size(); ++k) assert(same(f.events[k], events[k]));
+}
+
+[[maybe_unused]] static bool parse_throws(std::vector<uint64_t> words) {
+  try {
+    (void)parse_frame(words);
+  } catch (const std::runtime_error&) {
+    return true;
+  }
+  return false;
+}
+
+int main() {
+  const ScenarioGenerator gen(ScenarioId::B);
+  const std::vector<std::string> ifaces = {"eth0", "wifi0", "lte0", "sat0"};
+
+  // Socket sink: names first, then one Tick frame per publish; an interface
+  // added mid-run is announced on its own.
+  {
+    int fds[2];
+    const int paired = ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    assert(paired == 0);
+    SocketSnapshotSink sink(fds[0]);
+
+    TelemetryAgent agent;
+    for (std::size_t k = 0; k + 1 < ifaces.size(); ++k) agent.register_interface(ifaces[k]);
+    std::vector<std::string> names;
+    std::vector<uint64_t> words;
+    std::size_t total_events = 0;
+    uint64_t expect_seq = 0;
+    for (int64_t t = 0; t < 120; ++t) {
+      if (t == 60) agent.register_interface(ifaces.back());
+      agent.note_time(t);
+      for (InterfaceId id = 0; id < agent.size(); ++id) {
+        if (const auto g = gen.sample(ifaces[id], t)) agent.ingest(id, g->ts, g->m);
+      }
+      const std::vector<TransitionEvent> events = agent.drain_transitions();
+      total_events += events.size();
+      sink.publish(agent, t, events);
+
+      if (t == 0 || t == 60) {
+        const bool got = read_frame(fds[1], words);
+        assert(got);
+        const FrameView f = parse_frame(words);
+        assert(f.header.kind == FrameKind::Names && f.header.seq == expect_seq);
+        ++expect_seq;
+        assert(f.header.name_count == (t == 0 ? 3u : 1u));
+        decode_names(f, names);
+        assert(names.size() == agent.size());
+      }
+      const bool got = read_frame(fds[1], words);
+      assert(got);
+      const FrameView f = parse_frame(words);
+      assert(f.header.seq == expect_seq);
+      ++expect_seq;
+      check_tick(f, agent, t, events);
+    }
+    assert(names == ifaces);
+    assert(total_events > 0 && sink.frames() == expect_seq);
+
+    // Closing the sink ends the stream cleanly.
+    { SocketSnapshotSink gone(std::move(sink)); }
+    const bool more = read_frame(fds[1], words);
+    assert(!more);
+    ::close(fds[1]);
+  }
+
+  // Malformed frames are rejected.
+  {
+    TelemetryAgent agent;
+    agent.register_interface("eth0");
+    int fds[2];
+    const int paired = ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    assert(paired == 0);
+    {
+      SocketSnapshotSink sink(fds[0]);
+      sink.publish(agent, 0, {});
+    }
+    std::vector<uint64_t> words;
+    const bool names = read_frame(fds[1], words);
+    const bool tick = read_frame(fds[1], words);
+    assert(names && tick);
+    ::close(fds[1]);
+    assert(!parse_throws(words) && !words.empty());
+    auto bad = words;
+    if (!bad.empty()) bad.pop_back();
+    assert(parse_throws(bad));
+    bad = words;
+    bad[0] ^= 1; // magic
+    assert(parse_throws(bad));
+    assert(parse_throws({1, 2}));
+  }
+
+  // Shared-memory ring, single threaded: the latest frame, lapped frames and
+  // the name table.
+  const std::string shm = "/test_snapshot_export_" + std::to_string(::getpid());
+  {
+    ShmRingConfig cfg;
+    cfg.slot_count = 4;
+    cfg.max_interfaces = 8;
+    cfg.max_events = 16;
+    ShmSnapshotRing ring(shm, cfg);
+    ShmSnapshotReader reader(shm);
+    std::vector<uint64_t> words;
+    std::vector<std::string> names;
+    const bool early = reader.read_latest(words);
+    assert(reader.published() == 0 && !early);
+    const ShmRead none = reader.read(0, words);
+    assert(none == ShmRead::NotReady);
+
+    TelemetryAgent agent;
+    for (const auto& i : ifaces) agent.register_interface(i);
+    for (int64_t t = 0; t < 50; ++t) {
+      agent.note_time(t);
+      for (InterfaceId id = 0; id < agent.size(); ++id) {
+        if (const auto g = gen.sample(ifaces[id], t)) agent.ingest(id, g->ts, g->m);
+      }
+      const std::vector<TransitionEvent> events = agent.drain_transitions();
+      ring.publish(agent, t, events);
+      const bool got = reader.read_latest(words);
+      assert(got);
+      const FrameView f = parse_frame(words);
+      assert(f.header.seq == static_cast<uint64_t>(t));
+      check_tick(f, agent, t, events);
+    }
+    assert(reader.published() == 50 && ring.frames() == 50);
+    const ShmRead lapped = reader.read(49 - 4, words);
+    assert(lapped == ShmRead::Overrun);
+    const ShmRead oldest = reader.read(49 - 3, words);
+    assert(oldest == ShmRead::Ok && parse_frame(words).header.tick_ts == 46);
+    const ShmRead ahead = reader.read(50, words);
+    assert(ahead == ShmRead::NotReady);
+    const bool named = reader.names(names);
+    assert(named && names == ifaces);
+
+    agent.register_interface("if4");
+    ring.publish(agent, 50, {});
+    const bool renamed = reader.names(names);
+    assert(renamed && names.size() == 5 && names[4] == "if4");
+
+    for (int i = 0; i < 4; ++i) agent.register_interface("extra" + std::to_string(i));
+    bool threw = false;
+    try {
+      ring.publish(agent, 51, {});
+    } catch (const std::length_error&) {
+      threw = true;
+    }
+    assert(threw);
+  }
+
+  // Once the writer is gone the name is unlinked.
+  {
+    bool threw = false;
+    try {
+      ShmSnapshotReader gone(shm);
+    } catch (const std::runtime_error&) {
+      threw = true;
+    }
+    assert(threw);
+  }
+
+  // Concurrent reader: every frame it accepts is complete and consistent.
+  {
+    ShmRingConfig cfg;
+    cfg.slot_count = 2;
+    cfg.max_interfaces = 64;
+    ShmSnapshotRing ring(shm, cfg);
+    ShmSnapshotReader reader(shm);
+
+    TelemetryAgent agent;
+    for (int i = 0; i < 64; ++i) agent.register_interface("if" + std::to_string(i));
+    constexpr int64_t kTicks = 3000;
+    std::thread consumer([&] {
+      std::vector<uint64_t> words;
+      uint64_t last = 0;
+      while (last < kTicks) {
+        if (!reader.read_latest(words)) continue;
+        const FrameView f = parse_frame(words);
+        assert(f.header.seq + 1 >= last && f.snapshots.size() == 64);
+        for (InterfaceId id = 0; id < 64; ++id) {
+          assert(f.snapshots[id].id == id && f.snapshots[id].avg_rtt_ms == f.snapshots[0].avg_rtt_ms);
+        }
+        last = f.header.seq + 1;
+      }
+    });
+    for (int64_t t = 0; t < kTicks; ++t) {
+      agent.note_time(t);
+      for (InterfaceId id = 0; id < 64; ++id) agent.ingest(id, t, Metrics{10.0 + static_cast<double>(t % 50), 100, 0, 1});
+      ring.publish(agent, t, {});
+    }
+    consumer.join();
+  }
+
+  std::printf("test_snapshot_export OK\n");
+  return 0;
+}
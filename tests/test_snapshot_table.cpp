@@ -0,0 +1,151 @@
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "scenarios.hpp"
+#include "snapshot_table.hpp"
+#include "telemetry_agent.hpp"
+
+using namespace telemetry;
+
+// Count heap allocations so the reader path can be checked allocation-free.
+static std::atomic<long> g_allocs{0};
+
+void* operator new(std::size_t n) {
+  g_allocs.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+static void assert_same([[maybe_unused]] const InterfaceSnapshot& a, [[maybe_unused]] const PublishedSnapshot& b) {
+  assert(a.status == b.status);
+  assert(a.score_raw == b.score_raw);
+  assert(a.score_smoothed == b.score_smoothed);
+  assert(a.score_used == b.score_used);
+  assert(a.confidence == b.confidence);
+  assert(a.missing_rate == b.missing_rate);
+  assert(a.avg_tp_mbps == b.avg_tp_mbps);
+  assert(a.avg_rtt_ms == b.avg_rtt_ms);
+  assert(a.avg_loss_pct == b.avg_loss_pct);
+  assert(a.avg_jitter_ms == b.avg_jitter_ms);
+}
+
+// Every field of entry i in the tick published at ts encodes (ts, i), so a
+// reader can tell a torn or mixed-tick copy from a consistent one.
+static InterfaceSnapshot encoded(int64_t ts, std::size_t i) {
+  InterfaceSnapshot s;
+  const double v = static_cast<double>(ts) * 1e4 + static_cast<double>(i);
+  s.status = static_cast<IfStatus>((ts + i) % 3);
+  s.score_raw = s.score_smoothed = s.score_used = v;
+  s.confidence = s.missing_rate = v;
+  s.avg_tp_mbps = s.avg_rtt_ms = s.avg_loss_pct = s.avg_jitter_ms = v;
+  return s;
+}
+
+[[maybe_unused]] static bool consistent(int64_t ts, std::size_t i, const PublishedSnapshot& p) {
+  const InterfaceSnapshot e = encoded(ts, i);
+  return p.status == e.status && p.score_raw == e.score_used && p.score_smoothed == e.score_used &&
+         p.score_used == e.score_used && p.confidence == e.score_used && p.missing_rate == e.score_used &&
+         p.avg_tp_mbps == e.score_used && p.avg_rtt_ms == e.score_used &&
+         p.avg_loss_pct == e.score_used && p.avg_jitter_ms == e.score_used;
+}
+
+int main() {
+  // Published table mirrors the agent's snapshots as of each note_time().
+  {
+    TelemetryAgent agent;
+    const std::vector<std::string> ifaces = {"eth0", "wifi0", "lte0", "sat0"};
+    for (const auto& n : ifaces) agent.register_interface(n);
+    const SnapshotTable& pub = agent.published();
+    assert(pub.size() == 0 && pub.version() == 0);
+
+    ScenarioGenerator gen(ScenarioId::B);
+    PublishedSnapshot p;
+    int64_t ts = -1;
+    for (int64_t t = 0; t < 120; ++t) {
+      agent.note_time(t);
+      assert(pub.version() == static_cast<uint64_t>(t + 1));
+      assert(pub.size() == ifaces.size());
+      for (InterfaceId id = 0; id < agent.size(); ++id) {
+        const bool got = pub.read(id, p, &ts);
+        assert(got && ts == t);
+        assert_same(agent.snapshot(id), p);
+      }
+      const bool past_end = pub.read(static_cast<InterfaceId>(ifaces.size()), p);
+      assert(!past_end);
+
+      std::vector<PublishedSnapshot> two(2);
+      const std::size_t read = pub.read_all(two);
+      assert(read == 2);
+      assert_same(agent.snapshot(1), two[1]);
+
+      for (InterfaceId id = 0; id < agent.size(); ++id) {
+        if (auto g = gen.sample(ifaces[id], t)) agent.ingest(id, g->ts, g->m);
+      }
+    }
+  }
+
+  // Concurrent readers see whole ticks while the writer publishes and grows
+  // the table across chunk boundaries; reads never allocate.
+  {
+    constexpr std::size_t kMax = 3 * SnapshotTable::kChunk + 17;
+    constexpr int64_t kTicks = 1500;
+    SnapshotTable table;
+    std::atomic<bool> done{false};
+    std::atomic<long> reads{0};
+
+    auto reader = [&] {
+      std::vector<PublishedSnapshot> buf(kMax);
+      PublishedSnapshot one;
+      long local_reads = 0;
+      while (!done.load(std::memory_order_acquire)) {
+        int64_t ts = -1;
+        const std::size_t n = table.read_all(buf, &ts);
+        for (std::size_t i = 0; i < n; ++i) assert(consistent(ts, i, buf[i]));
+        if (n > 0) {
+          const auto id = static_cast<InterfaceId>(local_reads % n);
+          if (table.read(id, one, &ts)) assert(consistent(ts, id, one));
+        }
+        ++local_reads;
+      }
+      reads.fetch_add(local_reads);
+    };
+
+    std::thread r1(reader), r2(reader);
+    std::vector<InterfaceSnapshot> scratch(kMax);
+    for (int64_t t = 1; t <= kTicks; ++t) {
+      const std::size_t n = 1 + static_cast<std::size_t>(t - 1) * (kMax - 1) / (kTicks - 1);
+      for (std::size_t i = 0; i < n; ++i) scratch[i] = encoded(t, i);
+      table.publish(t, n, [&](InterfaceId id) -> const InterfaceSnapshot& { return scratch[id]; });
+    }
+    done.store(true, std::memory_order_release);
+    r1.join();
+    r2.join();
+    assert(reads.load() > 0);
+    assert(table.version() == static_cast<uint64_t>(kTicks));
+    assert(table.size() == kMax);
+
+    // Steady-state reads and re-publishes at the same size are allocation-free.
+    std::vector<PublishedSnapshot> buf(kMax);
+    const long before = g_allocs.load();
+    for (int64_t t = kTicks + 1; t < kTicks + 100; ++t) {
+      for (std::size_t i = 0; i < kMax; ++i) scratch[i] = encoded(t, i);
+      table.publish(t, kMax, [&](InterfaceId id) -> const InterfaceSnapshot& { return scratch[id]; });
+      int64_t ts = -1;
+      const std::size_t read = table.read_all(buf, &ts);
+      assert(read == kMax);
+      assert(ts == t && consistent(t, kMax - 1, buf[kMax - 1]));
+    }
+    assert(g_allocs.load() == before);
+  }
+
+  std::printf("test_snapshot_table OK\n");
+  return 0;
+}
@@ -0,0 +1,138 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "fleet_generator.hpp"
+#include "telemetry_agent.hpp"
+#include "tick_arena.hpp"
+
+using namespace telemetry;
+
+// Count heap allocations so the steady-state tick loop can be checked
+// allocation-free.
+static long g_allocs = 0;
+
+void* operator new(std::size_t n) {
+  ++g_allocs;
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+[[maybe_unused]] static bool same(const PublishedSnapshot& a, const InterfaceSnapshot& b) {
+  return a.status == b.status && a.score_raw == b.score_raw && a.score_smoothed == b.score_smoothed &&
+         a.score_used == b.score_used && a.confidence == b.confidence && a.missing_rate == b.missing_rate &&
+         a.avg_tp_mbps == b.avg_tp_mbps && a.avg_rtt_ms == b.avg_rtt_ms && a.avg_loss_pct == b.avg_loss_pct &&
+         a.avg_jitter_ms == b.avg_jitter_ms;
+}
+
+// A reserved agent driven by a FleetGenerator: after registration, the tick
+// loop with every per-tick query in its span / pmr form allocates nothing.
+// Returns the transitions seen.
+static std::size_t check_steady_state(AgentConfig cfg, bool batch) {
+  constexpr std::size_t kIfaces = 2000;
+  FleetConfig fc;
+  fc.interfaces = kIfaces;
+  fc.missing_rate = 0.05;
+  fc.late_rate = 0.02;
+  const FleetGenerator fleet(fc);
+
+  TelemetryAgent agent(cfg);
+  agent.reserve(kIfaces);
+  for (std::size_t i = 0; i < kIfaces; ++i) agent.register_interface("interface-with-a-long-name-" + std::to_string(i));
+
+  std::vector<Sample> samples(kIfaces);
+  std::vector<InterfaceId> best(8);
+  std::vector<TransitionEvent> events(64);
+  std::vector<PublishedSnapshot> published(kIfaces);
+  TickArena arena(1 << 20);
+  std::size_t transitions = 0;
+
+  const long before = g_allocs;
+  for (int64_t t = 0; t < 300; ++t) {
+    const std::size_t n = fleet.tick(t, samples);
+    if (batch) {
+      agent.ingest_batch(std::span<const Sample>(samples.data(), n));
+    } else {
+      for (std::size_t i = 0; i < n; ++i) agent.ingest(samples[i].id, samples[i].ts, samples[i].m);
+    }
+    agent.note_time(t);
+    agent.record_tick();
+
+    (void)agent.best_interfaces(best.size(), IfStatus::Degraded, best);
+    (void)agent.published().read_all(published);
+    if (t % 2 == 0) {
+      transitions += agent.drain_transitions(events);
+    } else {
+      transitions += agent.drain_transitions(&arena).size();
+    }
+    const auto snaps = agent.snapshots(&arena);
+    const auto ranked = agent.summary_ranked(&arena);
+    assert(snaps.size() == kIfaces && ranked.size() == kIfaces);
+    arena.reset();
+  }
+  assert(g_allocs == before);
+  assert(arena.overflows() == 0 && arena.high_water() > 0);
+
+  // The pmr forms agree with the allocating ones.
+  const auto snaps = agent.snapshots(&arena);
+  for (InterfaceId id = 0; id < kIfaces; ++id) assert(same(snaps[id], agent.snapshot(id)));
+  const auto ranked = agent.summary_ranked(&arena);
+  const auto items = agent.summary_ranked();
+  for (std::size_t i = 0; i < kIfaces; ++i) {
+    assert(agent.tracker(ranked[i].id).iface() == items[i].iface);
+    assert(ranked[i].avg_score == items[i].avg_score && ranked[i].last_status == items[i].last_status);
+  }
+  return transitions;
+}
+
+int main() {
+  // TickArena: aligned bump allocation, reset() reuses the block, overflow
+  // throws with the default upstream and is forwarded otherwise.
+  {
+    TickArena arena(256);
+    void* a = arena.allocate(3, 1);
+    void* b = arena.allocate(16, 16);
+    assert(reinterpret_cast<std::uintptr_t>(b) % 16 == 0 && b != a);
+    assert(arena.used() >= 19 && arena.used() <= 35);
+    arena.deallocate(b, 16, 16); // no-op
+    arena.reset();
+    assert(arena.used() == 0 && arena.allocate(3, 1) == a);
+    assert(arena.high_water() >= 19);
+
+    bool threw = false;
+    try {
+      (void)arena.allocate(300, 8);
+    } catch (const std::bad_alloc&) {
+      threw = true;
+    }
+    assert(threw && arena.overflows() == 1 && arena.high_water() > 256);
+
+    TickArena spill(64, std::pmr::new_delete_resource());
+    std::pmr::vector<int> v(&spill);
+    for (int i = 0; i < 100; ++i) v.push_back(i); // regrowth frees spilled blocks upstream
+    assert(spill.overflows() > 0 && v[99] == 99);
+  }
+
+  AgentConfig base;
+  base.fsm.min_dwell_sec = 2;
+  AgentConfig per_tick = base;
+  per_tick.recompute = RecomputeMode::PerTick;
+  AgentConfig active = base;
+  active.tick_scan = TickScan::Active;
+
+  std::size_t transitions = 0;
+  for (const AgentConfig& cfg : {base, per_tick, active}) {
+    transitions += check_steady_state(cfg, false);
+    transitions += check_steady_state(cfg, true);
+  }
+  assert(transitions > 0);
+
+  std::printf("test_tick_arena OK (transitions=%zu)\n", transitions);
+  return 0;
+}
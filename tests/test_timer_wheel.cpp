@@ -0,0 +1,219 @@
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "telemetry_agent.hpp"
+#include "timer_wheel.hpp"
+
+using namespace telemetry;
+
+[[maybe_unused]] static bool same(const InterfaceSnapshot& a, const InterfaceSnapshot& b) {
+  auto eq = [](double x, double y) { return std::memcmp(&x, &y, sizeof x) == 0; };
+  return a.status == b.status && eq(a.score_raw, b.score_raw) && eq(a.score_smoothed, b.score_smoothed) &&
+         eq(a.score_used, b.score_used) && eq(a.confidence, b.confidence) && eq(a.missing_rate, b.missing_rate) &&
+         eq(a.avg_tp_mbps, b.avg_tp_mbps) && eq(a.avg_rtt_ms, b.avg_rtt_ms) && eq(a.avg_loss_pct, b.avg_loss_pct) &&
+         eq(a.avg_jitter_ms, b.avg_jitter_ms);
+}
+
+[[maybe_unused]] static bool same(const PublishedSnapshot& a, const InterfaceSnapshot& b) {
+  InterfaceSnapshot c = b;
+  c.status = a.status;
+  c.score_raw = a.score_raw;
+  c.score_smoothed = a.score_smoothed;
+  c.score_used = a.score_used;
+  c.confidence = a.confidence;
+  c.missing_rate = a.missing_rate;
+  c.avg_tp_mbps = a.avg_tp_mbps;
+  c.avg_rtt_ms = a.avg_rtt_ms;
+  c.avg_loss_pct = a.avg_loss_pct;
+  c.avg_jitter_ms = a.avg_jitter_ms;
+  return same(c, b);
+}
+
+// Runs a mixed fleet through an All and an Active agent in lockstep and
+// checks that every snapshot, transition and published tick agrees.
+static void check_equivalent(AgentConfig cfg, bool batch, uint32_t seed) {
+  constexpr int kIfaces = 200;
+  AgentConfig all_cfg = cfg;
+  all_cfg.tick_scan = TickScan::All;
+  AgentConfig active_cfg = cfg;
+  active_cfg.tick_scan = TickScan::Active;
+  TelemetryAgent all(all_cfg), active(active_cfg);
+  for (int i = 0; i < kIfaces; ++i) {
+    all.register_interface("if" + std::to_string(i));
+    active.register_interface("if" + std::to_string(i));
+  }
+
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  std::vector<Sample> samples;
+  std::vector<PublishedSnapshot> pub(kIfaces);
+  std::size_t min_active = kIfaces;
+  int64_t t = 1000;
+  for (int step = 0; step < 1500; ++step) {
+    t += (step % 400 == 399) ? 120 : 1; // occasional idle gap
+
+    samples.clear();
+    for (int i = 0; i < kIfaces; ++i) {
+      // 0-9 always report; 10-49 report in bursts; the rest stop after a while.
+      bool reports = false;
+      if (i < 10) reports = true;
+      else if (i < 50) reports = ((t / 60 + i) % 7) == 0;
+      else reports = step < 100 + 2 * i && (u(rng) < 0.8);
+      if (!reports) continue;
+      const double bad = ((t / 30 + i) % 4 == 0) ? 0.9 : 0.2 * u(rng);
+      const Metrics m{20.0 + 600.0 * bad, 190.0 - 150.0 * bad, 20.0 * bad, 120.0 * bad};
+      const int64_t ts = (u(rng) < 0.1) ? t - static_cast<int64_t>(u(rng) * 50.0) : t; // some late
+      samples.push_back(Sample{static_cast<InterfaceId>(i), ts, m});
+      if (u(rng) < 0.2) samples.push_back(Sample{static_cast<InterfaceId>(i), ts, m}); // same second again
+    }
+    if (batch) {
+      all.ingest_batch(samples);
+      active.ingest_batch(samples);
+    } else {
+      for (const Sample& s : samples) {
+        all.ingest(s.id, s.ts, s.m);
+        active.ingest(s.id, s.ts, s.m);
+      }
+    }
+
+    const int repeats = (step % 97 == 0) ? 2 : 1; // repeated ticks too
+    for (int r = 0; r < repeats; ++r) {
+      all.note_time(t);
+      active.note_time(t);
+    }
+    min_active = std::min(min_active, active.active_count());
+
+    for (InterfaceId id = 0; id < kIfaces; ++id) assert(same(all.snapshot(id), active.snapshot(id)));
+
+    const auto ea = all.drain_transitions();
+    const auto eb = active.drain_transitions();
+    assert(ea.size() == eb.size());
+    for (std::size_t k = 0; k < ea.size(); ++k) {
+      assert(ea[k].id == eb[k].id && ea[k].ts == eb[k].ts && ea[k].from == eb[k].from &&
+             ea[k].to == eb[k].to && ea[k].reason == eb[k].reason);
+    }
+
+    int64_t pub_ts = 0;
+    [[maybe_unused]] const std::size_t published = active.published().read_all(pub, &pub_ts);
+    assert(published == kIfaces && pub_ts == t);
+    for (InterfaceId id = 0; id < kIfaces; ++id) assert(same(pub[id], all.snapshot(id)));
+  }
+
+  // Once the stopped interfaces settle, ticks leave them alone.
+  assert(all.active_count() == kIfaces);
+  assert(min_active < kIfaces / 2);
+  if constexpr (kInstrumentationEnabled) {
+    assert(active.stats().totals.recomputes < all.stats().totals.recomputes);
+  }
+}
+
+int main() {
+  // TimerWheel against a brute-force deadline map: random arming, re-arming,
+  // cancelling and advancing with small steps and huge jumps.
+  {
+    constexpr std::size_t kIds = 500;
+    TimerWheel w;
+    w.resize(kIds);
+    std::map<TimerWheel::Id, int64_t> ref;
+    std::mt19937_64 rng(7);
+    int64_t now = -5000;
+    w.advance(now, [](TimerWheel::Id) { assert(false); });
+    for (int i = 0; i < 200000; ++i) {
+      const auto id = static_cast<TimerWheel::Id>(rng() % kIds);
+      switch (rng() % 8) {
+        case 0: case 1: case 2: {
+          static const int64_t kSpans[] = {3, 70, 5000, 300000, 40000000, int64_t{1} << 40};
+          const int64_t at = now - 2 + static_cast<int64_t>(rng() % static_cast<uint64_t>(kSpans[rng() % 6]));
+          w.schedule(id, at);
+          ref[id] = at;
+          break;
+        }
+        case 3:
+          w.cancel(id);
+          ref.erase(id);
+          break;
+        default: {
+          const uint64_t r = rng() % 1000;
+          now += r < 900 ? static_cast<int64_t>(r % 4) : r < 995 ? static_cast<int64_t>(rng() % 100000)
+                                                                 : static_cast<int64_t>(rng() % (int64_t{1} << 41));
+          w.advance(now, [&](TimerWheel::Id fired) {
+            auto it = ref.find(fired);
+            assert(it != ref.end() && it->second <= now);
+            ref.erase(it);
+          });
+          for ([[maybe_unused]] const auto& [rid, at] : ref) assert(at > now);
+          break;
+        }
+      }
+      assert(w.size() == ref.size());
+      const auto it = ref.find(id);
+      assert(w.scheduled(id) == (it != ref.end()));
+      if (it != ref.end()) assert(w.deadline(id) == it->second);
+    }
+    assert(w.now() == now);
+  }
+
+  // Callbacks may re-arm timers, including for the current advance().
+  {
+    TimerWheel w;
+    w.resize(2);
+    w.advance(0, [](TimerWheel::Id) {});
+    w.schedule(0, 10);
+    int fired = 0;
+    w.advance(100, [&](TimerWheel::Id id) {
+      ++fired;
+      if (fired == 1) w.schedule(id, 50); // still <= 100: fires again now
+      if (fired == 2) w.schedule(id, 1000);
+    });
+    assert(fired == 2 && w.scheduled(0) && w.deadline(0) == 1000);
+  }
+
+  // TickScan::Active is indistinguishable from visiting every tracker.
+  {
+    AgentConfig cfg;
+    check_equivalent(cfg, false, 1);
+    check_equivalent(cfg, true, 2);
+
+    cfg.recompute = RecomputeMode::PerTick;
+    check_equivalent(cfg, false, 3);
+
+    AgentConfig sharp;
+    sharp.score.useEwma = false;
+    sharp.score.enable_downtrend_penalty = true;
+    sharp.fsm.min_dwell_sec = 30;
+    sharp.fsm.force_down_if_confidence_below = 0.2;
+    check_equivalent(sharp, false, 4);
+
+    AgentConfig penalty;
+    penalty.score.enable_downtrend_penalty = true;
+    penalty.same_second = SameSecond::Average;
+    penalty.fsm.min_dwell_sec = 0;
+    check_equivalent(penalty, true, 5);
+  }
+
+  // A silent interface stops being visited once nothing can change, and a
+  // sample brings it straight back.
+  {
+    AgentConfig cfg;
+    cfg.tick_scan = TickScan::Active;
+    TelemetryAgent agent(cfg);
+    const InterfaceId id = agent.register_interface("eth0");
+    agent.register_interface("wlan0");
+    for (int64_t t = 0; t < 300; ++t) {
+      if (t < 60) agent.ingest(id, t, Metrics{30, 180, 0.1, 3});
+      agent.note_time(t);
+    }
+    assert(agent.active_count() == 0);
+    agent.ingest(id, 300, Metrics{30, 180, 0.1, 3});
+    assert(agent.active_count() == 1);
+    agent.note_time(300);
+    assert(agent.snapshot(id).confidence == 1.0 / RollingWindow::kWindow);
+  }
+
+  std::printf("test_timer_wheel OK\n");
+  return 0;
+}
@@ -0,0 +1,197 @@
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "scenarios.hpp"
+#include "telemetry_agent.hpp"
+#include "trace_file.hpp"
+
+using namespace telemetry;
+
+static bool same(const InterfaceSnapshot& a, const InterfaceSnapshot& b) {
+  return a.iface == b.iface && a.status == b.status && a.score_raw == b.score_raw &&
+         a.score_smoothed == b.score_smoothed && a.score_used == b.score_used &&
+         a.confidence == b.confidence && a.avg_rtt_ms == b.avg_rtt_ms;
+}
+
+[[maybe_unused]] static bool throws(const std::string& path) {
+  try {
+    TraceReader r(path);
+  } catch (const std::runtime_error&) {
+    return true;
+  }
+  return false;
+}
+
+int main() {
+  const auto dir = std::filesystem::temp_directory_path();
+  const std::string path = (dir / "test_trace_file.trace").string();
+
+  // Record a run with late and missing samples, single and batched ingest;
+  // some batches carry two samples for one interface, which only replays
+  // exactly as one ingest_batch().
+  ImperfectDataConfig imp;
+  imp.enable_missing = true;
+  imp.enable_late = true;
+  const ScenarioGenerator gen(ScenarioId::B, imp);
+  const std::vector<std::string> ifaces = {"eth0", "wifi0", "lte0", "sat0"};
+
+  std::vector<InterfaceSnapshot> recorded;
+  std::vector<TransitionEvent> recorded_events;
+  uint64_t samples = 0, ticks = 0, batches = 0;
+  {
+    TraceWriter w(path);
+    TelemetryAgent agent;
+    agent.register_interface(ifaces[0]); // before recording: named on attach
+    agent.record_to(&w);
+    for (std::size_t k = 1; k < ifaces.size(); ++k) agent.register_interface(ifaces[k]);
+
+    std::vector<Sample> batch;
+    for (int64_t t = 0; t < 200; ++t) {
+      agent.note_time(t);
+      ++ticks;
+      batch.clear();
+      for (InterfaceId id = 0; id < ifaces.size(); ++id) {
+        const auto g = gen.sample(ifaces[id], t);
+        if (!g) continue;
+        ++samples;
+        if (t % 2) {
+          agent.ingest(id, g->ts, g->m);
+        } else {
+          batch.push_back(Sample{id, g->ts, g->m});
+          if (t % 4 == 0 && id == 0) {
+            Metrics spike = g->m;
+            spike.rtt_ms += 400.0;
+            batch.push_back(Sample{id, g->ts - 1, spike});
+            ++samples;
+          }
+        }
+      }
+      batches += !batch.empty();
+      agent.ingest_batch(batch);
+      for (const auto& ev : agent.drain_transitions()) recorded_events.push_back(ev);
+    }
+    agent.record_to(nullptr);
+    agent.note_time(1000); // not recorded
+    recorded = agent.snapshots();
+    for (const auto& ev : agent.drain_transitions()) recorded_events.push_back(ev);
+    w.close();
+    assert(w.records() == samples + ticks + 2 * batches);
+  }
+
+  // The mapped trace holds exactly what the agent saw.
+  {
+    TraceReader r(path);
+    assert(r.header().record_count == samples + ticks + 2 * batches);
+    assert(r.header().flags == 0); // default config
+    assert(r.names().size() == ifaces.size());
+    for (std::size_t k = 0; k < ifaces.size(); ++k) assert(r.names()[k] == ifaces[k]);
+    assert(r.records().front().is_tick() && r.records().front().ts == 0);
+    uint64_t n_ticks = 0;
+    uint64_t n_samples = 0;
+    for (const auto& rec : r.records()) {
+      n_ticks += rec.is_tick();
+      n_samples += rec.is_sample();
+    }
+    assert(n_ticks == ticks && n_samples == samples);
+
+    // Replaying the recorded calls reproduces the recorded run; feeding the
+    // batched samples one by one does not.
+    TelemetryAgent replay, loose;
+    for (const auto& name : r.names()) {
+      replay.register_interface(name);
+      loose.register_interface(name);
+    }
+    std::vector<TransitionEvent> events;
+    std::vector<Sample> batch;
+    bool in_batch = false;
+    for (const auto& rec : r.records()) {
+      if (rec.is_tick()) {
+        replay.note_time(rec.ts);
+        loose.note_time(rec.ts);
+      } else if (rec.iface == TraceRecord::kBatchBegin) {
+        in_batch = true;
+      } else if (rec.iface == TraceRecord::kBatchEnd) {
+        replay.ingest_batch(batch);
+        batch.clear();
+        in_batch = false;
+      } else {
+        if (in_batch) {
+          batch.push_back(Sample{rec.iface, rec.ts, rec.metrics()});
+        } else {
+          replay.ingest(rec.iface, rec.ts, rec.metrics());
+        }
+        loose.ingest(rec.iface, rec.ts, rec.metrics());
+      }
+      for (const auto& ev : replay.drain_transitions()) events.push_back(ev);
+    }
+    replay.note_time(1000);
+    for (const auto& ev : replay.drain_transitions()) events.push_back(ev);
+    for (InterfaceId id = 0; id < ifaces.size(); ++id) assert(same(replay.snapshot(id), recorded[id]));
+    loose.note_time(1000);
+    const bool diverged = !same(loose.snapshot(0), recorded[0]);
+    assert(diverged);
+    assert(events.size() == recorded_events.size() && !events.empty());
+    for (std::size_t k = 0; k < events.size(); ++k) {
+      assert(events[k].id == recorded_events[k].id && events[k].ts == recorded_events[k].ts &&
+             events[k].to == recorded_events[k].to && events[k].reason == recorded_events[k].reason);
+    }
+  }
+
+  // Damaged and foreign files are rejected.
+  {
+    const std::string bad = (dir / "test_trace_file.bad").string();
+    std::filesystem::copy_file(path, bad, std::filesystem::copy_options::overwrite_existing);
+    std::filesystem::resize_file(bad, std::filesystem::file_size(path) - 100);
+    assert(throws(bad));
+    std::filesystem::resize_file(bad, 10);
+    assert(throws(bad));
+    {
+      std::FILE* f = std::fopen(bad.c_str(), "wb");
+      const TraceHeader h{}; // zero magic: an unfinished recording
+      std::fwrite(&h, sizeof h, 1, f);
+      std::fclose(f);
+    }
+    assert(throws(bad));
+    assert(throws((dir / "test_trace_file.missing").string()));
+
+    // Sample ids are bounded by the name table, so a corrupt id cannot make
+    // a replay register billions of interfaces.
+    for (const uint32_t id : {1u, 0xFFFFFFF0u}) {
+      TraceWriter w(bad);
+      w.name(0, "eth0");
+      w.sample(0, 0, Metrics{20.0, 100.0, 0.0, 1.0});
+      w.sample(id, 1, Metrics{20.0, 100.0, 0.0, 1.0});
+      w.close();
+      assert(throws(bad));
+    }
+    std::filesystem::remove(bad);
+  }
+
+  // The header keeps the settings a replay needs.
+  {
+    AgentConfig cfg;
+    cfg.score.useEwma = false;
+    cfg.same_second = SameSecond::Average;
+    {
+      TraceWriter w(path);
+      TelemetryAgent agent(cfg);
+      agent.record_to(&w);
+      agent.register_interface("eth0");
+      agent.note_time(0);
+      w.close();
+    }
+    const TraceReader r(path);
+    assert(r.header().flags == (TraceHeader::kNoEwma | TraceHeader::kSameSecondAverage));
+    AgentConfig back;
+    r.header().apply_config(back);
+    assert(!back.score.useEwma && back.recompute == RecomputeMode::Eager && back.same_second == SameSecond::Average);
+  }
+
+  std::filesystem::remove(path);
+  std::printf("test_trace_file OK\n");
+  return 0;
+}
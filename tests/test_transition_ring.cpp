@@ -0,0 +1,123 @@
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "telemetry_agent.hpp"
+#include "transition_ring.hpp"
+
+using namespace telemetry;
+
+// Count heap allocations so the transition path can be checked allocation-free.
+static long g_allocs = 0;
+
+void* operator new(std::size_t n) {
+  ++g_allocs;
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+static TransitionEvent ev(int64_t ts) {
+  return TransitionEvent{static_cast<InterfaceId>(ts), ts, IfStatus::Degraded, IfStatus::Down,
+                         TransitionReason::DownEnter};
+}
+
+int main() {
+  // FIFO order, wrap-around and partial span drains.
+  {
+    TransitionRing r(TransitionLogConfig{4, OverflowPolicy::DropNewest});
+    assert(r.capacity() == 4 && r.empty());
+    for (int64_t t = 0; t < 3; ++t) r.push(ev(t));
+    TransitionEvent out[2];
+    const std::size_t first = r.drain(out);
+    assert(first == 2);
+    assert(out[0].ts == 0 && out[1].ts == 1);
+    for (int64_t t = 3; t < 6; ++t) r.push(ev(t)); // wraps
+    assert(r.size() == 4);
+    std::vector<int64_t> seen;
+    const std::size_t rest = r.drain([&](const TransitionEvent& e) { seen.push_back(e.ts); });
+    assert(rest == 4);
+    assert((seen == std::vector<int64_t>{2, 3, 4, 5}));
+    assert(r.empty() && r.stats().recorded == 6 && r.stats().dropped == 0);
+  }
+
+  // DropNewest keeps the oldest events and counts the rest.
+  {
+    TransitionRing r(TransitionLogConfig{3, OverflowPolicy::DropNewest});
+    for (int64_t t = 0; t < 10; ++t) r.push(ev(t));
+    assert(r.size() == 3);
+    assert(r.stats().recorded == 3 && r.stats().dropped == 7 && r.stats().overwritten == 0);
+    std::vector<int64_t> seen;
+    r.drain([&](const TransitionEvent& e) { seen.push_back(e.ts); });
+    assert((seen == std::vector<int64_t>{0, 1, 2}));
+  }
+
+  // OverwriteOldest keeps the newest events and counts the lost ones.
+  {
+    TransitionRing r(TransitionLogConfig{3, OverflowPolicy::OverwriteOldest});
+    for (int64_t t = 0; t < 10; ++t) r.push(ev(t));
+    assert(r.size() == 3);
+    assert(r.stats().recorded == 10 && r.stats().overwritten == 7 && r.stats().dropped == 0);
+    std::vector<int64_t> seen;
+    r.drain([&](const TransitionEvent& e) { seen.push_back(e.ts); });
+    assert((seen == std::vector<int64_t>{7, 8, 9}));
+  }
+
+  // Reasons carry the FSM's descriptive text.
+  assert(std::strcmp(to_string(TransitionReason::DownEnter), fsm_reason::kDownEnter) == 0);
+  assert(std::strcmp(to_string(TransitionReason::None), "") == 0);
+
+  // Flap storm: every interface alternates good/bad so the FSMs keep
+  // transitioning; recording and draining must not touch the heap.
+  {
+    AgentConfig cfg;
+    cfg.score.useEwma = false;
+    cfg.fsm.healthy_enter_N = 1;
+    cfg.fsm.healthy_exit_N = 1;
+    cfg.fsm.down_enter_N = 1;
+    cfg.fsm.down_exit_N = 1;
+    cfg.fsm.min_dwell_sec = 0;
+    cfg.fsm.min_confidence_for_promotion = 0.0;
+    cfg.score.enable_confidence_cap = false;
+
+    constexpr int kIfaces = 256;
+    TelemetryAgent agent(cfg, TransitionLogConfig{1024, OverflowPolicy::OverwriteOldest});
+    std::vector<InterfaceId> ids;
+    for (int i = 0; i < kIfaces; ++i) ids.push_back(agent.register_interface("if" + std::to_string(i)));
+
+    const Metrics good{10, 200, 0, 0};
+    const Metrics bad{800, 0, 30, 200};
+    // Ticks are 100 s apart, so each window holds just the latest sample.
+    auto tick = [&](int64_t t) {
+      agent.note_time(t);
+      const Metrics& m = ((t / 100) % 2 == 0) ? bad : good;
+      for (auto id : ids) agent.ingest(id, t, m);
+    };
+
+    for (int64_t t = 0; t < 1000; t += 100) tick(t);
+    agent.drain_transitions([](const TransitionEvent&) {});
+
+    const long before = g_allocs;
+    const uint64_t overwritten = agent.transition_stats().overwritten;
+    uint64_t drained = 0;
+    for (int64_t t = 1000; t < 5000; t += 100) {
+      tick(t);
+      drained += agent.drain_transitions([&]([[maybe_unused]] const TransitionEvent& e) {
+        assert(e.id < kIfaces);
+        assert(e.reason != TransitionReason::None);
+        assert(e.from != e.to);
+      });
+    }
+    assert(g_allocs == before);
+    assert(drained > 0);
+    assert(agent.transition_stats().overwritten == overwritten); // drained every tick
+  }
+
+  std::printf("test_transition_ring OK\n");
+  return 0;
+}
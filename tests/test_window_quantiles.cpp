@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "columnar_agent.hpp"
+#include "telemetry_agent.hpp"
+#include "window_quantiles.hpp"
+
+using namespace telemetry;
+
+[[maybe_unused]] static double nearest_rank(std::vector<double> v, double q) {
+  if (v.empty()) return 0.0;
+  std::sort(v.begin(), v.end());
+  const auto rank = static_cast<std::size_t>(std::ceil(q * static_cast<double>(v.size())));
+  return v[std::clamp<std::size_t>(rank, 1, v.size()) - 1];
+}
+
+int main() {
+  // SortedWindow against a sorted reference, duplicates included.
+  {
+    SortedWindow<45> w;
+    std::vector<double> ref;
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> val(0, 20);
+    for (int i = 0; i < 20000; ++i) {
+      if (ref.size() < 45 && (ref.empty() || rng() % 2)) {
+        const double x = val(rng);
+        w.insert(x);
+        ref.push_back(x);
+      } else {
+        const std::size_t k = rng() % ref.size();
+        w.erase(ref[k]);
+        ref.erase(ref.begin() + static_cast<std::ptrdiff_t>(k));
+      }
+      assert(w.size() == ref.size());
+      for (double q : {0.0, 0.5, 0.95, 0.99, 1.0}) assert(w.quantile(q) == nearest_rank(ref, q));
+    }
+    w.insert(std::nan(""));
+    assert(w.size() == ref.size());
+  }
+
+  // RollingWindow quantiles follow the window through overwrites, late
+  // samples, eviction and idle gaps.
+  {
+    RollingWindow w;
+    w.enable_quantiles();
+    assert(w.quantiles_enabled());
+    std::mt19937 rng(2);
+    std::uniform_int_distribution<int> late(-50, 2);
+    std::uniform_real_distribution<double> val(1.0, 900.0);
+    int64_t now = 0;
+    for (int i = 0; i < 20000; ++i) {
+      if (i % 3 == 0) ++now;
+      if (i % 1000 == 999) now += 100;
+      w.note_time(now);
+      w.ingest(now + late(rng), Metrics{val(rng), 100.0, val(rng) / 30.0, val(rng) / 5.0});
+
+      std::vector<double> rtt, jit, loss;
+      for (int64_t t = w.newest_ts() - (RollingWindow::kWindow - 1); t <= w.newest_ts(); ++t) {
+        if (const auto m = w.get(t)) {
+          rtt.push_back(m->rtt_ms);
+          jit.push_back(m->jitter_ms);
+          loss.push_back(m->loss_pct);
+        }
+      }
+      const auto s = w.summary();
+      assert(s.p50_rtt_ms == nearest_rank(rtt, 0.50));
+      assert(s.p95_rtt_ms == nearest_rank(rtt, 0.95));
+      assert(s.p99_rtt_ms == nearest_rank(rtt, 0.99));
+      assert(s.p95_jitter_ms == nearest_rank(jit, 0.95));
+      assert(s.max_loss_pct == nearest_rank(loss, 1.0));
+    }
+
+    // Copies carry their own quantile state.
+    RollingWindow copy = w;
+    copy.note_time(w.newest_ts() + 1000);
+    assert(copy.summary().p50_rtt_ms == 0.0 && w.summary().p50_rtt_ms != 0.0);
+  }
+
+  // Default windows do not track quantiles.
+  {
+    RollingWindow w;
+    w.ingest(0, Metrics{50, 100, 1, 5});
+    assert(!w.quantiles_enabled() && w.summary().p50_rtt_ms == 0.0);
+  }
+
+  // One 2 s RTT spike among 44 good seconds: the mean drops the score, the
+  // median ignores it. A sustained rise moves both.
+  {
+    AgentConfig mean_cfg;
+    mean_cfg.score.useEwma = false;
+    AgentConfig p50_cfg = mean_cfg;
+    p50_cfg.score.rtt_stat = WindowStat::P50;
+    AgentConfig p99_cfg = mean_cfg;
+    p99_cfg.score.rtt_stat = WindowStat::P99;
+
+    TelemetryAgent a(mean_cfg), b(p50_cfg), c(p99_cfg);
+    for (auto* ag : {&a, &b, &c}) ag->register_interface("eth0");
+    for (int64_t t = 0; t < 45; ++t) {
+      const Metrics m{t == 20 ? 2000.0 : 30.0, 180.0, 0.1, 3.0};
+      for (auto* ag : {&a, &b, &c}) {
+        ag->note_time(t);
+        ag->ingest(InterfaceId{0}, t, m);
+      }
+    }
+    const double good = InterfaceTracker::norm_rtt(30.0);
+    const double spike_mean = InterfaceTracker::norm_rtt((44 * 30.0 + 2000.0) / 45.0);
+    assert(std::abs((b.snapshot(0).score_raw - a.snapshot(0).score_raw) -
+                    mean_cfg.score.w_rtt * (good - spike_mean)) <= 1e-12);
+    assert(c.snapshot(0).score_raw < a.snapshot(0).score_raw); // p99 sees the spike in full
+
+    for (int64_t t = 45; t < 90; ++t) {
+      for (auto* ag : {&a, &b, &c}) {
+        ag->note_time(t);
+        ag->ingest(InterfaceId{0}, t, Metrics{400.0, 180.0, 0.1, 3.0});
+      }
+    }
+    assert(std::abs(a.snapshot(0).score_raw - b.snapshot(0).score_raw) <= 1e-12);
+  }
+
+  // Loss on the window maximum.
+  {
+    AgentConfig cfg;
+    cfg.score.loss_use_max = true;
+    TelemetryAgent agent(cfg);
+    agent.register_interface("eth0");
+    agent.note_time(0);
+    agent.ingest(InterfaceId{0}, 0, Metrics{30, 180, 15.0, 3});
+    agent.ingest(InterfaceId{0}, 1, Metrics{30, 180, 0.0, 3});
+    const double expect = cfg.score.w_tp * InterfaceTracker::norm_tp(180) +
+                          cfg.score.w_rtt * InterfaceTracker::norm_rtt(30) +
+                          cfg.score.w_loss * InterfaceTracker::norm_loss(15.0) +
+                          cfg.score.w_jit * InterfaceTracker::norm_jit(3);
+    assert(std::abs(agent.snapshot(0).score_raw - expect) <= 1e-12);
+  }
+
+  // The columnar engine scores on means only and says so.
+  {
+    AgentConfig cfg;
+    cfg.score.jitter_stat = WindowStat::P95;
+    bool threw = false;
+    try {
+      ColumnarTelemetryAgent col(cfg);
+    } catch (const std::invalid_argument&) {
+      threw = true;
+    }
+    assert(threw);
+  }
+
+  std::printf("test_window_quantiles OK\n");
+  return 0;
+}